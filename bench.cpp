@@ -0,0 +1,164 @@
+// ═══════════════════════════════════════
+// Режим замера производительности (--bench)
+// ═══════════════════════════════════════
+
+#include "bench.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// ═══════════════════════════════════════
+// Статистика
+// ═══════════════════════════════════════
+
+// Перцентиль по отсортированному массиву (метод ближайшего ранга)
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    std::size_t rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(sorted.size()) + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > sorted.size()) rank = sorted.size();
+    return sorted[rank - 1];
+}
+
+FrameStats computeFrameStats(std::vector<double> frameMs) {
+    FrameStats st;
+    if (frameMs.empty()) return st;
+
+    std::sort(frameMs.begin(), frameMs.end());
+    double sum = 0.0;
+    for (double v : frameMs) sum += v;
+
+    st.frames = static_cast<int>(frameMs.size());
+    st.minMs  = frameMs.front();
+    st.maxMs  = frameMs.back();
+    st.meanMs = sum / static_cast<double>(frameMs.size());
+    st.p50Ms  = percentile(frameMs, 50.0);
+    st.p95Ms  = percentile(frameMs, 95.0);
+    st.p99Ms  = percentile(frameMs, 99.0);
+    st.fps    = st.meanMs > 0.0 ? 1000.0 / st.meanMs : 0.0;
+    return st;
+}
+
+// ═══════════════════════════════════════
+// Отчёт
+// ═══════════════════════════════════════
+
+// Вывести строку в JSON с экранированием кавычек и обратной косой черты
+static void writeJsonString(std::FILE* out, const char* str) {
+    std::fputc('"', out);
+    for (const char* c = str; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') std::fputc('\\', out);
+        std::fputc(*c, out);
+    }
+    std::fputc('"', out);
+}
+
+static void writeJson(std::FILE* out, const BenchOptions& opts, const FrameStats& st,
+                      std::size_t itemsPerFrame, const char* renderer) {
+    std::fprintf(out,
+        "{\"scene\":%d,\"width\":%d,\"height\":%d,\"items\":%zu,\"frames\":%d,",
+        opts.scene, opts.width, opts.height, itemsPerFrame, st.frames);
+    std::fprintf(out, "\"renderer\":");
+    writeJsonString(out, renderer);
+    std::fprintf(out,
+        ",\"frame_ms\":{\"min\":%.4f,\"mean\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"p99\":%.4f,\"max\":%.4f},"
+        "\"fps\":%.2f,\"items_per_sec\":%.1f}\n",
+        st.minMs, st.meanMs, st.p50Ms, st.p95Ms, st.p99Ms, st.maxMs,
+        st.fps, st.fps * static_cast<double>(itemsPerFrame));
+}
+
+static void printReport(const BenchOptions& opts, const FrameStats& st,
+                        std::size_t itemsPerFrame, const char* renderer) {
+    std::printf("Benchmark: scene %d, %dx%d, %zu %s, %d frames (+%d warmup)\n",
+                opts.scene, opts.width, opts.height, itemsPerFrame,
+                opts.scene == 0 ? "trees" : "objects", st.frames, opts.warmup);
+    std::printf("Renderer:  %s\n", renderer);
+    std::printf("Frame time (ms): min %.3f  mean %.3f  p50 %.3f  p95 %.3f  p99 %.3f  max %.3f\n",
+                st.minMs, st.meanMs, st.p50Ms, st.p95Ms, st.p99Ms, st.maxMs);
+    std::printf("Throughput: %.1f fps, %.0f %s/s\n", st.fps,
+                st.fps * static_cast<double>(itemsPerFrame),
+                opts.scene == 0 ? "trees" : "objects");
+
+    writeJson(stdout, opts, st, itemsPerFrame, renderer);
+
+    if (!opts.jsonPath.empty()) {
+        std::FILE* f = std::fopen(opts.jsonPath.c_str(), "w");
+        if (f == nullptr) {
+            std::fprintf(stderr, "Cannot write %s\n", opts.jsonPath.c_str());
+            return;
+        }
+        writeJson(f, opts, st, itemsPerFrame, renderer);
+        std::fclose(f);
+    }
+}
+
+// ═══════════════════════════════════════
+// Прогон
+// ═══════════════════════════════════════
+
+int runBenchmark(GLFWwindow* window, const BenchOptions& opts,
+                 void (*renderFrame)(), std::size_t itemsPerFrame) {
+    typedef std::chrono::steady_clock Clock;
+
+    // Без ожидания вертикальной синхронизации
+    glfwSwapInterval(0);
+
+    std::vector<double> frameMs;
+    frameMs.reserve(static_cast<std::size_t>(opts.frames));
+
+    for (int i = 0; i < opts.warmup + opts.frames; ++i) {
+        Clock::time_point t0 = Clock::now();
+        profilerBeginFrame();
+        renderFrame();
+        {
+            PROFILE_SCOPE("glfwSwapBuffers");
+            glfwSwapBuffers(window);
+        }
+        {
+            PROFILE_SCOPE("glfwPollEvents");
+            glfwPollEvents();
+        }
+        {
+            PROFILE_SCOPE("glFinish");
+            glFinish(); // кадр считается законченным, когда GPU выполнил все команды
+        }
+        profilerEndFrame();
+        Clock::time_point t1 = Clock::now();
+
+        if (i >= opts.warmup) {
+            frameMs.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+    }
+
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    printReport(opts, computeFrameStats(frameMs), itemsPerFrame,
+                renderer != nullptr ? renderer : "unknown");
+    profilerPrintSummary(stdout);
+    return 0;
+}
+
+int runSoftwareBenchmark(const BenchOptions& opts, void (*renderFrame)(),
+                         std::size_t itemsPerFrame, const char* renderer) {
+    typedef std::chrono::steady_clock Clock;
+
+    std::vector<double> frameMs;
+    frameMs.reserve(static_cast<std::size_t>(opts.frames));
+
+    for (int i = 0; i < opts.warmup + opts.frames; ++i) {
+        Clock::time_point t0 = Clock::now();
+        profilerBeginFrame();
+        renderFrame();
+        profilerEndFrame();
+        Clock::time_point t1 = Clock::now();
+
+        if (i >= opts.warmup) {
+            frameMs.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+        }
+    }
+
+    printReport(opts, computeFrameStats(frameMs), itemsPerFrame, renderer);
+    profilerPrintSummary(stdout);
+    return 0;
+}
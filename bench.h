@@ -0,0 +1,53 @@
+// ═══════════════════════════════════════
+// Режим замера производительности (--bench)
+// Фиксированное число кадров в скрытом окне, статистика времени кадра
+// в текстовом виде и в JSON
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+#include <string>
+#include <vector>
+
+// Параметры замера (заполняются из командной строки в options.cpp)
+struct BenchOptions {
+    bool        enabled  = false; // передан --bench
+    bool        headless = false; // --headless: платформа GLFW без дисплея + OSMesa
+    int         frames   = 300;   // замеряемые кадры
+    int         warmup   = 30;    // кадры прогрева (не учитываются)
+    int         scene    = 0;     // sceneMode: 0 — 2D-лес, 1 — 3D-объекты
+    int         width    = 800;
+    int         height   = 600;
+    int         trees    = -1;    // число деревьев (-1 — исходная сцена)
+    int         objects  = -1;    // число 3D-объектов (-1 — исходная сцена)
+    std::string jsonPath;         // файл для JSON-отчёта (пусто — только stdout)
+    double      panSpeed = 0.0;   // сдвиг 2D-сцены за кадр (проверка подгрузки при движении)
+};
+
+// Статистика времени кадра, миллисекунды
+struct FrameStats {
+    int    frames = 0;
+    double minMs  = 0.0;
+    double meanMs = 0.0;
+    double p50Ms  = 0.0;
+    double p95Ms  = 0.0;
+    double p99Ms  = 0.0;
+    double maxMs  = 0.0;
+    double fps    = 0.0;
+};
+
+// Посчитать статистику по длительностям кадров (мс)
+FrameStats computeFrameStats(std::vector<double> frameMs);
+
+// Прогнать замер: renderFrame рисует один кадр, swap и ожидание GPU делает раннер.
+// itemsPerFrame — число деревьев или объектов в кадре (для пропускной способности).
+// Возвращает код завершения процесса
+int runBenchmark(GLFWwindow* window, const BenchOptions& opts,
+                 void (*renderFrame)(), std::size_t itemsPerFrame);
+
+// Замер программной отрисовки: без окна и буфера кадра, renderFrame сам
+// дожидается готовности кадра. renderer — описание для отчёта
+int runSoftwareBenchmark(const BenchOptions& opts, void (*renderFrame)(),
+                         std::size_t itemsPerFrame, const char* renderer);
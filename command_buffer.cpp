@@ -0,0 +1,125 @@
+// ═══════════════════════════════════════
+// Буферы команд рисования, записываемые параллельно
+// ═══════════════════════════════════════
+
+#include "command_buffer.h"
+
+#include <algorithm>
+
+// ═══════════════════════════════════════
+// Арена кадра
+// ═══════════════════════════════════════
+
+void* FrameArena::allocate(std::size_t size, std::size_t align) {
+    for (;;) {
+        if (mBlock < mBlocks.size()) {
+            Block& block = mBlocks[mBlock];
+            std::size_t offset = (mOffset + align - 1) & ~(align - 1);
+            if (offset + size <= block.size) {
+                mUsed += offset + size - mOffset;
+                mOffset = offset + size;
+                return block.data.get() + offset;
+            }
+            // Не влезло: следующий блок (остаток этого пропадает до reset)
+            ++mBlock;
+            mOffset = 0;
+            continue;
+        }
+
+        // Новый блок: не меньше запроса и вдвое больше прошлого
+        std::size_t blockSize = mBlocks.empty() ? ARENA_BLOCK_SIZE : mBlocks.back().size * 2;
+        blockSize = std::max(blockSize, size + align);
+        Block block;
+        block.data.reset(new unsigned char[blockSize]);
+        block.size = blockSize;
+        mBlocks.push_back(std::move(block));
+        mCapacity += blockSize;
+    }
+}
+
+void FrameArena::reset() {
+    if (mBlocks.size() > 1) {
+        Block merged;
+        merged.data.reset(new unsigned char[mCapacity]);
+        merged.size = mCapacity;
+        mBlocks.clear();
+        mBlocks.push_back(std::move(merged));
+    }
+    mBlock = 0;
+    mOffset = 0;
+    mUsed = 0;
+}
+
+// ═══════════════════════════════════════
+// Буфер исполнителя
+// ═══════════════════════════════════════
+
+void CommandBuffer::draw(std::uint32_t sequence, std::uint32_t stateKey, const Mesh& mesh,
+                         const Mat4* modelView, int material) {
+    if (mCount == mPages.size() * COMMAND_PAGE_SIZE) {
+        mPages.push_back(mArena.allocateArray<DrawCommand>(COMMAND_PAGE_SIZE));
+    }
+    DrawCommand& cmd = mPages[mCount / COMMAND_PAGE_SIZE][mCount % COMMAND_PAGE_SIZE];
+    cmd.sequence  = sequence;
+    cmd.stateKey  = stateKey;
+    cmd.material  = material;
+    cmd.mesh      = &mesh;
+    cmd.modelView = modelView;
+    ++mCount;
+}
+
+void CommandBuffer::reset() {
+    mArena.reset();
+    mPages.clear();
+    mCount = 0;
+}
+
+// ═══════════════════════════════════════
+// Слияние и проигрывание
+// ═══════════════════════════════════════
+
+void CommandRecorder::begin(const ThreadPool& pool) {
+    if (mBuffers.size() != pool.size()) mBuffers.resize(pool.size());
+    for (CommandBuffer& buffer : mBuffers) buffer.reset();
+}
+
+std::size_t CommandRecorder::arenaBytes() const {
+    std::size_t bytes = 0;
+    for (const CommandBuffer& buffer : mBuffers) bytes += buffer.arena().used();
+    return bytes;
+}
+
+std::size_t CommandRecorder::submit(const CommandBackend& backend, bool stateSort) {
+    // Номера команд плотные: каждая встаёт на своё место без сортировки
+    std::size_t total = 0;
+    for (const CommandBuffer& buffer : mBuffers) total += buffer.size();
+    mCommands.resize(total);
+    for (const CommandBuffer& buffer : mBuffers) {
+        for (std::size_t i = 0; i < buffer.size(); ++i) mCommands[buffer[i].sequence] = &buffer[i];
+    }
+
+    // Сортировка по состоянию устойчива: при равном ключе — исходный порядок
+    if (stateSort && total > 1) {
+        mItems.resize(total);
+        mScratch.resize(total);
+        for (std::size_t i = 0; i < total; ++i) {
+            mItems[i] = {mCommands[i]->stateKey, static_cast<std::uint32_t>(i)};
+        }
+        radixSort(mItems, mScratch);
+        mSorted.resize(total);
+        for (std::size_t i = 0; i < total; ++i) mSorted[i] = mCommands[mItems[i].value];
+        mCommands.swap(mSorted);
+    }
+
+    std::size_t triangles = 0;
+    int material = -1;
+    for (const DrawCommand* cmd : mCommands) {
+        if (cmd->material != material) {
+            material = cmd->material;
+            if (backend.setMaterial != nullptr) backend.setMaterial(material);
+        }
+        backend.draw(*cmd->mesh, *cmd->modelView, cmd->material);
+        triangles += cmd->mesh->indices.size() / 3;
+    }
+    return triangles;
+}
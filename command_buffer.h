@@ -0,0 +1,136 @@
+// ═══════════════════════════════════════
+// Буферы команд рисования, записываемые параллельно
+// Обход сцены делится между потоками пула: каждый исполнитель пишет команды
+// в свой буфер, память которого берётся из арены кадра (сдвиг указателя,
+// сброс в начале кадра, без обращений к куче после прогрева). Поток OpenGL
+// сливает буферы по порядковым номерам команд, при необходимости сортирует
+// по состоянию и проигрывает поток через заданные функции — сами команды
+// о OpenGL ничего не знают
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "mesh.h"
+#include "radix_sort.h"
+#include "thread_pool.h"
+#include "vecmath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+// Размер первого блока арены, байты
+static const std::size_t ARENA_BLOCK_SIZE = 64 * 1024;
+
+// Команд в одной странице буфера
+static const std::size_t COMMAND_PAGE_SIZE = 256;
+
+// ═══════════════════════════════════════
+// Арена кадра
+// ═══════════════════════════════════════
+
+class FrameArena {
+public:
+    // Выделить size байт с выравниванием align (степень двойки, не больше 16)
+    void* allocate(std::size_t size, std::size_t align);
+
+    // Массив без конструкторов и деструкторов: живёт до reset
+    template <typename T>
+    T* allocateArray(std::size_t count) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena memory is never destroyed");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Освободить всё выделенное за кадр. Если кадр не уместился в один блок,
+    // блоки заменяются одним общего размера — следующий кадр обойдётся им
+    void reset();
+
+    std::size_t used() const { return mUsed; }
+    std::size_t capacity() const { return mCapacity; }
+
+private:
+    struct Block {
+        std::unique_ptr<unsigned char[]> data;
+        std::size_t size = 0;
+    };
+
+    std::vector<Block> mBlocks;
+    std::size_t mBlock = 0;    // текущий блок
+    std::size_t mOffset = 0;   // занято в текущем блоке
+    std::size_t mUsed = 0;     // всего за кадр (с выравниванием)
+    std::size_t mCapacity = 0;
+};
+
+// ═══════════════════════════════════════
+// Команды
+// ═══════════════════════════════════════
+
+// Нарисовать сетку с материалом. sequence — место в исходном порядке
+// рисования (номера кадра идут от 0 без пропусков), stateKey — ключ
+// состояния (сетка и материал) для сортировки
+struct DrawCommand {
+    std::uint32_t sequence;
+    std::uint32_t stateKey;
+    int           material;
+    const Mesh*   mesh;
+    const Mat4*   modelView; // в арене записавшего буфера
+};
+
+// Команды одного исполнителя: страницы по COMMAND_PAGE_SIZE в его арене
+class CommandBuffer {
+public:
+    FrameArena& arena() { return mArena; }
+    const FrameArena& arena() const { return mArena; }
+
+    // Записать команду рисования; modelView должна лежать в arena()
+    void draw(std::uint32_t sequence, std::uint32_t stateKey, const Mesh& mesh,
+              const Mat4* modelView, int material);
+
+    std::size_t size() const { return mCount; }
+    const DrawCommand& operator[](std::size_t i) const {
+        return mPages[i / COMMAND_PAGE_SIZE][i % COMMAND_PAGE_SIZE];
+    }
+
+    // Начать кадр: команды и арена сбрасываются, память остаётся
+    void reset();
+
+private:
+    FrameArena mArena;
+    std::vector<DrawCommand*> mPages;
+    std::size_t mCount = 0;
+};
+
+// Функции проигрывания (поток OpenGL). setMaterial вызывается только при
+// смене материала и может быть nullptr, если draw ставит материал сам
+struct CommandBackend {
+    void (*setMaterial)(int material);
+    void (*draw)(const Mesh& mesh, const Mat4& modelView, int material);
+};
+
+// Буферы всех исполнителей пула и слияние их в один поток
+class CommandRecorder {
+public:
+    // Начать кадр: по буферу на исполнителя pool
+    void begin(const ThreadPool& pool);
+
+    // Буфер исполнителя (номер из parallelFor/parallelForStealing)
+    CommandBuffer& buffer(unsigned worker) { return mBuffers[worker]; }
+
+    // Слить буферы в исходном порядке (раскладкой по sequence); stateSort —
+    // затем устойчиво упорядочить по stateKey (порядок рисования не важен).
+    // Проиграть поток через backend; возвращает число треугольников
+    std::size_t submit(const CommandBackend& backend, bool stateSort);
+
+    // Итоги последнего кадра
+    std::size_t commandCount() const { return mCommands.size(); }
+    std::size_t arenaBytes() const;
+
+private:
+    std::vector<CommandBuffer> mBuffers;
+    std::vector<const DrawCommand*> mCommands;
+    std::vector<const DrawCommand*> mSorted;
+    std::vector<SortItem> mItems;
+    std::vector<SortItem> mScratch;
+};
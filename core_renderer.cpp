@@ -0,0 +1,299 @@
+// ═══════════════════════════════════════
+// Программируемый конвейер для core-профиля OpenGL 3.3
+// ═══════════════════════════════════════
+
+#include "core_renderer.h"
+#include "gl_ext.h"
+#include "shader.h"
+#include "stream_ring.h"
+
+#include <cstdio>
+#include <cstring>
+
+// ═══════════════════════════════════════
+// Шейдеры
+// ═══════════════════════════════════════
+
+// Блоки uniform-буферов (раскладка std140: только vec4 и mat4, без выравнивающих дыр)
+#define LAB_FRAME_BLOCK                                                        \
+    "layout(std140) uniform Frame {\n"                                         \
+    "    mat4 uProjection;\n"                                                  \
+    "    vec4 uLightPosition;\n"                                               \
+    "    vec4 uLightAmbient;\n"                                                \
+    "    vec4 uLightDiffuse;\n"                                                \
+    "    vec4 uLightSpecular;\n"                                               \
+    "    vec4 uModelAmbient;\n"                                                \
+    "    vec4 uParams;\n" /* x — яркость, y — альфа рассеянного цвета */       \
+    "};\n"
+
+// Освещённые объекты: модельно-видовая матрица объекта считается на процессоре
+// (пакетом для всех объектов кадра); нормаль поворачивается её верхним блоком 3x3
+// (в сцене только повороты и переносы) и нормализуется во фрагментном шейдере
+static const char* LIT_VS =
+    "#version 330 core\n"
+    LAB_FRAME_BLOCK
+    "uniform mat4 uModelView;\n"
+    "in vec3 aPosition;\n"
+    "in vec3 aNormal;\n"
+    "out vec3 vEyePos;\n"
+    "out vec3 vNormal;\n"
+    "void main() {\n"
+    "    vec4 eye = uModelView * vec4(aPosition, 1.0);\n"
+    "    vEyePos = eye.xyz;\n"
+    "    vNormal = mat3(uModelView) * aNormal;\n"
+    "    gl_Position = uProjection * eye;\n"
+    "}\n";
+
+static const char* LIT_FS =
+    "#version 330 core\n"
+    LAB_FRAME_BLOCK
+    "struct MaterialData {\n"
+    "    vec4 ambient;\n"
+    "    vec4 diffuse;\n" // w — резкость блика
+    "    vec4 specular;\n"
+    "};\n"
+    "layout(std140) uniform Materials {\n"
+    "    MaterialData uMaterials[64];\n" // CORE_MAX_MATERIALS
+    "};\n"
+    "uniform int uMaterial;\n"
+    "in vec3 vEyePos;\n"
+    "in vec3 vNormal;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    MaterialData m = uMaterials[uMaterial];\n"
+    "    float brightness = uParams.x;\n"
+    "    vec3 n = normalize(vNormal);\n"
+    "    if (!gl_FrontFacing) n = -n;\n" // двустороннее освещение
+    "    vec3 l = normalize(uLightPosition.w != 0.0 ? uLightPosition.xyz - vEyePos\n"
+    "                                               : uLightPosition.xyz);\n"
+    "    float nDotL = dot(n, l);\n"
+    "    vec3 color = uModelAmbient.rgb * m.ambient.rgb\n"
+    "               + uLightAmbient.rgb * brightness * m.ambient.rgb;\n"
+    "    if (nDotL > 0.0) {\n"
+    "        color += nDotL * uLightDiffuse.rgb * brightness * m.diffuse.rgb;\n"
+    "        float nDotH = dot(n, normalize(l + vec3(0.0, 0.0, 1.0)));\n" // наблюдатель на бесконечности
+    "        if (nDotH > 0.0) {\n"
+    "            color += pow(nDotH, m.diffuse.w) * uLightSpecular.rgb * brightness * m.specular.rgb;\n"
+    "        }\n"
+    "    }\n"
+    "    fragColor = vec4(clamp(color, 0.0, 1.0), clamp(uParams.y, 0.0, 1.0));\n"
+    "}\n";
+
+// Сплошная заливка прямоугольника: единичный квадрат растягивается на uRect
+static const char* FLAT_VS =
+    "#version 330 core\n"
+    "uniform mat4 uMvp;\n"
+    "uniform vec4 uRect;\n" // x0, y0, x1, y1
+    "in vec2 aCorner;\n"
+    "void main() {\n"
+    "    gl_Position = uMvp * vec4(mix(uRect.xy, uRect.zw, aCorner), 0.0, 1.0);\n"
+    "}\n";
+
+static const char* FLAT_FS =
+    "#version 330 core\n"
+    "uniform vec4 uColor;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    fragColor = uColor;\n"
+    "}\n";
+
+// Точки привязки uniform-буферов
+static const GLuint FRAME_BINDING    = 0;
+static const GLuint MATERIAL_BINDING = 1;
+
+// Атрибут угла квадрата
+static const GLuint ATTR_CORNER = 0;
+
+// ═══════════════════════════════════════
+// Содержимое uniform-буферов (std140)
+// ═══════════════════════════════════════
+
+struct FrameBlock {
+    float projection[16];
+    float lightPosition[4];
+    float lightAmbient[4];
+    float lightDiffuse[4];
+    float lightSpecular[4];
+    float modelAmbient[4];
+    float params[4];
+};
+
+struct MaterialBlock {
+    float ambient[4];
+    float diffuse[4];
+    float specular[4];
+};
+
+// Фоновый цвет материала не задаётся сценой — значение OpenGL по умолчанию
+static const float MATERIAL_AMBIENT = 0.2f;
+
+// ═══════════════════════════════════════
+// Ресурсы
+// ═══════════════════════════════════════
+
+static bool   gCoreReady = false;
+static GLuint gLitProgram = 0;
+static GLuint gFlatProgram = 0;
+static GLuint gFrameUbo = 0;
+static GLuint gMaterialUbo = 0;
+static GLuint gQuadVbo = 0;
+static GLuint gQuadVao = 0;
+
+static GLint gModelViewLocation = -1;
+static GLint gMaterialLocation = -1;
+static GLint gFlatMvpLocation = -1;
+static GLint gFlatRectLocation = -1;
+static GLint gFlatColorLocation = -1;
+
+// Привязать блок программы к точке; false — блока нет (ошибка в шейдере)
+static bool bindBlock(GLuint program, const char* name, GLuint binding) {
+    GLuint index = gl.GetUniformBlockIndex(program, name);
+    if (index == GL_INVALID_INDEX) return false;
+    gl.UniformBlockBinding(program, index, binding);
+    return true;
+}
+
+bool initCoreRenderer() {
+    if (gCoreReady) return true;
+    if (!gl.hasUniformBuffers || !gl.hasInstancing || !glVersionAtLeast(3, 3)) return false;
+
+    const AttribBinding litBindings[] = {
+        {MESH_ATTR_POSITION, "aPosition"},
+        {MESH_ATTR_NORMAL,   "aNormal"},
+    };
+    const AttribBinding flatBindings[] = {
+        {ATTR_CORNER, "aCorner"},
+    };
+    gLitProgram = buildProgram(LIT_VS, LIT_FS, litBindings, 2);
+    gFlatProgram = buildProgram(FLAT_VS, FLAT_FS, flatBindings, 1);
+    if (gLitProgram == 0 || gFlatProgram == 0 ||
+        !bindBlock(gLitProgram, "Frame", FRAME_BINDING) ||
+        !bindBlock(gLitProgram, "Materials", MATERIAL_BINDING)) {
+        releaseCoreRenderer();
+        return false;
+    }
+    gModelViewLocation = gl.GetUniformLocation(gLitProgram, "uModelView");
+    gMaterialLocation  = gl.GetUniformLocation(gLitProgram, "uMaterial");
+    gFlatMvpLocation   = gl.GetUniformLocation(gFlatProgram, "uMvp");
+    gFlatRectLocation  = gl.GetUniformLocation(gFlatProgram, "uRect");
+    gFlatColorLocation = gl.GetUniformLocation(gFlatProgram, "uColor");
+
+    // Буферы кадра и материалов живут всё время работы и лишь переписываются
+    gl.GenBuffers(1, &gFrameUbo);
+    gl.BindBuffer(GL_UNIFORM_BUFFER, gFrameUbo);
+    gl.BufferData(GL_UNIFORM_BUFFER, sizeof(FrameBlock), nullptr, GL_DYNAMIC_DRAW);
+    gl.GenBuffers(1, &gMaterialUbo);
+    gl.BindBuffer(GL_UNIFORM_BUFFER, gMaterialUbo);
+    gl.BufferData(GL_UNIFORM_BUFFER, sizeof(MaterialBlock) * CORE_MAX_MATERIALS, nullptr, GL_STATIC_DRAW);
+    gl.BindBuffer(GL_UNIFORM_BUFFER, 0);
+    gl.BindBufferBase(GL_UNIFORM_BUFFER, FRAME_BINDING, gFrameUbo);
+    gl.BindBufferBase(GL_UNIFORM_BUFFER, MATERIAL_BINDING, gMaterialUbo);
+
+    // Единичный квадрат веером (0,1,2) и (0,2,3) — как glBegin(GL_QUADS)
+    static const float CORNERS[8] = {0.0f, 0.0f,  1.0f, 0.0f,  1.0f, 1.0f,  0.0f, 1.0f};
+    gl.GenBuffers(1, &gQuadVbo);
+    gl.GenVertexArrays(1, &gQuadVao);
+    gl.BindVertexArray(gQuadVao);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gQuadVbo);
+    gl.BufferData(GL_ARRAY_BUFFER, sizeof(CORNERS), CORNERS, GL_STATIC_DRAW);
+    gl.EnableVertexAttribArray(ATTR_CORNER);
+    gl.VertexAttribPointer(ATTR_CORNER, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+    gl.BindVertexArray(0);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    gCoreReady = true;
+    return true;
+}
+
+void releaseCoreRenderer() {
+    if (gLitProgram != 0) gl.DeleteProgram(gLitProgram);
+    if (gFlatProgram != 0) gl.DeleteProgram(gFlatProgram);
+    if (gFrameUbo != 0) gl.DeleteBuffers(1, &gFrameUbo);
+    if (gMaterialUbo != 0) gl.DeleteBuffers(1, &gMaterialUbo);
+    if (gQuadVbo != 0) gl.DeleteBuffers(1, &gQuadVbo);
+    if (gQuadVao != 0) gl.DeleteVertexArrays(1, &gQuadVao);
+    gLitProgram = gFlatProgram = gFrameUbo = gMaterialUbo = gQuadVbo = gQuadVao = 0;
+    gCoreReady = false;
+}
+
+// ═══════════════════════════════════════
+// Кадр
+// ═══════════════════════════════════════
+
+void coreSetMaterials(const Material* materials, std::size_t count) {
+    if (!gCoreReady) return;
+    if (count > static_cast<std::size_t>(CORE_MAX_MATERIALS)) {
+        std::fprintf(stderr, "Core renderer: %zu materials, only the first %d are used\n",
+                     count, CORE_MAX_MATERIALS);
+        count = CORE_MAX_MATERIALS;
+    }
+
+    MaterialBlock blocks[CORE_MAX_MATERIALS];
+    std::memset(blocks, 0, sizeof(blocks));
+    for (std::size_t i = 0; i < count; ++i) {
+        const Material& m = materials[i];
+        MaterialBlock& b = blocks[i];
+        b.ambient[0] = b.ambient[1] = b.ambient[2] = MATERIAL_AMBIENT;
+        b.ambient[3] = 1.0f;
+        for (int c = 0; c < 3; ++c) b.diffuse[c] = m.diffuse[c];
+        b.diffuse[3] = m.shininess;
+        for (int c = 0; c < 4; ++c) b.specular[c] = m.specular[c];
+    }
+    gl.BindBuffer(GL_UNIFORM_BUFFER, gMaterialUbo);
+    gl.BufferSubData(GL_UNIFORM_BUFFER, 0, static_cast<std::ptrdiff_t>(sizeof(MaterialBlock) * count), blocks);
+    gl.BindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void coreSetFrame(const Mat4& projection, const CoreLight& light, float brightness, float alpha) {
+    FrameBlock block;
+    std::memcpy(block.projection, projection.m, sizeof(block.projection));
+    std::memcpy(block.lightPosition, light.position, sizeof(block.lightPosition));
+    std::memcpy(block.lightAmbient, light.ambient, sizeof(block.lightAmbient));
+    std::memcpy(block.lightDiffuse, light.diffuse, sizeof(block.lightDiffuse));
+    std::memcpy(block.lightSpecular, light.specular, sizeof(block.lightSpecular));
+    std::memcpy(block.modelAmbient, light.modelAmbient, sizeof(block.modelAmbient));
+    block.params[0] = brightness;
+    block.params[1] = alpha;
+    block.params[2] = 0.0f;
+    block.params[3] = 0.0f;
+
+    // С кольцом блок кадра пишется в его сегмент и привязывается диапазоном:
+    // glBufferSubData в буфер, который ещё читает прошлый кадр, не нужен
+    StreamAlloc alloc = streamAllocate(sizeof(block), streamUniformAlignment());
+    if (alloc.ptr != nullptr) {
+        std::memcpy(alloc.ptr, &block, sizeof(block));
+        gl.BindBufferRange(GL_UNIFORM_BUFFER, FRAME_BINDING, alloc.buffer,
+                           static_cast<std::ptrdiff_t>(alloc.offset), sizeof(block));
+        return;
+    }
+    gl.BindBuffer(GL_UNIFORM_BUFFER, gFrameUbo);
+    gl.BufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+    gl.BindBuffer(GL_UNIFORM_BUFFER, 0);
+    gl.BindBufferBase(GL_UNIFORM_BUFFER, FRAME_BINDING, gFrameUbo);
+}
+
+void coreBeginObjects() {
+    gl.UseProgram(gLitProgram);
+}
+
+void coreDrawObject(const Mesh& mesh, const Mat4& modelView, int material) {
+    if (material < 0 || material >= CORE_MAX_MATERIALS) material = 0;
+    gl.UniformMatrix4fv(gModelViewLocation, 1, GL_FALSE, modelView.m);
+    gl.Uniform1i(gMaterialLocation, material);
+    drawMesh(mesh);
+}
+
+void coreEndObjects() {
+    gl.UseProgram(0);
+}
+
+void coreDrawRect(const Mat4& mvp, float x0, float y0, float x1, float y1, const float color[3]) {
+    gl.UseProgram(gFlatProgram);
+    gl.UniformMatrix4fv(gFlatMvpLocation, 1, GL_FALSE, mvp.m);
+    gl.Uniform4f(gFlatRectLocation, x0, y0, x1, y1);
+    gl.Uniform4f(gFlatColorLocation, color[0], color[1], color[2], 1.0f);
+    gl.BindVertexArray(gQuadVao);
+    glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
+    gl.BindVertexArray(0);
+    gl.UseProgram(0);
+}
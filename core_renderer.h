@@ -0,0 +1,49 @@
+// ═══════════════════════════════════════
+// Программируемый конвейер для core-профиля OpenGL 3.3
+// Та же модель освещения, что у фиксированного конвейера (фоновая, рассеянная
+// и зеркальная составляющие, двустороннее освещение, бесконечно удалённый
+// наблюдатель), но считается по пикселям. Проекция, источник света и яркость
+// лежат в uniform-буфере кадра, материалы сцены — массивом в uniform-буфере,
+// геометрия — в VAO
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "mesh.h"
+#include "scene.h"
+#include "vecmath.h"
+
+#include <cstddef>
+
+// Наибольшее число материалов в uniform-буфере (48 байт на материал)
+static const int CORE_MAX_MATERIALS = 64;
+
+// Источник света: позиция в координатах глаза и цвета при яркости 1
+struct CoreLight {
+    float position[4];
+    float ambient[4];
+    float diffuse[4];
+    float specular[4];
+    float modelAmbient[4]; // GL_LIGHT_MODEL_AMBIENT
+};
+
+// Собрать программы и буферы; false — контекст не поддерживает OpenGL 3.3 core
+bool initCoreRenderer();
+
+// Освободить программы и буферы (до уничтожения контекста)
+void releaseCoreRenderer();
+
+// Загрузить материалы сцены (при изменении списка материалов)
+void coreSetMaterials(const Material* materials, std::size_t count);
+
+// Параметры кадра 3D-сцены: проекция, источник света, его яркость
+// и общая прозрачность объектов (альфа рассеянного цвета)
+void coreSetFrame(const Mat4& projection, const CoreLight& light, float brightness, float alpha);
+
+// Освещённые объекты: между begin и end рисуются только coreDrawObject
+void coreBeginObjects();
+void coreDrawObject(const Mesh& mesh, const Mat4& modelView, int material);
+void coreEndObjects();
+
+// Прямоугольник [x0, x1] x [y0, y1] плоскости z = 0 сплошным цветом
+void coreDrawRect(const Mat4& mvp, float x0, float y0, float x1, float y1, const float color[3]);
@@ -0,0 +1,387 @@
+// ═══════════════════════════════════════
+// Отсечение по пирамиде видимости
+// ═══════════════════════════════════════
+
+#include "culling.h"
+
+#include <algorithm>
+#include <cmath>
+
+// SSE2 есть на любом x86-64; на остальных платформах — скалярный путь
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LAB_CULL_SSE 1
+#include <emmintrin.h>
+#endif
+
+// Объектов в листе BVH — ровно одна проверка SSE на плоскость
+static const std::uint32_t BVH_LEAF_SIZE = 4;
+
+// Глубина стека обхода: медианное деление даёт глубину не больше log2(N)
+static const int BVH_STACK_DEPTH = 64;
+
+// Все шесть плоскостей
+static const unsigned ALL_PLANES = 0x3F;
+
+// Желаемое среднее число объектов в ячейке сетки и предел числа ячеек по оси
+static const float GRID_ITEMS_PER_CELL = 4.0f;
+static const int   GRID_MAX_CELLS_AXIS = 1024;
+
+// ═══════════════════════════════════════
+// Матрицы и плоскости
+// ═══════════════════════════════════════
+
+void extractFrustum(const float clip[16], Frustum& frustum) {
+    // Метод Грибба–Хартмана: плоскости — суммы и разности строк матрицы clip
+    for (int i = 0; i < 3; ++i) {
+        float* lo = frustum.planes[i * 2];
+        float* hi = frustum.planes[i * 2 + 1];
+        for (int k = 0; k < 4; ++k) {
+            float w = clip[k * 4 + 3];
+            float v = clip[k * 4 + i];
+            lo[k] = w + v;
+            hi[k] = w - v;
+        }
+    }
+
+    // Нормализация: расстояние до плоскости в мировых единицах
+    for (float* p : frustum.planes) {
+        float len = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        if (len > 0.0f) {
+            p[0] /= len; p[1] /= len; p[2] /= len; p[3] /= len;
+        }
+    }
+}
+
+Rect2D orthoViewRect(const float clip[16]) {
+    // x_clip = m0 * x + m12, видимая полоса -1..1 (аналогично по y)
+    float x0 = (-1.0f - clip[12]) / clip[0];
+    float x1 = ( 1.0f - clip[12]) / clip[0];
+    float y0 = (-1.0f - clip[13]) / clip[5];
+    float y1 = ( 1.0f - clip[13]) / clip[5];
+    Rect2D r;
+    r.minX = std::min(x0, x1);
+    r.maxX = std::max(x0, x1);
+    r.minY = std::min(y0, y1);
+    r.maxY = std::max(y0, y1);
+    return r;
+}
+
+Aabb transformAabb(const Aabb& local, float angleDeg, const float axis[3], const float position[3]) {
+    // Матрица поворота как у glRotatef
+    Mat4 rot = mat4Rotate(angleDeg, axis[0], axis[1], axis[2]);
+
+    // Метод Арво: центр поворачивается, полуразмер — через модули элементов
+    float center[3], extent[3];
+    for (int i = 0; i < 3; ++i) {
+        center[i] = 0.5f * (local.min[i] + local.max[i]);
+        extent[i] = 0.5f * (local.max[i] - local.min[i]);
+    }
+    Aabb out;
+    for (int i = 0; i < 3; ++i) {
+        float c = position[i];
+        float e = 0.0f;
+        for (int j = 0; j < 3; ++j) {
+            c += rot.m[j * 4 + i] * center[j];
+            e += std::fabs(rot.m[j * 4 + i]) * extent[j];
+        }
+        out.min[i] = c - e;
+        out.max[i] = c + e;
+    }
+    return out;
+}
+
+// ═══════════════════════════════════════
+// Равномерная 2D-сетка
+// ═══════════════════════════════════════
+
+void UniformGrid2D::build(const Rect2D* rects, std::size_t count) {
+    mRects.assign(rects, rects + count);
+    mMarks.assign(count, 0);
+    mMaxHalfW = mMaxHalfH = 0.0f;
+    if (count == 0) {
+        mCols = mRows = 0;
+        mCellStart.assign(1, 0);
+        mItems.clear();
+        return;
+    }
+
+    // Область центров и наибольшие полуразмеры
+    float minX = rects[0].minX, maxX = rects[0].maxX;
+    float minY = rects[0].minY, maxY = rects[0].maxY;
+    float cMinX = 0.0f, cMaxX = 0.0f, cMinY = 0.0f, cMaxY = 0.0f;
+    for (std::size_t i = 0; i < count; ++i) {
+        const Rect2D& r = rects[i];
+        float cx = 0.5f * (r.minX + r.maxX);
+        float cy = 0.5f * (r.minY + r.maxY);
+        if (i == 0) {
+            cMinX = cMaxX = cx;
+            cMinY = cMaxY = cy;
+        }
+        cMinX = std::min(cMinX, cx); cMaxX = std::max(cMaxX, cx);
+        cMinY = std::min(cMinY, cy); cMaxY = std::max(cMaxY, cy);
+        minX = std::min(minX, r.minX); maxX = std::max(maxX, r.maxX);
+        minY = std::min(minY, r.minY); maxY = std::max(maxY, r.maxY);
+        mMaxHalfW = std::max(mMaxHalfW, 0.5f * (r.maxX - r.minX));
+        mMaxHalfH = std::max(mMaxHalfH, 0.5f * (r.maxY - r.minY));
+    }
+
+    // Число ячеек пропорционально числу объектов, форма — по пропорциям области
+    float w = std::max(cMaxX - cMinX, 1e-6f);
+    float h = std::max(cMaxY - cMinY, 1e-6f);
+    float cells = std::max(1.0f, static_cast<float>(count) / GRID_ITEMS_PER_CELL);
+    float cols = std::sqrt(cells * w / h);
+    mCols = std::min(GRID_MAX_CELLS_AXIS, std::max(1, static_cast<int>(cols)));
+    mRows = std::min(GRID_MAX_CELLS_AXIS, std::max(1, static_cast<int>(cells / mCols)));
+    mOriginX = cMinX;
+    mOriginY = cMinY;
+    mCellW = w / mCols;
+    mCellH = h / mRows;
+
+    // Раскладка подсчётом: сначала размеры ячеек, затем их содержимое
+    std::vector<std::uint32_t> cellOf(count);
+    mCellStart.assign(static_cast<std::size_t>(mCols) * mRows + 1, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        const Rect2D& r = rects[i];
+        int col = static_cast<int>((0.5f * (r.minX + r.maxX) - mOriginX) / mCellW);
+        int row = static_cast<int>((0.5f * (r.minY + r.maxY) - mOriginY) / mCellH);
+        col = std::min(std::max(col, 0), mCols - 1);
+        row = std::min(std::max(row, 0), mRows - 1);
+        cellOf[i] = static_cast<std::uint32_t>(row * mCols + col);
+        ++mCellStart[cellOf[i] + 1];
+    }
+    for (std::size_t c = 1; c < mCellStart.size(); ++c) mCellStart[c] += mCellStart[c - 1];
+
+    mItems.resize(count);
+    std::vector<std::uint32_t> fill(mCellStart.begin(), mCellStart.end() - 1);
+    for (std::size_t i = 0; i < count; ++i) {
+        mItems[fill[cellOf[i]]++] = static_cast<std::uint32_t>(i);
+    }
+}
+
+void UniformGrid2D::query(const Rect2D& view, std::vector<std::uint32_t>& visible,
+                          CullStats& stats) const {
+    visible.clear();
+    stats.visible = 0;
+    stats.culled = mRects.size();
+    if (mRects.empty()) return;
+
+    // Ячейки, центры которых могут дать пересечение с view
+    int c0 = static_cast<int>(std::floor((view.minX - mMaxHalfW - mOriginX) / mCellW));
+    int c1 = static_cast<int>(std::floor((view.maxX + mMaxHalfW - mOriginX) / mCellW));
+    int r0 = static_cast<int>(std::floor((view.minY - mMaxHalfH - mOriginY) / mCellH));
+    int r1 = static_cast<int>(std::floor((view.maxY + mMaxHalfH - mOriginY) / mCellH));
+    c0 = std::max(c0, 0); c1 = std::min(c1, mCols - 1);
+    r0 = std::max(r0, 0); r1 = std::min(r1, mRows - 1);
+
+    std::size_t marked = 0;
+    for (int row = r0; row <= r1; ++row) {
+        float cellMinY = mOriginY + row * mCellH;
+        bool insideY = cellMinY >= view.minY && cellMinY + mCellH <= view.maxY;
+        for (int col = c0; col <= c1; ++col) {
+            float cellMinX = mOriginX + col * mCellW;
+            bool inside = insideY && cellMinX >= view.minX && cellMinX + mCellW <= view.maxX;
+
+            std::size_t cell = static_cast<std::size_t>(row) * mCols + col;
+            for (std::uint32_t k = mCellStart[cell]; k < mCellStart[cell + 1]; ++k) {
+                std::uint32_t i = mItems[k];
+                const Rect2D& r = mRects[i];
+                // Центр внутри view — объект заведомо виден, иначе проверка пересечения
+                if (inside || (r.maxX >= view.minX && r.minX <= view.maxX &&
+                               r.maxY >= view.minY && r.minY <= view.maxY)) {
+                    mMarks[i] = 1;
+                    ++marked;
+                }
+            }
+        }
+    }
+
+    // Ответ по возрастанию индексов: порядок наложения деревьев не меняется
+    visible.reserve(marked);
+    for (std::size_t i = 0; i < mMarks.size() && visible.size() < marked; ++i) {
+        if (mMarks[i]) {
+            mMarks[i] = 0;
+            visible.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+    stats.visible = marked;
+    stats.culled = mRects.size() - marked;
+}
+
+// ═══════════════════════════════════════
+// BVH
+// ═══════════════════════════════════════
+
+void Bvh::build(const Aabb* boxes, std::size_t count) {
+    mNodes.clear();
+    mIndices.resize(count);
+    for (std::size_t i = 0; i < count; ++i) mIndices[i] = static_cast<std::uint32_t>(i);
+
+    std::vector<float> centroids(count * 3);
+    for (std::size_t i = 0; i < count; ++i) {
+        for (int a = 0; a < 3; ++a) {
+            centroids[i * 3 + a] = 0.5f * (boxes[i].min[a] + boxes[i].max[a]);
+        }
+    }
+
+    if (count > 0) {
+        mNodes.reserve(2 * (count / BVH_LEAF_SIZE + 1));
+        mNodes.push_back(Node());
+        buildNode(0, 0, static_cast<std::uint32_t>(count), boxes, centroids.data());
+    }
+
+    // Объёмы в порядке листьев; хвост дополнен, чтобы лист читался целым вектором
+    std::size_t padded = count + BVH_LEAF_SIZE - 1;
+    std::vector<float>* soa[6] = {&mCx, &mCy, &mCz, &mEx, &mEy, &mEz};
+    for (std::vector<float>* v : soa) v->assign(padded, 0.0f);
+    for (std::size_t k = 0; k < count; ++k) {
+        const Aabb& b = boxes[mIndices[k]];
+        mCx[k] = 0.5f * (b.min[0] + b.max[0]);
+        mCy[k] = 0.5f * (b.min[1] + b.max[1]);
+        mCz[k] = 0.5f * (b.min[2] + b.max[2]);
+        mEx[k] = 0.5f * (b.max[0] - b.min[0]);
+        mEy[k] = 0.5f * (b.max[1] - b.min[1]);
+        mEz[k] = 0.5f * (b.max[2] - b.min[2]);
+    }
+}
+
+void Bvh::buildNode(std::uint32_t node, std::uint32_t first, std::uint32_t count,
+                    const Aabb* boxes, const float* centroids) {
+    // Объём узла и область центров
+    float lo[3], hi[3], cLo[3], cHi[3];
+    for (int a = 0; a < 3; ++a) {
+        lo[a] = cLo[a] = INFINITY;
+        hi[a] = cHi[a] = -INFINITY;
+    }
+    for (std::uint32_t k = first; k < first + count; ++k) {
+        std::uint32_t i = mIndices[k];
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = std::min(lo[a], boxes[i].min[a]);
+            hi[a] = std::max(hi[a], boxes[i].max[a]);
+            cLo[a] = std::min(cLo[a], centroids[i * 3 + a]);
+            cHi[a] = std::max(cHi[a], centroids[i * 3 + a]);
+        }
+    }
+
+    Node& n = mNodes[node];
+    for (int a = 0; a < 3; ++a) {
+        n.center[a] = 0.5f * (lo[a] + hi[a]);
+        n.extent[a] = 0.5f * (hi[a] - lo[a]);
+    }
+    n.first = first;
+    n.count = count;
+    n.left = 0;
+    if (count <= BVH_LEAF_SIZE) return;
+
+    // Медиана вдоль самой длинной оси центров
+    int axis = 0;
+    for (int a = 1; a < 3; ++a) {
+        if (cHi[a] - cLo[a] > cHi[axis] - cLo[axis]) axis = a;
+    }
+    std::uint32_t half = count / 2;
+    std::uint32_t* begin = mIndices.data() + first;
+    std::nth_element(begin, begin + half, begin + count,
+                     [centroids, axis](std::uint32_t a, std::uint32_t b) {
+                         return centroids[a * 3 + axis] < centroids[b * 3 + axis];
+                     });
+
+    // Потомки соседние; ссылка n может устареть после push_back
+    std::uint32_t left = static_cast<std::uint32_t>(mNodes.size());
+    mNodes[node].left = left;
+    mNodes.push_back(Node());
+    mNodes.push_back(Node());
+    buildNode(left,     first,        half,         boxes, centroids);
+    buildNode(left + 1, first + half, count - half, boxes, centroids);
+}
+
+void Bvh::cullLeaf(const Node& node, const Frustum& frustum, unsigned planeMask,
+                   std::vector<std::uint32_t>& visible) const {
+    const std::uint32_t first = node.first;
+#ifdef LAB_CULL_SSE
+    // Четыре объёма против плоскости за раз: n·c + d + |n|·e < 0 — объём снаружи
+    const __m128 cx = _mm_loadu_ps(&mCx[first]);
+    const __m128 cy = _mm_loadu_ps(&mCy[first]);
+    const __m128 cz = _mm_loadu_ps(&mCz[first]);
+    const __m128 ex = _mm_loadu_ps(&mEx[first]);
+    const __m128 ey = _mm_loadu_ps(&mEy[first]);
+    const __m128 ez = _mm_loadu_ps(&mEz[first]);
+    const __m128 zero = _mm_setzero_ps();
+    __m128 outside = zero;
+    for (int p = 0; p < 6; ++p) {
+        if (!(planeMask & (1u << p))) continue;
+        const float* pl = frustum.planes[p];
+        __m128 d = _mm_set1_ps(pl[3]);
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(pl[0]), cx));
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(pl[1]), cy));
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(pl[2]), cz));
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(std::fabs(pl[0])), ex));
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(std::fabs(pl[1])), ey));
+        d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(std::fabs(pl[2])), ez));
+        outside = _mm_or_ps(outside, _mm_cmplt_ps(d, zero));
+    }
+    unsigned inside = ~static_cast<unsigned>(_mm_movemask_ps(outside)) & ((1u << node.count) - 1u);
+    for (std::uint32_t lane = 0; lane < node.count; ++lane) {
+        if (inside & (1u << lane)) visible.push_back(mIndices[first + lane]);
+    }
+#else
+    for (std::uint32_t k = first; k < first + node.count; ++k) {
+        bool out = false;
+        for (int p = 0; p < 6 && !out; ++p) {
+            if (!(planeMask & (1u << p))) continue;
+            const float* pl = frustum.planes[p];
+            float d = pl[0] * mCx[k] + pl[1] * mCy[k] + pl[2] * mCz[k] + pl[3] +
+                      std::fabs(pl[0]) * mEx[k] + std::fabs(pl[1]) * mEy[k] +
+                      std::fabs(pl[2]) * mEz[k];
+            out = d < 0.0f;
+        }
+        if (!out) visible.push_back(mIndices[k]);
+    }
+#endif
+}
+
+void Bvh::cull(const Frustum& frustum, std::vector<std::uint32_t>& visible,
+               CullStats& stats) const {
+    visible.clear();
+    if (!mNodes.empty()) {
+        // Стек (узел, плоскости, которые ещё нужно проверять)
+        struct Entry { std::uint32_t node; unsigned mask; };
+        Entry stack[BVH_STACK_DEPTH];
+        int top = 0;
+        stack[top++] = {0, ALL_PLANES};
+
+        while (top > 0) {
+            Entry e = stack[--top];
+            const Node& n = mNodes[e.node];
+            unsigned mask = e.mask;
+
+            // Узел снаружи хотя бы одной плоскости — отброшен; целиком внутри плоскости —
+            // её не проверяем у потомков
+            bool outside = false;
+            for (int p = 0; p < 6; ++p) {
+                if (!(mask & (1u << p))) continue;
+                const float* pl = frustum.planes[p];
+                float s = pl[0] * n.center[0] + pl[1] * n.center[1] + pl[2] * n.center[2] + pl[3];
+                float r = std::fabs(pl[0]) * n.extent[0] + std::fabs(pl[1]) * n.extent[1] +
+                          std::fabs(pl[2]) * n.extent[2];
+                if (s + r < 0.0f) {
+                    outside = true;
+                    break;
+                }
+                if (s - r >= 0.0f) mask &= ~(1u << p);
+            }
+            if (outside) continue;
+
+            if (mask == 0) {
+                // Поддерево целиком внутри — без проверок
+                visible.insert(visible.end(), mIndices.begin() + n.first,
+                               mIndices.begin() + n.first + n.count);
+            } else if (n.left == 0) {
+                cullLeaf(n, frustum, mask, visible);
+            } else {
+                stack[top++] = {n.left + 1, mask};
+                stack[top++] = {n.left, mask};
+            }
+        }
+    }
+    stats.visible = visible.size();
+    stats.culled = mIndices.size() - visible.size();
+}
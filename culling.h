@@ -0,0 +1,112 @@
+// ═══════════════════════════════════════
+// Отсечение по пирамиде видимости
+// Ограничивающие объёмы деревьев лежат в равномерной 2D-сетке,
+// объёмы 3D-примитивов — в BVH. Плоскости извлекаются из матрицы
+// projection * modelview, листья BVH проверяются по четыре объёма за раз (SSE)
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "vecmath.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Прямоугольник на плоскости XY
+struct Rect2D {
+    float minX, minY, maxX, maxY;
+};
+
+// Параллелепипед, выровненный по осям
+struct Aabb {
+    float min[3];
+    float max[3];
+};
+
+// Шесть плоскостей (a, b, c, d); точка внутри, если ax + by + cz + d >= 0 для всех
+struct Frustum {
+    float planes[6][4];
+};
+
+// Итог отсечения за кадр
+struct CullStats {
+    std::size_t visible = 0;
+    std::size_t culled  = 0;
+};
+
+// Плоскости пирамиды видимости из матрицы clip = projection * modelview
+void extractFrustum(const float clip[16], Frustum& frustum);
+
+// Видимая область плоскости z = 0 для ортографической матрицы clip без поворота
+Rect2D orthoViewRect(const float clip[16]);
+
+// Мировой AABB для локального, повёрнутого на angleDeg вокруг axis (как glRotatef)
+// и перенесённого в position
+Aabb transformAabb(const Aabb& local, float angleDeg, const float axis[3], const float position[3]);
+
+// ═══════════════════════════════════════
+// Равномерная сетка для 2D-объектов
+// Объект хранится в ячейке своего центра, запрос расширяется на
+// наибольший полуразмер объекта; ячейки целиком внутри запроса не проверяются
+// ═══════════════════════════════════════
+
+class UniformGrid2D {
+public:
+    void build(const Rect2D* rects, std::size_t count);
+
+    // Индексы объектов, пересекающих view, по возрастанию (порядок рисования сохраняется)
+    void query(const Rect2D& view, std::vector<std::uint32_t>& visible, CullStats& stats) const;
+
+    std::size_t size() const { return mRects.size(); }
+
+private:
+    std::vector<Rect2D>        mRects;
+    std::vector<std::uint32_t> mCellStart; // начало ячейки в mItems, cells + 1 элементов
+    std::vector<std::uint32_t> mItems;
+    mutable std::vector<std::uint8_t> mMarks; // отметки видимости для упорядочивания ответа
+
+    float mOriginX = 0.0f, mOriginY = 0.0f;
+    float mCellW = 1.0f, mCellH = 1.0f;
+    int   mCols = 0, mRows = 0;
+    float mMaxHalfW = 0.0f, mMaxHalfH = 0.0f;
+};
+
+// ═══════════════════════════════════════
+// BVH для 3D-объектов
+// Делится пополам по медиане вдоль самой длинной оси центров,
+// в листе не больше четырёх объектов
+// ═══════════════════════════════════════
+
+class Bvh {
+public:
+    void build(const Aabb* boxes, std::size_t count);
+
+    // Индексы видимых объектов в порядке обхода дерева
+    void cull(const Frustum& frustum, std::vector<std::uint32_t>& visible, CullStats& stats) const;
+
+    std::size_t size() const { return mIndices.size(); }
+
+private:
+    // Узел: центр и полуразмер, диапазон объектов поддерева и левый потомок (0 — лист;
+    // правый потомок всегда сразу за левым)
+    struct Node {
+        float center[3];
+        float extent[3];
+        std::uint32_t first;
+        std::uint32_t count;
+        std::uint32_t left;
+    };
+
+    void buildNode(std::uint32_t node, std::uint32_t first, std::uint32_t count,
+                   const Aabb* boxes, const float* centroids);
+
+    void cullLeaf(const Node& node, const Frustum& frustum, unsigned planeMask,
+                  std::vector<std::uint32_t>& visible) const;
+
+    std::vector<Node>          mNodes;
+    std::vector<std::uint32_t> mIndices; // порядок BVH -> исходный индекс
+
+    // Объёмы объектов в порядке BVH, структура массивов для SSE (с запасом в 3 элемента)
+    std::vector<float> mCx, mCy, mCz, mEx, mEy, mEz;
+};
@@ -0,0 +1,241 @@
+// ═══════════════════════════════════════
+// Динамическое разрешение под бюджет времени кадра
+// ═══════════════════════════════════════
+
+#include "dynamic_resolution.h"
+#include "gl_ext.h"
+#include "profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+// Результат запроса кадра N читается в кадре N + DYNRES_LATENCY (без ожидания GPU)
+static const int DYNRES_LATENCY = 4;
+
+// Столько замеров усредняется перед решением о смене масштаба
+static const int DYNRES_ADJUST_FRAMES = 8;
+
+// Полоса без изменений: время кадра в [LOWER, UPPER] от бюджета
+static const double DYNRES_LOWER_BAND = 0.85;
+static const double DYNRES_UPPER_BAND = 1.0;
+
+// Масштаб меняется не больше чем во столько раз за одно решение
+// (вверх — осторожнее, чтобы не раскачиваться у границы бюджета)
+static const float DYNRES_MAX_GROWTH = 1.1f;
+static const float DYNRES_MAX_SHRINK = 0.7f;
+
+// Замеры дольше этого — разрыв (пауза, свёрнутое окно), не время кадра
+static const double DYNRES_MAX_SAMPLE_MS = 1000.0;
+
+// Программные растеризаторы выполняют кадр уже после glEndQuery,
+// их GL_TIME_ELAPSED показывает лишь запись команд
+static const char* const SOFTWARE_RENDERERS[] = {"llvmpipe", "softpipe", "SwiftShader", "Software"};
+
+// Шаг масштаба: мелкие колебания не пересоздают цели OIT каждый раз
+static const float DYNRES_SCALE_STEP = 1.0f / 64.0f;
+
+// Параметры
+static bool   gEnabled  = false;
+static double gTargetMs = 0.0;
+static float  gMinScale = 0.5f;
+static float  gScale    = 1.0f;
+
+// Буферы: цвет и глубина размером с окно, кадр занимает угол renderW x renderH
+static bool   gInitDone  = false;
+static bool   gAvailable = false;
+static GLuint gFbo = 0;
+static GLuint gColorRb = 0;
+static GLuint gDepthRb = 0;
+static int    gBufWidth = 0;
+static int    gBufHeight = 0;
+static int    gWinWidth = 0;
+static int    gWinHeight = 0;
+static int    gRenderWidth = 0;
+static int    gRenderHeight = 0;
+
+// Замеры: кольцо запросов времени GPU или интервал между кадрами на CPU
+static bool   gGpuTiming = false;
+static GLuint gQueries[DYNRES_LATENCY] = {};
+static bool   gQueryPending[DYNRES_LATENCY] = {};
+static int    gFrame = 0;
+static int    gSkipSamples = 0; // замеры, начатые до смены масштаба, не в счёт
+static double gSampleSum = 0.0;
+static int    gSampleCount = 0;
+static std::chrono::steady_clock::time_point gLastBegin;
+static bool   gHasLastBegin = false;
+
+void initDynamicResolution(double targetMs, float minScale) {
+    gEnabled  = targetMs > 0.0;
+    gTargetMs = targetMs;
+    gMinScale = std::min(std::max(minScale, DYNRES_SCALE_STEP), 1.0f);
+    gScale    = 1.0f;
+}
+
+bool dynamicResolutionEnabled() {
+    return gEnabled;
+}
+
+float dynamicResolutionScale() {
+    return gScale;
+}
+
+static void initTargets() {
+    gInitDone = true;
+    if (!gl.hasFramebuffer) {
+        std::fprintf(stderr, "Dynamic resolution needs framebuffer objects; rendering at full size\n");
+        return;
+    }
+    gl.GenFramebuffers(1, &gFbo);
+    gl.GenRenderbuffers(1, &gColorRb);
+    gl.GenRenderbuffers(1, &gDepthRb);
+
+    const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+    gGpuTiming = gl.hasTimerQuery;
+    for (const char* name : SOFTWARE_RENDERERS) {
+        if (renderer != nullptr && std::strstr(renderer, name) != nullptr) gGpuTiming = false;
+    }
+    if (gGpuTiming) gl.GenQueries(DYNRES_LATENCY, gQueries);
+    gAvailable = true;
+}
+
+// Пересоздать буферы под размер окна
+static bool resizeTargets(int w, int h) {
+    if (w == gBufWidth && h == gBufHeight) return true;
+
+    gl.BindRenderbuffer(GL_RENDERBUFFER, gColorRb);
+    gl.RenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, w, h);
+    gl.BindRenderbuffer(GL_RENDERBUFFER, gDepthRb);
+    gl.RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+    gl.BindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    gl.BindFramebuffer(GL_FRAMEBUFFER, gFbo);
+    gl.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, gColorRb);
+    gl.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, gDepthRb);
+    bool complete = gl.CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    gl.BindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (!complete) {
+        std::fprintf(stderr, "Dynamic resolution framebuffer is incomplete; rendering at full size\n");
+        gAvailable = false;
+        return false;
+    }
+    gBufWidth = w;
+    gBufHeight = h;
+    return true;
+}
+
+// Учесть замер времени кадра (мс)
+static void addSample(double ms) {
+    if (ms > DYNRES_MAX_SAMPLE_MS) return;
+    if (gSkipSamples > 0) {
+        --gSkipSamples;
+        return;
+    }
+    gSampleSum += ms;
+    ++gSampleCount;
+}
+
+bool beginDynamicResolution(int width, int height, int& renderWidth, int& renderHeight) {
+    if (!gEnabled || width <= 0 || height <= 0) return false;
+    if (!gInitDone) initTargets();
+    if (!gAvailable || !resizeTargets(width, height)) return false;
+
+    gWinWidth = width;
+    gWinHeight = height;
+    gRenderWidth  = std::max(1, static_cast<int>(std::lround(width * gScale)));
+    gRenderHeight = std::max(1, static_cast<int>(std::lround(height * gScale)));
+    renderWidth = gRenderWidth;
+    renderHeight = gRenderHeight;
+
+    gl.BindFramebuffer(GL_FRAMEBUFFER, gFbo);
+    glViewport(0, 0, gRenderWidth, gRenderHeight);
+
+    if (gGpuTiming) {
+        // Запрос этого слота задан DYNRES_LATENCY кадров назад: результат либо готов,
+        // либо отбрасывается — ждать GPU нельзя
+        const int slot = gFrame % DYNRES_LATENCY;
+        if (gQueryPending[slot]) {
+            GLint available = 0;
+            gl.GetQueryObjectiv(gQueries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available) {
+                unsigned long long ns = 0;
+                gl.GetQueryObjectui64v(gQueries[slot], GL_QUERY_RESULT, &ns);
+                addSample(static_cast<double>(ns) / 1.0e6);
+            }
+            gQueryPending[slot] = false;
+        }
+        gl.BeginQuery(GL_TIME_ELAPSED, gQueries[slot]);
+    } else {
+        // Без запросов: интервал между кадрами (glfwSwapBuffers ждёт GPU).
+        // С вертикальной синхронизацией он не меньше периода развёртки
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (gHasLastBegin) {
+            addSample(std::chrono::duration<double, std::milli>(now - gLastBegin).count());
+        }
+        gLastBegin = now;
+        gHasLastBegin = true;
+    }
+    return true;
+}
+
+// Раз в DYNRES_ADJUST_FRAMES замеров: сменить масштаб, если время вне полосы
+static void adjustScale() {
+    if (gSampleCount < DYNRES_ADJUST_FRAMES) return;
+    double meanMs = gSampleSum / gSampleCount;
+    gSampleSum = 0.0;
+    gSampleCount = 0;
+    if (meanMs <= 0.0) return;
+    if (meanMs >= gTargetMs * DYNRES_LOWER_BAND && meanMs <= gTargetMs * DYNRES_UPPER_BAND) return;
+
+    // Время пропорционально площади: сторона меняется как корень отношения
+    float factor = static_cast<float>(std::sqrt(gTargetMs / meanMs));
+    factor = std::min(std::max(factor, DYNRES_MAX_SHRINK), DYNRES_MAX_GROWTH);
+    float next = std::min(std::max(gScale * factor, gMinScale), 1.0f);
+    next = std::round(next / DYNRES_SCALE_STEP) * DYNRES_SCALE_STEP;
+    next = std::min(std::max(next, gMinScale), 1.0f);
+    if (next == gScale) return;
+
+    gScale = next;
+    gSkipSamples = gGpuTiming ? DYNRES_LATENCY : 1;
+}
+
+void endDynamicResolution() {
+    if (gGpuTiming) {
+        gl.EndQuery(GL_TIME_ELAPSED);
+        gQueryPending[gFrame % DYNRES_LATENCY] = true;
+    }
+    ++gFrame;
+
+    // Растянуть кадр на окно; при полном размере фильтр не нужен
+    PROFILE_SCOPE("upscale");
+    gl.BindFramebuffer(GL_READ_FRAMEBUFFER, gFbo);
+    gl.BindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    const bool fullSize = gRenderWidth == gWinWidth && gRenderHeight == gWinHeight;
+    gl.BlitFramebuffer(0, 0, gRenderWidth, gRenderHeight, 0, 0, gWinWidth, gWinHeight,
+                       GL_COLOR_BUFFER_BIT, fullSize ? GL_NEAREST : GL_LINEAR);
+    gl.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, gWinWidth, gWinHeight);
+
+    adjustScale();
+    profilerCounter("renderScale", gScale);
+}
+
+void releaseDynamicResolution() {
+    if (gFbo != 0) gl.DeleteFramebuffers(1, &gFbo);
+    if (gColorRb != 0) gl.DeleteRenderbuffers(1, &gColorRb);
+    if (gDepthRb != 0) gl.DeleteRenderbuffers(1, &gDepthRb);
+    if (gQueries[0] != 0) gl.DeleteQueries(DYNRES_LATENCY, gQueries);
+    gFbo = gColorRb = gDepthRb = 0;
+    for (int i = 0; i < DYNRES_LATENCY; ++i) {
+        gQueries[i] = 0;
+        gQueryPending[i] = false;
+    }
+    gBufWidth = gBufHeight = 0;
+    gInitDone = false;
+    gAvailable = false;
+    gHasLastBegin = false;
+    gGpuTiming = false;
+}
@@ -0,0 +1,32 @@
+// ═══════════════════════════════════════
+// Динамическое разрешение под бюджет времени кадра
+// Сцена рисуется во внеэкранный буфер размером scale от окна и растягивается
+// на окно билинейным glBlitFramebuffer. Время кадра на GPU меряется
+// запросами GL_TIME_ELAPSED (без них и на программных растеризаторах —
+// интервалом между кадрами на CPU); раз в несколько кадров
+// регулятор подбирает scale так, чтобы время уложилось в бюджет: стоимость
+// растеризации пропорциональна числу пикселей, то есть scale^2
+// ═══════════════════════════════════════
+
+#pragma once
+
+// Включить регулятор: бюджет кадра targetMs, масштаб не меньше minScale.
+// Буферы создаются при первом кадре
+void initDynamicResolution(double targetMs, float minScale);
+
+// Режим включён параметрами (буферы могут оказаться недоступны — см. begin)
+bool dynamicResolutionEnabled();
+
+// Начать кадр окна width x height: рисование переключается во внеэкранный
+// буфер, область вывода — renderWidth x renderHeight. false — режим выключен
+// или FBO недоступны, рисовать прямо в окно
+bool beginDynamicResolution(int width, int height, int& renderWidth, int& renderHeight);
+
+// Растянуть кадр на окно, забрать готовые замеры и при необходимости сменить масштаб
+void endDynamicResolution();
+
+// Текущий масштаб стороны кадра (1 — полное разрешение)
+float dynamicResolutionScale();
+
+// Освободить буферы и запросы (до уничтожения контекста)
+void releaseDynamicResolution();
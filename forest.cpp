@@ -0,0 +1,352 @@
+// ═══════════════════════════════════════
+// Пакетная отрисовка леса
+// ═══════════════════════════════════════
+
+#include "forest.h"
+#include "gl_ext.h"
+#include "shader.h"
+#include "stream_ring.h"
+
+#include <cstddef>
+#include <cstring>
+
+// ═══════════════════════════════════════
+// Меш единичного дерева (основание ствола в начале координат, масштаб 1)
+// ═══════════════════════════════════════
+
+// Цвет ствола дерева
+static const float TRUNK_R = 0.4f;
+static const float TRUNK_G = 0.2f;
+static const float TRUNK_B = 0.05f;
+
+static const TreeVertex UNIT_TREE[] = {
+    // Ствол — коричневый прямоугольник из двух треугольников
+    {-0.03f, 0.0f,  TRUNK_R, TRUNK_G, TRUNK_B},
+    { 0.03f, 0.0f,  TRUNK_R, TRUNK_G, TRUNK_B},
+    { 0.03f, 0.15f, TRUNK_R, TRUNK_G, TRUNK_B},
+    {-0.03f, 0.0f,  TRUNK_R, TRUNK_G, TRUNK_B},
+    { 0.03f, 0.15f, TRUNK_R, TRUNK_G, TRUNK_B},
+    {-0.03f, 0.15f, TRUNK_R, TRUNK_G, TRUNK_B},
+
+    // Ярус 1 (нижний) — тёмно-зелёный
+    {-0.35f, 0.1f,  0.05f, 0.4f, 0.05f},
+    { 0.35f, 0.1f,  0.05f, 0.4f, 0.05f},
+    { 0.0f,  0.45f, 0.05f, 0.4f, 0.05f},
+
+    // Ярус 2 (средний) — зелёный
+    {-0.27f, 0.3f,  0.1f, 0.55f, 0.1f},
+    { 0.27f, 0.3f,  0.1f, 0.55f, 0.1f},
+    { 0.0f,  0.6f,  0.1f, 0.55f, 0.1f},
+
+    // Ярус 3 (верхний) — светло-зелёный
+    {-0.18f, 0.48f, 0.15f, 0.65f, 0.15f},
+    { 0.18f, 0.48f, 0.15f, 0.65f, 0.15f},
+    { 0.0f,  0.75f, 0.15f, 0.65f, 0.15f},
+};
+
+static const int UNIT_TREE_VERTS = sizeof(UNIT_TREE) / sizeof(UNIT_TREE[0]);
+
+const TreeVertex* unitTreeVertices(int& count) {
+    count = UNIT_TREE_VERTS;
+    return UNIT_TREE;
+}
+
+void unitTreeBounds(float& minX, float& minY, float& maxX, float& maxY) {
+    minX = maxX = UNIT_TREE[0].x;
+    minY = maxY = UNIT_TREE[0].y;
+    for (const TreeVertex& v : UNIT_TREE) {
+        if (v.x < minX) minX = v.x;
+        if (v.x > maxX) maxX = v.x;
+        if (v.y < minY) minY = v.y;
+        if (v.y > maxY) maxY = v.y;
+    }
+}
+
+// ═══════════════════════════════════════
+// Шейдер инстансинга: позиция = смещение + масштаб * вершина единичного дерева
+// ═══════════════════════════════════════
+
+static const char* TREE_VS =
+    "#version 120\n"
+    "attribute vec2 aPos;\n"
+    "attribute vec3 aColor;\n"
+    "attribute vec3 aInstance;\n" // xy — основание ствола, z — масштаб
+    "varying vec3 vColor;\n"
+    "void main() {\n"
+    "    vec2 p = aInstance.xy + aPos * aInstance.z;\n"
+    "    gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 0.0, 1.0);\n"
+    "    vColor = aColor;\n"
+    "}\n";
+
+static const char* TREE_FS =
+    "#version 120\n"
+    "varying vec3 vColor;\n"
+    "void main() {\n"
+    "    gl_FragColor = vec4(vColor, 1.0);\n"
+    "}\n";
+
+// Те же шейдеры для core-профиля: матрица передаётся явно
+static const char* TREE_VS_CORE =
+    "#version 330 core\n"
+    "uniform mat4 uMvp;\n"
+    "in vec2 aPos;\n"
+    "in vec3 aColor;\n"
+    "in vec3 aInstance;\n"
+    "out vec3 vColor;\n"
+    "void main() {\n"
+    "    vec2 p = aInstance.xy + aPos * aInstance.z;\n"
+    "    gl_Position = uMvp * vec4(p, 0.0, 1.0);\n"
+    "    vColor = aColor;\n"
+    "}\n";
+
+static const char* TREE_FS_CORE =
+    "#version 330 core\n"
+    "in vec3 vColor;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    fragColor = vec4(vColor, 1.0);\n"
+    "}\n";
+
+// Индексы атрибутов шейдера
+static const GLuint ATTR_POS      = 0;
+static const GLuint ATTR_COLOR    = 1;
+static const GLuint ATTR_INSTANCE = 2;
+
+// Общие ресурсы: VBO единичного дерева и программа
+static GLuint gTreeMeshVbo = 0;
+static GLuint gTreeProgram = 0;
+static bool   gTreeInitDone = false;
+static bool   gTreeInstanced = false;
+
+// Core-профиль: VAO с атрибутами единичного дерева и матрица проекции * вида
+static GLuint gTreeVao = 0;
+static GLint  gTreeMvpLocation = -1;
+static float  gTreeMvp[16] = {1, 0, 0, 0,  0, 1, 0, 0,  0, 0, 1, 0,  0, 0, 0, 1};
+
+static void initForestRenderer() {
+    gTreeInitDone = true;
+    if (!gl.hasInstancing) return;
+
+    const AttribBinding bindings[] = {
+        {ATTR_POS,      "aPos"},
+        {ATTR_COLOR,    "aColor"},
+        {ATTR_INSTANCE, "aInstance"},
+    };
+    if (gl.coreProfile) {
+        gTreeProgram = buildProgram(TREE_VS_CORE, TREE_FS_CORE, bindings, 3);
+    } else {
+        gTreeProgram = buildProgram(TREE_VS, TREE_FS, bindings, 3);
+    }
+    if (gTreeProgram == 0) return; // откатываемся на заранее собранный буфер
+
+    gl.GenBuffers(1, &gTreeMeshVbo);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gTreeMeshVbo);
+    gl.BufferData(GL_ARRAY_BUFFER, sizeof(UNIT_TREE), UNIT_TREE, GL_STATIC_DRAW);
+
+    // В core-профиле вершины единичного дерева описываются один раз в VAO
+    if (gl.coreProfile) {
+        gTreeMvpLocation = gl.GetUniformLocation(gTreeProgram, "uMvp");
+        gl.GenVertexArrays(1, &gTreeVao);
+        gl.BindVertexArray(gTreeVao);
+        gl.EnableVertexAttribArray(ATTR_POS);
+        gl.EnableVertexAttribArray(ATTR_COLOR);
+        gl.VertexAttribPointer(ATTR_POS, 2, GL_FLOAT, GL_FALSE, sizeof(TreeVertex),
+                               attribPointer(nullptr, offsetof(TreeVertex, x)));
+        gl.VertexAttribPointer(ATTR_COLOR, 3, GL_FLOAT, GL_FALSE, sizeof(TreeVertex),
+                               attribPointer(nullptr, offsetof(TreeVertex, r)));
+        gl.EnableVertexAttribArray(ATTR_INSTANCE);
+        gl.VertexAttribDivisor(ATTR_INSTANCE, 1);
+        gl.BindVertexArray(0);
+    }
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    gTreeInstanced = true;
+}
+
+void setForestTransform(const float mvp[16]) {
+    for (int i = 0; i < 16; ++i) gTreeMvp[i] = mvp[i];
+}
+
+void releaseForestRenderer() {
+    if (gTreeMeshVbo != 0) gl.DeleteBuffers(1, &gTreeMeshVbo);
+    if (gTreeProgram != 0) gl.DeleteProgram(gTreeProgram);
+    if (gTreeVao != 0) gl.DeleteVertexArrays(1, &gTreeVao);
+    gTreeMeshVbo = 0;
+    gTreeProgram = 0;
+    gTreeVao = 0;
+    gTreeMvpLocation = -1;
+    gTreeInitDone = false;
+    gTreeInstanced = false;
+}
+
+// ═══════════════════════════════════════
+// Пакет деревьев
+// ═══════════════════════════════════════
+
+void setForestInstances(ForestBatch& batch, const TreeInstance* trees, std::size_t count) {
+    batch.instances.assign(trees, trees + count);
+    batch.dirty = true;
+    batch.stableFrames = 0;
+}
+
+void releaseForestBatch(ForestBatch& batch) {
+    if (batch.vbo != 0) gl.DeleteBuffers(1, &batch.vbo);
+    batch.vbo = 0;
+    batch.capacity = 0;
+    batch.dirty = true;
+    batch.stableFrames = 0;
+}
+
+// Развернуть все деревья в один массив вершин (запасной путь без инстансинга)
+static void bakeForest(const ForestBatch& batch, std::vector<TreeVertex>& out) {
+    out.resize(batch.instances.size() * UNIT_TREE_VERTS);
+    TreeVertex* dst = out.data();
+    for (const TreeInstance& t : batch.instances) {
+        for (int i = 0; i < UNIT_TREE_VERTS; ++i) {
+            TreeVertex v = UNIT_TREE[i];
+            v.x = t.x + v.x * t.scale;
+            v.y = t.y + v.y * t.scale;
+            *dst++ = v;
+        }
+    }
+}
+
+// Загрузить данные пакета в буфер; буфер растёт только при нехватке места
+static void uploadBatch(ForestBatch& batch, const void* data, std::size_t itemSize) {
+    std::size_t count = batch.instances.size();
+    if (batch.vbo == 0) gl.GenBuffers(1, &batch.vbo);
+    gl.BindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    if (count > batch.capacity) {
+        gl.BufferData(GL_ARRAY_BUFFER, static_cast<std::ptrdiff_t>(count * itemSize),
+                      data, GL_DYNAMIC_DRAW);
+        batch.capacity = count;
+    } else {
+        gl.BufferSubData(GL_ARRAY_BUFFER, 0, static_cast<std::ptrdiff_t>(count * itemSize), data);
+    }
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Буфер экземпляров кадра и смещение в нём. Пока экземпляры меняются каждый
+// кадр (панорамирование перестраивает пакет), они пишутся в кольцо потоковых
+// данных; в буфер пакета — когда простоят STREAM_RING_SEGMENTS кадров: к этому
+// времени GPU его уже не читает, и glBufferSubData не ждёт
+static GLuint instanceSource(ForestBatch& batch, std::size_t& offset) {
+    offset = 0;
+    if (batch.dirty && batch.stableFrames < STREAM_RING_SEGMENTS && streamRingAvailable()) {
+        ++batch.stableFrames;
+        const std::size_t bytes = batch.instances.size() * sizeof(TreeInstance);
+        StreamAlloc alloc = streamAllocate(bytes, sizeof(float));
+        if (alloc.ptr != nullptr) {
+            std::memcpy(alloc.ptr, batch.instances.data(), bytes);
+            offset = alloc.offset;
+            return alloc.buffer;
+        }
+    }
+    uploadForestBatch(batch);
+    return batch.vbo;
+}
+
+// Core-профиль: атрибуты дерева уже в VAO, остаётся буфер экземпляров пакета
+static void drawInstancedCore(ForestBatch& batch) {
+    std::size_t offset = 0;
+    GLuint instances = instanceSource(batch, offset);
+
+    gl.UseProgram(gTreeProgram);
+    gl.UniformMatrix4fv(gTreeMvpLocation, 1, GL_FALSE, gTreeMvp);
+    gl.BindVertexArray(gTreeVao);
+    gl.BindBuffer(GL_ARRAY_BUFFER, instances);
+    gl.VertexAttribPointer(ATTR_INSTANCE, 3, GL_FLOAT, GL_FALSE, sizeof(TreeInstance),
+                           attribPointer(nullptr, offset));
+
+    gl.DrawArraysInstanced(GL_TRIANGLES, 0, UNIT_TREE_VERTS,
+                           static_cast<GLsizei>(batch.instances.size()));
+
+    gl.BindVertexArray(0);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    gl.UseProgram(0);
+}
+
+static void drawInstanced(ForestBatch& batch) {
+    std::size_t offset = 0;
+    GLuint instances = instanceSource(batch, offset);
+
+    gl.UseProgram(gTreeProgram);
+
+    // Вершины единичного дерева
+    gl.BindBuffer(GL_ARRAY_BUFFER, gTreeMeshVbo);
+    gl.EnableVertexAttribArray(ATTR_POS);
+    gl.EnableVertexAttribArray(ATTR_COLOR);
+    gl.VertexAttribPointer(ATTR_POS, 2, GL_FLOAT, GL_FALSE, sizeof(TreeVertex),
+                           attribPointer(nullptr, offsetof(TreeVertex, x)));
+    gl.VertexAttribPointer(ATTR_COLOR, 3, GL_FLOAT, GL_FALSE, sizeof(TreeVertex),
+                           attribPointer(nullptr, offsetof(TreeVertex, r)));
+
+    // Атрибут экземпляра: сдвигается один раз на дерево
+    gl.BindBuffer(GL_ARRAY_BUFFER, instances);
+    gl.EnableVertexAttribArray(ATTR_INSTANCE);
+    gl.VertexAttribPointer(ATTR_INSTANCE, 3, GL_FLOAT, GL_FALSE, sizeof(TreeInstance),
+                           attribPointer(nullptr, offset));
+    gl.VertexAttribDivisor(ATTR_INSTANCE, 1);
+
+    gl.DrawArraysInstanced(GL_TRIANGLES, 0, UNIT_TREE_VERTS,
+                           static_cast<GLsizei>(batch.instances.size()));
+
+    gl.VertexAttribDivisor(ATTR_INSTANCE, 0);
+    gl.DisableVertexAttribArray(ATTR_INSTANCE);
+    gl.DisableVertexAttribArray(ATTR_COLOR);
+    gl.DisableVertexAttribArray(ATTR_POS);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    gl.UseProgram(0);
+}
+
+static void drawBaked(ForestBatch& batch) {
+    // Без VBO массив собирается заново каждый кадр и остаётся в оперативной памяти
+    static std::vector<TreeVertex> baked;
+    const void* base = nullptr;
+    if (!gl.hasVBO) {
+        bakeForest(batch, baked);
+        base = baked.data();
+    } else {
+        uploadForestBatch(batch);
+    }
+
+    if (gl.hasVBO) gl.BindBuffer(GL_ARRAY_BUFFER, batch.vbo);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(TreeVertex), attribPointer(base, offsetof(TreeVertex, x)));
+    glColorPointer(3, GL_FLOAT, sizeof(TreeVertex), attribPointer(base, offsetof(TreeVertex, r)));
+
+    glDrawArrays(GL_TRIANGLES, 0, static_cast<GLsizei>(batch.instances.size() * UNIT_TREE_VERTS));
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    if (gl.hasVBO) gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void uploadForestBatch(ForestBatch& batch) {
+    if (!batch.dirty || batch.instances.empty()) return;
+    if (!gTreeInitDone) initForestRenderer();
+
+    if (gTreeInstanced) {
+        uploadBatch(batch, batch.instances.data(), sizeof(TreeInstance));
+    } else if (gl.hasVBO) {
+        static std::vector<TreeVertex> baked;
+        bakeForest(batch, baked);
+        uploadBatch(batch, baked.data(), sizeof(TreeVertex) * UNIT_TREE_VERTS);
+    } else {
+        return; // без VBO вершины собираются при каждой отрисовке
+    }
+    batch.dirty = false;
+}
+
+void drawForestBatch(ForestBatch& batch) {
+    if (batch.instances.empty()) return;
+    if (!gTreeInitDone) initForestRenderer();
+
+    if (gTreeInstanced && gl.coreProfile) {
+        drawInstancedCore(batch);
+    } else if (gTreeInstanced) {
+        drawInstanced(batch);
+    } else {
+        drawBaked(batch);
+    }
+}
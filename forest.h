@@ -0,0 +1,59 @@
+// ═══════════════════════════════════════
+// Пакетная отрисовка леса
+// Все ёлочки рисуются одним инстансным вызовом из общего меша
+// единичного дерева; без инстансинга — одним заранее собранным VBO
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+#include <vector>
+
+// Экземпляр дерева: позиция основания ствола и масштаб
+struct TreeInstance {
+    float x, y, scale;
+};
+
+// Набор деревьев, рисуемый одним вызовом
+struct ForestBatch {
+    std::vector<TreeInstance> instances;
+
+    // Буфер экземпляров (инстансинг) или развёрнутых вершин (запасной путь)
+    GLuint vbo = 0;
+    std::size_t capacity = 0; // вместимость буфера в экземплярах
+    bool dirty = true;        // экземпляры изменились после последней загрузки
+    int stableFrames = 0;     // кадров без изменений (пока мало — экземпляры идут через кольцо)
+};
+
+// Вершина дерева: 2D-позиция и цвет
+struct TreeVertex {
+    float x, y;
+    float r, g, b;
+};
+
+// Треугольники единичного дерева (вершины по три подряд)
+const TreeVertex* unitTreeVertices(int& count);
+
+// Габариты единичного дерева (основание ствола в начале координат, масштаб 1)
+void unitTreeBounds(float& minX, float& minY, float& maxX, float& maxY);
+
+// Заменить список деревьев пакета
+void setForestInstances(ForestBatch& batch, const TreeInstance* trees, std::size_t count);
+
+// Загрузить изменённые экземпляры в буфер заранее, не дожидаясь отрисовки
+void uploadForestBatch(ForestBatch& batch);
+
+// Матрица проекции * вида для деревьев в core-профиле (стека матриц там нет);
+// вне core-профиля деревья берут текущие матрицы OpenGL
+void setForestTransform(const float mvp[16]);
+
+// Нарисовать все деревья пакета с текущими матрицами (освещение должно быть выключено)
+void drawForestBatch(ForestBatch& batch);
+
+// Освободить буфер пакета
+void releaseForestBatch(ForestBatch& batch);
+
+// Освободить общие ресурсы (меш единичного дерева и шейдер)
+void releaseForestRenderer();
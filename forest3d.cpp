@@ -0,0 +1,754 @@
+// ═══════════════════════════════════════
+// Трёхмерный лес до горизонта
+// ═══════════════════════════════════════
+
+#include "forest3d.h"
+#include "culling.h"
+#include "gl_ext.h"
+#include "occlusion.h"
+#include "profiler.h"
+#include "shader.h"
+#include "stream_ring.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+// ═══════════════════════════════════════
+// Сетка единичного дерева (основание ствола в начале координат, масштаб 1)
+// ═══════════════════════════════════════
+
+// Сегментов по окружности ствола и конусов
+static const int TREE3D_SEGMENTS = 10;
+
+// Ствол (цвет — как у 2D-дерева)
+static const float TRUNK3D_RADIUS = 0.12f;
+static const float TRUNK3D_HEIGHT = 0.5f;
+static const float TRUNK3D_COLOR[3] = {0.4f, 0.2f, 0.05f};
+
+// Ярусы хвои снизу вверх: высота основания, радиус, высота конуса, цвет
+struct TreeTier {
+    float baseY, radius, height;
+    float color[3];
+};
+
+static const TreeTier TREE3D_TIERS[] = {
+    {0.35f, 0.95f, 1.05f, {0.08f, 0.40f, 0.12f}},
+    {0.85f, 0.75f, 0.95f, {0.10f, 0.46f, 0.14f}},
+    {1.35f, 0.55f, 1.05f, {0.12f, 0.52f, 0.16f}},
+};
+
+// Нижняя сторона яруса темнее боковой
+static const float TIER_UNDERSIDE = 0.6f;
+
+// Окклюдер дерева — осевые сечения ствола и ярусов, повёрнутые к камере. Радиус
+// сечения — вписанный в многоугольник сетки и ещё с запасом на силуэт impostor-а,
+// который после фильтрации и альфа-теста немного у́же сетки
+static const float OCCLUDER_MARGIN = 0.9f;
+
+// ═══════════════════════════════════════
+// Атлас impostor-ов
+// ═══════════════════════════════════════
+
+// Строки атласа — углы возвышения камеры 0, 20, 40 и 60 градусов; ячейки лежат в ряд
+static const int   IMPOSTOR_ROWS = 4;
+static const float IMPOSTOR_ROW_STEP_DEG = 20.0f;
+static const int   IMPOSTOR_CELL = 128;
+
+// Фон атласа: цвет хвои с нулевой альфой, чтобы фильтрация на краю силуэта не темнила его
+static const float IMPOSTOR_CLEAR[4] = {0.1f, 0.46f, 0.14f, 0.0f};
+
+// Земля: цвет как у 2D-сцены, выходит за крайние деревья на эту долю радиуса
+static const float GROUND3D_COLOR[3] = {0.1f, 0.3f, 0.05f};
+static const float GROUND3D_MARGIN = 0.1f;
+
+// Атрибуты
+static const GLuint ATTR3D_POSITION = 0;
+static const GLuint ATTR3D_NORMAL   = 1;
+static const GLuint ATTR3D_COLOR    = 2;
+static const GLuint ATTR3D_INSTANCE = 3;
+static const GLuint ATTR3D_TINT     = 4;
+static const GLuint ATTR3D_CORNER   = 0;
+
+// Вершина сетки дерева и земли
+struct Tree3DVertex {
+    float px, py, pz;
+    float nx, ny, nz;
+    float r, g, b;
+};
+
+// Экземпляр кадра: основание, масштаб, оттенок и доля перехода в impostor (в альфе)
+struct TreeDraw {
+    float position[3];
+    float scale;
+    std::uint8_t tint[4];
+};
+
+static_assert(sizeof(TreeDraw) == 20, "TreeDraw is read by the vertex shaders as-is");
+
+// ═══════════════════════════════════════
+// Шейдеры
+// Освещение одно для сетки и атласа: фоновая доля плюс рассеянная от
+// направленного источника в координатах глаза, всё умножено на яркость —
+// поэтому запечённый при яркости 1 атлас достаточно умножить на неё же
+// ═══════════════════════════════════════
+
+// Шум с чередующимся градиентом: порог дизеринга для пикселя
+#define LAB_DITHER                                                             \
+    "float dither() {\n"                                                       \
+    "    return fract(52.9829189 * fract(dot(gl_FragCoord.xy,\n"               \
+    "                                        vec2(0.06711056, 0.00583715))));\n" \
+    "}\n"
+
+static const char* TREE3D_VS =
+    "#version 330 core\n"
+    "uniform mat4 uProjection;\n"
+    "uniform mat4 uView;\n"
+    "in vec3 aPosition;\n"
+    "in vec3 aNormal;\n"
+    "in vec3 aColor;\n"
+    "in vec4 aInstance;\n" // xyz — основание, w — масштаб
+    "in vec4 aTint;\n"     // rgb — оттенок, a — доля перехода
+    "out vec3 vNormal;\n"
+    "out vec3 vColor;\n"
+    "flat out float vFade;\n"
+    "void main() {\n"
+    "    vec4 eye = uView * vec4(aInstance.xyz + aPosition * aInstance.w, 1.0);\n"
+    "    vNormal = mat3(uView) * aNormal;\n"
+    "    vColor = aColor * aTint.rgb;\n"
+    "    vFade = aTint.a;\n"
+    "    gl_Position = uProjection * eye;\n"
+    "}\n";
+
+static const char* TREE3D_FS =
+    "#version 330 core\n"
+    "uniform vec4 uLight;\n" // xyz — направление на источник, w — яркость
+    "in vec3 vNormal;\n"
+    "in vec3 vColor;\n"
+    "flat in float vFade;\n"
+    "out vec4 fragColor;\n"
+    LAB_DITHER
+    "void main() {\n"
+    "    if (dither() < vFade) discard;\n" // эти пиксели отданы impostor-у
+    "    vec3 n = normalize(vNormal);\n"
+    "    if (!gl_FrontFacing) n = -n;\n"
+    "    float diffuse = max(dot(n, uLight.xyz), 0.0);\n"
+    "    fragColor = vec4(clamp(vColor * (0.35 + 0.65 * diffuse) * uLight.w, 0.0, 1.0), 1.0);\n"
+    "}\n";
+
+static const char* IMPOSTOR_VS =
+    "#version 330 core\n"
+    "uniform mat4 uProjection;\n"
+    "uniform mat4 uView;\n"
+    "uniform vec4 uBillboard;\n" // x — высота центра, y — радиус, z — строк, w — шаг строк (рад)
+    "in vec2 aCorner;\n"
+    "in vec4 aInstance;\n"
+    "in vec4 aTint;\n"
+    "out vec2 vUv;\n"
+    "out vec3 vTint;\n"
+    "flat out float vFade;\n"
+    "void main() {\n"
+    "    vec4 eye = uView * vec4(aInstance.xyz + vec3(0.0, uBillboard.x * aInstance.w, 0.0), 1.0);\n"
+    // Угол возвышения камеры над центром дерева: ось Y мира в координатах глаза — uView[1]
+    "    float sinElevation = clamp(dot(normalize(-eye.xyz), uView[1].xyz), -1.0, 1.0);\n"
+    "    float row = clamp(floor(asin(sinElevation) / uBillboard.w + 0.5), 0.0, uBillboard.z - 1.0);\n"
+    "    eye.xy += (aCorner * 2.0 - 1.0) * uBillboard.y * aInstance.w;\n"
+    "    vUv = vec2((row + aCorner.x) / uBillboard.z, aCorner.y);\n"
+    "    vTint = aTint.rgb;\n"
+    "    vFade = aTint.a;\n"
+    "    gl_Position = uProjection * eye;\n"
+    "}\n";
+
+static const char* IMPOSTOR_FS =
+    "#version 330 core\n"
+    "uniform sampler2D uAtlas;\n"
+    "uniform float uBrightness;\n"
+    "in vec2 vUv;\n"
+    "in vec3 vTint;\n"
+    "flat in float vFade;\n"
+    "out vec4 fragColor;\n"
+    LAB_DITHER
+    "void main() {\n"
+    "    vec4 texel = texture(uAtlas, vUv);\n"
+    "    if (texel.a < 0.5 || dither() >= vFade) discard;\n" // вне силуэта или за сеткой
+    "    fragColor = vec4(clamp(texel.rgb * vTint * uBrightness, 0.0, 1.0), 1.0);\n"
+    "}\n";
+
+// ═══════════════════════════════════════
+// Ресурсы
+// ═══════════════════════════════════════
+
+static bool   gForest3DReady = false;
+static GLuint gTreeProgram = 0;
+static GLuint gImpostorProgram = 0;
+static GLuint gMeshVbo = 0;      // дерево, затем земля
+static GLuint gCornerVbo = 0;
+static GLuint gStaticInstances = 0; // [0] — дерево для атласа, [1] — земля
+static GLuint gStreamBuffer = 0;    // экземпляры кадра без кольца потоковых данных
+static GLuint gMeshVao = 0;
+static GLuint gQuadVao = 0;
+static GLuint gAtlas = 0;
+
+static GLint gTreeProjection = -1;
+static GLint gTreeView = -1;
+static GLint gTreeLight = -1;
+static GLint gImpostorProjection = -1;
+static GLint gImpostorView = -1;
+static GLint gImpostorBillboard = -1;
+static GLint gImpostorBrightness = -1;
+
+static GLint gTreeVertexCount = 0;
+static GLint gGroundFirst = 0;
+static float gLightDir[3] = {0.0f, 0.0f, 1.0f};
+
+// Описанная сфера единичного дерева: центр на оси ствола
+static float gCenterY = 0.0f;
+static float gRadius = 0.0f;
+
+// Габарит единичного дерева: полуширина (радиус нижнего яруса) и высота
+static float gHalfWidth = 0.0f;
+static float gHeight = 0.0f;
+
+// Деревья, их BVH и переход
+static const Tree3D* gTrees = nullptr;
+static std::size_t gTreeCount = 0;
+static Bvh gTreeBvh;
+static float gFadeStart = 0.0f;
+static float gFadeBand = 1.0f;
+static float gForestRadius = 0.0f;
+static float gGroundY = 0.0f;
+
+// Буфер окклюдеров
+static OcclusionBuffer gOcclusion;
+
+// ═══════════════════════════════════════
+// Сетка
+// ═══════════════════════════════════════
+
+static void pushVertex(std::vector<Tree3DVertex>& out, float x, float y, float z,
+                       float nx, float ny, float nz, const float color[3], float shade) {
+    out.push_back({x, y, z, nx, ny, nz, color[0] * shade, color[1] * shade, color[2] * shade});
+}
+
+// Боковая поверхность ствола
+static void addTrunk(std::vector<Tree3DVertex>& out) {
+    const float step = 6.2831853f / TREE3D_SEGMENTS;
+    for (int i = 0; i < TREE3D_SEGMENTS; ++i) {
+        float a0 = step * i, a1 = step * (i + 1);
+        float c0 = std::cos(a0), s0 = std::sin(a0), c1 = std::cos(a1), s1 = std::sin(a1);
+        float x0 = TRUNK3D_RADIUS * c0, z0 = TRUNK3D_RADIUS * s0;
+        float x1 = TRUNK3D_RADIUS * c1, z1 = TRUNK3D_RADIUS * s1;
+        pushVertex(out, x0, 0.0f, z0, c0, 0.0f, s0, TRUNK3D_COLOR, 1.0f);
+        pushVertex(out, x1, 0.0f, z1, c1, 0.0f, s1, TRUNK3D_COLOR, 1.0f);
+        pushVertex(out, x1, TRUNK3D_HEIGHT, z1, c1, 0.0f, s1, TRUNK3D_COLOR, 1.0f);
+        pushVertex(out, x0, 0.0f, z0, c0, 0.0f, s0, TRUNK3D_COLOR, 1.0f);
+        pushVertex(out, x1, TRUNK3D_HEIGHT, z1, c1, 0.0f, s1, TRUNK3D_COLOR, 1.0f);
+        pushVertex(out, x0, TRUNK3D_HEIGHT, z0, c0, 0.0f, s0, TRUNK3D_COLOR, 1.0f);
+    }
+}
+
+// Ярус: боковая поверхность конуса (нормали гладкие) и нижний круг
+static void addTier(std::vector<Tree3DVertex>& out, const TreeTier& tier) {
+    const float step = 6.2831853f / TREE3D_SEGMENTS;
+    const float slant = std::sqrt(tier.height * tier.height + tier.radius * tier.radius);
+    const float nh = tier.height / slant; // горизонтальная доля нормали
+    const float ny = tier.radius / slant;
+    const float topY = tier.baseY + tier.height;
+    for (int i = 0; i < TREE3D_SEGMENTS; ++i) {
+        float a0 = step * i, a1 = step * (i + 1), am = step * (i + 0.5f);
+        float c0 = std::cos(a0), s0 = std::sin(a0), c1 = std::cos(a1), s1 = std::sin(a1);
+        float x0 = tier.radius * c0, z0 = tier.radius * s0;
+        float x1 = tier.radius * c1, z1 = tier.radius * s1;
+        pushVertex(out, x0, tier.baseY, z0, nh * c0, ny, nh * s0, tier.color, 1.0f);
+        pushVertex(out, 0.0f, topY, 0.0f, nh * std::cos(am), ny, nh * std::sin(am), tier.color, 1.0f);
+        pushVertex(out, x1, tier.baseY, z1, nh * c1, ny, nh * s1, tier.color, 1.0f);
+
+        pushVertex(out, 0.0f, tier.baseY, 0.0f, 0.0f, -1.0f, 0.0f, tier.color, TIER_UNDERSIDE);
+        pushVertex(out, x0, tier.baseY, z0, 0.0f, -1.0f, 0.0f, tier.color, TIER_UNDERSIDE);
+        pushVertex(out, x1, tier.baseY, z1, 0.0f, -1.0f, 0.0f, tier.color, TIER_UNDERSIDE);
+    }
+}
+
+// Сетка дерева и квадрат земли в один VBO; описанная сфера дерева
+static void uploadMeshes() {
+    std::vector<Tree3DVertex> vertices;
+    addTrunk(vertices);
+    for (const TreeTier& tier : TREE3D_TIERS) addTier(vertices, tier);
+    gTreeVertexCount = static_cast<GLint>(vertices.size());
+
+    float minY = vertices[0].py, maxY = vertices[0].py;
+    for (const Tree3DVertex& v : vertices) {
+        minY = std::min(minY, v.py);
+        maxY = std::max(maxY, v.py);
+    }
+    gCenterY = 0.5f * (minY + maxY);
+    gRadius = 0.0f;
+    gHalfWidth = 0.0f;
+    for (const Tree3DVertex& v : vertices) {
+        float dy = v.py - gCenterY;
+        gRadius = std::max(gRadius, std::sqrt(v.px * v.px + dy * dy + v.pz * v.pz));
+        gHalfWidth = std::max(gHalfWidth, std::max(std::fabs(v.px), std::fabs(v.pz)));
+    }
+    gHeight = maxY;
+
+    // Земля — единичный квадрат, экземпляр растягивает его на весь лес
+    gGroundFirst = gTreeVertexCount;
+    const float corners[6][2] = {{-1, -1}, {1, -1}, {1, 1}, {-1, -1}, {1, 1}, {-1, 1}};
+    for (const float* c : corners) pushVertex(vertices, c[0], 0.0f, c[1], 0.0f, 1.0f, 0.0f, GROUND3D_COLOR, 1.0f);
+
+    gl.GenBuffers(1, &gMeshVbo);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gMeshVbo);
+    gl.BufferData(GL_ARRAY_BUFFER, static_cast<std::ptrdiff_t>(vertices.size() * sizeof(Tree3DVertex)),
+                  vertices.data(), GL_STATIC_DRAW);
+
+    static const float CORNERS[8] = {0.0f, 0.0f,  1.0f, 0.0f,  0.0f, 1.0f,  1.0f, 1.0f};
+    gl.GenBuffers(1, &gCornerVbo);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gCornerVbo);
+    gl.BufferData(GL_ARRAY_BUFFER, sizeof(CORNERS), CORNERS, GL_STATIC_DRAW);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Постоянные экземпляры: дерево для атласа и земля на весь лес (после buildTreeBvh)
+static void uploadStaticInstances() {
+    const float groundSize = gForestRadius * (1.0f + GROUND3D_MARGIN);
+    const TreeDraw statics[2] = {
+        {{0.0f, 0.0f, 0.0f}, 1.0f, {255, 255, 255, 0}},
+        {{0.0f, gGroundY, 0.0f}, groundSize, {255, 255, 255, 0}},
+    };
+    gl.GenBuffers(1, &gStaticInstances);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gStaticInstances);
+    gl.BufferData(GL_ARRAY_BUFFER, sizeof(statics), statics, GL_STATIC_DRAW);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// Атрибуты экземпляра на массив TreeDraw в текущем GL_ARRAY_BUFFER со смещения offset
+static void setInstancePointers(std::size_t offset) {
+    gl.VertexAttribPointer(ATTR3D_INSTANCE, 4, GL_FLOAT, GL_FALSE, sizeof(TreeDraw),
+                           attribPointer(nullptr, offset + offsetof(TreeDraw, position)));
+    gl.VertexAttribPointer(ATTR3D_TINT, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(TreeDraw),
+                           attribPointer(nullptr, offset + offsetof(TreeDraw, tint)));
+}
+
+static void createVertexArrays() {
+    gl.GenVertexArrays(1, &gMeshVao);
+    gl.BindVertexArray(gMeshVao);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gMeshVbo);
+    gl.EnableVertexAttribArray(ATTR3D_POSITION);
+    gl.EnableVertexAttribArray(ATTR3D_NORMAL);
+    gl.EnableVertexAttribArray(ATTR3D_COLOR);
+    gl.VertexAttribPointer(ATTR3D_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(Tree3DVertex),
+                           attribPointer(nullptr, offsetof(Tree3DVertex, px)));
+    gl.VertexAttribPointer(ATTR3D_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(Tree3DVertex),
+                           attribPointer(nullptr, offsetof(Tree3DVertex, nx)));
+    gl.VertexAttribPointer(ATTR3D_COLOR, 3, GL_FLOAT, GL_FALSE, sizeof(Tree3DVertex),
+                           attribPointer(nullptr, offsetof(Tree3DVertex, r)));
+
+    gl.GenVertexArrays(1, &gQuadVao);
+    gl.BindVertexArray(gQuadVao);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gCornerVbo);
+    gl.EnableVertexAttribArray(ATTR3D_CORNER);
+    gl.VertexAttribPointer(ATTR3D_CORNER, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    // Указатели экземпляров задаются перед каждым рисованием
+    for (GLuint vao : {gMeshVao, gQuadVao}) {
+        gl.BindVertexArray(vao);
+        gl.EnableVertexAttribArray(ATTR3D_INSTANCE);
+        gl.EnableVertexAttribArray(ATTR3D_TINT);
+        gl.VertexAttribDivisor(ATTR3D_INSTANCE, 1);
+        gl.VertexAttribDivisor(ATTR3D_TINT, 1);
+    }
+    gl.BindVertexArray(0);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// ═══════════════════════════════════════
+// Атлас: дерево в ортографической проекции под углами возвышения строк
+// ═══════════════════════════════════════
+
+static bool bakeAtlas() {
+    const int width = IMPOSTOR_CELL * IMPOSTOR_ROWS;
+    const int height = IMPOSTOR_CELL;
+
+    glGenTextures(1, &gAtlas);
+    glBindTexture(GL_TEXTURE_2D, gAtlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    GLuint fbo = 0, depth = 0;
+    gl.GenFramebuffers(1, &fbo);
+    gl.GenRenderbuffers(1, &depth);
+    gl.BindRenderbuffer(GL_RENDERBUFFER, depth);
+    gl.RenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+    gl.BindRenderbuffer(GL_RENDERBUFFER, 0);
+    gl.BindFramebuffer(GL_FRAMEBUFFER, fbo);
+    gl.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gAtlas, 0);
+    gl.FramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+    bool complete = gl.CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    if (complete) {
+        GLint viewport[4];
+        GLfloat clearColor[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+        glViewport(0, 0, width, height);
+        glClearColor(IMPOSTOR_CLEAR[0], IMPOSTOR_CLEAR[1], IMPOSTOR_CLEAR[2], IMPOSTOR_CLEAR[3]);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        gl.UseProgram(gTreeProgram);
+        gl.Uniform4f(gTreeLight, gLightDir[0], gLightDir[1], gLightDir[2], 1.0f);
+        Mat4 projection = mat4Ortho(-gRadius, gRadius, -gRadius, gRadius, 0.5f * gRadius, 3.5f * gRadius);
+        gl.UniformMatrix4fv(gTreeProjection, 1, GL_FALSE, projection.m);
+        gl.BindVertexArray(gMeshVao);
+        gl.BindBuffer(GL_ARRAY_BUFFER, gStaticInstances);
+        setInstancePointers(0);
+        for (int row = 0; row < IMPOSTOR_ROWS; ++row) {
+            const float elevation = IMPOSTOR_ROW_STEP_DEG * row * 3.1415927f / 180.0f;
+            const float distance = 2.0f * gRadius;
+            Mat4 view = mat4LookAt(0.0f, gCenterY + distance * std::sin(elevation), distance * std::cos(elevation),
+                                   0.0f, gCenterY, 0.0f, 0.0f, 1.0f, 0.0f);
+            gl.UniformMatrix4fv(gTreeView, 1, GL_FALSE, view.m);
+            glViewport(row * IMPOSTOR_CELL, 0, IMPOSTOR_CELL, IMPOSTOR_CELL);
+            gl.DrawArraysInstanced(GL_TRIANGLES, 0, gTreeVertexCount, 1);
+        }
+        gl.BindVertexArray(0);
+        gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+        gl.UseProgram(0);
+
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    }
+    gl.BindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl.DeleteFramebuffers(1, &fbo);
+    gl.DeleteRenderbuffers(1, &depth);
+    if (!complete) return false;
+
+    glBindTexture(GL_TEXTURE_2D, gAtlas);
+    gl.GenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return true;
+}
+
+// ═══════════════════════════════════════
+// Инициализация
+// ═══════════════════════════════════════
+
+// Габарит дерева по его сетке. Силуэт impostor-а внутри него же: квадрат
+// больше, но за силуэтом его пиксели отброшены альфа-тестом
+static Aabb treeBox(const Tree3D& t) {
+    const float r = gHalfWidth * t.scale;
+    Aabb box;
+    box.min[0] = t.position[0] - r;
+    box.max[0] = t.position[0] + r;
+    box.min[1] = t.position[1];
+    box.max[1] = t.position[1] + gHeight * t.scale;
+    box.min[2] = t.position[2] - r;
+    box.max[2] = t.position[2] + r;
+    return box;
+}
+
+// BVH деревьев по их габаритам и радиус леса
+static void buildTreeBvh() {
+    std::vector<Aabb> boxes(gTreeCount);
+    gForestRadius = 0.0f;
+    for (std::size_t i = 0; i < gTreeCount; ++i) {
+        const Tree3D& t = gTrees[i];
+        boxes[i] = treeBox(t);
+        gForestRadius = std::max(gForestRadius, std::sqrt(t.position[0] * t.position[0] +
+                                                          t.position[2] * t.position[2]) + gRadius * t.scale);
+    }
+    gTreeBvh.build(boxes.data(), boxes.size());
+}
+
+bool initForest3D(const Tree3D* trees, std::size_t count, float impostorDistance,
+                  const float lightPosition[4]) {
+    if (gForest3DReady) releaseForest3D();
+    if (!gl.hasShaders || !gl.hasInstancing || !gl.hasUniformBuffers || !gl.hasFramebuffer ||
+        !glVersionAtLeast(3, 3) || count == 0) {
+        return false;
+    }
+
+    const AttribBinding treeBindings[] = {
+        {ATTR3D_POSITION, "aPosition"},
+        {ATTR3D_NORMAL,   "aNormal"},
+        {ATTR3D_COLOR,    "aColor"},
+        {ATTR3D_INSTANCE, "aInstance"},
+        {ATTR3D_TINT,     "aTint"},
+    };
+    const AttribBinding impostorBindings[] = {
+        {ATTR3D_CORNER,   "aCorner"},
+        {ATTR3D_INSTANCE, "aInstance"},
+        {ATTR3D_TINT,     "aTint"},
+    };
+    gTreeProgram = buildProgram(TREE3D_VS, TREE3D_FS, treeBindings, 5);
+    gImpostorProgram = buildProgram(IMPOSTOR_VS, IMPOSTOR_FS, impostorBindings, 3);
+    if (gTreeProgram == 0 || gImpostorProgram == 0) {
+        releaseForest3D();
+        return false;
+    }
+    gTreeProjection     = gl.GetUniformLocation(gTreeProgram, "uProjection");
+    gTreeView           = gl.GetUniformLocation(gTreeProgram, "uView");
+    gTreeLight          = gl.GetUniformLocation(gTreeProgram, "uLight");
+    gImpostorProjection = gl.GetUniformLocation(gImpostorProgram, "uProjection");
+    gImpostorView       = gl.GetUniformLocation(gImpostorProgram, "uView");
+    gImpostorBillboard  = gl.GetUniformLocation(gImpostorProgram, "uBillboard");
+    gImpostorBrightness = gl.GetUniformLocation(gImpostorProgram, "uBrightness");
+    gl.UseProgram(gImpostorProgram);
+    gl.Uniform1i(gl.GetUniformLocation(gImpostorProgram, "uAtlas"), 0);
+    gl.UseProgram(0);
+
+    // Источник точечный, но для деревьев — направленный: атлас не зависит от
+    // положения дерева на экране
+    const float len = std::sqrt(lightPosition[0] * lightPosition[0] + lightPosition[1] * lightPosition[1] +
+                                lightPosition[2] * lightPosition[2]);
+    for (int c = 0; c < 3; ++c) gLightDir[c] = len > 0.0f ? lightPosition[c] / len : (c == 2 ? 1.0f : 0.0f);
+
+    gTrees = trees;
+    gTreeCount = count;
+    gGroundY = trees[0].position[1];
+    gFadeBand = std::max(impostorDistance * FOREST3D_FADE_BAND, 1e-3f);
+    gFadeStart = impostorDistance - 0.5f * gFadeBand;
+
+    uploadMeshes();
+    buildTreeBvh();
+    uploadStaticInstances();
+    createVertexArrays();
+    gl.GenBuffers(1, &gStreamBuffer);
+
+    if (!bakeAtlas()) {
+        std::fprintf(stderr, "Impostor atlas framebuffer is incomplete\n");
+        releaseForest3D();
+        return false;
+    }
+
+    std::fprintf(stderr, "3D forest: %zu trees, %d vertices per tree, impostors beyond %.1f\n",
+                 count, gTreeVertexCount, impostorDistance);
+    gForest3DReady = true;
+    return true;
+}
+
+float forest3DRadius() {
+    return gForestRadius;
+}
+
+void releaseForest3D() {
+    if (gTreeProgram != 0) gl.DeleteProgram(gTreeProgram);
+    if (gImpostorProgram != 0) gl.DeleteProgram(gImpostorProgram);
+    if (gMeshVbo != 0) gl.DeleteBuffers(1, &gMeshVbo);
+    if (gCornerVbo != 0) gl.DeleteBuffers(1, &gCornerVbo);
+    if (gStaticInstances != 0) gl.DeleteBuffers(1, &gStaticInstances);
+    if (gStreamBuffer != 0) gl.DeleteBuffers(1, &gStreamBuffer);
+    if (gMeshVao != 0) gl.DeleteVertexArrays(1, &gMeshVao);
+    if (gQuadVao != 0) gl.DeleteVertexArrays(1, &gQuadVao);
+    if (gAtlas != 0) glDeleteTextures(1, &gAtlas);
+    gTreeProgram = gImpostorProgram = gMeshVbo = gCornerVbo = gStaticInstances = gStreamBuffer = 0;
+    gMeshVao = gQuadVao = gAtlas = 0;
+    gTrees = nullptr;
+    gTreeCount = 0;
+    gForest3DReady = false;
+}
+
+// ═══════════════════════════════════════
+// Кадр
+// ═══════════════════════════════════════
+
+// Окклюдер дерева в буфер: сечения перпендикулярны направлению на камеру по горизонтали
+static void addTreeOccluder(const Tree3D& t, const float eye[3]) {
+    float sx = -(t.position[2] - eye[2]);
+    float sz = t.position[0] - eye[0];
+    const float len = std::sqrt(sx * sx + sz * sz);
+    if (len > 0.0f) {
+        sx /= len;
+        sz /= len;
+    } else {
+        sx = 1.0f;
+        sz = 0.0f;
+    }
+
+    const float inscribed = std::cos(3.1415927f / TREE3D_SEGMENTS) * OCCLUDER_MARGIN * t.scale;
+    const float* p = t.position;
+    auto point = [&](float side, float y, float out[3]) {
+        out[0] = p[0] + sx * side;
+        out[1] = p[1] + y * t.scale;
+        out[2] = p[2] + sz * side;
+    };
+
+    // Ствол — прямоугольник
+    float a[3], b[3], c[3], d[3];
+    const float trunk = TRUNK3D_RADIUS * inscribed;
+    point(-trunk, 0.0f, a);
+    point(trunk, 0.0f, b);
+    point(trunk, TRUNK3D_HEIGHT, c);
+    point(-trunk, TRUNK3D_HEIGHT, d);
+    gOcclusion.addTriangle(a, b, c);
+    gOcclusion.addTriangle(a, c, d);
+
+    // Ярус — треугольник от края основания до вершины
+    for (const TreeTier& tier : TREE3D_TIERS) {
+        const float r = tier.radius * inscribed;
+        point(-r, tier.baseY, a);
+        point(r, tier.baseY, b);
+        point(0.0f, tier.baseY + tier.height, c);
+        gOcclusion.addTriangle(a, b, c);
+    }
+}
+
+// Отбросить из visible деревья, закрытые ближайшими FOREST3D_OCCLUDERS из них
+static void occlusionCull(const Forest3DFrame& frame, std::vector<std::uint32_t>& visible) {
+    static std::vector<std::uint32_t> nearest;
+    static std::vector<std::uint8_t> hidden;
+
+    {
+        PROFILE_SCOPE("rasterOccluders");
+        Mat4 clip = frame.projection * frame.view;
+        gOcclusion.begin(clip, frame.projection.m[5] / frame.projection.m[0]); // пропорции — из проекции
+
+        auto distance2 = [&frame](std::uint32_t index) {
+            const float* p = gTrees[index].position;
+            const float dx = p[0] - frame.eye[0], dz = p[2] - frame.eye[2];
+            return dx * dx + dz * dz;
+        };
+        nearest = visible;
+        const std::size_t count = std::min(nearest.size(), static_cast<std::size_t>(FOREST3D_OCCLUDERS));
+        std::nth_element(nearest.begin(), nearest.begin() + count, nearest.end(),
+                         [&](std::uint32_t a, std::uint32_t b) { return distance2(a) < distance2(b); });
+        for (std::size_t k = 0; k < count; ++k) addTreeOccluder(gTrees[nearest[k]], frame.eye);
+        gOcclusion.buildPyramid();
+    }
+    profilerCounter("occluderTriangles", static_cast<double>(gOcclusion.triangles()));
+
+    std::size_t kept = 0;
+    {
+        PROFILE_SCOPE("occlusionTest");
+        hidden.resize(visible.size());
+        ThreadPool::global().parallelFor(visible.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+            for (std::size_t k = begin; k < end; ++k) hidden[k] = gOcclusion.occluded(treeBox(gTrees[visible[k]]));
+        });
+        for (std::size_t k = 0; k < visible.size(); ++k) {
+            if (!hidden[k]) visible[kept++] = visible[k];
+        }
+    }
+    profilerCounter("occludedTrees3D", static_cast<double>(visible.size() - kept));
+    visible.resize(kept);
+}
+
+void drawForest3D(const Forest3DFrame& frame) {
+    if (!gForest3DReady) return;
+
+    static std::vector<std::uint32_t> visible;
+    static std::vector<TreeDraw> nearTrees;
+    static std::vector<TreeDraw> farTrees;
+    {
+        PROFILE_SCOPE("cullForest3D");
+        CullStats stats;
+        if (frame.cull) {
+            Frustum frustum;
+            Mat4 clip = frame.projection * frame.view;
+            extractFrustum(clip.m, frustum);
+            gTreeBvh.cull(frustum, visible, stats);
+        } else {
+            visible.resize(gTreeCount);
+            for (std::size_t i = 0; i < gTreeCount; ++i) visible[i] = static_cast<std::uint32_t>(i);
+            stats.visible = gTreeCount;
+        }
+        if (frame.occlusion) {
+            occlusionCull(frame, visible);
+            stats.visible = visible.size();
+        }
+
+        // Доля перехода по расстоянию от камеры до центра дерева: 0 — только сетка,
+        // 255 — только impostor, между ними — оба
+        nearTrees.clear();
+        farTrees.clear();
+        for (std::uint32_t index : visible) {
+            const Tree3D& t = gTrees[index];
+            const float dx = t.position[0] - frame.eye[0];
+            const float dy = t.position[1] + gCenterY * t.scale - frame.eye[1];
+            const float dz = t.position[2] - frame.eye[2];
+            const float fade = (std::sqrt(dx * dx + dy * dy + dz * dz) - gFadeStart) / gFadeBand;
+            TreeDraw draw;
+            std::memcpy(draw.position, t.position, sizeof(draw.position));
+            draw.scale = t.scale;
+            std::memcpy(draw.tint, t.tint, sizeof(t.tint));
+            draw.tint[3] = static_cast<std::uint8_t>(std::lround(255.0f * std::min(std::max(fade, 0.0f), 1.0f)));
+            if (draw.tint[3] < 255) nearTrees.push_back(draw);
+            if (draw.tint[3] > 0) farTrees.push_back(draw);
+        }
+        profilerCounter("visibleTrees3D", static_cast<double>(stats.visible));
+        profilerCounter("culledTrees3D", static_cast<double>(stats.culled));
+    }
+    profilerCounter("meshTrees3D", static_cast<double>(nearTrees.size()));
+    profilerCounter("impostorTrees3D", static_cast<double>(farTrees.size()));
+    profilerCounter("forest3DVertices", static_cast<double>(nearTrees.size()) * gTreeVertexCount +
+                                        static_cast<double>(farTrees.size()) * 4.0);
+
+    // Экземпляры кадра: ближние, за ними дальние
+    const std::size_t nearBytes = nearTrees.size() * sizeof(TreeDraw);
+    const std::size_t farBytes = farTrees.size() * sizeof(TreeDraw);
+    GLuint buffer = gStreamBuffer;
+    std::size_t offset = 0;
+    if (nearBytes + farBytes > 0) {
+        StreamAlloc alloc = streamAllocate(nearBytes + farBytes, sizeof(float));
+        if (alloc.ptr != nullptr) {
+            unsigned char* dst = static_cast<unsigned char*>(alloc.ptr);
+            if (nearBytes > 0) std::memcpy(dst, nearTrees.data(), nearBytes);
+            if (farBytes > 0) std::memcpy(dst + nearBytes, farTrees.data(), farBytes);
+            buffer = alloc.buffer;
+            offset = alloc.offset;
+        } else {
+            // Без кольца: старое хранилище отдаётся драйверу, кадр — в новое
+            gl.BindBuffer(GL_ARRAY_BUFFER, gStreamBuffer);
+            gl.BufferData(GL_ARRAY_BUFFER, static_cast<std::ptrdiff_t>(nearBytes + farBytes), nullptr,
+                          GL_STREAM_DRAW);
+            if (nearBytes > 0) gl.BufferSubData(GL_ARRAY_BUFFER, 0, static_cast<std::ptrdiff_t>(nearBytes),
+                                                nearTrees.data());
+            if (farBytes > 0) gl.BufferSubData(GL_ARRAY_BUFFER, static_cast<std::ptrdiff_t>(nearBytes),
+                                               static_cast<std::ptrdiff_t>(farBytes), farTrees.data());
+        }
+    }
+
+    // Земля и ближние деревья — сеткой
+    gl.UseProgram(gTreeProgram);
+    gl.UniformMatrix4fv(gTreeProjection, 1, GL_FALSE, frame.projection.m);
+    gl.UniformMatrix4fv(gTreeView, 1, GL_FALSE, frame.view.m);
+    gl.Uniform4f(gTreeLight, gLightDir[0], gLightDir[1], gLightDir[2], frame.brightness);
+    gl.BindVertexArray(gMeshVao);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gStaticInstances);
+    setInstancePointers(sizeof(TreeDraw));
+    gl.DrawArraysInstanced(GL_TRIANGLES, gGroundFirst, 6, 1);
+    if (!nearTrees.empty()) {
+        gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+        setInstancePointers(offset);
+        gl.DrawArraysInstanced(GL_TRIANGLES, 0, gTreeVertexCount, static_cast<GLsizei>(nearTrees.size()));
+    }
+
+    // Дальние — квадратами из атласа
+    if (!farTrees.empty()) {
+        gl.UseProgram(gImpostorProgram);
+        gl.UniformMatrix4fv(gImpostorProjection, 1, GL_FALSE, frame.projection.m);
+        gl.UniformMatrix4fv(gImpostorView, 1, GL_FALSE, frame.view.m);
+        gl.Uniform4f(gImpostorBillboard, gCenterY, gRadius, static_cast<float>(IMPOSTOR_ROWS),
+                     IMPOSTOR_ROW_STEP_DEG * 3.1415927f / 180.0f);
+        gl.Uniform1f(gImpostorBrightness, frame.brightness);
+        gl.ActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, gAtlas);
+        gl.BindVertexArray(gQuadVao);
+        gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+        setInstancePointers(offset + nearBytes);
+        gl.DrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(farTrees.size()));
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    gl.BindVertexArray(0);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    gl.UseProgram(0);
+}
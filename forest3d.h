@@ -0,0 +1,54 @@
+// ═══════════════════════════════════════
+// Трёхмерный лес до горизонта
+// Вблизи — настоящие ёлки (ствол и три яруса конусов) инстансингом, вдали —
+// impostor-ы: по квадрату на дерево, повёрнутому к камере и затекстурированному
+// из атласа. Атлас рисуется один раз при запуске из той же сетки дерева под
+// несколькими углами возвышения камеры; строка выбирается по углу, под которым
+// камера видит дерево. На границе полоса перехода: сетка и impostor рисуются
+// вместе и делят пиксели дизерингом по доле перехода, поэтому переход плавный
+// и без смешивания (обе формы пишут глубину). Вершин в кадре — в основном
+// у ближнего кольца деревьев, дальние стоят по четыре вершины. Деревья,
+// целиком закрытые ближайшими, отбрасываются до отправки (occlusion.h)
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "scene.h"
+#include "vecmath.h"
+
+#include <cstddef>
+
+// Расстояние от камеры до центра дерева, на котором оно становится impostor-ом
+static const float FOREST3D_IMPOSTOR_DISTANCE = 20.0f;
+
+// Ширина полосы перехода — доля расстояния перехода
+static const float FOREST3D_FADE_BAND = 0.2f;
+
+// Ближайших видимых деревьев, растеризуемых в буфер окклюдеров
+static const int FOREST3D_OCCLUDERS = 128;
+
+// Параметры кадра
+struct Forest3DFrame {
+    Mat4 projection;
+    Mat4 view;
+    float eye[3];     // позиция камеры (та же, что в mat4LookAt)
+    float brightness;
+    bool cull;        // отсечение по пирамиде видимости
+    bool occlusion;   // отсечение деревьев, закрытых ближними
+};
+
+// Подготовить сетку дерева, программы и атлас impostor-ов. Массив деревьев
+// (generateForest3D) должен жить до releaseForest3D; земля — квадрат под всем
+// лесом. lightPosition — источник в координатах глаза (его направление
+// запекается в атлас). false — нужен OpenGL 3.3 (шейдеры, инстансинг, FBO)
+bool initForest3D(const Tree3D* trees, std::size_t count, float impostorDistance,
+                  const float lightPosition[4]);
+
+// Радиус круга, в котором стоит лес (для дальней плоскости отсечения)
+float forest3DRadius();
+
+// Нарисовать землю и деревья (непрозрачные, с записью глубины)
+void drawForest3D(const Forest3DFrame& frame);
+
+// Освободить буферы, программы и атлас (до уничтожения контекста)
+void releaseForest3D();
@@ -0,0 +1,220 @@
+// ═══════════════════════════════════════
+// Бесконечный лес с подгрузкой чанков
+// ═══════════════════════════════════════
+
+#include "forest_stream.h"
+#include "scene.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+// Чанков сверх видимых с каждой стороны
+static const long long STREAM_PREFETCH_CHUNKS = 2;
+
+// Упреждение по направлению движения: путь за столько кадров при текущей скорости
+static const float     STREAM_LOOKAHEAD_FRAMES     = 20.0f;
+static const long long STREAM_MAX_LOOKAHEAD_CHUNKS = 64;
+
+// Предел кеша чанков; вытесняются давно не нужные
+static const std::size_t STREAM_CACHE_CHUNKS = 128;
+
+// Сколько байт экземпляров можно загрузить в VBO за кадр (один чанк — всегда)
+static const std::size_t STREAM_UPLOAD_BUDGET_BYTES = 64 * 1024;
+
+// Ёмкость очередей заказов и результатов (результатов — с запасом на исполнителей)
+static const std::size_t STREAM_REQUEST_CAPACITY = 256;
+static const std::size_t STREAM_RESULT_CAPACITY  = 512;
+
+// Не больше стольких фоновых потоков
+static const unsigned STREAM_MAX_WORKERS = 4;
+
+// Как долго исполнитель спит без заказов, прежде чем проверить очередь снова
+static const std::chrono::milliseconds STREAM_IDLE_WAIT(10);
+
+// Номер чанка, содержащего координату x
+static long long chunkOf(float x) {
+    return static_cast<long long>(std::floor(x / FOREST_CHUNK_WIDTH));
+}
+
+ForestStream::ForestStream(unsigned int seed, int treesPerChunk, unsigned workers)
+    : mSeed(seed),
+      mTreesPerChunk(treesPerChunk),
+      mRequests(STREAM_REQUEST_CAPACITY),
+      mResults(STREAM_RESULT_CAPACITY) {
+    if (workers == 0) {
+        unsigned hw = std::thread::hardware_concurrency();
+        workers = std::min(STREAM_MAX_WORKERS, hw > 1 ? hw - 1 : 1u);
+    }
+    for (unsigned i = 0; i < workers; ++i) {
+        mWorkers.emplace_back(&ForestStream::workerLoop, this);
+    }
+}
+
+ForestStream::~ForestStream() {
+    mStop.store(true);
+    mWake.notify_all();
+    for (std::thread& t : mWorkers) t.join();
+
+    ChunkBuild build;
+    while (mResults.tryPop(build)) delete build.trees;
+}
+
+// ═══════════════════════════════════════
+// Фоновые исполнители
+// ═══════════════════════════════════════
+
+void ForestStream::workerLoop() {
+    while (!mStop.load(std::memory_order_relaxed)) {
+        long long index;
+        if (!mRequests.tryPop(index)) {
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWake.wait_for(lock, STREAM_IDLE_WAIT,
+                           [this] { return mStop.load() || !mRequests.empty(); });
+            continue;
+        }
+
+        // Окрестность успела уйти — чанк уже не нужен, сообщаем об отмене
+        ChunkBuild build = {index, nullptr};
+        if (index >= mWantedLo.load(std::memory_order_relaxed) &&
+            index <= mWantedHi.load(std::memory_order_relaxed)) {
+            build.trees = new std::vector<TreeInstance>();
+            generateForestChunk(*build.trees, index, index * FOREST_CHUNK_WIDTH,
+                                FOREST_CHUNK_WIDTH, mTreesPerChunk, mSeed);
+        }
+
+        // Очередь результатов вмещает все заказы, так что ожидание здесь редкость
+        while (!mResults.tryPush(build)) {
+            if (mStop.load()) {
+                delete build.trees;
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+// ═══════════════════════════════════════
+// Поток отрисовки
+// ═══════════════════════════════════════
+
+void ForestStream::update(const Rect2D& view) {
+    ++mFrame;
+    mStats.uploads = 0;
+
+    // Окрестность: видимые чанки, запас с обеих сторон и упреждение по движению
+    float center = 0.5f * (view.minX + view.maxX);
+    float velocity = mHasLastCenter ? center - mLastCenter : 0.0f;
+    mLastCenter = center;
+    mHasLastCenter = true;
+
+    long long lo = chunkOf(view.minX) - STREAM_PREFETCH_CHUNKS;
+    long long hi = chunkOf(view.maxX) + STREAM_PREFETCH_CHUNKS;
+    long long ahead = static_cast<long long>(
+        std::ceil(std::fabs(velocity) * STREAM_LOOKAHEAD_FRAMES / FOREST_CHUNK_WIDTH));
+    ahead = std::min(ahead, STREAM_MAX_LOOKAHEAD_CHUNKS);
+    if (velocity > 0.0f) hi += ahead;
+    if (velocity < 0.0f) lo -= ahead;
+    mWantedLo.store(lo, std::memory_order_relaxed);
+    mWantedHi.store(hi, std::memory_order_relaxed);
+
+    // Принять готовые чанки (без ожидания)
+    ChunkBuild build;
+    while (mResults.tryPop(build)) {
+        mPending.erase(build.index);
+        if (build.trees == nullptr) continue;
+
+        Chunk& chunk = mChunks[build.index];
+        chunk.batch.instances.swap(*build.trees);
+        chunk.batch.dirty = true;
+        chunk.uploaded = false;
+        chunk.lastUsed = mFrame;
+        mUploadQueue.push_back(build.index);
+        delete build.trees;
+    }
+
+    // Заказать недостающие чанки от центра к краям; очередь полна — дозакажем в следующем кадре
+    long long mid = chunkOf(center);
+    bool requested = false;
+    bool full = false;
+    for (long long d = 0; !full && (mid - d >= lo || mid + d <= hi); ++d) {
+        long long candidates[2] = {mid + d, mid - d};
+        for (int k = 0; k < (d == 0 ? 1 : 2) && !full; ++k) {
+            long long index = candidates[k];
+            if (index < lo || index > hi) continue;
+
+            auto it = mChunks.find(index);
+            if (it != mChunks.end()) {
+                it->second.lastUsed = mFrame;
+                continue;
+            }
+            if (mPending.count(index) != 0) continue;
+            if (!mRequests.tryPush(index)) {
+                full = true;
+                break;
+            }
+            mPending[index] = true;
+            requested = true;
+        }
+    }
+    if (requested) mWake.notify_all();
+
+    // Загрузка в VBO в пределах бюджета, ближние к центру — первыми
+    std::sort(mUploadQueue.begin(), mUploadQueue.end(), [mid](long long a, long long b) {
+        return std::llabs(a - mid) < std::llabs(b - mid);
+    });
+    std::size_t bytes = 0;
+    std::size_t done = 0;
+    for (; done < mUploadQueue.size(); ++done) {
+        auto it = mChunks.find(mUploadQueue[done]);
+        if (it == mChunks.end()) continue; // вытеснен, не дождавшись загрузки
+
+        std::size_t size = it->second.batch.instances.size() * sizeof(TreeInstance);
+        if (mStats.uploads > 0 && bytes + size > STREAM_UPLOAD_BUDGET_BYTES) break;
+        uploadForestBatch(it->second.batch);
+        it->second.uploaded = true;
+        bytes += size;
+        ++mStats.uploads;
+    }
+    mUploadQueue.erase(mUploadQueue.begin(), mUploadQueue.begin() + done);
+
+    evict();
+
+    mStats.resident = mChunks.size();
+    mStats.pending = mPending.size();
+}
+
+void ForestStream::evict() {
+    if (mChunks.size() <= STREAM_CACHE_CHUNKS) return;
+
+    // Кандидаты — чанки вне текущей окрестности, самые давние первыми
+    std::vector<std::pair<unsigned long long, long long>> stale;
+    for (const auto& entry : mChunks) {
+        if (entry.second.lastUsed < mFrame) stale.emplace_back(entry.second.lastUsed, entry.first);
+    }
+    std::sort(stale.begin(), stale.end());
+
+    std::size_t excess = mChunks.size() - STREAM_CACHE_CHUNKS;
+    for (std::size_t i = 0; i < excess && i < stale.size(); ++i) {
+        auto it = mChunks.find(stale[i].second);
+        releaseForestBatch(it->second.batch);
+        mChunks.erase(it);
+    }
+}
+
+void ForestStream::draw(const Rect2D& view) {
+    // Кроны выступают за границу своего чанка — берём по соседу с каждой стороны
+    mStats.visible = 0;
+    for (long long index = chunkOf(view.minX) - 1; index <= chunkOf(view.maxX) + 1; ++index) {
+        auto it = mChunks.find(index);
+        if (it == mChunks.end() || !it->second.uploaded) continue; // ещё строится — без ожидания
+        drawForestBatch(it->second.batch);
+        mStats.visible += it->second.batch.instances.size();
+    }
+}
+
+void ForestStream::releaseBuffers() {
+    for (auto& entry : mChunks) releaseForestBatch(entry.second.batch);
+    mChunks.clear();
+    mUploadQueue.clear();
+}
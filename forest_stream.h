@@ -0,0 +1,98 @@
+// ═══════════════════════════════════════
+// Бесконечный лес с подгрузкой чанков
+// Мир вдоль X разбит на чанки фиксированной ширины. Деревья чанка
+// генерируются детерминированно по зерну в фоновых потоках и передаются
+// потоку отрисовки через очередь без блокировок. Поток отрисовки только
+// загружает готовые чанки в VBO (не больше бюджета за кадр) и никогда
+// не ждёт исполнителей; дальние чанки вытесняются из ограниченного кеша
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "culling.h"
+#include "forest.h"
+#include "lockfree_queue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Ширина чанка в мировых единицах (экран 2D-режима — 2 единицы)
+static const float FOREST_CHUNK_WIDTH = 1.0f;
+
+// Деревьев в чанке по умолчанию (плотность как у исходной сцены)
+static const int FOREST_CHUNK_TREES = 4;
+
+// Итоги потоковой подгрузки за кадр
+struct ForestStreamStats {
+    std::size_t resident = 0; // чанков в кеше
+    std::size_t pending  = 0; // заказано и ещё не получено
+    std::size_t uploads  = 0; // загружено в VBO за кадр
+    std::size_t visible  = 0; // деревьев нарисовано
+};
+
+class ForestStream {
+public:
+    // workers — число фоновых потоков (0 — по числу ядер без одного)
+    ForestStream(unsigned int seed, int treesPerChunk, unsigned workers = 0);
+    ~ForestStream();
+
+    ForestStream(const ForestStream&) = delete;
+    ForestStream& operator=(const ForestStream&) = delete;
+
+    // Раз в кадр: заказать чанки вокруг view, принять готовые, загрузить в пределах
+    // бюджета и вытеснить лишние
+    void update(const Rect2D& view);
+
+    // Нарисовать загруженные чанки, задевающие view (после update)
+    void draw(const Rect2D& view);
+
+    // Освободить буферы чанков (контекст OpenGL ещё жив)
+    void releaseBuffers();
+
+    const ForestStreamStats& stats() const { return mStats; }
+
+private:
+    // Готовые деревья чанка от исполнителя (nullptr в trees — заказ отменён)
+    struct ChunkBuild {
+        long long index;
+        std::vector<TreeInstance>* trees;
+    };
+
+    struct Chunk {
+        ForestBatch batch;
+        bool uploaded = false;
+        unsigned long long lastUsed = 0; // номер кадра последнего попадания в окрестность
+    };
+
+    void workerLoop();
+    void evict();
+
+    unsigned int mSeed;
+    int mTreesPerChunk;
+
+    std::unordered_map<long long, Chunk> mChunks;  // готовые чанки (кеш)
+    std::unordered_map<long long, bool>  mPending; // заказанные чанки
+    std::vector<long long> mUploadQueue;           // готовы, но ещё не в VBO
+
+    LockFreeQueue<long long>  mRequests; // поток отрисовки -> исполнители
+    LockFreeQueue<ChunkBuild> mResults;  // исполнители -> поток отрисовки
+
+    // Окрестность, которая ещё нужна: заказы вне неё исполнители отменяют
+    std::atomic<long long> mWantedLo{0};
+    std::atomic<long long> mWantedHi{0};
+
+    std::vector<std::thread> mWorkers;
+    std::mutex mWakeMutex;
+    std::condition_variable mWake;
+    std::atomic<bool> mStop{false};
+
+    float mLastCenter = 0.0f;
+    bool  mHasLastCenter = false;
+    unsigned long long mFrame = 0;
+    ForestStreamStats mStats;
+};
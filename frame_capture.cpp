@@ -0,0 +1,379 @@
+// ═══════════════════════════════════════
+// Запись кадров в видео без остановки отрисовки
+// ═══════════════════════════════════════
+
+#include "frame_capture.h"
+#include "image_io.h"
+#include "profiler.h"
+
+#include <chrono>
+#include <cstring>
+
+// Сколько поток записи спит без кадров, прежде чем проверить очередь снова
+static const std::chrono::milliseconds CAPTURE_IDLE_WAIT(10);
+
+// Предел ожидания барьера при остановке записи (наносекунды)
+static const unsigned long long CAPTURE_FENCE_TIMEOUT_NS = 1000000000ull;
+
+CaptureFormat captureFormatForPath(const std::string& path) {
+    if (path.find('%') != std::string::npos) return CAPTURE_PPM_SEQUENCE;
+    std::size_t dot = path.rfind('.');
+    if (dot != std::string::npos) {
+        std::string ext = path.substr(dot);
+        for (char& c : ext) {
+            if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        }
+        if (ext == ".y4m") return CAPTURE_Y4M;
+    }
+    return CAPTURE_RAW;
+}
+
+// Разобрать шаблон нумерованных PPM: ровно одно %d или %0Nd, %% — знак процента.
+// Имя собирается без printf, поэтому прочие % в пути недопустимы
+static bool parseFramePattern(const std::string& path, std::string& prefix, std::string& suffix,
+                              int& digits) {
+    prefix.clear();
+    suffix.clear();
+    digits = -1;
+    for (std::size_t i = 0; i < path.size(); ++i) {
+        std::string& out = digits < 0 ? prefix : suffix;
+        if (path[i] != '%') {
+            out += path[i];
+            continue;
+        }
+        if (i + 1 < path.size() && path[i + 1] == '%') {
+            out += '%';
+            ++i;
+            continue;
+        }
+        if (digits >= 0) return false; // второй номер
+
+        // %d или %0Nd
+        std::size_t k = i + 1;
+        int width = 0;
+        if (k < path.size() && path[k] == '0') {
+            ++k;
+            while (k < path.size() && path[k] >= '0' && path[k] <= '9' && width < 100) {
+                width = width * 10 + (path[k] - '0');
+                ++k;
+            }
+            if (width == 0 || width > 20) return false;
+        }
+        if (k >= path.size() || path[k] != 'd') return false;
+        digits = width;
+        i = k;
+    }
+    return digits >= 0;
+}
+
+// Яркость и цветоразность BT.601 (узкий диапазон 16..235 / 16..240)
+static std::uint8_t lumaBT601(int r, int g, int b) {
+    return static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+}
+
+static std::uint8_t chromaU(int r, int g, int b) {
+    return static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+}
+
+static std::uint8_t chromaV(int r, int g, int b) {
+    return static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+FrameRecorder::~FrameRecorder() {
+    stop();
+}
+
+bool FrameRecorder::start(const std::string& path, int width, int height, int fps) {
+    stop();
+    if (width <= 0 || height <= 0) return false;
+
+    mFormat = captureFormatForPath(path);
+    if (mFormat == CAPTURE_PPM_SEQUENCE && !parseFramePattern(path, mPrefix, mSuffix, mDigits)) {
+        std::fprintf(stderr, "--record pattern %s must contain exactly one %%d or %%0Nd "
+                             "(use %%%% for a literal %%)\n", path.c_str());
+        return false;
+    }
+    mPath   = path;
+    mWidth  = width;
+    mHeight = height;
+    mAsync  = gl.hasAsyncReadback;
+
+    if (mFormat != CAPTURE_PPM_SEQUENCE) {
+        mFile = std::fopen(path.c_str(), "wb");
+        if (mFile == nullptr) {
+            std::fprintf(stderr, "Cannot write %s\n", path.c_str());
+            return false;
+        }
+        // Центры цветоразности посередине квадрата 2x2 (как в JPEG)
+        if (mFormat == CAPTURE_Y4M) {
+            std::fprintf(mFile, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, fps);
+        }
+    }
+
+    const std::size_t frameBytes = static_cast<std::size_t>(width) * height * 4;
+    for (Slot& slot : mSlots) {
+        slot.state.store(SLOT_FREE);
+        slot.fence  = nullptr;
+        slot.pixels = nullptr;
+        if (mAsync) {
+            gl.GenBuffers(1, &slot.pbo);
+            gl.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            gl.BufferData(GL_PIXEL_PACK_BUFFER, static_cast<std::ptrdiff_t>(frameBytes),
+                          nullptr, GL_STREAM_READ);
+        } else {
+            slot.cpu.resize(frameBytes);
+        }
+    }
+    if (mAsync) gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    mNext  = 0;
+    mFrame = 0;
+    mReading.clear();
+    mStats = CaptureStats();
+    mWritten.store(0);
+    mFailed.store(false);
+    mStop.store(false);
+    mWriter = std::thread(&FrameRecorder::writerLoop, this);
+    mActive = true;
+
+    std::printf("Recording %dx%d to %s (%s readback)\n", width, height, path.c_str(),
+                mAsync ? "asynchronous PBO" : "synchronous");
+    return true;
+}
+
+void FrameRecorder::captureFrame(int width, int height) {
+    if (!mActive) return;
+    PROFILE_SCOPE("captureFrame");
+
+    if (mFailed.load()) {
+        stop();
+        return;
+    }
+    if (width != mWidth || height != mHeight) {
+        std::fprintf(stderr, "Framebuffer resized to %dx%d; recording stopped\n", width, height);
+        stop();
+        return;
+    }
+
+    recycle();
+
+    // Поток записи отстаёт на всё кольцо — кадр пропускается, отрисовка не ждёт
+    Slot& slot = mSlots[mNext];
+    if (slot.state.load(std::memory_order_acquire) != SLOT_FREE) {
+        ++mStats.dropped;
+        profilerCounter("captureDropped", static_cast<double>(mStats.dropped));
+        collect(false);
+        return;
+    }
+
+    slot.frame = mFrame++;
+    ++mStats.captured;
+    if (mAsync) {
+        // Копирование идёт на GPU; glReadPixels возвращается сразу
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glReadPixels(0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        slot.fence = gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        slot.state.store(SLOT_READING, std::memory_order_relaxed);
+        mReading.push_back(mNext);
+    } else {
+        glReadPixels(0, 0, mWidth, mHeight, GL_RGBA, GL_UNSIGNED_BYTE, slot.cpu.data());
+        slot.pixels = slot.cpu.data();
+        submit(mNext);
+    }
+    mNext = (mNext + 1) % CAPTURE_RING_SLOTS;
+
+    collect(false);
+}
+
+// Отобразить буферы, чьё чтение закончилось. Без wait берутся только кадры
+// старше CAPTURE_READBACK_LAG и только с уже сработавшим барьером
+void FrameRecorder::collect(bool wait) {
+    std::size_t done = 0;
+    for (; done < mReading.size(); ++done) {
+        Slot& slot = mSlots[mReading[done]];
+        if (!wait) {
+            if (slot.frame + CAPTURE_READBACK_LAG > mFrame) break;
+            GLenum status = gl.ClientWaitSync(slot.fence, 0, 0);
+            if (status == GL_TIMEOUT_EXPIRED) break;
+        } else {
+            gl.ClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, CAPTURE_FENCE_TIMEOUT_NS);
+        }
+        gl.DeleteSync(slot.fence);
+        slot.fence = nullptr;
+
+        const std::size_t frameBytes = static_cast<std::size_t>(mWidth) * mHeight * 4;
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        slot.pixels = static_cast<const std::uint8_t*>(
+            gl.MapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<std::ptrdiff_t>(frameBytes),
+                              GL_MAP_READ_BIT));
+        gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (slot.pixels == nullptr) {
+            // Отобразить не удалось — буфер просто возвращается в кольцо
+            ++mStats.dropped;
+            slot.state.store(SLOT_FREE, std::memory_order_relaxed);
+            continue;
+        }
+        submit(mReading[done]);
+    }
+    mReading.erase(mReading.begin(), mReading.begin() + static_cast<std::ptrdiff_t>(done));
+}
+
+// Передать буфер потоку записи (в очереди не больше буферов, чем в кольце)
+void FrameRecorder::submit(int slot) {
+    mSlots[slot].state.store(SLOT_WRITING, std::memory_order_release);
+    mQueue.tryPush(slot);
+    mWake.notify_one();
+}
+
+// Вернуть в кольцо записанные буферы (glUnmapBuffer — только из потока отрисовки)
+void FrameRecorder::recycle() {
+    for (Slot& slot : mSlots) {
+        if (slot.state.load(std::memory_order_acquire) != SLOT_WRITTEN) continue;
+        if (mAsync) {
+            gl.BindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            gl.UnmapBuffer(GL_PIXEL_PACK_BUFFER);
+            gl.BindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        }
+        slot.pixels = nullptr;
+        slot.state.store(SLOT_FREE, std::memory_order_relaxed);
+    }
+}
+
+void FrameRecorder::stop() {
+    if (!mActive) return;
+    mActive = false;
+
+    // Все кадры в полёте дочитываются и дописываются
+    if (mAsync) collect(true);
+    mStop.store(true);
+    mWake.notify_all();
+    if (mWriter.joinable()) mWriter.join();
+    recycle();
+    release();
+
+    mStats.written = mWritten.load();
+    std::printf("Recorded %llu frames to %s (%llu dropped)\n",
+                mStats.written, mPath.c_str(), mStats.dropped);
+}
+
+// Освободить буферы и закрыть файл
+void FrameRecorder::release() {
+    for (Slot& slot : mSlots) {
+        if (slot.fence != nullptr) {
+            gl.DeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        if (slot.pbo != 0) {
+            gl.DeleteBuffers(1, &slot.pbo);
+            slot.pbo = 0;
+        }
+        std::vector<std::uint8_t>().swap(slot.cpu);
+        slot.state.store(SLOT_FREE);
+    }
+    mReading.clear();
+    if (mFile != nullptr) {
+        std::fclose(mFile);
+        mFile = nullptr;
+    }
+}
+
+// ═══════════════════════════════════════
+// Поток записи
+// ═══════════════════════════════════════
+
+void FrameRecorder::writerLoop() {
+    unsigned long long index = 0;
+    for (;;) {
+        int slot;
+        if (!mQueue.tryPop(slot)) {
+            // Очередь пуста и новых кадров не будет
+            if (mStop.load()) break;
+            std::unique_lock<std::mutex> lock(mWakeMutex);
+            mWake.wait_for(lock, CAPTURE_IDLE_WAIT,
+                           [this] { return mStop.load() || !mQueue.empty(); });
+            continue;
+        }
+
+        Slot& s = mSlots[slot];
+        if (!mFailed.load(std::memory_order_relaxed)) {
+            if (writeFrame(s, index)) {
+                ++index;
+                mWritten.store(index, std::memory_order_relaxed);
+            } else {
+                std::fprintf(stderr, "Cannot write frame %llu to %s; recording stopped\n",
+                             s.frame, mPath.c_str());
+                mFailed.store(true);
+            }
+        }
+        s.state.store(SLOT_WRITTEN, std::memory_order_release);
+    }
+}
+
+// Записать кадр (строки в буфере идут снизу вверх, как у glReadPixels)
+bool FrameRecorder::writeFrame(const Slot& slot, unsigned long long index) {
+    const std::uint8_t* rgba = slot.pixels;
+    const int w = mWidth;
+    const int h = mHeight;
+    const std::size_t stride = static_cast<std::size_t>(w) * 4;
+    auto row = [&](int y) { return rgba + static_cast<std::size_t>(h - 1 - y) * stride; };
+
+    if (mFormat == CAPTURE_PPM_SEQUENCE) {
+        char number[32];
+        std::snprintf(number, sizeof(number), "%0*llu", mDigits, index);
+        const std::string name = mPrefix + number + mSuffix;
+        return writePPM(name.c_str(), rgba, w, h, true);
+    }
+
+    if (mFormat == CAPTURE_RAW) {
+        mRow.resize(static_cast<std::size_t>(w) * 3);
+        for (int y = 0; y < h; ++y) {
+            const std::uint8_t* src = row(y);
+            for (int x = 0; x < w; ++x) {
+                mRow[x * 3 + 0] = src[x * 4 + 0];
+                mRow[x * 3 + 1] = src[x * 4 + 1];
+                mRow[x * 3 + 2] = src[x * 4 + 2];
+            }
+            std::fwrite(mRow.data(), 1, mRow.size(), mFile);
+        }
+        return std::ferror(mFile) == 0;
+    }
+
+    // Y4M: плоскость Y, затем U и V с половинным разрешением (нечётный край —
+    // повтором последней строки и столбца)
+    const int cw = (w + 1) / 2;
+    const int ch = (h + 1) / 2;
+    const std::size_t lumaSize   = static_cast<std::size_t>(w) * h;
+    const std::size_t chromaSize = static_cast<std::size_t>(cw) * ch;
+    mPlanes.resize(lumaSize + 2 * chromaSize);
+    std::uint8_t* planeY = mPlanes.data();
+    std::uint8_t* planeU = planeY + lumaSize;
+    std::uint8_t* planeV = planeU + chromaSize;
+
+    for (int y = 0; y < h; ++y) {
+        const std::uint8_t* src = row(y);
+        std::uint8_t* dst = planeY + static_cast<std::size_t>(y) * w;
+        for (int x = 0; x < w; ++x) {
+            dst[x] = lumaBT601(src[x * 4 + 0], src[x * 4 + 1], src[x * 4 + 2]);
+        }
+    }
+    for (int cy = 0; cy < ch; ++cy) {
+        const std::uint8_t* r0 = row(2 * cy);
+        const std::uint8_t* r1 = row(2 * cy + 1 < h ? 2 * cy + 1 : 2 * cy);
+        for (int cx = 0; cx < cw; ++cx) {
+            int x0 = 2 * cx * 4;
+            int x1 = (2 * cx + 1 < w ? 2 * cx + 1 : 2 * cx) * 4;
+            int sum[3];
+            for (int c = 0; c < 3; ++c) {
+                sum[c] = (r0[x0 + c] + r0[x1 + c] + r1[x0 + c] + r1[x1 + c] + 2) >> 2;
+            }
+            std::size_t i = static_cast<std::size_t>(cy) * cw + cx;
+            planeU[i] = chromaU(sum[0], sum[1], sum[2]);
+            planeV[i] = chromaV(sum[0], sum[1], sum[2]);
+        }
+    }
+
+    std::fputs("FRAME\n", mFile);
+    std::fwrite(mPlanes.data(), 1, mPlanes.size(), mFile);
+    return std::ferror(mFile) == 0;
+}
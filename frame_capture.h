@@ -0,0 +1,123 @@
+// ═══════════════════════════════════════
+// Запись кадров в видео без остановки отрисовки
+// glReadPixels пишет кадр в буфер пикселей (PBO) из кольца и ставит барьер;
+// кадр N отображается в память только через два кадра, когда GPU давно
+// закончил копирование, и отдаётся потоку записи без копии на стороне
+// отрисовки. Если поток записи не успевает, кадр пропускается, а не ждёт.
+// Без PBO и барьеров (OpenGL до 3.2) кадр читается синхронно
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "gl_ext.h"
+#include "lockfree_queue.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Буферов в кольце: два кадра в полёте на GPU, остальные — запас потоку записи
+static const int CAPTURE_RING_SLOTS = 6;
+
+// Через сколько кадров после glReadPixels буфер отображается в память
+static const unsigned long long CAPTURE_READBACK_LAG = 2;
+
+// Формат записи по имени файла
+enum CaptureFormat {
+    CAPTURE_Y4M,          // .y4m: YUV 4:2:0 (BT.601), открывается ffmpeg/mpv
+    CAPTURE_RAW,          // сырые кадры RGB24 подряд, строки сверху вниз
+    CAPTURE_PPM_SEQUENCE, // шаблон с %d или %0Nd (shot_%05d.ppm): по файлу на кадр
+};
+
+// .y4m — Y4M, имя с '%' — нумерованные PPM, иначе — сырые RGB24
+CaptureFormat captureFormatForPath(const std::string& path);
+
+// Итоги записи
+struct CaptureStats {
+    unsigned long long captured = 0; // поставлено в очередь чтения
+    unsigned long long written  = 0; // записано на диск
+    unsigned long long dropped  = 0; // пропущено: кольцо занято потоком записи
+};
+
+class FrameRecorder {
+public:
+    FrameRecorder() = default;
+    ~FrameRecorder();
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    // Начать запись кадров width x height; fps попадает в заголовок Y4M.
+    // Нужен текущий контекст OpenGL
+    bool start(const std::string& path, int width, int height, int fps);
+
+    // Захватить задний буфер: после отрисовки кадра, до glfwSwapBuffers.
+    // Размер кадрового буфера сменился — запись останавливается
+    void captureFrame(int width, int height);
+
+    // Дочитать кадры из кольца, дождаться записи и закрыть файл
+    // (контекст OpenGL ещё жив)
+    void stop();
+
+    bool active() const { return mActive; }
+    const CaptureStats& stats() const { return mStats; }
+
+private:
+    // Буфер кольца переходит FREE -> READING (копирует GPU) -> WRITING
+    // (пикселями владеет поток записи) -> WRITTEN -> FREE (после glUnmapBuffer)
+    enum SlotState { SLOT_FREE, SLOT_READING, SLOT_WRITING, SLOT_WRITTEN };
+
+    struct Slot {
+        GLuint pbo = 0;
+        LabGLsync fence = nullptr;
+        std::vector<std::uint8_t> cpu;        // кадр при синхронном чтении
+        const std::uint8_t* pixels = nullptr; // отображённый PBO или cpu.data()
+        unsigned long long frame = 0;
+        std::atomic<int> state{SLOT_FREE};
+    };
+
+    void collect(bool wait);
+    void submit(int slot);
+    void recycle();
+    void writerLoop();
+    bool writeFrame(const Slot& slot, unsigned long long index);
+    void release();
+
+    bool mActive = false;
+    bool mAsync  = false;
+    CaptureFormat mFormat = CAPTURE_RAW;
+    std::string mPath;
+    std::FILE* mFile = nullptr;
+
+    // Шаблон нумерованных PPM: имя = mPrefix + номер (mDigits цифр с нулями) + mSuffix
+    std::string mPrefix;
+    std::string mSuffix;
+    int mDigits = 0;
+    int mWidth  = 0;
+    int mHeight = 0;
+
+    Slot mSlots[CAPTURE_RING_SLOTS];
+    int  mNext = 0;                   // буфер для следующего кадра
+    std::vector<int> mReading;        // буферы в порядке чтения (READING)
+    unsigned long long mFrame = 0;    // номер следующего захватываемого кадра
+
+    // Поток записи: номера буферов в порядке кадров
+    LockFreeQueue<int> mQueue{CAPTURE_RING_SLOTS};
+    std::thread mWriter;
+    std::mutex mWakeMutex;
+    std::condition_variable mWake;
+    std::atomic<bool> mStop{false};
+    std::atomic<bool> mFailed{false};
+    std::atomic<unsigned long long> mWritten{0};
+
+    // Рабочие строки потока записи
+    std::vector<std::uint8_t> mRow;
+    std::vector<std::uint8_t> mPlanes;
+
+    CaptureStats mStats;
+};
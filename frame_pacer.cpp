@@ -0,0 +1,60 @@
+// ═══════════════════════════════════════
+// Темп кадров
+// ═══════════════════════════════════════
+
+#include "frame_pacer.h"
+
+#include <GLFW/glfw3.h>
+
+#include <thread>
+
+// Последний отрезок ожидания досыпаем уступками потока: точность sleep_for
+// на многих системах — около миллисекунды
+static const std::chrono::microseconds SPIN_MARGIN(1500);
+
+void applyVsync(VsyncMode mode) {
+    switch (mode) {
+        case VSYNC_OFF:
+            glfwSwapInterval(0);
+            break;
+        case VSYNC_ON:
+            glfwSwapInterval(1);
+            break;
+        case VSYNC_ADAPTIVE:
+            if (glfwExtensionSupported("WGL_EXT_swap_control_tear") ||
+                glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+                glfwSwapInterval(-1);
+            } else {
+                glfwSwapInterval(1);
+            }
+            break;
+    }
+}
+
+FrameLimiter::FrameLimiter(double fps)
+    : mPeriod(Clock::duration::zero()), mNext(Clock::now()), mEnabled(fps > 0.0) {
+    if (mEnabled) {
+        mPeriod = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / fps));
+    }
+}
+
+void FrameLimiter::wait() {
+    if (!mEnabled) return;
+
+    Clock::time_point now = Clock::now();
+    mNext += mPeriod;
+
+    // Сильно опоздали (например, окно было свёрнуто) — не догоняем пачкой кадров
+    if (mNext < now) {
+        mNext = now;
+        return;
+    }
+
+    if (mNext - now > SPIN_MARGIN) {
+        std::this_thread::sleep_for(mNext - now - SPIN_MARGIN);
+    }
+    while (Clock::now() < mNext) {
+        std::this_thread::yield();
+    }
+}
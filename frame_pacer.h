@@ -0,0 +1,34 @@
+// ═══════════════════════════════════════
+// Темп кадров: вертикальная синхронизация и ограничитель частоты
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <chrono>
+
+// Политика вертикальной синхронизации
+enum VsyncMode {
+    VSYNC_OFF      = 0, // swap interval 0
+    VSYNC_ON       = 1, // swap interval 1
+    VSYNC_ADAPTIVE = 2  // swap interval -1 (с разрывом при опоздании), иначе как VSYNC_ON
+};
+
+// Применить политику к текущему контексту
+void applyVsync(VsyncMode mode);
+
+// Ограничитель частоты кадров для непрерывного режима
+class FrameLimiter {
+public:
+    // fps <= 0 — без ограничения
+    explicit FrameLimiter(double fps = 0.0);
+
+    // Дождаться момента начала следующего кадра
+    void wait();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::duration   mPeriod;
+    Clock::time_point mNext;
+    bool              mEnabled;
+};
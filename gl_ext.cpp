@@ -0,0 +1,154 @@
+// ═══════════════════════════════════════
+// Загрузчик функций OpenGL новее 1.1
+// ═══════════════════════════════════════
+
+#include "gl_ext.h"
+
+#include <cstdio>
+
+GLFunctions gl;
+
+// Получить адрес функции и привести к типу указателя поля таблицы
+template <typename T>
+static bool loadProc(T& fn, const char* name) {
+    fn = reinterpret_cast<T>(glfwGetProcAddress(name));
+    return fn != nullptr;
+}
+
+// Попробовать основное имя функции, затем имя из расширения ARB
+template <typename T>
+static bool loadProc(T& fn, const char* name, const char* arbName) {
+    return loadProc(fn, name) || loadProc(fn, arbName);
+}
+
+bool glVersionAtLeast(int major, int minor) {
+    if (gl.versionMajor != major) return gl.versionMajor > major;
+    return gl.versionMinor >= minor;
+}
+
+void loadGLFunctions() {
+    gl = GLFunctions();
+
+    // Строка версии начинается с "major.minor". Проверка версии обязательна:
+    // glXGetProcAddress возвращает ненулевой адрес для любого имени
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    if (version == nullptr ||
+        std::sscanf(version, "%d.%d", &gl.versionMajor, &gl.versionMinor) != 2) {
+        gl.versionMajor = 1;
+        gl.versionMinor = 1;
+    }
+
+    bool ok = glVersionAtLeast(1, 5);
+    ok &= loadProc(gl.GenBuffers,    "glGenBuffers");
+    ok &= loadProc(gl.DeleteBuffers, "glDeleteBuffers");
+    ok &= loadProc(gl.BindBuffer,    "glBindBuffer");
+    ok &= loadProc(gl.BufferData,    "glBufferData");
+    ok &= loadProc(gl.BufferSubData, "glBufferSubData");
+    gl.hasVBO = ok;
+
+    ok = glVersionAtLeast(3, 3) || glfwExtensionSupported("GL_ARB_timer_query");
+    ok &= loadProc(gl.GenQueries,          "glGenQueries");
+    ok &= loadProc(gl.DeleteQueries,       "glDeleteQueries");
+    ok &= loadProc(gl.BeginQuery,          "glBeginQuery");
+    ok &= loadProc(gl.EndQuery,            "glEndQuery");
+    ok &= loadProc(gl.QueryCounter,        "glQueryCounter");
+    ok &= loadProc(gl.GetQueryObjectiv,    "glGetQueryObjectiv");
+    ok &= loadProc(gl.GetQueryObjectui64v, "glGetQueryObjectui64v");
+    ok &= loadProc(gl.GetInteger64v,       "glGetInteger64v");
+    gl.hasTimerQuery = ok;
+
+    ok = glVersionAtLeast(2, 0);
+    ok &= loadProc(gl.CreateShader,             "glCreateShader");
+    ok &= loadProc(gl.DeleteShader,             "glDeleteShader");
+    ok &= loadProc(gl.ShaderSource,             "glShaderSource");
+    ok &= loadProc(gl.CompileShader,            "glCompileShader");
+    ok &= loadProc(gl.GetShaderiv,              "glGetShaderiv");
+    ok &= loadProc(gl.GetShaderInfoLog,         "glGetShaderInfoLog");
+    ok &= loadProc(gl.CreateProgram,            "glCreateProgram");
+    ok &= loadProc(gl.DeleteProgram,            "glDeleteProgram");
+    ok &= loadProc(gl.AttachShader,             "glAttachShader");
+    ok &= loadProc(gl.BindAttribLocation,       "glBindAttribLocation");
+    ok &= loadProc(gl.LinkProgram,              "glLinkProgram");
+    ok &= loadProc(gl.GetProgramiv,             "glGetProgramiv");
+    ok &= loadProc(gl.GetProgramInfoLog,        "glGetProgramInfoLog");
+    ok &= loadProc(gl.UseProgram,               "glUseProgram");
+    ok &= loadProc(gl.GetUniformLocation,       "glGetUniformLocation");
+    ok &= loadProc(gl.Uniform1i,                "glUniform1i");
+    ok &= loadProc(gl.Uniform1f,                "glUniform1f");
+    ok &= loadProc(gl.Uniform2f,                "glUniform2f");
+    ok &= loadProc(gl.Uniform4f,                "glUniform4f");
+    ok &= loadProc(gl.UniformMatrix4fv,         "glUniformMatrix4fv");
+    ok &= loadProc(gl.EnableVertexAttribArray,  "glEnableVertexAttribArray");
+    ok &= loadProc(gl.DisableVertexAttribArray, "glDisableVertexAttribArray");
+    ok &= loadProc(gl.VertexAttribPointer,      "glVertexAttribPointer");
+    gl.hasShaders = ok;
+
+    ok = gl.hasVBO && gl.hasShaders &&
+         (glVersionAtLeast(3, 3) ||
+          (glfwExtensionSupported("GL_ARB_instanced_arrays") &&
+           glfwExtensionSupported("GL_ARB_draw_instanced")));
+    ok &= loadProc(gl.VertexAttribDivisor,   "glVertexAttribDivisor",   "glVertexAttribDivisorARB");
+    ok &= loadProc(gl.DrawArraysInstanced,   "glDrawArraysInstanced",   "glDrawArraysInstancedARB");
+    ok &= loadProc(gl.DrawElementsInstanced, "glDrawElementsInstanced", "glDrawElementsInstancedARB");
+    gl.hasInstancing = ok;
+
+    ok = gl.hasShaders && glVersionAtLeast(3, 0);
+    ok &= loadProc(gl.GenFramebuffers,         "glGenFramebuffers");
+    ok &= loadProc(gl.DeleteFramebuffers,      "glDeleteFramebuffers");
+    ok &= loadProc(gl.BindFramebuffer,         "glBindFramebuffer");
+    ok &= loadProc(gl.FramebufferTexture2D,    "glFramebufferTexture2D");
+    ok &= loadProc(gl.GenRenderbuffers,        "glGenRenderbuffers");
+    ok &= loadProc(gl.DeleteRenderbuffers,     "glDeleteRenderbuffers");
+    ok &= loadProc(gl.BindRenderbuffer,        "glBindRenderbuffer");
+    ok &= loadProc(gl.RenderbufferStorage,     "glRenderbufferStorage");
+    ok &= loadProc(gl.FramebufferRenderbuffer, "glFramebufferRenderbuffer");
+    ok &= loadProc(gl.CheckFramebufferStatus,  "glCheckFramebufferStatus");
+    ok &= loadProc(gl.DrawBuffers,             "glDrawBuffers");
+    ok &= loadProc(gl.ClearBufferfv,           "glClearBufferfv");
+    ok &= loadProc(gl.BlendFuncSeparate,       "glBlendFuncSeparate");
+    ok &= loadProc(gl.ActiveTexture,           "glActiveTexture");
+    ok &= loadProc(gl.GenerateMipmap,          "glGenerateMipmap");
+    ok &= loadProc(gl.BlitFramebuffer,         "glBlitFramebuffer");
+    gl.hasFramebuffer = ok;
+
+    ok = gl.hasShaders && gl.hasVBO && glVersionAtLeast(3, 1);
+    ok &= loadProc(gl.GenVertexArrays,      "glGenVertexArrays");
+    ok &= loadProc(gl.DeleteVertexArrays,   "glDeleteVertexArrays");
+    ok &= loadProc(gl.BindVertexArray,      "glBindVertexArray");
+    ok &= loadProc(gl.GetUniformBlockIndex, "glGetUniformBlockIndex");
+    ok &= loadProc(gl.UniformBlockBinding,  "glUniformBlockBinding");
+    ok &= loadProc(gl.BindBufferBase,       "glBindBufferBase");
+    ok &= loadProc(gl.BindBufferRange,      "glBindBufferRange");
+    gl.hasUniformBuffers = ok;
+
+    ok = gl.hasVBO &&
+         (glVersionAtLeast(3, 2) ||
+          (glfwExtensionSupported("GL_ARB_sync") &&
+           glfwExtensionSupported("GL_ARB_map_buffer_range")));
+    ok &= loadProc(gl.MapBufferRange, "glMapBufferRange");
+    ok &= loadProc(gl.UnmapBuffer,    "glUnmapBuffer", "glUnmapBufferARB");
+    ok &= loadProc(gl.FenceSync,      "glFenceSync");
+    ok &= loadProc(gl.ClientWaitSync, "glClientWaitSync");
+    ok &= loadProc(gl.DeleteSync,     "glDeleteSync");
+    gl.hasAsyncReadback = ok;
+
+    ok = gl.hasAsyncReadback &&
+         (glVersionAtLeast(4, 4) || glfwExtensionSupported("GL_ARB_buffer_storage"));
+    ok &= loadProc(gl.BufferStorage, "glBufferStorage");
+    gl.hasBufferStorage = ok;
+
+    // baseInstance в команде учитывается только с ARB_base_instance (OpenGL 4.2)
+    ok = gl.hasInstancing &&
+         (glVersionAtLeast(4, 3) ||
+          (glfwExtensionSupported("GL_ARB_multi_draw_indirect") &&
+           glfwExtensionSupported("GL_ARB_base_instance")));
+    ok &= loadProc(gl.MultiDrawElementsIndirect, "glMultiDrawElementsIndirect");
+    gl.hasMultiDrawIndirect = ok;
+
+    // Профиль появился в OpenGL 3.2; у более старых контекстов он всегда совместимый
+    if (glVersionAtLeast(3, 2)) {
+        GLint mask = 0;
+        glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &mask);
+        gl.coreProfile = (mask & GL_CONTEXT_CORE_PROFILE_BIT) != 0;
+    }
+}
@@ -0,0 +1,322 @@
+// ═══════════════════════════════════════
+// Загрузчик функций OpenGL новее 1.1
+// Указатели получаем через glfwGetProcAddress, чтобы не тянуть
+// сторонние загрузчики (GLEW/glad) и не зависеть от glext.h
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+
+// Соглашение о вызовах функций OpenGL (на Windows — stdcall)
+#if defined(_WIN32)
+#define LAB_APIENTRY __stdcall
+#else
+#define LAB_APIENTRY
+#endif
+
+// ═══════════════════════════════════════
+// Константы, отсутствующие в gl.h версии 1.1
+// ═══════════════════════════════════════
+
+#ifndef GL_ARRAY_BUFFER
+#define GL_ARRAY_BUFFER 0x8892
+#endif
+#ifndef GL_ELEMENT_ARRAY_BUFFER
+#define GL_ELEMENT_ARRAY_BUFFER 0x8893
+#endif
+#ifndef GL_STREAM_DRAW
+#define GL_STREAM_DRAW 0x88E0
+#endif
+#ifndef GL_STATIC_DRAW
+#define GL_STATIC_DRAW 0x88E4
+#endif
+#ifndef GL_DYNAMIC_DRAW
+#define GL_DYNAMIC_DRAW 0x88E8
+#endif
+#ifndef GL_QUERY_RESULT
+#define GL_QUERY_RESULT 0x8866
+#endif
+#ifndef GL_QUERY_RESULT_AVAILABLE
+#define GL_QUERY_RESULT_AVAILABLE 0x8867
+#endif
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+#ifndef GL_TIMESTAMP
+#define GL_TIMESTAMP 0x8E28
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+#ifndef GL_DEPTH_COMPONENT24
+#define GL_DEPTH_COMPONENT24 0x81A6
+#endif
+#ifndef GL_R16F
+#define GL_R16F 0x822D
+#endif
+#ifndef GL_TEXTURE0
+#define GL_TEXTURE0 0x84C0
+#endif
+#ifndef GL_TEXTURE1
+#define GL_TEXTURE1 0x84C1
+#endif
+#ifndef GL_RGBA16F
+#define GL_RGBA16F 0x881A
+#endif
+#ifndef GL_HALF_FLOAT
+#define GL_HALF_FLOAT 0x140B
+#endif
+#ifndef GL_FRAMEBUFFER_BINDING
+#define GL_FRAMEBUFFER_BINDING 0x8CA6
+#endif
+#ifndef GL_READ_FRAMEBUFFER
+#define GL_READ_FRAMEBUFFER 0x8CA8
+#endif
+#ifndef GL_DRAW_FRAMEBUFFER
+#define GL_DRAW_FRAMEBUFFER 0x8CA9
+#endif
+#ifndef GL_FRAMEBUFFER_COMPLETE
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#endif
+#ifndef GL_COLOR_ATTACHMENT0
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+#ifndef GL_COLOR_ATTACHMENT1
+#define GL_COLOR_ATTACHMENT1 0x8CE1
+#endif
+#ifndef GL_DEPTH_ATTACHMENT
+#define GL_DEPTH_ATTACHMENT 0x8D00
+#endif
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#endif
+#ifndef GL_RENDERBUFFER
+#define GL_RENDERBUFFER 0x8D41
+#endif
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#endif
+#ifndef GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+#define GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 0x8A34
+#endif
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+#ifndef GL_CONTEXT_PROFILE_MASK
+#define GL_CONTEXT_PROFILE_MASK 0x9126
+#endif
+#ifndef GL_CONTEXT_CORE_PROFILE_BIT
+#define GL_CONTEXT_CORE_PROFILE_BIT 0x00000001
+#endif
+#ifndef GL_FRAGMENT_SHADER
+#define GL_FRAGMENT_SHADER 0x8B30
+#endif
+#ifndef GL_VERTEX_SHADER
+#define GL_VERTEX_SHADER 0x8B31
+#endif
+#ifndef GL_COMPILE_STATUS
+#define GL_COMPILE_STATUS 0x8B81
+#endif
+#ifndef GL_LINK_STATUS
+#define GL_LINK_STATUS 0x8B82
+#endif
+#ifndef GL_INFO_LOG_LENGTH
+#define GL_INFO_LOG_LENGTH 0x8B84
+#endif
+#ifndef GL_PIXEL_PACK_BUFFER
+#define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif
+#ifndef GL_STREAM_READ
+#define GL_STREAM_READ 0x88E1
+#endif
+#ifndef GL_MAP_READ_BIT
+#define GL_MAP_READ_BIT 0x0001
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif
+#ifndef GL_ALREADY_SIGNALED
+#define GL_ALREADY_SIGNALED 0x911A
+#endif
+#ifndef GL_TIMEOUT_EXPIRED
+#define GL_TIMEOUT_EXPIRED 0x911B
+#endif
+#ifndef GL_CONDITION_SATISFIED
+#define GL_CONDITION_SATISFIED 0x911C
+#endif
+#ifndef GL_WAIT_FAILED
+#define GL_WAIT_FAILED 0x911D
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#define GL_MAP_WRITE_BIT 0x0002
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#define GL_MAP_PERSISTENT_BIT 0x0040
+#endif
+#ifndef GL_MAP_COHERENT_BIT
+#define GL_MAP_COHERENT_BIT 0x0080
+#endif
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+// Объект синхронизации (GLsync из glext.h)
+typedef struct __GLsync* LabGLsync;
+
+// ═══════════════════════════════════════
+// Таблица загруженных функций
+// ═══════════════════════════════════════
+
+struct GLFunctions {
+    // Буферы вершин (OpenGL 1.5 / ARB_vertex_buffer_object)
+    void (LAB_APIENTRY* GenBuffers)(GLsizei n, GLuint* buffers) = nullptr;
+    void (LAB_APIENTRY* DeleteBuffers)(GLsizei n, const GLuint* buffers) = nullptr;
+    void (LAB_APIENTRY* BindBuffer)(GLenum target, GLuint buffer) = nullptr;
+    void (LAB_APIENTRY* BufferData)(GLenum target, std::ptrdiff_t size,
+                                    const void* data, GLenum usage) = nullptr;
+    void (LAB_APIENTRY* BufferSubData)(GLenum target, std::ptrdiff_t offset,
+                                       std::ptrdiff_t size, const void* data) = nullptr;
+
+    // Запросы таймера GPU (OpenGL 3.3 / ARB_timer_query)
+    void (LAB_APIENTRY* GenQueries)(GLsizei n, GLuint* ids) = nullptr;
+    void (LAB_APIENTRY* DeleteQueries)(GLsizei n, const GLuint* ids) = nullptr;
+    void (LAB_APIENTRY* BeginQuery)(GLenum target, GLuint id) = nullptr;
+    void (LAB_APIENTRY* EndQuery)(GLenum target) = nullptr;
+    void (LAB_APIENTRY* QueryCounter)(GLuint id, GLenum target) = nullptr;
+    void (LAB_APIENTRY* GetQueryObjectiv)(GLuint id, GLenum pname, GLint* params) = nullptr;
+    void (LAB_APIENTRY* GetQueryObjectui64v)(GLuint id, GLenum pname,
+                                             unsigned long long* params) = nullptr;
+    void (LAB_APIENTRY* GetInteger64v)(GLenum pname, long long* data) = nullptr;
+
+    // Шейдеры GLSL (OpenGL 2.0)
+    GLuint (LAB_APIENTRY* CreateShader)(GLenum type) = nullptr;
+    void (LAB_APIENTRY* DeleteShader)(GLuint shader) = nullptr;
+    void (LAB_APIENTRY* ShaderSource)(GLuint shader, GLsizei count,
+                                      const char* const* strings, const GLint* lengths) = nullptr;
+    void (LAB_APIENTRY* CompileShader)(GLuint shader) = nullptr;
+    void (LAB_APIENTRY* GetShaderiv)(GLuint shader, GLenum pname, GLint* params) = nullptr;
+    void (LAB_APIENTRY* GetShaderInfoLog)(GLuint shader, GLsizei bufSize,
+                                          GLsizei* length, char* log) = nullptr;
+    GLuint (LAB_APIENTRY* CreateProgram)() = nullptr;
+    void (LAB_APIENTRY* DeleteProgram)(GLuint program) = nullptr;
+    void (LAB_APIENTRY* AttachShader)(GLuint program, GLuint shader) = nullptr;
+    void (LAB_APIENTRY* BindAttribLocation)(GLuint program, GLuint index, const char* name) = nullptr;
+    void (LAB_APIENTRY* LinkProgram)(GLuint program) = nullptr;
+    void (LAB_APIENTRY* GetProgramiv)(GLuint program, GLenum pname, GLint* params) = nullptr;
+    void (LAB_APIENTRY* GetProgramInfoLog)(GLuint program, GLsizei bufSize,
+                                           GLsizei* length, char* log) = nullptr;
+    void (LAB_APIENTRY* UseProgram)(GLuint program) = nullptr;
+    GLint (LAB_APIENTRY* GetUniformLocation)(GLuint program, const char* name) = nullptr;
+    void (LAB_APIENTRY* Uniform1i)(GLint location, GLint v0) = nullptr;
+    void (LAB_APIENTRY* Uniform1f)(GLint location, GLfloat v0) = nullptr;
+    void (LAB_APIENTRY* Uniform2f)(GLint location, GLfloat v0, GLfloat v1) = nullptr;
+    void (LAB_APIENTRY* Uniform4f)(GLint location, GLfloat v0, GLfloat v1,
+                                   GLfloat v2, GLfloat v3) = nullptr;
+    void (LAB_APIENTRY* UniformMatrix4fv)(GLint location, GLsizei count,
+                                          GLboolean transpose, const GLfloat* value) = nullptr;
+    void (LAB_APIENTRY* EnableVertexAttribArray)(GLuint index) = nullptr;
+    void (LAB_APIENTRY* DisableVertexAttribArray)(GLuint index) = nullptr;
+    void (LAB_APIENTRY* VertexAttribPointer)(GLuint index, GLint size, GLenum type,
+                                             GLboolean normalized, GLsizei stride,
+                                             const void* pointer) = nullptr;
+
+    // Инстансинг (OpenGL 3.3 или ARB_instanced_arrays + ARB_draw_instanced)
+    void (LAB_APIENTRY* VertexAttribDivisor)(GLuint index, GLuint divisor) = nullptr;
+    void (LAB_APIENTRY* DrawArraysInstanced)(GLenum mode, GLint first, GLsizei count,
+                                             GLsizei instanceCount) = nullptr;
+    void (LAB_APIENTRY* DrawElementsInstanced)(GLenum mode, GLsizei count, GLenum type,
+                                               const void* indices,
+                                               GLsizei instanceCount) = nullptr;
+
+    // Версия контекста (из строки GL_VERSION)
+    int versionMajor = 1;
+    int versionMinor = 1;
+
+    // Кадровые буферы и смешивание (OpenGL 3.0 / ARB_framebuffer_object)
+    void (LAB_APIENTRY* GenFramebuffers)(GLsizei n, GLuint* ids) = nullptr;
+    void (LAB_APIENTRY* DeleteFramebuffers)(GLsizei n, const GLuint* ids) = nullptr;
+    void (LAB_APIENTRY* BindFramebuffer)(GLenum target, GLuint framebuffer) = nullptr;
+    void (LAB_APIENTRY* FramebufferTexture2D)(GLenum target, GLenum attachment, GLenum textarget,
+                                              GLuint texture, GLint level) = nullptr;
+    void (LAB_APIENTRY* GenRenderbuffers)(GLsizei n, GLuint* ids) = nullptr;
+    void (LAB_APIENTRY* DeleteRenderbuffers)(GLsizei n, const GLuint* ids) = nullptr;
+    void (LAB_APIENTRY* BindRenderbuffer)(GLenum target, GLuint renderbuffer) = nullptr;
+    void (LAB_APIENTRY* RenderbufferStorage)(GLenum target, GLenum internalformat,
+                                             GLsizei width, GLsizei height) = nullptr;
+    void (LAB_APIENTRY* FramebufferRenderbuffer)(GLenum target, GLenum attachment,
+                                                 GLenum renderbuffertarget,
+                                                 GLuint renderbuffer) = nullptr;
+    GLenum (LAB_APIENTRY* CheckFramebufferStatus)(GLenum target) = nullptr;
+    void (LAB_APIENTRY* DrawBuffers)(GLsizei n, const GLenum* bufs) = nullptr;
+    void (LAB_APIENTRY* ClearBufferfv)(GLenum buffer, GLint drawbuffer, const GLfloat* value) = nullptr;
+    void (LAB_APIENTRY* BlendFuncSeparate)(GLenum srcRGB, GLenum dstRGB,
+                                           GLenum srcAlpha, GLenum dstAlpha) = nullptr;
+    void (LAB_APIENTRY* ActiveTexture)(GLenum texture) = nullptr;
+    void (LAB_APIENTRY* GenerateMipmap)(GLenum target) = nullptr;
+    void (LAB_APIENTRY* BlitFramebuffer)(GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1,
+                                         GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1,
+                                         GLbitfield mask, GLenum filter) = nullptr;
+
+    // Объекты массивов вершин и uniform-буферы (OpenGL 3.1 / ARB_uniform_buffer_object)
+    void (LAB_APIENTRY* GenVertexArrays)(GLsizei n, GLuint* arrays) = nullptr;
+    void (LAB_APIENTRY* DeleteVertexArrays)(GLsizei n, const GLuint* arrays) = nullptr;
+    void (LAB_APIENTRY* BindVertexArray)(GLuint array) = nullptr;
+    GLuint (LAB_APIENTRY* GetUniformBlockIndex)(GLuint program, const char* name) = nullptr;
+    void (LAB_APIENTRY* UniformBlockBinding)(GLuint program, GLuint blockIndex, GLuint binding) = nullptr;
+    void (LAB_APIENTRY* BindBufferBase)(GLenum target, GLuint index, GLuint buffer) = nullptr;
+    void (LAB_APIENTRY* BindBufferRange)(GLenum target, GLuint index, GLuint buffer,
+                                         std::ptrdiff_t offset, std::ptrdiff_t size) = nullptr;
+
+    // Отображение буферов и барьеры (OpenGL 3.2 / ARB_map_buffer_range + ARB_sync)
+    void* (LAB_APIENTRY* MapBufferRange)(GLenum target, std::ptrdiff_t offset,
+                                         std::ptrdiff_t length, GLbitfield access) = nullptr;
+    GLboolean (LAB_APIENTRY* UnmapBuffer)(GLenum target) = nullptr;
+    LabGLsync (LAB_APIENTRY* FenceSync)(GLenum condition, GLbitfield flags) = nullptr;
+    GLenum (LAB_APIENTRY* ClientWaitSync)(LabGLsync sync, GLbitfield flags,
+                                          unsigned long long timeout) = nullptr;
+    void (LAB_APIENTRY* DeleteSync)(LabGLsync sync) = nullptr;
+
+    // Неизменяемое хранилище буфера с постоянным отображением (OpenGL 4.4 / ARB_buffer_storage)
+    void (LAB_APIENTRY* BufferStorage)(GLenum target, std::ptrdiff_t size, const void* data,
+                                       GLbitfield flags) = nullptr;
+
+    // Косвенное рисование пачкой команд из буфера (OpenGL 4.3 / ARB_multi_draw_indirect)
+    void (LAB_APIENTRY* MultiDrawElementsIndirect)(GLenum mode, GLenum type, const void* indirect,
+                                                   GLsizei drawCount, GLsizei stride) = nullptr;
+
+    // Флаги доступности групп функций
+    bool hasVBO        = false;
+    bool hasShaders    = false;
+    bool hasInstancing = false;
+    bool hasTimerQuery = false;
+    bool hasFramebuffer = false; // FBO, MRT и текстуры с плавающей точкой
+    bool hasUniformBuffers = false; // VAO и UBO
+    bool hasAsyncReadback = false; // чтение кадра в PBO с барьерами
+    bool hasBufferStorage = false; // постоянно отображённые буферы (и барьеры)
+    bool hasMultiDrawIndirect = false; // glMultiDrawElementsIndirect с baseInstance
+
+    // Контекст core-профиля: фиксированного конвейера, стека матриц и glBegin нет,
+    // всё рисуется шейдерами из VAO
+    bool coreProfile = false;
+};
+
+// Глобальная таблица функций (заполняется в loadGLFunctions)
+extern GLFunctions gl;
+
+// Загрузить функции для текущего контекста; вызывать после glfwMakeContextCurrent
+void loadGLFunctions();
+
+// Версия контекста не ниже major.minor
+bool glVersionAtLeast(int major, int minor);
+
+// Адрес атрибута: смещение внутри VBO (base == nullptr) или указатель в оперативную память
+inline const void* attribPointer(const void* base, std::size_t offset) {
+    if (base == nullptr) return reinterpret_cast<const void*>(offset);
+    return static_cast<const char*>(base) + offset;
+}
@@ -0,0 +1,214 @@
+// ═══════════════════════════════════════
+// Кеш состояния OpenGL
+// ═══════════════════════════════════════
+
+#include "gl_state.h"
+#include "gl_ext.h"
+#include "profiler.h"
+
+#include <cstring>
+
+// Значение флага в кеше: неизвестно (после glsInvalidate), выключен, включён
+enum CapState { CAP_UNKNOWN = -1, CAP_OFF = 0, CAP_ON = 1 };
+
+struct CapSlot {
+    GLenum cap;
+    int    state;
+};
+
+// Флаги, которые меняет отрисовка; остальные идут драйверу без кеша
+static CapSlot gCaps[] = {
+    {GL_DEPTH_TEST, CAP_UNKNOWN},
+    {GL_BLEND,      CAP_UNKNOWN},
+    {GL_LIGHTING,   CAP_UNKNOWN},
+    {GL_LIGHT0,     CAP_UNKNOWN},
+    {GL_NORMALIZE,  CAP_UNKNOWN},
+};
+static const int CAP_COUNT = sizeof(gCaps) / sizeof(gCaps[0]);
+
+// Кешируемые источники света GL_LIGHT0 .. GL_LIGHT0 + LIGHT_COUNT - 1
+static const int LIGHT_COUNT = 8;
+static const GLenum LIGHT_PARAMS[] = {GL_AMBIENT, GL_DIFFUSE, GL_SPECULAR, GL_POSITION};
+static const int LIGHT_PARAM_COUNT = sizeof(LIGHT_PARAMS) / sizeof(LIGHT_PARAMS[0]);
+
+static const GLenum MATERIAL_PARAMS[] = {GL_AMBIENT, GL_DIFFUSE, GL_SPECULAR, GL_EMISSION, GL_SHININESS};
+static const int MATERIAL_PARAM_COUNT = sizeof(MATERIAL_PARAMS) / sizeof(MATERIAL_PARAMS[0]);
+
+// Четыре числа параметра и признак, что значение известно
+struct VecSlot {
+    GLfloat value[4];
+    bool    valid;
+};
+
+static VecSlot gLights[LIGHT_COUNT][LIGHT_PARAM_COUNT];
+static VecSlot gMaterial[MATERIAL_PARAM_COUNT]; // GL_FRONT_AND_BACK
+
+static bool      gDepthMaskValid = false;
+static GLboolean gDepthMask = GL_TRUE;
+
+static bool   gBlendValid = false;
+static GLenum gBlend[4] = {GL_ONE, GL_ZERO, GL_ONE, GL_ZERO};
+
+static bool  gTwoSideValid = false;
+static GLint gTwoSide = 0;
+
+// Счётчики текущего кадра
+static unsigned int gIssued = 0;
+static unsigned int gElided = 0;
+
+// true — вызов нужно выдать драйверу; заодно считает вызовы
+static bool changed(bool differs) {
+    if (differs) {
+        ++gIssued;
+        return true;
+    }
+    ++gElided;
+    return false;
+}
+
+void glsInvalidate() {
+    for (int i = 0; i < CAP_COUNT; ++i) gCaps[i].state = CAP_UNKNOWN;
+    for (int l = 0; l < LIGHT_COUNT; ++l) {
+        for (int p = 0; p < LIGHT_PARAM_COUNT; ++p) gLights[l][p].valid = false;
+    }
+    for (int p = 0; p < MATERIAL_PARAM_COUNT; ++p) gMaterial[p].valid = false;
+    gDepthMaskValid = false;
+    gBlendValid = false;
+    gTwoSideValid = false;
+}
+
+// ═══════════════════════════════════════
+// Флаги
+// ═══════════════════════════════════════
+
+static CapSlot* findCap(GLenum cap) {
+    for (int i = 0; i < CAP_COUNT; ++i) {
+        if (gCaps[i].cap == cap) return &gCaps[i];
+    }
+    return nullptr;
+}
+
+static void setCap(GLenum cap, bool on) {
+    CapSlot* slot = findCap(cap);
+    int state = on ? CAP_ON : CAP_OFF;
+    if (slot != nullptr) {
+        if (!changed(slot->state != state)) return;
+        slot->state = state;
+    } else {
+        ++gIssued;
+    }
+    if (on) {
+        glEnable(cap);
+    } else {
+        glDisable(cap);
+    }
+}
+
+void glsEnable(GLenum cap) {
+    setCap(cap, true);
+}
+
+void glsDisable(GLenum cap) {
+    setCap(cap, false);
+}
+
+bool glsIsEnabled(GLenum cap) {
+    CapSlot* slot = findCap(cap);
+    if (slot == nullptr) return glIsEnabled(cap) == GL_TRUE;
+    if (slot->state == CAP_UNKNOWN) slot->state = glIsEnabled(cap) == GL_TRUE ? CAP_ON : CAP_OFF;
+    return slot->state == CAP_ON;
+}
+
+// ═══════════════════════════════════════
+// Глубина и смешивание
+// ═══════════════════════════════════════
+
+void glsDepthMask(GLboolean flag) {
+    if (!changed(!gDepthMaskValid || gDepthMask != flag)) return;
+    gDepthMaskValid = true;
+    gDepthMask = flag;
+    glDepthMask(flag);
+}
+
+void glsBlendFunc(GLenum src, GLenum dst) {
+    const GLenum blend[4] = {src, dst, src, dst};
+    if (!changed(!gBlendValid || std::memcmp(gBlend, blend, sizeof(blend)) != 0)) return;
+    gBlendValid = true;
+    std::memcpy(gBlend, blend, sizeof(blend));
+    glBlendFunc(src, dst);
+}
+
+void glsBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+    const GLenum blend[4] = {srcRGB, dstRGB, srcAlpha, dstAlpha};
+    if (!changed(!gBlendValid || std::memcmp(gBlend, blend, sizeof(blend)) != 0)) return;
+    gBlendValid = true;
+    std::memcpy(gBlend, blend, sizeof(blend));
+    gl.BlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+}
+
+// ═══════════════════════════════════════
+// Освещение и материалы
+// ═══════════════════════════════════════
+
+static int paramIndex(const GLenum* params, int count, GLenum pname) {
+    for (int i = 0; i < count; ++i) {
+        if (params[i] == pname) return i;
+    }
+    return -1;
+}
+
+// Сравнить и запомнить n чисел параметра; true — значение изменилось
+static bool updateSlot(VecSlot& slot, const GLfloat* params, int n) {
+    std::size_t bytes = sizeof(GLfloat) * n;
+    if (!changed(!slot.valid || std::memcmp(slot.value, params, bytes) != 0)) return false;
+    slot.valid = true;
+    std::memcpy(slot.value, params, bytes);
+    return true;
+}
+
+void glsLightfv(GLenum light, GLenum pname, const GLfloat* params) {
+    int l = static_cast<int>(light) - GL_LIGHT0;
+    int p = paramIndex(LIGHT_PARAMS, LIGHT_PARAM_COUNT, pname);
+    if (l < 0 || l >= LIGHT_COUNT || p < 0) {
+        ++gIssued;
+        glLightfv(light, pname, params);
+        return;
+    }
+    if (updateSlot(gLights[l][p], params, 4)) glLightfv(light, pname, params);
+}
+
+void glsLightModeli(GLenum pname, GLint param) {
+    if (pname != GL_LIGHT_MODEL_TWO_SIDE) {
+        ++gIssued;
+        glLightModeli(pname, param);
+        return;
+    }
+    if (!changed(!gTwoSideValid || gTwoSide != param)) return;
+    gTwoSideValid = true;
+    gTwoSide = param;
+    glLightModeli(pname, param);
+}
+
+void glsMaterialfv(GLenum face, GLenum pname, const GLfloat* params) {
+    int p = paramIndex(MATERIAL_PARAMS, MATERIAL_PARAM_COUNT, pname);
+    if (face != GL_FRONT_AND_BACK || p < 0) {
+        // Одна сторона или GL_AMBIENT_AND_DIFFUSE расходятся с кешем
+        for (int i = 0; i < MATERIAL_PARAM_COUNT; ++i) gMaterial[i].valid = false;
+        ++gIssued;
+        glMaterialfv(face, pname, params);
+        return;
+    }
+    int n = pname == GL_SHININESS ? 1 : 4;
+    if (updateSlot(gMaterial[p], params, n)) glMaterialfv(face, pname, params);
+}
+
+// ═══════════════════════════════════════
+// Счётчики
+// ═══════════════════════════════════════
+
+void glStateEndFrame() {
+    profilerCounter("glStateIssued", static_cast<double>(gIssued));
+    profilerCounter("glStateElided", static_cast<double>(gElided));
+    gIssued = 0;
+    gElided = 0;
+}
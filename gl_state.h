@@ -0,0 +1,38 @@
+// ═══════════════════════════════════════
+// Кеш состояния OpenGL
+// Вся отрисовка меняет флаги glEnable, маску глубины, смешивание, источники
+// света и материалы через эти обёртки. Они помнят последнее выставленное
+// значение и не передают драйверу вызов, который ничего не меняет.
+// За кадр считаются выданные и пропущенные вызовы (счётчики профилировщика
+// glStateIssued и glStateElided)
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+// Забыть всё известное о состоянии: следующие вызовы уйдут драйверу.
+// Нужен после создания контекста и после изменений в обход кеша
+void glsInvalidate();
+
+// Флаги glEnable / glDisable
+void glsEnable(GLenum cap);
+void glsDisable(GLenum cap);
+bool glsIsEnabled(GLenum cap); // по кешу; неизвестный флаг спрашивается у драйвера
+
+void glsDepthMask(GLboolean flag);
+void glsBlendFunc(GLenum src, GLenum dst);
+void glsBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha);
+
+// Параметры источника света (GL_AMBIENT, GL_DIFFUSE, GL_SPECULAR, GL_POSITION).
+// Позиция переводится драйвером в координаты глаза текущей модельно-видовой
+// матрицей, поэтому кешировать её можно, только если она всегда задаётся
+// при одной и той же матрице (у нас — при единичной)
+void glsLightfv(GLenum light, GLenum pname, const GLfloat* params);
+void glsLightModeli(GLenum pname, GLint param);
+
+// Материал (GL_AMBIENT, GL_DIFFUSE, GL_SPECULAR, GL_EMISSION, GL_SHININESS)
+void glsMaterialfv(GLenum face, GLenum pname, const GLfloat* params);
+
+// Записать счётчики кадра в профилировщик и обнулить их (в конце display())
+void glStateEndFrame();
@@ -0,0 +1,207 @@
+// ═══════════════════════════════════════
+// Запись изображений без внешних библиотек
+// ═══════════════════════════════════════
+
+#include "image_io.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Наибольший блок deflate без сжатия
+static const std::size_t DEFLATE_STORED_MAX = 65535;
+
+// Строка y итогового изображения (сверху вниз) во входном буфере
+static const std::uint8_t* sourceRow(const std::uint8_t* rgba, int width, int height, int y, bool flipY) {
+    int row = flipY ? height - 1 - y : y;
+    return rgba + static_cast<std::size_t>(row) * width * 4;
+}
+
+bool writePPM(const char* path, const std::uint8_t* rgba, int width, int height, bool flipY) {
+    std::FILE* f = std::fopen(path, "wb");
+    if (f == nullptr) {
+        std::fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+    std::fprintf(f, "P6\n%d %d\n255\n", width, height);
+
+    std::vector<std::uint8_t> line(static_cast<std::size_t>(width) * 3);
+    for (int y = 0; y < height; ++y) {
+        const std::uint8_t* src = sourceRow(rgba, width, height, y, flipY);
+        for (int x = 0; x < width; ++x) {
+            line[x * 3 + 0] = src[x * 4 + 0];
+            line[x * 3 + 1] = src[x * 4 + 1];
+            line[x * 3 + 2] = src[x * 4 + 2];
+        }
+        std::fwrite(line.data(), 1, line.size(), f);
+    }
+    bool ok = std::ferror(f) == 0;
+    std::fclose(f);
+    return ok;
+}
+
+// Пропустить пробелы и комментарии заголовка PPM
+static void skipPpmSpace(std::FILE* f) {
+    int c = std::fgetc(f);
+    while (c != EOF) {
+        if (c == '#') {
+            while (c != EOF && c != '\n') c = std::fgetc(f);
+        } else if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            std::ungetc(c, f);
+            return;
+        }
+        c = std::fgetc(f);
+    }
+}
+
+bool readPPM(const char* path, std::vector<std::uint8_t>& rgba, int& width, int& height) {
+    std::FILE* f = std::fopen(path, "rb");
+    if (f == nullptr) {
+        std::fprintf(stderr, "Cannot read %s\n", path);
+        return false;
+    }
+    char magic[3] = {};
+    int maxValue = 0;
+    bool ok = std::fread(magic, 1, 2, f) == 2 && std::strcmp(magic, "P6") == 0;
+    if (ok) {
+        skipPpmSpace(f);
+        ok = std::fscanf(f, "%d", &width) == 1;
+        skipPpmSpace(f);
+        ok = ok && std::fscanf(f, "%d", &height) == 1;
+        skipPpmSpace(f);
+        ok = ok && std::fscanf(f, "%d", &maxValue) == 1 && std::fgetc(f) != EOF;
+        ok = ok && width > 0 && height > 0 && maxValue == 255;
+    }
+
+    std::vector<std::uint8_t> rgb;
+    if (ok) {
+        rgb.resize(static_cast<std::size_t>(width) * height * 3);
+        ok = std::fread(rgb.data(), 1, rgb.size(), f) == rgb.size();
+    }
+    std::fclose(f);
+    if (!ok) {
+        std::fprintf(stderr, "%s is not an 8-bit binary PPM\n", path);
+        return false;
+    }
+
+    rgba.resize(static_cast<std::size_t>(width) * height * 4);
+    for (std::size_t i = 0, n = static_cast<std::size_t>(width) * height; i < n; ++i) {
+        rgba[i * 4 + 0] = rgb[i * 3 + 0];
+        rgba[i * 4 + 1] = rgb[i * 3 + 1];
+        rgba[i * 4 + 2] = rgb[i * 3 + 2];
+        rgba[i * 4 + 3] = 255;
+    }
+    return true;
+}
+
+// ═══════════════════════════════════════
+// PNG
+// ═══════════════════════════════════════
+
+static std::uint32_t crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0) {
+    static std::uint32_t table[256];
+    static bool ready = false;
+    if (!ready) {
+        for (std::uint32_t n = 0; n < 256; ++n) {
+            std::uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        ready = true;
+    }
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBE32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    out.push_back(static_cast<std::uint8_t>(v >> 24));
+    out.push_back(static_cast<std::uint8_t>(v >> 16));
+    out.push_back(static_cast<std::uint8_t>(v >> 8));
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+// Блок PNG: длина, тип, данные и CRC от типа и данных
+static void writeChunk(std::FILE* f, const char* type, const std::vector<std::uint8_t>& data) {
+    std::vector<std::uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    putBE32(chunk, static_cast<std::uint32_t>(data.size()));
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putBE32(chunk, crc32(chunk.data() + 4, data.size() + 4));
+    std::fwrite(chunk.data(), 1, chunk.size(), f);
+}
+
+bool writePNG(const char* path, const std::uint8_t* rgba, int width, int height, bool flipY) {
+    // Несжатые строки RGB, каждая с байтом фильтра 0
+    std::size_t rowBytes = static_cast<std::size_t>(width) * 3 + 1;
+    std::vector<std::uint8_t> raw(rowBytes * height);
+    for (int y = 0; y < height; ++y) {
+        const std::uint8_t* src = sourceRow(rgba, width, height, y, flipY);
+        std::uint8_t* dst = &raw[rowBytes * y];
+        dst[0] = 0;
+        for (int x = 0; x < width; ++x) {
+            dst[1 + x * 3 + 0] = src[x * 4 + 0];
+            dst[1 + x * 3 + 1] = src[x * 4 + 1];
+            dst[1 + x * 3 + 2] = src[x * 4 + 2];
+        }
+    }
+
+    // Поток zlib: заголовок, блоки «stored» и Adler-32
+    std::vector<std::uint8_t> z;
+    z.reserve(raw.size() + raw.size() / DEFLATE_STORED_MAX * 5 + 16);
+    z.push_back(0x78);
+    z.push_back(0x01);
+    std::size_t pos = 0;
+    do {
+        std::size_t len = raw.size() - pos;
+        if (len > DEFLATE_STORED_MAX) len = DEFLATE_STORED_MAX;
+        bool last = pos + len == raw.size();
+        z.push_back(last ? 1 : 0);
+        z.push_back(static_cast<std::uint8_t>(len));
+        z.push_back(static_cast<std::uint8_t>(len >> 8));
+        z.push_back(static_cast<std::uint8_t>(~len));
+        z.push_back(static_cast<std::uint8_t>(~len >> 8));
+        z.insert(z.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < raw.size());
+
+    std::uint32_t a = 1, b = 0;
+    for (std::uint8_t v : raw) {
+        a = (a + v) % 65521;
+        b = (b + a) % 65521;
+    }
+    putBE32(z, (b << 16) | a);
+
+    std::FILE* f = std::fopen(path, "wb");
+    if (f == nullptr) {
+        std::fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+    static const std::uint8_t SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    std::fwrite(SIGNATURE, 1, sizeof(SIGNATURE), f);
+
+    std::vector<std::uint8_t> header;
+    putBE32(header, static_cast<std::uint32_t>(width));
+    putBE32(header, static_cast<std::uint32_t>(height));
+    header.push_back(8); // бит на канал
+    header.push_back(2); // RGB
+    header.push_back(0); // deflate
+    header.push_back(0); // стандартные фильтры
+    header.push_back(0); // без чередования строк
+    writeChunk(f, "IHDR", header);
+    writeChunk(f, "IDAT", z);
+    writeChunk(f, "IEND", std::vector<std::uint8_t>());
+
+    bool ok = std::ferror(f) == 0;
+    std::fclose(f);
+    return ok;
+}
+
+bool writeImage(const char* path, const std::uint8_t* rgba, int width, int height, bool flipY) {
+    std::size_t len = std::strlen(path);
+    if (len >= 4 && std::strcmp(path + len - 4, ".png") == 0) {
+        return writePNG(path, rgba, width, height, flipY);
+    }
+    return writePPM(path, rgba, width, height, flipY);
+}
@@ -0,0 +1,20 @@
+// ═══════════════════════════════════════
+// Запись изображений без внешних библиотек
+// PPM (P6) и PNG без сжатия (блоки deflate типа «stored»); PPM читается
+// обратно для сравнения с эталонами
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Пиксели RGBA8 построчно; flipY — строки идут снизу вверх (как у glReadPixels)
+bool writePPM(const char* path, const std::uint8_t* rgba, int width, int height, bool flipY);
+bool writePNG(const char* path, const std::uint8_t* rgba, int width, int height, bool flipY);
+
+// Формат по расширению: .png — PNG, иначе PPM
+bool writeImage(const char* path, const std::uint8_t* rgba, int width, int height, bool flipY);
+
+// Прочитать PPM (P6, 8 бит) в RGBA8 сверху вниз; false — файла нет или формат другой
+bool readPPM(const char* path, std::vector<std::uint8_t>& rgba, int& width, int& height);
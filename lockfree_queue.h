@@ -0,0 +1,90 @@
+// ═══════════════════════════════════════
+// Ограниченная очередь без блокировок (схема Вьюкова)
+// Любое число производителей и потребителей; каждая ячейка несёт
+// счётчик последовательности, поэтому push и pop — один CAS без мьютексов
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+template <typename T>
+class LockFreeQueue {
+public:
+    // Ёмкость округляется вверх до степени двойки
+    explicit LockFreeQueue(std::size_t capacity) {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mMask = size - 1;
+        mCells.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i) {
+            mCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    // false — очередь заполнена, значение не принято
+    bool tryPush(T value) {
+        std::size_t pos = mEnqueue.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = mCells[pos & mMask];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (mEnqueue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = mEnqueue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // false — очередь пуста
+    bool tryPop(T& out) {
+        std::size_t pos = mDequeue.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = mCells[pos & mMask];
+            std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+            if (diff == 0) {
+                if (mDequeue.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = std::move(cell.value);
+                    cell.sequence.store(pos + mMask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = mDequeue.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Приблизительно: очередь могла измениться сразу после проверки
+    bool empty() const {
+        return mDequeue.load(std::memory_order_relaxed) == mEnqueue.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> mCells;
+    std::size_t mMask = 0;
+
+    // Счётчики на разных строках кеша, чтобы производители и потребители не мешали друг другу
+    alignas(64) std::atomic<std::size_t> mEnqueue{0};
+    alignas(64) std::atomic<std::size_t> mDequeue{0};
+};
@@ -0,0 +1,41 @@
+// ═══════════════════════════════════════
+// Уровни детализации по экранной ошибке
+// ═══════════════════════════════════════
+
+#include "lod.h"
+
+#include <cmath>
+
+// M_PI может отсутствовать на MSVC
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+float projectedRadiusPx(float worldRadius, float distance, float fovyDeg, float viewportHeight) {
+    // Камера внутри сферы — считаем объект бесконечно большим
+    if (distance <= worldRadius) return 1e9f;
+
+    float halfFov = fovyDeg * 0.5f * static_cast<float>(M_PI) / 180.0f;
+    return worldRadius / (distance * std::tan(halfFov)) * (0.5f * viewportHeight);
+}
+
+int selectLod(const LodChain& chain, float radiusPx, int current) {
+    const int count = static_cast<int>(chain.levels.size());
+
+    // Самый грубый уровень, ошибка которого не превышает порога
+    int target = 0;
+    while (target + 1 < count && chain.error[target + 1] * radiusPx <= LOD_MAX_ERROR_PX) {
+        ++target;
+    }
+
+    // Нужна большая точность (или уровня ещё нет) — переключаемся сразу
+    if (current < 0 || current >= count || target < current) return target;
+
+    // Более грубый уровень — только если его ошибка ушла ниже порога с запасом
+    int level = current;
+    while (level + 1 < count &&
+           chain.error[level + 1] * radiusPx <= LOD_MAX_ERROR_PX * (1.0f - LOD_HYSTERESIS)) {
+        ++level;
+    }
+    return level;
+}
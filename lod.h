@@ -0,0 +1,30 @@
+// ═══════════════════════════════════════
+// Уровни детализации по экранной ошибке
+// Для примитива заранее готовится цепочка мешей от подробного к грубому.
+// Уровень выбирается по проекции геометрической ошибки на экран,
+// гистерезис не даёт уровню прыгать на границе
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "mesh.h"
+
+#include <vector>
+
+// Допустимая экранная ошибка силуэта, пиксели
+static const float LOD_MAX_ERROR_PX = 0.5f;
+
+// Доля порога, на которую ошибка должна опуститься, чтобы перейти на грубый уровень
+static const float LOD_HYSTERESIS = 0.25f;
+
+// Цепочка уровней: levels[0] — самый подробный
+struct LodChain {
+    std::vector<const Mesh*> levels;
+    std::vector<float>       error; // геометрическая ошибка уровня в долях радиуса
+};
+
+// Радиус ограничивающей сферы в пикселях для перспективной камеры
+float projectedRadiusPx(float worldRadius, float distance, float fovyDeg, float viewportHeight);
+
+// Выбрать уровень по экранному радиусу; current — уровень прошлого кадра (-1 — нет)
+int selectLod(const LodChain& chain, float radiusPx, int current);
@@ -6,8 +6,38 @@
 
 #include <GLFW/glfw3.h>
 
+#include "core_renderer.h"
+#include "command_buffer.h"
+#include "culling.h"
+#include "dynamic_resolution.h"
+#include "forest.h"
+#include "forest3d.h"
+#include "forest_stream.h"
+#include "frame_capture.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "image_io.h"
+#include "lod.h"
+#include "mesh.h"
+#include "options.h"
+#include "primitives.h"
+#include "profiler.h"
+#include "scene.h"
+#include "scene_file.h"
+#include "simulation.h"
+#include "softraster.h"
+#include "stream_ring.h"
+#include "stress_scene.h"
+#include "thread_pool.h"
+#include "transparency.h"
+
+#include <algorithm>
 #include <cmath>
+#include <cstdio>
+#include <cstdint>
 #include <cstdlib>
+#include <memory>
+#include <vector>
 
 // M_PI может отсутствовать на MSVC
 #ifndef M_PI
@@ -27,53 +57,34 @@ static const float SKY_R = 0.98f;
 static const float SKY_G = 0.96f;
 static const float SKY_B = 0.90f;
 
-// Ограничения смещения 2D-сцены
-static const float OFFSET_X_MIN = -0.5f;
-static const float OFFSET_X_MAX =  0.5f;
-static const float OFFSET_Y_MIN = -0.3f;
-static const float OFFSET_Y_MAX =  0.3f;
-
-// Шаг смещения 2D-сцены
-static const float OFFSET_STEP = 0.05f;
-
 // Начальная позиция камеры
 static const float CAM_X_INIT = 0.0f;
 static const float CAM_Y_INIT = 1.0f;
 static const float CAM_Z_INIT = 5.0f;
 
-// Ограничение камеры (только минимальная дистанция по Z, чтобы не уйти в 0)
-static const float CAM_Z_MIN = 0.1f;
-
-// Шаги камеры
-static const float CAM_XY_STEP = 0.1f;
-static const float CAM_Z_STEP  = 0.2f;
-
-// Ограничения яркости
-static const float BRIGHTNESS_MIN  = 0.1f;
-static const float BRIGHTNESS_MAX  = 2.0f;
-static const float BRIGHTNESS_STEP = 0.1f;
-
-// Ограничения прозрачности
-static const float TRANSPARENCY_MIN  = 0.1f;
-static const float TRANSPARENCY_MAX  = 1.0f;
-static const float TRANSPARENCY_STEP = 0.05f;
+// Параметры перспективной проекции 3D-режима
+static const double FOV_Y  = 45.0;
+static const double Z_NEAR = 0.1;
+static const double Z_FAR  = 100.0;
 
-// Параметры пирамиды
-static const float PYRAMID_HALF_BASE = 0.5f;
-static const float PYRAMID_HEIGHT    = 1.0f;
+// Зерно генератора нагрузочного леса (--bench --trees N)
+static const unsigned int BENCH_SEED = 12345u;
 
-// Параметры сферы
-static const float SPHERE_RADIUS = 0.5f;
-static const int   SPHERE_SLICES = 32;
-static const int   SPHERE_STACKS = 32;
+// Зерно бесконечного леса: одинаковые чанки при каждом запуске
+static const unsigned int FOREST_STREAM_SEED = 2024u;
 
-// Размер куба
-static const float CUBE_SIZE = 0.8f;
+// 3D-лес (--forest3d): шаг сетки деревьев, радиус поляны под примитивами, уровень земли
+static const float FOREST3D_SPACING  = 2.0f;
+static const float FOREST3D_CLEARING = 6.0f;
+static const float FOREST3D_GROUND_Y = -1.0f;
 
-// Цвет ствола дерева
-static const float TRUNK_R = 0.4f;
-static const float TRUNK_G = 0.2f;
-static const float TRUNK_B = 0.05f;
+// Источник света 3D-сцены: позиция в координатах глаза (задаётся при единичной
+// модельно-видовой матрице) и интенсивности при яркости 1
+static const float LIGHT_POSITION[4] = {2.0f, 3.0f, 4.0f, 1.0f};
+static const float LIGHT_AMBIENT  = 0.2f;
+static const float LIGHT_DIFFUSE  = 1.0f;
+static const float LIGHT_SPECULAR = 0.8f;
+static const float MODEL_AMBIENT  = 0.2f; // GL_LIGHT_MODEL_AMBIENT по умолчанию
 
 // Цвет земли
 static const float GROUND_R = 0.1f;
@@ -105,158 +116,70 @@ float transparency = 0.8f;
 // Режим отображения: 0 = 2D-лес, 1 = 3D-объекты
 int sceneMode = 0;
 
-// ═══════════════════════════════════════
-// Вспомогательная функция ограничения значения
-// ═══════════════════════════════════════
+// Способ смешивания полупрозрачных 3D-объектов
+TransparencyMode gTransparencyMode = TRANSPARENCY_SORTED;
 
-static float clampf(float val, float lo, float hi) {
-    if (val < lo) return lo;
-    if (val > hi) return hi;
-    return val;
-}
+// Уровни детализации сферы по экранной ошибке
+bool gLodEnabled = true;
 
-// ═══════════════════════════════════════
-// Замена gluPerspective — перспективная проекция через glFrustum
-// ═══════════════════════════════════════
+// Текущий уровень детализации каждого объекта (-1 — ещё не выбран)
+std::vector<int> gObjectLod;
 
-static void myPerspective(double fovy, double aspect, double zNear, double zFar) {
-    double top   = zNear * std::tan(fovy * M_PI / 360.0);
-    double right = top * aspect;
-    glFrustum(-right, right, -top, top, zNear, zFar);
-}
+// Бесконечный лес из подгружаемых чанков вместо фиксированной сцены (2D-режим)
+bool gInfiniteForest = false;
 
-// ═══════════════════════════════════════
-// Замена gluLookAt — установка матрицы камеры вручную
-// ═══════════════════════════════════════
+// Деревьев в одном чанке бесконечного леса
+int gChunkTrees = FOREST_CHUNK_TREES;
 
-static void myLookAt(double eyeX, double eyeY, double eyeZ,
-                     double centerX, double centerY, double centerZ,
-                     double upX, double upY, double upZ) {
-    // Вектор направления взгляда (forward)
-    double fx = centerX - eyeX;
-    double fy = centerY - eyeY;
-    double fz = centerZ - eyeZ;
-    double fLen = std::sqrt(fx * fx + fy * fy + fz * fz);
-    fx /= fLen; fy /= fLen; fz /= fLen;
+// Сдвиг 2D-сцены за кадр в режиме замера (--pan-speed)
+float gBenchPanSpeed = 0.0f;
 
-    // Боковой вектор (side = forward x up)
-    double sx = fy * upZ - fz * upY;
-    double sy = fz * upX - fx * upZ;
-    double sz = fx * upY - fy * upX;
-    double sLen = std::sqrt(sx * sx + sy * sy + sz * sz);
-    sx /= sLen; sy /= sLen; sz /= sLen;
+// Запись кадров в видео (--record)
+FrameRecorder gRecorder;
 
-    // Вертикальный вектор (u = side x forward)
-    double ux = sy * fz - sz * fy;
-    double uy = sz * fx - sx * fz;
-    double uz = sx * fy - sy * fx;
+// Нагрузочная 3D-сцена (--stress): экземпляры и готовность её конвейера
+std::vector<StressInstance> gStressInstances;
+bool gStressActive = false;
 
-    // Матрица в column-major порядке для OpenGL
-    double m[16] = {
-         sx,  ux, -fx, 0.0,
-         sy,  uy, -fy, 0.0,
-         sz,  uz, -fz, 0.0,
-        0.0, 0.0, 0.0, 1.0
-    };
-    glMultMatrixd(m);
-    glTranslated(-eyeX, -eyeY, -eyeZ);
-}
+// 3D-лес (--forest3d): деревья и готовность его конвейера
+std::vector<Tree3D> gForest3DTrees;
+bool gForest3DActive = false;
 
-// ═══════════════════════════════════════
-// Замена glutSolidCube — куб из шести граней с нормалями
-// ═══════════════════════════════════════
+// Дальняя плоскость отсечения 3D-режима (3D-лес отодвигает её до своего края)
+float gZFar = static_cast<float>(Z_FAR);
 
-static void mySolidCube(float size) {
-    float h = size / 2.0f;
+// Отсечение невидимых деревьев и 3D-объектов по пирамиде видимости
+bool gCullingEnabled = true;
 
-    glBegin(GL_QUADS);
-        // Передняя грань (+Z)
-        glNormal3f(0.0f, 0.0f, 1.0f);
-        glVertex3f(-h, -h,  h);
-        glVertex3f( h, -h,  h);
-        glVertex3f( h,  h,  h);
-        glVertex3f(-h,  h,  h);
-
-        // Задняя грань (-Z)
-        glNormal3f(0.0f, 0.0f, -1.0f);
-        glVertex3f( h, -h, -h);
-        glVertex3f(-h, -h, -h);
-        glVertex3f(-h,  h, -h);
-        glVertex3f( h,  h, -h);
-
-        // Верхняя грань (+Y)
-        glNormal3f(0.0f, 1.0f, 0.0f);
-        glVertex3f(-h,  h,  h);
-        glVertex3f( h,  h,  h);
-        glVertex3f( h,  h, -h);
-        glVertex3f(-h,  h, -h);
-
-        // Нижняя грань (-Y)
-        glNormal3f(0.0f, -1.0f, 0.0f);
-        glVertex3f(-h, -h, -h);
-        glVertex3f( h, -h, -h);
-        glVertex3f( h, -h,  h);
-        glVertex3f(-h, -h,  h);
-
-        // Правая грань (+X)
-        glNormal3f(1.0f, 0.0f, 0.0f);
-        glVertex3f( h, -h,  h);
-        glVertex3f( h, -h, -h);
-        glVertex3f( h,  h, -h);
-        glVertex3f( h,  h,  h);
-
-        // Левая грань (-X)
-        glNormal3f(-1.0f, 0.0f, 0.0f);
-        glVertex3f(-h, -h, -h);
-        glVertex3f(-h, -h,  h);
-        glVertex3f(-h,  h,  h);
-        glVertex3f(-h,  h, -h);
-    glEnd();
-}
+// Отсечение деревьев 3D-леса, закрытых ближними (Hi-Z)
+bool gOcclusionEnabled = true;
 
-// ═══════════════════════════════════════
-// Замена gluSphere — сфера из параметрических полос
-// ═══════════════════════════════════════
-
-static void mySolidSphere(float radius, int slices, int stacks) {
-    for (int i = 0; i < stacks; ++i) {
-        // Широтные углы для текущей и следующей полосы
-        float lat0 = static_cast<float>(M_PI) * (-0.5f + static_cast<float>(i) / stacks);
-        float lat1 = static_cast<float>(M_PI) * (-0.5f + static_cast<float>(i + 1) / stacks);
-
-        float y0  = std::sin(lat0);
-        float yr0 = std::cos(lat0);
-        float y1  = std::sin(lat1);
-        float yr1 = std::cos(lat1);
+// Высота области вывода в пикселях (для экранной ошибки LOD)
+int gViewportHeight = WINDOW_HEIGHT;
 
-        glBegin(GL_QUAD_STRIP);
-        for (int j = 0; j <= slices; ++j) {
-            float lng = 2.0f * static_cast<float>(M_PI) * static_cast<float>(j) / slices;
-            float x = std::cos(lng);
-            float z = std::sin(lng);
+// Матрицы проекции и вида на процессоре: в core-профиле стека матриц OpenGL нет
+Mat4 gProjection = mat4Identity();
+Mat4 gModelView = mat4Identity();
 
-            // Нижняя вершина полосы
-            glNormal3f(x * yr0, y0, z * yr0);
-            glVertex3f(radius * x * yr0, radius * y0, radius * z * yr0);
+// Сцена изменилась и требует перерисовки (режим --on-demand)
+bool gNeedsRedraw = true;
 
-            // Верхняя вершина полосы
-            glNormal3f(x * yr1, y1, z * yr1);
-            glVertex3f(radius * x * yr1, radius * y1, radius * z * yr1);
-        }
-        glEnd();
-    }
-}
+// Поток симуляции: камера, смещение, яркость и прозрачность (только в главном цикле)
+std::unique_ptr<Simulation> gSim;
 
 // ═══════════════════════════════════════
 // Инициализация OpenGL
 // ═══════════════════════════════════════
 
 void initGL() {
+    loadGLFunctions();                         // функции OpenGL новее 1.1
     glClearColor(SKY_R, SKY_G, SKY_B, 1.0f); // молочный фон
-    glEnable(GL_DEPTH_TEST);                   // тест глубины
-    glEnable(GL_BLEND);                        // прозрачность
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glEnable(GL_NORMALIZE);                    // нормализация нормалей
+    glsInvalidate();                           // новый контекст — кеш состояния пуст
+    glsEnable(GL_DEPTH_TEST);                  // тест глубины
+    glsEnable(GL_BLEND);                       // прозрачность
+    glsBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    if (gl.coreProfile) return;                // нормали и затенение — в шейдерах
+    glsEnable(GL_NORMALIZE);                   // нормализация нормалей
     glShadeModel(GL_SMOOTH);                   // плавное затенение
 }
 
@@ -266,91 +189,229 @@ void initGL() {
 
 void reshape(int w, int h) {
     if (h == 0) h = 1; // защита от деления на ноль
+    gViewportHeight = h;
 
     glViewport(0, 0, w, h);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
 
     if (sceneMode == 0) {
-        // Ортографическая проекция для 2D
-        glOrtho(-1.0, 1.0, -1.0, 1.0, -1.0, 1.0);
+        gProjection = mat4Ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f);
     } else {
-        // Перспективная проекция для 3D
-        myPerspective(45.0, static_cast<double>(w) / h, 0.1, 100.0);
+        gProjection = mat4Perspective(static_cast<float>(FOV_Y), static_cast<float>(w) / h,
+                                      static_cast<float>(Z_NEAR), gZFar);
     }
+    if (gl.coreProfile) return;
 
+    // Фиксированному конвейеру матрица проекции передаётся готовой
+    glMatrixMode(GL_PROJECTION);
+    glLoadMatrixf(gProjection.m);
     glMatrixMode(GL_MODELVIEW);
 }
 
 // Обёртка-колбэк для GLFW (framebuffer size)
 static void framebufferSizeCallback(GLFWwindow* /*window*/, int w, int h) {
     reshape(w, h);
+    gNeedsRedraw = true;
+}
+
+// Содержимое окна повреждено (перекрытие, восстановление) — перерисовать
+static void windowRefreshCallback(GLFWwindow* /*window*/) {
+    gNeedsRedraw = true;
 }
 
 // ═══════════════════════════════════════
-// Рисование одной ёлочки из трёх ярусов и ствола
+// Содержимое сцен
 // ═══════════════════════════════════════
 
-void drawTree(float x, float y, float scale) {
-    // Ствол — коричневый прямоугольник
-    glColor3f(TRUNK_R, TRUNK_G, TRUNK_B);
-    glBegin(GL_QUADS);
-        glVertex2f(x - 0.03f * scale, y);
-        glVertex2f(x + 0.03f * scale, y);
-        glVertex2f(x + 0.03f * scale, y + 0.15f * scale);
-        glVertex2f(x - 0.03f * scale, y + 0.15f * scale);
-    glEnd();
+// Деревья, 3D-объекты и материалы (исходная сцена или нагрузочная для --bench)
+Scene gScene;
 
-    // Ярус 1 (нижний) — тёмно-зелёный
-    glColor3f(0.05f, 0.4f, 0.05f);
-    glBegin(GL_TRIANGLES);
-        glVertex2f(x - 0.35f * scale, y + 0.1f * scale);
-        glVertex2f(x + 0.35f * scale, y + 0.1f * scale);
-        glVertex2f(x, y + 0.45f * scale);
-    glEnd();
+// Пакет деревьев 2D-сцены (рисуется одним вызовом)
+ForestBatch gForest;
 
-    // Ярус 2 (средний) — зелёный
-    glColor3f(0.1f, 0.55f, 0.1f);
-    glBegin(GL_TRIANGLES);
-        glVertex2f(x - 0.27f * scale, y + 0.3f * scale);
-        glVertex2f(x + 0.27f * scale, y + 0.3f * scale);
-        glVertex2f(x, y + 0.6f * scale);
-    glEnd();
+// Пространственные индексы ограничивающих объёмов: деревья — сетка, 3D-объекты — BVH
+UniformGrid2D gTreeGrid;
+Bvh gObjectBvh;
 
-    // Ярус 3 (верхний) — светло-зелёный
-    glColor3f(0.15f, 0.65f, 0.15f);
-    glBegin(GL_TRIANGLES);
-        glVertex2f(x - 0.18f * scale, y + 0.48f * scale);
-        glVertex2f(x + 0.18f * scale, y + 0.48f * scale);
-        glVertex2f(x, y + 0.75f * scale);
-    glEnd();
-}
+// Матрицы модели 3D-объектов (перенос * поворот), строятся вместе с BVH
+std::vector<Mat4> gObjectModel;
+
+// Итоги отсечения последнего кадра
+CullStats gTreeCull;
+CullStats gObjectCull;
+
+// Чанки бесконечного леса и фоновые потоки их генерации (создаются при первом включении)
+std::unique_ptr<ForestStream> gForestStream;
+
+// Видимая область, для которой собран пакет деревьев (пакет пересобирается
+// только при её изменении)
+static Rect2D gForestView;
+static bool gForestViewValid = false;
 
 // ═══════════════════════════════════════
-// Рисование леса из семи ёлочек и земли
+// Ограничивающие объёмы сцены
 // ═══════════════════════════════════════
 
-void drawForest() {
-    // Применить смещение 2D-сцены
-    glTranslatef(offsetX, offsetY, 0.0f);
+// Локальный AABB примитива (до поворота и переноса)
+static Aabb primitiveBounds(PrimitiveType type) {
+    const SceneMesh& custom = gScene.meshes[type];
+    if (custom.vertexCount != 0) {
+        return {{custom.boundsMin[0], custom.boundsMin[1], custom.boundsMin[2]},
+                {custom.boundsMax[0], custom.boundsMax[1], custom.boundsMax[2]}};
+    }
+
+    float h = CUBE_SIZE / 2.0f;
+    switch (type) {
+        case PRIM_PYRAMID:
+            return {{-PYRAMID_HALF_BASE, 0.0f, -PYRAMID_HALF_BASE},
+                    { PYRAMID_HALF_BASE, PYRAMID_HEIGHT, PYRAMID_HALF_BASE}};
+        case PRIM_SPHERE:
+            return {{-SPHERE_RADIUS, -SPHERE_RADIUS, -SPHERE_RADIUS},
+                    { SPHERE_RADIUS,  SPHERE_RADIUS,  SPHERE_RADIUS}};
+        case PRIM_CUBE:
+        default:
+            return {{-h, -h, -h}, {h, h, h}};
+    }
+}
+
+// Построить сетку деревьев и BVH объектов (после любой замены содержимого сцены)
+static void buildSceneIndex() {
+    float tMinX, tMinY, tMaxX, tMaxY;
+    unitTreeBounds(tMinX, tMinY, tMaxX, tMaxY);
+    std::vector<Rect2D> rects(gScene.trees.size());
+    for (std::size_t i = 0; i < rects.size(); ++i) {
+        const TreeInstance& t = gScene.trees[i];
+        rects[i] = {t.x + tMinX * t.scale, t.y + tMinY * t.scale,
+                    t.x + tMaxX * t.scale, t.y + tMaxY * t.scale};
+    }
+    gTreeGrid.build(rects.data(), rects.size());
+
+    std::vector<Aabb> boxes(gScene.objects.size());
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        const SceneObject& obj = gScene.objects[i];
+        boxes[i] = transformAabb(primitiveBounds(obj.type), obj.rotAngle, obj.rotAxis, obj.position);
+    }
+    gObjectBvh.build(boxes.data(), boxes.size());
+
+    gObjectModel.resize(gScene.objects.size());
+    for (std::size_t i = 0; i < gObjectModel.size(); ++i) {
+        const SceneObject& obj = gScene.objects[i];
+        gObjectModel[i] = mat4Translate(obj.position[0], obj.position[1], obj.position[2]);
+        if (obj.rotAngle != 0.0f) {
+            gObjectModel[i] = gObjectModel[i] * mat4Rotate(obj.rotAngle, obj.rotAxis[0], obj.rotAxis[1], obj.rotAxis[2]);
+        }
+    }
+
+    gForestViewValid = false;
+}
+
+// Проекция * вид для текущих матриц (все матрицы считаются на процессоре,
+// поэтому glGetFloatv и ожидание драйвера не нужны)
+static void currentClipMatrix(float clip[16]) {
+    multiplyMatrix(gProjection.m, gModelView.m, clip);
+}
+
+// Видимая часть плоскости 2D-сцены при текущих матрицах
+static Rect2D currentViewRect() {
+    float clip[16];
+    currentClipMatrix(clip);
+    return orthoViewRect(clip);
+}
+
+// Обновить пакет деревьев под текущие матрицы: только деревья, задевающие экран
+static void updateForestVisibility() {
+    PROFILE_SCOPE("cullForest");
+
+    if (!gCullingEnabled) {
+        if (gForestViewValid || gForest.instances.size() != gScene.trees.size()) {
+            setForestInstances(gForest, gScene.trees.data(), gScene.trees.size());
+            gForestViewValid = false;
+        }
+        gTreeCull.visible = gScene.trees.size();
+        gTreeCull.culled = 0;
+        return;
+    }
 
-    // Земля — тёмно-зелёный прямоугольник
+    Rect2D rect = currentViewRect();
+
+    if (!gForestViewValid || rect.minX != gForestView.minX || rect.minY != gForestView.minY ||
+        rect.maxX != gForestView.maxX || rect.maxY != gForestView.maxY) {
+        static std::vector<std::uint32_t> visible;
+        static std::vector<TreeInstance> trees;
+        gTreeGrid.query(rect, visible, gTreeCull);
+        trees.resize(visible.size());
+        for (std::size_t i = 0; i < visible.size(); ++i) trees[i] = gScene.trees[visible[i]];
+        setForestInstances(gForest, trees.data(), trees.size());
+        gForestView = rect;
+        gForestViewValid = true;
+    }
+}
+
+// ═══════════════════════════════════════
+// Рисование леса и земли
+// ═══════════════════════════════════════
+
+// Земля — тёмно-зелёный прямоугольник от x0 до x1 под деревьями
+static void drawGround(float x0, float x1) {
+    if (gl.coreProfile) {
+        static const float GROUND_COLOR[3] = {GROUND_R, GROUND_G, GROUND_B};
+        coreDrawRect(gProjection * gModelView, x0, -1.0f, x1, -0.6f, GROUND_COLOR);
+        return;
+    }
     glColor3f(GROUND_R, GROUND_G, GROUND_B);
     glBegin(GL_QUADS);
-        glVertex2f(-1.0f, -1.0f);
-        glVertex2f( 1.0f, -1.0f);
-        glVertex2f( 1.0f, -0.6f);
-        glVertex2f(-1.0f, -0.6f);
+        glVertex2f(x0, -1.0f);
+        glVertex2f(x1, -1.0f);
+        glVertex2f(x1, -0.6f);
+        glVertex2f(x0, -0.6f);
     glEnd();
+}
+
+// Бесконечный лес: земля во всю видимую ширину и готовые чанки вокруг экрана
+static void drawInfiniteForest() {
+    Rect2D view = currentViewRect();
+    if (!gForestStream) {
+        gForestStream.reset(new ForestStream(FOREST_STREAM_SEED, gChunkTrees));
+    }
+
+    drawGround(view.minX, view.maxX);
+
+    {
+        PROFILE_SCOPE("streamForest");
+        gForestStream->update(view);
+    }
+    gForestStream->draw(view);
 
-    // Семь ёлочек с разными позициями и масштабами
-    drawTree(-0.85f, -0.6f, 0.55f);
-    drawTree(-0.55f, -0.65f, 0.45f);
-    drawTree(-0.25f, -0.6f, 0.65f);
-    drawTree( 0.05f, -0.7f, 0.38f);
-    drawTree( 0.32f, -0.6f, 0.58f);
-    drawTree( 0.62f, -0.65f, 0.42f);
-    drawTree( 0.88f, -0.6f, 0.52f);
+    const ForestStreamStats& st = gForestStream->stats();
+    profilerCounter("visibleTrees", static_cast<double>(st.visible));
+    profilerCounter("chunksResident", static_cast<double>(st.resident));
+    profilerCounter("chunksPending", static_cast<double>(st.pending));
+    profilerCounter("chunkUploads", static_cast<double>(st.uploads));
+}
+
+void drawForest() {
+    PROFILE_GPU_SCOPE("drawForest");
+
+    // Применить смещение 2D-сцены
+    gModelView = gModelView * mat4Translate(offsetX, offsetY, 0.0f);
+    if (gl.coreProfile) {
+        Mat4 clip = gProjection * gModelView;
+        setForestTransform(clip.m);
+    } else {
+        glLoadMatrixf(gModelView.m);
+    }
+
+    if (gInfiniteForest) {
+        drawInfiniteForest();
+        return;
+    }
+
+    drawGround(-1.0f, 1.0f);
+
+    // Все видимые ёлочки — одним вызовом
+    updateForestVisibility();
+    profilerCounter("visibleTrees", static_cast<double>(gTreeCull.visible));
+    profilerCounter("culledTrees", static_cast<double>(gTreeCull.culled));
+    drawForestBatch(gForest);
 }
 
 // ═══════════════════════════════════════
@@ -358,156 +419,326 @@ void drawForest() {
 // ═══════════════════════════════════════
 
 void setupLighting() {
-    glEnable(GL_LIGHTING);
-    glEnable(GL_LIGHT0);
+    PROFILE_GPU_SCOPE("setupLighting");
+
+    // В core-профиле источник света уходит в uniform-буфер кадра (draw3DObjects)
+    if (gl.coreProfile) return;
 
-    // Позиция источника света
-    GLfloat pos[]  = {2.0f, 3.0f, 4.0f, 1.0f};
+    // Вызовы идут через кеш состояния: пока яркость не менялась,
+    // драйверу ничего не передаётся
+    glsEnable(GL_LIGHTING);
+    glsEnable(GL_LIGHT0);
 
     // Компоненты освещения, масштабированные яркостью
-    GLfloat amb[]  = {0.2f * lightBrightness, 0.2f * lightBrightness,
-                      0.2f * lightBrightness, 1.0f};
-    GLfloat diff[] = {1.0f * lightBrightness, 1.0f * lightBrightness,
-                      1.0f * lightBrightness, 1.0f};
-    GLfloat spec[] = {0.8f * lightBrightness, 0.8f * lightBrightness,
-                      0.8f * lightBrightness, 1.0f};
-
-    glLightfv(GL_LIGHT0, GL_POSITION, pos);
-    glLightfv(GL_LIGHT0, GL_AMBIENT,  amb);
-    glLightfv(GL_LIGHT0, GL_DIFFUSE,  diff);
-    glLightfv(GL_LIGHT0, GL_SPECULAR, spec);
+    GLfloat amb[]  = {LIGHT_AMBIENT * lightBrightness, LIGHT_AMBIENT * lightBrightness,
+                      LIGHT_AMBIENT * lightBrightness, 1.0f};
+    GLfloat diff[] = {LIGHT_DIFFUSE * lightBrightness, LIGHT_DIFFUSE * lightBrightness,
+                      LIGHT_DIFFUSE * lightBrightness, 1.0f};
+    GLfloat spec[] = {LIGHT_SPECULAR * lightBrightness, LIGHT_SPECULAR * lightBrightness,
+                      LIGHT_SPECULAR * lightBrightness, 1.0f};
+
+    glsLightfv(GL_LIGHT0, GL_POSITION, LIGHT_POSITION);
+    glsLightfv(GL_LIGHT0, GL_AMBIENT,  amb);
+    glsLightfv(GL_LIGHT0, GL_DIFFUSE,  diff);
+    glsLightfv(GL_LIGHT0, GL_SPECULAR, spec);
 
     // Двустороннее освещение
-    glLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
+    glsLightModeli(GL_LIGHT_MODEL_TWO_SIDE, GL_TRUE);
 }
 
+// Треугольников 3D-примитивов за текущий кадр
+static std::size_t gFrameTriangles = 0;
+
 // ═══════════════════════════════════════
-// Рисование 3D-примитивов: куб, пирамида, сфера
+// Меш 3D-примитива (куб, пирамида и сфера — из кеша индексированных мешей)
+// Сфера выбирает уровень детализации по экранному радиусу с гистерезисом
+// относительно прошлого кадра
 // ═══════════════════════════════════════
 
-void draw3DObjects() {
-    // Отключить запись в буфер глубины для прозрачных объектов,
-    // чтобы задние грани были видны сквозь полупрозрачные передние
-    glDepthMask(GL_FALSE);
-
-    // --- Куб (слева) ---
-    glPushMatrix();
-    glTranslatef(-1.5f, 0.0f, 0.0f);
-    glRotatef(30.0f, 1.0f, 1.0f, 0.0f);
-
-    // Материал куба — зелёный
-    GLfloat cubeDiff[] = {0.1f, 0.7f, 0.2f, transparency};
-    GLfloat cubeSpec[] = {0.9f, 0.9f, 0.9f, 1.0f};
-    GLfloat cubeShin[] = {64.0f};
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,  cubeDiff);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, cubeSpec);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, cubeShin);
-
-    mySolidCube(CUBE_SIZE);
-    glPopMatrix();
-
-    // --- Пирамида (по центру) ---
-    glPushMatrix();
-    glTranslatef(0.0f, 0.0f, 0.0f);
-
-    // Материал пирамиды — фиолетовый
-    GLfloat pyrDiff[] = {0.55f, 0.0f, 0.8f, transparency};
-    GLfloat pyrSpec[] = {0.9f, 0.9f, 0.9f, 1.0f};
-    GLfloat pyrShin[] = {32.0f};
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,  pyrDiff);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, pyrSpec);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, pyrShin);
-
-    // Вершины пирамиды
-    float b = PYRAMID_HALF_BASE; // полуразмер основания
-    float h = PYRAMID_HEIGHT;    // высота
-
-    // Вершина
-    float apex[3] = {0.0f, h, 0.0f};
-
-    // Углы основания (Y = 0)
-    float v0[3] = {-b, 0.0f, -b};
-    float v1[3] = { b, 0.0f, -b};
-    float v2[3] = { b, 0.0f,  b};
-    float v3[3] = {-b, 0.0f,  b};
-
-    // Нормали для боковых граней (вычислены аналитически)
-    // Передняя грань (v2, v3, apex) — нормаль смотрит в +Z
-    float nFront[3] = {0.0f, b, b};
-    float lenF = std::sqrt(nFront[1] * nFront[1] + nFront[2] * nFront[2]);
-    nFront[1] /= lenF; nFront[2] /= lenF;
-
-    // Задняя грань (v0, v1, apex) — нормаль смотрит в -Z
-    float nBack[3] = {0.0f, b, -b};
-    float lenB = std::sqrt(nBack[1] * nBack[1] + nBack[2] * nBack[2]);
-    nBack[1] /= lenB; nBack[2] /= lenB;
-
-    // Правая грань (v1, v2, apex) — нормаль смотрит в +X
-    float nRight[3] = {b, b, 0.0f};
-    float lenR = std::sqrt(nRight[0] * nRight[0] + nRight[1] * nRight[1]);
-    nRight[0] /= lenR; nRight[1] /= lenR;
-
-    // Левая грань (v3, v0, apex) — нормаль смотрит в -X
-    float nLeft[3] = {-b, b, 0.0f};
-    float lenL = std::sqrt(nLeft[0] * nLeft[0] + nLeft[1] * nLeft[1]);
-    nLeft[0] /= lenL; nLeft[1] /= lenL;
-
-    // Боковые грани пирамиды
-    glBegin(GL_TRIANGLES);
-        // Передняя грань
-        glNormal3fv(nFront);
-        glVertex3fv(v2);
-        glVertex3fv(v3);
-        glVertex3fv(apex);
-
-        // Задняя грань
-        glNormal3fv(nBack);
-        glVertex3fv(v0);
-        glVertex3fv(v1);
-        glVertex3fv(apex);
-
-        // Правая грань
-        glNormal3fv(nRight);
-        glVertex3fv(v1);
-        glVertex3fv(v2);
-        glVertex3fv(apex);
-
-        // Левая грань
-        glNormal3fv(nLeft);
-        glVertex3fv(v3);
-        glVertex3fv(v0);
-        glVertex3fv(apex);
-    glEnd();
+static const Mesh& objectMesh(const SceneObject& obj, int& lod) {
+    // Сетка из файла сцены заменяет встроенную (без уровней детализации)
+    const SceneMesh& custom = gScene.meshes[obj.type];
+    if (custom.vertexCount != 0) {
+        return getStaticMesh(custom.vertices, custom.vertices, custom.vertexCount,
+                             custom.indices, custom.indexCount);
+    }
 
-    // Основание пирамиды (нормаль вниз)
-    glBegin(GL_QUADS);
-        glNormal3f(0.0f, -1.0f, 0.0f);
-        glVertex3fv(v0);
-        glVertex3fv(v3);
-        glVertex3fv(v2);
-        glVertex3fv(v1);
-    glEnd();
+    switch (obj.type) {
+        case PRIM_CUBE:
+            return getCubeMesh();
+        case PRIM_PYRAMID:
+            return getPyramidMesh();
+        case PRIM_SPHERE:
+        default:
+            break;
+    }
+    if (!gLodEnabled) return getSphereMesh();
+
+    const LodChain& chain = getSphereLodChain();
+    float dx = obj.position[0] - camX;
+    float dy = obj.position[1] - camY;
+    float dz = obj.position[2] - camZ;
+    float dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+    float radiusPx = projectedRadiusPx(SPHERE_RADIUS, dist, static_cast<float>(FOV_Y),
+                                       static_cast<float>(gViewportHeight));
+    lod = selectLod(chain, radiusPx, lod);
+    return *chain.levels[lod];
+}
+
+// Загрузить сетки всех типов до записи команд: в потоках пула кеш мешей
+// только читается (загрузка в OpenGL возможна лишь в этом потоке)
+static void prepareObjectMeshes() {
+    for (int t = 0; t < PRIM_COUNT; ++t) {
+        const SceneMesh& custom = gScene.meshes[t];
+        if (custom.vertexCount != 0) {
+            getStaticMesh(custom.vertices, custom.vertices, custom.vertexCount,
+                          custom.indices, custom.indexCount);
+        }
+    }
+    getCubeMesh();
+    getPyramidMesh();
+    getSphereMesh();
+    getSphereLodChain();
+}
+
+// Ключ состояния команды: сетка (тип и уровень детализации) в старших битах,
+// материал — в младших
+static std::uint32_t objectStateKey(const SceneObject& obj, int lod) {
+    std::uint32_t meshKey = static_cast<std::uint32_t>(obj.type) * 8u;
+    if (gScene.meshes[obj.type].vertexCount != 0) {
+        meshKey += 7u;
+    } else if (obj.type == PRIM_SPHERE && gLodEnabled) {
+        meshKey += static_cast<std::uint32_t>(lod);
+    } else {
+        meshKey += 6u;
+    }
+    return (meshKey << 16) | (static_cast<std::uint32_t>(obj.material) & 0xFFFFu);
+}
+
+// ═══════════════════════════════════════
+// Проигрывание команд 3D-примитивов в OpenGL
+// ═══════════════════════════════════════
+
+// Материал объекта; альфа рассеянного цвета — общая прозрачность
+static void glSetObjectMaterial(int material) {
+    const Material& mat = gScene.materials[material];
+    GLfloat diff[] = {mat.diffuse[0], mat.diffuse[1], mat.diffuse[2], transparency};
+    GLfloat shin[] = {mat.shininess};
+    glsMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,   diff);
+    glsMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR,  mat.specular);
+    glsMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, shin);
+}
+
+static void glDrawObject(const Mesh& mesh, const Mat4& modelView, int /*material*/) {
+    glLoadMatrixf(modelView.m);
+    drawMesh(mesh);
+}
+
+static const CommandBackend GL_OBJECT_BACKEND   = {glSetObjectMaterial, glDrawObject};
+static const CommandBackend CORE_OBJECT_BACKEND = {nullptr, coreDrawObject};
+
+// ═══════════════════════════════════════
+// Порядок рисования 3D-объектов: отсечение по пирамиде видимости
+// и сортировка полупрозрачных (общая часть OpenGL и программной отрисовки)
+// ═══════════════════════════════════════
+
+// Индексы видимых объектов в порядке рисования; clip — проекция * вид
+static const std::vector<std::uint32_t>& collectDrawOrder(const float clip[16], TransparencyMode mode) {
+    // Глубина центра каждого объекта вдоль направления взгляда (камера смотрит в начало координат)
+    static std::vector<std::uint32_t> visible;
+    static std::vector<float> viewDepth;
+    static std::vector<std::uint32_t> drawOrder;
+    static std::vector<std::uint32_t> order;
+
+    const std::size_t total = gScene.objects.size();
+    if (gCullingEnabled) {
+        PROFILE_SCOPE("cull3D");
+        Frustum frustum;
+        extractFrustum(clip, frustum);
+        gObjectBvh.cull(frustum, visible, gObjectCull);
+
+        // BVH выдаёт объекты в порядке обхода; без сортировки нужен порядок сцены
+        if (mode == TRANSPARENCY_UNSORTED) std::sort(visible.begin(), visible.end());
+    } else {
+        visible.resize(total);
+        for (std::size_t i = 0; i < total; ++i) visible[i] = static_cast<std::uint32_t>(i);
+        gObjectCull.visible = total;
+        gObjectCull.culled = 0;
+    }
+    profilerCounter("visibleObjects", static_cast<double>(gObjectCull.visible));
+    profilerCounter("culledObjects", static_cast<double>(gObjectCull.culled));
+
+    float fx = -camX;
+    float fy = -camY;
+    float fz = -camZ;
+    float fLen = std::sqrt(fx * fx + fy * fy + fz * fz);
+    if (fLen > 0.0f) {
+        fx /= fLen; fy /= fLen; fz /= fLen;
+    }
+
+    const std::size_t count = visible.size();
+    viewDepth.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        const float* p = gScene.objects[visible[i]].position;
+        viewDepth[i] = (p[0] - camX) * fx + (p[1] - camY) * fy + (p[2] - camZ) * fz;
+    }
+
+    {
+        PROFILE_SCOPE("sortTranslucent");
+        orderTranslucent(mode, viewDepth.data(), count, drawOrder);
+    }
+
+    order.resize(drawOrder.size());
+    for (std::size_t k = 0; k < drawOrder.size(); ++k) order[k] = visible[drawOrder[k]];
+    gObjectLod.resize(total, -1);
+    return order;
+}
+
+// Модельно-видовые матрицы объектов order — одним пакетным умножением на view
+static const std::vector<Mat4>& objectModelViews(const Mat4& view, const std::vector<std::uint32_t>& order) {
+    static std::vector<Mat4> models;
+    static std::vector<Mat4> modelViews;
+    models.resize(order.size());
+    modelViews.resize(order.size());
+    for (std::size_t k = 0; k < order.size(); ++k) models[k] = gObjectModel[order[k]];
+    mat4MultiplyBatch(view, models.data(), modelViews.data(), models.size());
+    return modelViews;
+}
+
+// ═══════════════════════════════════════
+// Запись команд 3D-примитивов в потоках пула
+// Куски по COMMAND_GRAIN объектов: исполнитель выбирает уровни детализации,
+// считает модельно-видовые матрицы пакетом в своей арене и пишет команды
+// ═══════════════════════════════════════
 
-    glPopMatrix();
+static const std::size_t COMMAND_GRAIN = 256;
+
+static CommandRecorder gObjectCommands;
+
+static void recordObjectCommands(const std::vector<std::uint32_t>& order, const Mat4& view) {
+    PROFILE_SCOPE("recordCommands");
+    prepareObjectMeshes();
+
+    ThreadPool& pool = ThreadPool::global();
+    gObjectCommands.begin(pool);
+    pool.parallelForStealing(order.size(), COMMAND_GRAIN,
+                             [&](std::size_t begin, std::size_t end, unsigned worker) {
+        CommandBuffer& buffer = gObjectCommands.buffer(worker);
+        const std::size_t n = end - begin;
+        Mat4* models = buffer.arena().allocateArray<Mat4>(n);
+        Mat4* modelViews = buffer.arena().allocateArray<Mat4>(n);
+        for (std::size_t k = 0; k < n; ++k) models[k] = gObjectModel[order[begin + k]];
+        mat4MultiplyBatch(view, models, modelViews, n);
+
+        for (std::size_t k = 0; k < n; ++k) {
+            const std::uint32_t index = order[begin + k];
+            const SceneObject& obj = gScene.objects[index];
+            int& lod = gObjectLod[index];
+            const Mesh& mesh = objectMesh(obj, lod);
+            buffer.draw(static_cast<std::uint32_t>(begin + k), objectStateKey(obj, lod), mesh,
+                        &modelViews[k], obj.material);
+        }
+    });
+}
 
-    // --- Сфера (справа) ---
-    glPushMatrix();
-    glTranslatef(1.5f, 0.0f, 0.0f);
+// ═══════════════════════════════════════
+// Рисование 3D-примитивов сцены (исходно — куб, пирамида, сфера)
+// ═══════════════════════════════════════
 
-    // Материал сферы — синий
-    GLfloat sphDiff[] = {0.15f, 0.35f, 0.85f, transparency};
-    GLfloat sphSpec[] = {1.0f, 1.0f, 1.0f, 1.0f};
-    GLfloat sphShin[] = {128.0f};
-    glMaterialfv(GL_FRONT_AND_BACK, GL_DIFFUSE,  sphDiff);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SPECULAR, sphSpec);
-    glMaterialfv(GL_FRONT_AND_BACK, GL_SHININESS, sphShin);
+// Нагрузочная сцена вместо объектов gScene: свой конвейер инстансинга
+static void drawStressObjects() {
+    StressFrame frame;
+    frame.projection = gProjection;
+    frame.view = gModelView;
+    for (int i = 0; i < 4; ++i) {
+        bool rgb = i < 3;
+        frame.light.position[i]     = LIGHT_POSITION[i];
+        frame.light.ambient[i]      = rgb ? LIGHT_AMBIENT : 1.0f;
+        frame.light.diffuse[i]      = rgb ? LIGHT_DIFFUSE : 1.0f;
+        frame.light.specular[i]     = rgb ? LIGHT_SPECULAR : 1.0f;
+        frame.light.modelAmbient[i] = rgb ? MODEL_AMBIENT : 1.0f;
+    }
+    frame.brightness = lightBrightness;
+    frame.alpha = transparency;
+    frame.mode = gTransparencyMode;
+    frame.cull = gCullingEnabled;
+    drawStressScene(frame);
+}
 
-    mySolidSphere(SPHERE_RADIUS, SPHERE_SLICES, SPHERE_STACKS);
+// 3D-лес вокруг объектов: непрозрачный, рисуется до них с записью глубины
+static void drawForest3DTrees() {
+    PROFILE_GPU_SCOPE("drawForest3D");
+    Forest3DFrame frame;
+    frame.projection = gProjection;
+    frame.view = gModelView;
+    frame.eye[0] = camX;
+    frame.eye[1] = camY;
+    frame.eye[2] = camZ;
+    frame.brightness = lightBrightness;
+    frame.cull = gCullingEnabled;
+    frame.occlusion = gOcclusionEnabled;
+    drawForest3D(frame);
+}
 
-    glPopMatrix();
+void draw3DObjects() {
+    PROFILE_GPU_SCOPE("draw3DObjects");
+
+    if (gForest3DActive) drawForest3DTrees();
+
+    if (gStressActive) {
+        drawStressObjects();
+        return;
+    }
+
+    // OIT недоступна — откатываемся на сортировку. Буферы накопления OIT без
+    // глубины, поэтому при непрозрачном трёхмерном лесе тоже нужна сортировка:
+    // иначе полупрозрачные объекты просвечивали бы сквозь деревья
+    TransparencyMode mode = gTransparencyMode;
+    if (mode == TRANSPARENCY_WEIGHTED_OIT && gForest3DActive) mode = TRANSPARENCY_SORTED;
+    bool oit = mode == TRANSPARENCY_WEIGHTED_OIT && beginWeightedOIT();
+    if (mode == TRANSPARENCY_WEIGHTED_OIT && !oit) mode = TRANSPARENCY_SORTED;
+
+    float clip[16];
+    currentClipMatrix(clip);
+    const std::vector<std::uint32_t>& order = collectDrawOrder(clip, mode);
+    recordObjectCommands(order, gModelView);
+
+    if (gl.coreProfile) {
+        CoreLight light;
+        for (int i = 0; i < 4; ++i) {
+            bool rgb = i < 3;
+            light.position[i]     = LIGHT_POSITION[i];
+            light.ambient[i]      = rgb ? LIGHT_AMBIENT : 1.0f;
+            light.diffuse[i]      = rgb ? LIGHT_DIFFUSE : 1.0f;
+            light.specular[i]     = rgb ? LIGHT_SPECULAR : 1.0f;
+            light.modelAmbient[i] = rgb ? MODEL_AMBIENT : 1.0f;
+        }
+        coreSetFrame(gProjection, light, lightBrightness, transparency);
+        coreBeginObjects();
+    }
+
+    // Отключить запись в буфер глубины для прозрачных объектов,
+    // чтобы задние грани были видны сквозь полупрозрачные передние
+    glsDepthMask(GL_FALSE);
+
+    // Порядок важен только без OIT; с ней команды группируются по сетке и материалу
+    {
+        PROFILE_SCOPE("submitCommands");
+        gFrameTriangles = gObjectCommands.submit(gl.coreProfile ? CORE_OBJECT_BACKEND : GL_OBJECT_BACKEND, oit);
+    }
+    profilerCounter("triangles3D", static_cast<double>(gFrameTriangles));
+    profilerCounter("drawCommands", static_cast<double>(gObjectCommands.commandCount()));
+    profilerCounter("commandArenaBytes", static_cast<double>(gObjectCommands.arenaBytes()));
+    if (gl.coreProfile) {
+        coreEndObjects();
+    } else {
+        glLoadMatrixf(gModelView.m);
+    }
 
     // Восстановить запись в буфер глубины
-    glDepthMask(GL_TRUE);
+    glsDepthMask(GL_TRUE);
+
+    if (oit) endWeightedOIT();
 }
 
 // ═══════════════════════════════════════
@@ -515,91 +746,304 @@ void draw3DObjects() {
 // ═══════════════════════════════════════
 
 void display() {
+    PROFILE_GPU_SCOPE("display");
+
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Сегмент кольца потоковых данных для этого кадра (ждёт, если GPU его ещё читает)
+    streamBeginFrame();
+
+    // Матрица вида считается на процессоре для обоих конвейеров
+    if (sceneMode == 0) {
+        gModelView = mat4Identity();
+    } else {
+        PROFILE_SCOPE("lookAt");
+        gModelView = mat4LookAt(camX, camY, camZ,
+                                0.0f, 0.0f, 0.0f,
+                                0.0f, 1.0f, 0.0f);
+    }
+
+    // Core-профиль: те же сцены шейдерами
+    if (gl.coreProfile) {
+        if (sceneMode == 0) {
+            drawForest();
+        } else {
+            draw3DObjects();
+        }
+        streamEndFrame();
+        glStateEndFrame();
+        return;
+    }
+
+    // Источник света задаётся при единичной модельно-видовой матрице
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
 
     if (sceneMode == 0) {
         // Режим 2D — отключить освещение, нарисовать лес
-        glDisable(GL_LIGHTING);
-        glPushMatrix();
+        glsDisable(GL_LIGHTING);
         drawForest();
-        glPopMatrix();
     } else {
         // Режим 3D — включить освещение, установить камеру
         setupLighting();
-        myLookAt(camX, camY, camZ,
-                 0.0, 0.0, 0.0,
-                 0.0, 1.0, 0.0);
+        glLoadMatrixf(gModelView.m);
         draw3DObjects();
-        glDisable(GL_LIGHTING);
+        // Освещение остаётся включённым до следующего кадра: 2D-ветка
+        // выключит его сама, а 3D-кадр не будет переключать его дважды
+    }
+    streamEndFrame();
+    glStateEndFrame();
+}
+
+// Кадр окна: при динамическом разрешении сцена рисуется в уменьшенный
+// внеэкранный буфер и растягивается на окно
+static void renderFrame() {
+    int w, h, renderW, renderH;
+    glfwGetFramebufferSize(gWindow, &w, &h);
+    if (!beginDynamicResolution(w, h, renderW, renderH)) {
+        display();
+        return;
     }
+    gViewportHeight = renderH; // уровни детализации — по пикселям настоящего кадра
+    display();
+    endDynamicResolution();
+    gViewportHeight = h > 0 ? h : 1;
+}
+
+// Отдать нарисованный кадр записи видео (до glfwSwapBuffers)
+static void captureFrame() {
+    if (!gRecorder.active()) return;
+    int w, h;
+    glfwGetFramebufferSize(gWindow, &w, &h);
+    gRecorder.captureFrame(w, h);
+}
+
+// Кадр замера: сцена сдвигается на --pan-speed перед отрисовкой
+static void benchDisplay() {
+    offsetX -= gBenchPanSpeed;
+    renderFrame();
+    captureFrame();
 }
 
 // ═══════════════════════════════════════
-// Обработка клавиш (колбэк GLFW)
+// Программная отрисовка (--software): та же сцена, что у display(),
+// растеризуется на процессоре без контекста OpenGL
 // ═══════════════════════════════════════
 
-void keyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int /*mods*/) {
-    // Реагируем на нажатие и повтор
-    if (action != GLFW_PRESS && action != GLFW_REPEAT) return;
+// Растеризатор программного режима (для кадров замера)
+static SoftRasterizer* gSoftRaster = nullptr;
+
+// Земля 2D-сцены — два треугольника, как glBegin(GL_QUADS)
+static void softwareGround(SoftRasterizer& sr, const Mat4& clip) {
+    static const float QUAD[4][2] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, -0.6f}, {-1.0f, -0.6f}};
+    static const int ORDER[6] = {0, 1, 2, 0, 2, 3};
+
+    SoftVertex v[6];
+    for (int i = 0; i < 6; ++i) {
+        float p[3] = {QUAD[ORDER[i]][0], QUAD[ORDER[i]][1], 0.0f};
+        transformPoint(clip, p, v[i].clip);
+        v[i].front[0] = v[i].back[0] = GROUND_R;
+        v[i].front[1] = v[i].back[1] = GROUND_G;
+        v[i].front[2] = v[i].back[2] = GROUND_B;
+        v[i].front[3] = v[i].back[3] = 1.0f;
+    }
+    sr.drawTriangles(v, 6);
+}
 
-    switch (key) {
-        // Перемещение 2D-сцены
-        case GLFW_KEY_A:
-            offsetX -= OFFSET_STEP;
-            offsetX = clampf(offsetX, OFFSET_X_MIN, OFFSET_X_MAX);
-            break;
-        case GLFW_KEY_D:
-            offsetX += OFFSET_STEP;
-            offsetX = clampf(offsetX, OFFSET_X_MIN, OFFSET_X_MAX);
-            break;
-        case GLFW_KEY_W:
-            offsetY += OFFSET_STEP;
-            offsetY = clampf(offsetY, OFFSET_Y_MIN, OFFSET_Y_MAX);
-            break;
-        case GLFW_KEY_S:
-            offsetY -= OFFSET_STEP;
-            offsetY = clampf(offsetY, OFFSET_Y_MIN, OFFSET_Y_MAX);
-            break;
+static void softwareForest(SoftRasterizer& sr) {
+    static std::vector<std::uint32_t> visible;
+    static std::vector<SoftVertex> vertices;
 
-        // Камера ближе / дальше (ось Z), без верхнего ограничения
-        case GLFW_KEY_Q:
-            camZ -= CAM_Z_STEP;
-            if (camZ < CAM_Z_MIN) camZ = CAM_Z_MIN;
-            break;
-        case GLFW_KEY_E:
-            camZ += CAM_Z_STEP;
-            break;
+    if (gInfiniteForest) {
+        static bool warned = false;
+        if (!warned) {
+            std::fprintf(stderr, "--software draws the fixed forest; --infinite-forest is ignored\n");
+            warned = true;
+        }
+    }
 
-        // Яркость освещения (+ / =)
-        case GLFW_KEY_EQUAL:
-        case GLFW_KEY_KP_ADD:
-            lightBrightness += BRIGHTNESS_STEP;
-            lightBrightness = clampf(lightBrightness, BRIGHTNESS_MIN, BRIGHTNESS_MAX);
-            break;
-        // Яркость освещения (-)
-        case GLFW_KEY_MINUS:
-        case GLFW_KEY_KP_SUBTRACT:
-            lightBrightness -= BRIGHTNESS_STEP;
-            lightBrightness = clampf(lightBrightness, BRIGHTNESS_MIN, BRIGHTNESS_MAX);
-            break;
+    Mat4 clip = mat4Ortho(-1.0f, 1.0f, -1.0f, 1.0f, -1.0f, 1.0f) * mat4Translate(offsetX, offsetY, 0.0f);
+    softwareGround(sr, clip);
 
-        // Прозрачность 3D-объектов
-        case GLFW_KEY_LEFT_BRACKET:
-            transparency -= TRANSPARENCY_STEP;
-            transparency = clampf(transparency, TRANSPARENCY_MIN, TRANSPARENCY_MAX);
-            break;
-        case GLFW_KEY_RIGHT_BRACKET:
-            transparency += TRANSPARENCY_STEP;
-            transparency = clampf(transparency, TRANSPARENCY_MIN, TRANSPARENCY_MAX);
-            break;
+    // Видимые деревья — как в updateForestVisibility()
+    {
+        PROFILE_SCOPE("cullForest");
+        if (gCullingEnabled) {
+            gTreeGrid.query(orthoViewRect(clip.m), visible, gTreeCull);
+        } else {
+            visible.resize(gScene.trees.size());
+            for (std::size_t i = 0; i < visible.size(); ++i) visible[i] = static_cast<std::uint32_t>(i);
+            gTreeCull.visible = visible.size();
+            gTreeCull.culled = 0;
+        }
+    }
+    profilerCounter("visibleTrees", static_cast<double>(gTreeCull.visible));
+    profilerCounter("culledTrees", static_cast<double>(gTreeCull.culled));
+
+    int treeVerts = 0;
+    const TreeVertex* unit = unitTreeVertices(treeVerts);
+    vertices.resize(visible.size() * treeVerts);
+    {
+        PROFILE_SCOPE("softVertices");
+        sr.pool().parallelFor(visible.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+            for (std::size_t i = begin; i < end; ++i) {
+                const TreeInstance& t = gScene.trees[visible[i]];
+                SoftVertex* dst = &vertices[i * treeVerts];
+                for (int k = 0; k < treeVerts; ++k) {
+                    float p[3] = {t.x + unit[k].x * t.scale, t.y + unit[k].y * t.scale, 0.0f};
+                    transformPoint(clip, p, dst[k].clip);
+                    dst[k].front[0] = dst[k].back[0] = unit[k].r;
+                    dst[k].front[1] = dst[k].back[1] = unit[k].g;
+                    dst[k].front[2] = dst[k].back[2] = unit[k].b;
+                    dst[k].front[3] = dst[k].back[3] = 1.0f;
+                }
+            }
+        });
+    }
+    sr.drawTriangles(vertices.data(), vertices.size());
+}
+
+static void softwareObjects(SoftRasterizer& sr) {
+    static std::vector<const Mesh*> meshes;
+    static std::vector<std::size_t> firstVertex;
+    static std::vector<SoftVertex> vertices;
+
+    float aspect = static_cast<float>(sr.width()) / static_cast<float>(sr.height());
+    Mat4 proj = mat4Perspective(static_cast<float>(FOV_Y), aspect,
+                                static_cast<float>(Z_NEAR), static_cast<float>(Z_FAR));
+    Mat4 view = mat4LookAt(camX, camY, camZ, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    Mat4 clip = proj * view;
+
+    // Порядок смешивания взвешенной OIT зависит от буферов OpenGL — здесь сортировка
+    TransparencyMode mode = gTransparencyMode;
+    if (mode == TRANSPARENCY_WEIGHTED_OIT) mode = TRANSPARENCY_SORTED;
+    const std::vector<std::uint32_t>& order = collectDrawOrder(clip.m, mode);
+
+    // Меши выбираются последовательно (кеш мешей и гистерезис LOD), вершины — параллельно
+    meshes.resize(order.size());
+    firstVertex.resize(order.size() + 1);
+    firstVertex[0] = 0;
+    for (std::size_t k = 0; k < order.size(); ++k) {
+        std::uint32_t index = order[k];
+        meshes[k] = &objectMesh(gScene.objects[index], gObjectLod[index]);
+        firstVertex[k + 1] = firstVertex[k] + meshes[k]->indices.size();
+    }
+    vertices.resize(firstVertex.back());
+    gFrameTriangles = vertices.size() / 3;
+    const std::vector<Mat4>& modelViews = objectModelViews(view, order);
+
+    // Источник света как в setupLighting(): задан при единичной модельно-видовой матрице
+    SoftLight light;
+    for (int i = 0; i < 4; ++i) {
+        bool rgb = i < 3;
+        light.position[i]     = LIGHT_POSITION[i];
+        light.ambient[i]      = rgb ? LIGHT_AMBIENT * lightBrightness : 1.0f;
+        light.diffuse[i]      = rgb ? LIGHT_DIFFUSE * lightBrightness : 1.0f;
+        light.specular[i]     = rgb ? LIGHT_SPECULAR * lightBrightness : 1.0f;
+        light.modelAmbient[i] = rgb ? MODEL_AMBIENT : 1.0f;
+    }
+
+    {
+        PROFILE_SCOPE("softVertices");
+        sr.pool().parallelFor(order.size(), [&](std::size_t begin, std::size_t end, unsigned) {
+            std::vector<SoftVertex> verts; // вершины меша до развёртки по индексам
+            std::vector<float> eyes, normals; // координаты глаза (по 4) и нормали (по 3)
+            for (std::size_t k = begin; k < end; ++k) {
+                const SceneObject& obj = gScene.objects[order[k]];
+                const Material& m = gScene.materials[obj.material];
+                SoftMaterial mat = {{0.2f, 0.2f, 0.2f, 1.0f},
+                                    {m.diffuse[0], m.diffuse[1], m.diffuse[2], transparency},
+                                    {m.specular[0], m.specular[1], m.specular[2], m.specular[3]},
+                                    m.shininess};
+
+                const Mesh& mesh = *meshes[k];
+                std::size_t vertexCount = mesh.vertices.size();
+                verts.resize(vertexCount);
+                eyes.resize(vertexCount * 4);
+                normals.resize(vertexCount * 3);
+
+                // Позиции и нормали меша — пакетом в координаты глаза
+                const std::size_t stride = sizeof(MeshVertex) / sizeof(float);
+                transformPoints(modelViews[k], &mesh.vertices[0].px, stride, eyes.data(), vertexCount);
+                transformVectors(modelViews[k], &mesh.vertices[0].nx, stride, normals.data(), vertexCount);
+
+                for (std::size_t i = 0; i < vertexCount; ++i) {
+                    const float* eye = &eyes[i * 4];
+                    float* normal = &normals[i * 3];
+
+                    // GL_NORMALIZE
+                    float len = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+                    if (len > 0.0f) {
+                        normal[0] /= len; normal[1] /= len; normal[2] /= len;
+                    }
+                    float backNormal[3] = {-normal[0], -normal[1], -normal[2]};
+
+                    SoftVertex& v = verts[i];
+                    transformPoint(proj, eye, v.clip);
+                    softLightVertex(light, mat, eye, normal, v.front);
+                    softLightVertex(light, mat, eye, backNormal, v.back);
+                }
+
+                SoftVertex* dst = &vertices[firstVertex[k]];
+                for (unsigned int index : mesh.indices) *dst++ = verts[index];
+            }
+        });
+    }
+    profilerCounter("triangles3D", static_cast<double>(gFrameTriangles));
+
+    // Как в draw3DObjects(): тест глубины без записи
+    SoftState state;
+    state.depthWrite = false;
+    sr.setState(state);
+    sr.drawTriangles(vertices.data(), vertices.size());
+    sr.setState(SoftState());
+}
+
+// Кадр программной отрисовки: то же содержимое, что у display()
+static void displaySoftware(SoftRasterizer& sr) {
+    sr.clear(SKY_R, SKY_G, SKY_B, 1.0f);
+    if (sceneMode == 0) {
+        softwareForest(sr);
+    } else {
+        softwareObjects(sr);
+    }
+    PROFILE_SCOPE("softRaster");
+    sr.finish();
+}
+
+static void softwareBenchDisplay() {
+    offsetX -= gBenchPanSpeed;
+    displaySoftware(*gSoftRaster);
+}
+
+// ═══════════════════════════════════════
+// Обработка клавиш (колбэк GLFW)
+// ═══════════════════════════════════════
 
+void keyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int /*mods*/) {
+    // Движение и яркость — дело потока симуляции: ему нужны нажатие и отпускание,
+    // автоповтор не нужен (удержание он помнит сам)
+    if (gSim && Simulation::handlesKey(key)) {
+        if (action == GLFW_PRESS) {
+            gSim->post({SIM_KEY_DOWN, key, 0});
+        } else if (action == GLFW_RELEASE) {
+            gSim->post({SIM_KEY_UP, key, 0});
+        }
+        gNeedsRedraw = true;
+        return;
+    }
+
+    // Остальные клавиши реагируют на нажатие и повтор
+    if (action != GLFW_PRESS && action != GLFW_REPEAT) return;
+
+    // Любая обработанная клавиша может изменить картинку
+    gNeedsRedraw = true;
+
+    switch (key) {
         // Переключение режимов
         case GLFW_KEY_1: {
             sceneMode = 0;
-            offsetX = 0.0f;
-            offsetY = 0.0f;
+            if (gSim) gSim->post({SIM_RESET_OFFSET, 0, 0});
             int w, h;
             glfwGetFramebufferSize(window, &w, &h);
             reshape(w, h);
@@ -613,18 +1057,40 @@ void keyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int
             break;
         }
 
-        // Стрелки — перемещение камеры (3D), без ограничений
-        case GLFW_KEY_LEFT:
-            camX -= CAM_XY_STEP;
+        // Режим прозрачности: без сортировки -> с сортировкой -> OIT
+        case GLFW_KEY_O:
+            gTransparencyMode = static_cast<TransparencyMode>((gTransparencyMode + 1) % 3);
+            std::printf("Transparency: %s\n", transparencyModeName(gTransparencyMode));
+            break;
+
+        // Уровни детализации сферы вкл/выкл
+        case GLFW_KEY_L:
+            gLodEnabled = !gLodEnabled;
+            std::printf("Sphere LOD: %s\n", gLodEnabled ? "on" : "off");
             break;
-        case GLFW_KEY_RIGHT:
-            camX += CAM_XY_STEP;
+
+        // Бесконечный лес вкл/выкл (при выключении сцена возвращается в исходные границы)
+        case GLFW_KEY_F:
+            gInfiniteForest = !gInfiniteForest;
+            if (gSim) gSim->post({SIM_LIMIT_OFFSET_X, 0, gInfiniteForest ? 0 : 1});
+            std::printf("Infinite forest: %s\n", gInfiniteForest ? "on" : "off");
             break;
-        case GLFW_KEY_UP:
-            camY += CAM_XY_STEP;
+
+        // Отсечение по пирамиде видимости вкл/выкл
+        case GLFW_KEY_C:
+            gCullingEnabled = !gCullingEnabled;
+            std::printf("Frustum culling: %s\n", gCullingEnabled ? "on" : "off");
+            break;
+
+        // Отсечение перекрытых деревьев 3D-леса вкл/выкл
+        case GLFW_KEY_H:
+            gOcclusionEnabled = !gOcclusionEnabled;
+            std::printf("Occlusion culling: %s\n", gOcclusionEnabled ? "on" : "off");
             break;
-        case GLFW_KEY_DOWN:
-            camY -= CAM_XY_STEP;
+
+        // Сводка профилировщика (при --profile / --trace)
+        case GLFW_KEY_P:
+            profilerPrintSummary(stdout);
             break;
 
         // Выход по ESC
@@ -637,18 +1103,195 @@ void keyCallback(GLFWwindow* window, int key, int /*scancode*/, int action, int
     }
 }
 
+// ═══════════════════════════════════════
+// Запуск
+// ═══════════════════════════════════════
+
+// Параметры из командной строки и содержимое сцен (общее для OpenGL и --software)
+static bool setupScene(const AppOptions& options) {
+    const BenchOptions& bench = options.bench;
+
+    gTransparencyMode = options.transparency;
+    gLodEnabled = !options.noLod;
+    setMeshOptimization(options.optimizeMeshes);
+    gCullingEnabled = !options.noCull;
+    gOcclusionEnabled = !options.noOcclusion;
+    gInfiniteForest = options.infiniteForest;
+    if (options.chunkTrees > 0) gChunkTrees = options.chunkTrees;
+    gBenchPanSpeed = static_cast<float>(bench.panSpeed);
+
+    // Профилировщик фаз кадра
+    if (options.profile || !options.tracePath.empty()) {
+        profilerInit(options.tracePath.c_str());
+    }
+
+    // Содержимое сцен: исходное или нагрузочное для замера
+    buildDefaultScene(gScene);
+    if (!options.sceneFile.empty() && !loadSceneFile(options.sceneFile.c_str(), gScene)) {
+        return false;
+    }
+    if (bench.trees >= 0) {
+        generateForest(gScene, static_cast<std::size_t>(bench.trees), BENCH_SEED);
+    }
+    if (bench.objects >= 0) {
+        generateObjectGrid(gScene, static_cast<std::size_t>(bench.objects));
+    }
+    setForestInstances(gForest, gScene.trees.data(), gScene.trees.size());
+    buildSceneIndex();
+    if (options.stressCount > 0) {
+        generateStressInstances(gStressInstances, static_cast<std::size_t>(options.stressCount),
+                                static_cast<float>(options.stressSpacing), BENCH_SEED);
+    }
+    if (options.forest3dCount > 0) {
+        generateForest3D(gForest3DTrees, static_cast<std::size_t>(options.forest3dCount), FOREST3D_SPACING,
+                         FOREST3D_CLEARING, FOREST3D_GROUND_Y, BENCH_SEED);
+    }
+    return true;
+}
+
+// Материал типа для нагрузочной сцены: как у первого объекта этого типа в gScene
+static void stressMaterials(Material out[PRIM_COUNT]) {
+    for (int t = 0; t < PRIM_COUNT; ++t) {
+        out[t] = gScene.materials[0];
+        for (const SceneObject& obj : gScene.objects) {
+            if (obj.type == t) {
+                out[t] = gScene.materials[obj.material];
+                break;
+            }
+        }
+    }
+}
+
+// Прочитать задний буфер и записать в файл
+static bool saveFramebuffer(const char* path, int width, int height) {
+    std::vector<std::uint8_t> rgba(static_cast<std::size_t>(width) * height * 4);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, rgba.data());
+    return writeImage(path, rgba.data(), width, height, true);
+}
+
+// --software: один кадр (--scene, --width, --height) в --output или замер при --bench
+static int runSoftware(const AppOptions& options) {
+    const BenchOptions& bench = options.bench;
+    if (!bench.enabled && options.outputPath.empty()) {
+        std::fprintf(stderr, "--software needs --output FILE or --bench\n");
+        return 2;
+    }
+    if (!options.recordPath.empty()) {
+        std::fprintf(stderr, "--record needs an OpenGL context; ignored with --software\n");
+    }
+    if (options.dynamicResMs > 0.0) {
+        std::fprintf(stderr, "--dynamic-res needs an OpenGL context; ignored with --software\n");
+    }
+    if (options.stressCount > 0) {
+        std::fprintf(stderr, "--stress needs an OpenGL context; ignored with --software\n");
+    }
+    if (options.forest3dCount > 0) {
+        std::fprintf(stderr, "--forest3d needs an OpenGL context; ignored with --software\n");
+    }
+
+    if (!setupScene(options)) return 2;
+    sceneMode = bench.scene;
+    gViewportHeight = bench.height;
+
+    std::unique_ptr<ThreadPool> ownPool;
+    if (options.threads > 0) ownPool.reset(new ThreadPool(static_cast<unsigned>(options.threads)));
+    ThreadPool& pool = ownPool ? *ownPool : ThreadPool::global();
+
+    SoftRasterizer raster(pool);
+    raster.resize(bench.width, bench.height);
+    gSoftRaster = &raster;
+
+    int exitCode = 0;
+    if (bench.enabled) {
+        char renderer[64];
+        std::snprintf(renderer, sizeof(renderer), "software rasterizer, %u threads", pool.size());
+        std::size_t items = sceneMode == 0 ? gScene.trees.size() : gScene.objects.size();
+        exitCode = runSoftwareBenchmark(bench, softwareBenchDisplay, items, renderer);
+    } else {
+        displaySoftware(raster);
+    }
+
+    if (!options.outputPath.empty() &&
+        !writeImage(options.outputPath.c_str(), raster.pixels(), raster.width(), raster.height(), true)) {
+        exitCode = 1;
+    }
+
+    gSoftRaster = nullptr;
+    profilerShutdown();
+    return exitCode;
+}
+
 // ═══════════════════════════════════════
 // Точка входа
 // ═══════════════════════════════════════
 
-int main(int /*argc*/, char** /*argv*/) {
+int main(int argc, char** argv) {
+    // Параметры командной строки
+    AppOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+    const BenchOptions& bench = options.bench;
+
+    // Сборка двоичного файла сцены из текста: ни окна, ни отрисовки
+    if (!options.convertInput.empty()) {
+        return convertSceneText(options.convertInput.c_str(), options.convertOutput.c_str()) ? 0 : 1;
+    }
+
+    // Отчёт по сеткам примитивов: тоже без окна
+    if (options.meshStats) {
+        printPrimitiveMeshStats(stdout);
+        return 0;
+    }
+
+    // Отрисовка на процессоре: ни окна, ни контекста OpenGL
+    if (options.software) {
+        return runSoftware(options);
+    }
+
+    // Без дисплея: нулевая платформа GLFW и программный контекст OSMesa (GLFW 3.4+)
+    if (bench.headless) {
+#if defined(GLFW_PLATFORM_NULL)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+        std::fprintf(stderr, "--headless requires GLFW 3.4; using a hidden window\n");
+#endif
+    }
+
     // Инициализация GLFW
     if (!glfwInit()) {
         return -1;
     }
 
-    // Создание окна
-    gWindow = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, "OpenGL Lab 1", nullptr, nullptr);
+    // Создание окна (для замера — невидимого и заданного размера)
+    int winW = WINDOW_WIDTH;
+    int winH = WINDOW_HEIGHT;
+    if (bench.enabled) {
+        winW = bench.width;
+        winH = bench.height;
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+#if defined(GLFW_PLATFORM_NULL)
+        if (bench.headless) glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+#endif
+    }
+
+    // Core-профиль OpenGL 3.3: только шейдеры; не удалось — обычный контекст
+    if (options.core) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+    }
+    gWindow = glfwCreateWindow(winW, winH, "OpenGL Lab 1", nullptr, nullptr);
+    if (!gWindow && options.core) {
+        std::fprintf(stderr, "OpenGL 3.3 core profile is not available; using the compatibility path\n");
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 1);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 0);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_ANY_PROFILE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_FALSE);
+        gWindow = glfwCreateWindow(winW, winH, "OpenGL Lab 1", nullptr, nullptr);
+    }
     if (!gWindow) {
         glfwTerminate();
         return -1;
@@ -660,26 +1303,152 @@ int main(int /*argc*/, char** /*argv*/) {
     // Регистрация колбэков
     glfwSetFramebufferSizeCallback(gWindow, framebufferSizeCallback);
     glfwSetKeyCallback(gWindow, keyCallback);
+    glfwSetWindowRefreshCallback(gWindow, windowRefreshCallback);
 
     // Инициализация OpenGL
     initGL();
+    if (!options.noStreamRing) initStreamRing();
+    initDynamicResolution(options.dynamicResMs, static_cast<float>(options.minScale));
+    if (gl.coreProfile && !initCoreRenderer()) {
+        std::fprintf(stderr, "Cannot build the OpenGL 3.3 core pipeline\n");
+        glfwDestroyWindow(gWindow);
+        glfwTerminate();
+        return -1;
+    }
+
+    if (!setupScene(options)) {
+        releaseStreamRing();
+        releaseCoreRenderer();
+        glfwDestroyWindow(gWindow);
+        glfwTerminate();
+        return 2;
+    }
+    if (gl.coreProfile) coreSetMaterials(gScene.materials.data(), gScene.materials.size());
+    if (!gStressInstances.empty()) {
+        Material materials[PRIM_COUNT];
+        stressMaterials(materials);
+        gStressActive = initStressRenderer(gStressInstances.data(), gStressInstances.size(),
+                                           materials, options.stressSubmit);
+        if (!gStressActive) {
+            std::fprintf(stderr, "The stress scene needs OpenGL 3.3 shaders and instancing; "
+                                 "drawing the regular objects\n");
+        }
+    }
+    if (!gForest3DTrees.empty()) {
+        gForest3DActive = initForest3D(gForest3DTrees.data(), gForest3DTrees.size(),
+                                       static_cast<float>(options.impostorDistance), LIGHT_POSITION);
+        if (gForest3DActive) {
+            // Лес виден до края из любой точки внутри него
+            gZFar = std::max(gZFar, 2.0f * forest3DRadius());
+        } else {
+            std::fprintf(stderr, "The 3D forest needs OpenGL 3.3 shaders, instancing and "
+                                 "framebuffer objects; skipped\n");
+        }
+    }
+    if (bench.enabled) {
+        sceneMode = bench.scene;
+    }
 
     // Первоначальная настройка проекции
     {
         int w, h;
         glfwGetFramebufferSize(gWindow, &w, &h);
         reshape(w, h);
+
+        if (!options.recordPath.empty() &&
+            !gRecorder.start(options.recordPath, w, h, options.recordFps)) {
+            glfwDestroyWindow(gWindow);
+            glfwTerminate();
+            return -1;
+        }
     }
 
-    // Главный цикл отрисовки
-    while (!glfwWindowShouldClose(gWindow)) {
-        display();
-        glfwSwapBuffers(gWindow);
-        glfwPollEvents();
+    int exitCode = 0;
+    if (bench.enabled) {
+        // Замер фиксированного числа кадров
+        std::size_t items = sceneMode == 0 ? gScene.trees.size() : gScene.objects.size();
+        if (sceneMode == 1 && gStressActive) items = gStressInstances.size();
+        if (sceneMode == 0 && gInfiniteForest) {
+            items = static_cast<std::size_t>(gChunkTrees * 2.0f / FOREST_CHUNK_WIDTH);
+        }
+        exitCode = runBenchmark(gWindow, bench, benchDisplay, items);
+
+        // Ещё один кадр — в файл (эталонные изображения для программной отрисовки)
+        if (!options.outputPath.empty()) {
+            display();
+            if (!saveFramebuffer(options.outputPath.c_str(), winW, winH)) exitCode = 1;
+        }
+    } else {
+        // Главный цикл отрисовки
+        applyVsync(options.vsync);
+        FrameLimiter limiter(options.onDemand ? 0.0 : options.fpsLimit);
+        gSim.reset(new Simulation({offsetX, offsetY, camX, camY, camZ, lightBrightness, transparency},
+                                  !gInfiniteForest));
+
+        bool simMoved = false; // последний кадр застал движение: нужен ещё кадр с конечным положением
+        while (!glfwWindowShouldClose(gWindow)) {
+            // По требованию: спать в ожидании событий, пока сцена не изменилась
+            // и ничего не движется. Начало и конец движения будят цикл из потока симуляции
+            const bool simMoving = gSim->moving();
+            if (options.onDemand && !gNeedsRedraw && !simMoving && !simMoved) {
+                if (options.redrawTimeout > 0.0) {
+                    glfwWaitEventsTimeout(options.redrawTimeout);
+                    gNeedsRedraw = true; // анимациям нужен кадр и по таймауту
+                } else {
+                    glfwWaitEvents();
+                }
+                continue;
+            }
+            gNeedsRedraw = false;
+            simMoved = simMoving;
+
+            profilerBeginFrame();
+            {
+                // Состояние между двумя последними шагами симуляции
+                SimState st = gSim->sample();
+                offsetX = st.offsetX;
+                offsetY = st.offsetY;
+                camX = st.camX;
+                camY = st.camY;
+                camZ = st.camZ;
+                lightBrightness = st.lightBrightness;
+                transparency = st.transparency;
+            }
+            renderFrame();
+            captureFrame();
+            {
+                PROFILE_SCOPE("glfwSwapBuffers");
+                glfwSwapBuffers(gWindow);
+            }
+            {
+                PROFILE_SCOPE("glfwPollEvents");
+                glfwPollEvents();
+            }
+            profilerEndFrame();
+
+            limiter.wait();
+        }
+        profilerPrintSummary(stdout);
+        gSim.reset();
     }
 
     // Освобождение ресурсов
+    gRecorder.stop();
+    profilerShutdown();
+    releaseTransparency();
+    releaseDynamicResolution();
+    releaseStressRenderer();
+    releaseForest3D();
+    if (gForestStream) {
+        gForestStream->releaseBuffers();
+        gForestStream.reset();
+    }
+    releaseForestBatch(gForest);
+    releaseForestRenderer();
+    releaseMeshCache();
+    releaseStreamRing();
+    releaseCoreRenderer();
     glfwDestroyWindow(gWindow);
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
@@ -0,0 +1,130 @@
+// ═══════════════════════════════════════
+// Индексированные меши с кешированием
+// ═══════════════════════════════════════
+
+#include "mesh.h"
+#include "gl_ext.h"
+#include "mesh_optimizer.h"
+
+#include <cstddef>
+#include <map>
+
+// ═══════════════════════════════════════
+// Кеш мешей
+// ═══════════════════════════════════════
+
+static bool gOptimizeMeshes = false;
+
+void setMeshOptimization(bool enabled) {
+    gOptimizeMeshes = enabled;
+}
+
+static std::map<const void*, Mesh>& meshCache() {
+    static std::map<const void*, Mesh> cache;
+    return cache;
+}
+
+const Mesh& getStaticMesh(const void* key, const MeshVertex* vertices, std::size_t vertexCount,
+                          const unsigned int* indices, std::size_t indexCount) {
+    std::map<const void*, Mesh>& cache = meshCache();
+    auto it = cache.find(key);
+    if (it == cache.end()) {
+        it = cache.emplace(key, Mesh()).first;
+        Mesh& mesh = it->second;
+        mesh.vertices.assign(vertices, vertices + vertexCount);
+        mesh.indices.assign(indices, indices + indexCount);
+        mesh.mode = GL_TRIANGLES;
+        if (gOptimizeMeshes) optimizeMesh(mesh.vertices, mesh.indices);
+        uploadMesh(mesh);
+    }
+    return it->second;
+}
+
+// ═══════════════════════════════════════
+// Загрузка и отрисовка
+// ═══════════════════════════════════════
+
+void uploadMesh(Mesh& mesh) {
+    mesh.uploaded = true;
+    if (!gl.hasVBO) return; // остаёмся на клиентских массивах
+
+    gl.GenBuffers(1, &mesh.vbo);
+    gl.BindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    gl.BufferData(GL_ARRAY_BUFFER,
+                  static_cast<std::ptrdiff_t>(mesh.vertices.size() * sizeof(MeshVertex)),
+                  mesh.vertices.data(), GL_STATIC_DRAW);
+
+    gl.GenBuffers(1, &mesh.ibo);
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+    gl.BufferData(GL_ELEMENT_ARRAY_BUFFER,
+                  static_cast<std::ptrdiff_t>(mesh.indices.size() * sizeof(unsigned int)),
+                  mesh.indices.data(), GL_STATIC_DRAW);
+
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // Core-профиль: формат вершин и индексный буфер запоминаются в VAO
+    if (gl.coreProfile && gl.hasUniformBuffers) {
+        const GLsizei stride = sizeof(MeshVertex);
+        gl.GenVertexArrays(1, &mesh.vao);
+        gl.BindVertexArray(mesh.vao);
+        gl.BindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        gl.EnableVertexAttribArray(MESH_ATTR_POSITION);
+        gl.EnableVertexAttribArray(MESH_ATTR_NORMAL);
+        gl.VertexAttribPointer(MESH_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, stride,
+                               attribPointer(nullptr, offsetof(MeshVertex, px)));
+        gl.VertexAttribPointer(MESH_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE, stride,
+                               attribPointer(nullptr, offsetof(MeshVertex, nx)));
+        gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+        gl.BindVertexArray(0);
+        gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+}
+
+void drawMesh(const Mesh& mesh) {
+    if (mesh.vao != 0) {
+        gl.BindVertexArray(mesh.vao);
+        glDrawElements(mesh.mode, static_cast<GLsizei>(mesh.indices.size()), GL_UNSIGNED_INT, nullptr);
+        gl.BindVertexArray(0);
+        return;
+    }
+
+    const GLsizei stride = sizeof(MeshVertex);
+
+    // Без VBO указатели смотрят в оперативную память, с VBO — это смещения в буфере
+    const void* base    = mesh.vertices.data();
+    const void* indices = mesh.indices.data();
+    if (mesh.vbo != 0) {
+        base    = nullptr;
+        indices = nullptr;
+        gl.BindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.ibo);
+    }
+
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glVertexPointer(3, GL_FLOAT, stride, attribPointer(base, offsetof(MeshVertex, px)));
+    glNormalPointer(GL_FLOAT, stride, attribPointer(base, offsetof(MeshVertex, nx)));
+
+    glDrawElements(mesh.mode, static_cast<GLsizei>(mesh.indices.size()),
+                   GL_UNSIGNED_INT, indices);
+
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    if (mesh.vbo != 0) {
+        gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+        gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+}
+
+void releaseMeshCache() {
+    std::map<const void*, Mesh>& cache = meshCache();
+    for (auto& entry : cache) {
+        Mesh& mesh = entry.second;
+        if (mesh.vbo != 0) gl.DeleteBuffers(1, &mesh.vbo);
+        if (mesh.ibo != 0) gl.DeleteBuffers(1, &mesh.ibo);
+        if (mesh.vao != 0) gl.DeleteVertexArrays(1, &mesh.vao);
+    }
+    cache.clear();
+}
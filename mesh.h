@@ -0,0 +1,55 @@
+// ═══════════════════════════════════════
+// Индексированные меши с кешированием
+// Геометрия собирается при компиляции (mesh_tables.h), загружается в VBO/IBO
+// и рисуется одним вызовом glDrawElements
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+#include <cstddef>
+#include <vector>
+
+// Вершина меша: позиция и нормаль, чередуются в одном массиве
+struct MeshVertex {
+    float px, py, pz;
+    float nx, ny, nz;
+};
+
+// Индексы атрибутов вершин меша для шейдеров core-профиля
+static const GLuint MESH_ATTR_POSITION = 0;
+static const GLuint MESH_ATTR_NORMAL   = 1;
+
+// Меш в оперативной памяти и его буферы на видеокарте
+struct Mesh {
+    std::vector<MeshVertex>   vertices;
+    std::vector<unsigned int> indices;
+    GLenum mode = GL_TRIANGLES;
+
+    // Буферы OpenGL (0 — ещё не загружены или VBO недоступны)
+    GLuint vbo = 0;
+    GLuint ibo = 0;
+    GLuint vao = 0; // только в core-профиле: атрибуты MESH_ATTR_* и индексный буфер
+    bool uploaded = false;
+};
+
+// Оптимизировать меши при построении (mesh_optimizer.h): слияние вершин и
+// перестановка треугольников. Меняет порядок смешивания полупрозрачных граней,
+// поэтому по умолчанию выключено; действует на меши, построенные после вызова
+void setMeshOptimization(bool enabled);
+
+// Меш из готовых массивов вершин и индексов (GL_TRIANGLES), например из таблиц
+// mesh_tables.h; строится и загружается при первом запросе для ключа key
+const Mesh& getStaticMesh(const void* key, const MeshVertex* vertices, std::size_t vertexCount,
+                          const unsigned int* indices, std::size_t indexCount);
+
+// Загрузить меш в VBO/IBO (если буферы доступны)
+void uploadMesh(Mesh& mesh);
+
+// Нарисовать меш одним индексированным вызовом (в core-профиле — из VAO
+// текущей шейдерной программой)
+void drawMesh(const Mesh& mesh);
+
+// Освободить буферы всех кешированных мешей (до уничтожения контекста)
+void releaseMeshCache();
@@ -0,0 +1,483 @@
+// ═══════════════════════════════════════
+// Оптимизация индексированных мешей: кеш вершин и перерисовка
+// ═══════════════════════════════════════
+
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+
+// Точность слияния вершин (позиции и нормали)
+static const float WELD_EPSILON = 1e-6f;
+
+// Модель кеша алгоритма Форсайта (LRU) и веса его оценки вершин
+static const int   FORSYTH_CACHE_SIZE = 32;
+static const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+static const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+static const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+static const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+// Сторона растра для замера перерисовки
+static const int OVERDRAW_GRID = 256;
+
+// ═══════════════════════════════════════
+// Слияние вершин
+// ═══════════════════════════════════════
+
+// Вершина на сетке WELD_EPSILON
+struct WeldKey {
+    long long q[6];
+
+    bool operator==(const WeldKey& o) const {
+        for (int i = 0; i < 6; ++i) {
+            if (q[i] != o.q[i]) return false;
+        }
+        return true;
+    }
+};
+
+struct WeldKeyHash {
+    std::size_t operator()(const WeldKey& k) const {
+        std::uint64_t h = 1469598103934665603ull;
+        for (long long v : k.q) {
+            h ^= static_cast<std::uint64_t>(v);
+            h *= 1099511628211ull;
+        }
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+};
+
+static WeldKey weldKey(const MeshVertex& v) {
+    const float f[6] = {v.px, v.py, v.pz, v.nx, v.ny, v.nz};
+    WeldKey k;
+    for (int i = 0; i < 6; ++i) k.q[i] = std::llround(static_cast<double>(f[i]) / WELD_EPSILON);
+    return k;
+}
+
+std::size_t weldMesh(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices) {
+    std::unordered_map<WeldKey, unsigned int, WeldKeyHash> unique;
+    unique.reserve(vertices.size());
+    std::vector<unsigned int> remap(vertices.size());
+    std::vector<MeshVertex> welded;
+    welded.reserve(vertices.size());
+
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        auto it = unique.emplace(weldKey(vertices[i]), static_cast<unsigned int>(welded.size())).first;
+        if (it->second == welded.size()) welded.push_back(vertices[i]);
+        remap[i] = it->second;
+    }
+
+    // Треугольники, у которых слились вершины (полюса сферы), площади не имеют
+    std::vector<unsigned int> kept;
+    kept.reserve(indices.size());
+    for (std::size_t t = 0; t + 2 < indices.size(); t += 3) {
+        unsigned int a = remap[indices[t]], b = remap[indices[t + 1]], c = remap[indices[t + 2]];
+        if (a == b || b == c || a == c) continue;
+        kept.push_back(a);
+        kept.push_back(b);
+        kept.push_back(c);
+    }
+
+    vertices.swap(welded);
+    indices.swap(kept);
+    return vertices.size();
+}
+
+// ═══════════════════════════════════════
+// Кеш вершин: линейный алгоритм Форсайта
+// Каждой вершине даётся оценка по месту в модели кеша и числу ещё не
+// выведенных треугольников; жадно выводится треугольник с наибольшей суммой
+// ═══════════════════════════════════════
+
+static float forsythScore(int cachePosition, unsigned int remaining) {
+    if (remaining == 0) return -1.0f; // вершина больше не нужна
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // Вершины только что выведенного треугольника — чуть ниже, чтобы не
+        // выводить полосу, а расти пятном
+        if (cachePosition < 3) {
+            score = FORSYTH_LAST_TRIANGLE_SCORE;
+        } else {
+            const float scale = 1.0f / (FORSYTH_CACHE_SIZE - 3);
+            score = std::pow(1.0f - (cachePosition - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+        }
+    }
+    // Вершины с немногими оставшимися треугольниками — вперёд, чтобы не оставлять одиночек
+    score += FORSYTH_VALENCE_BOOST_SCALE *
+             std::pow(static_cast<float>(remaining), -FORSYTH_VALENCE_BOOST_POWER);
+    return score;
+}
+
+void optimizeVertexCache(std::vector<unsigned int>& indices, std::size_t vertexCount) {
+    const std::size_t triCount = indices.size() / 3;
+    if (triCount < 2) return;
+
+    // Треугольники каждой вершины (подряд, первые remaining[v] — ещё не выведенные)
+    std::vector<unsigned int> remaining(vertexCount, 0);
+    for (unsigned int v : indices) ++remaining[v];
+    std::vector<std::size_t> offset(vertexCount + 1, 0);
+    for (std::size_t v = 0; v < vertexCount; ++v) offset[v + 1] = offset[v] + remaining[v];
+    std::vector<unsigned int> adjacency(indices.size());
+    {
+        std::vector<std::size_t> fill(offset.begin(), offset.end() - 1);
+        for (std::size_t t = 0; t < triCount; ++t) {
+            for (int k = 0; k < 3; ++k) adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>(t);
+        }
+    }
+
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (std::size_t v = 0; v < vertexCount; ++v) vertexScore[v] = forsythScore(-1, remaining[v]);
+
+    std::vector<float> triScore(triCount);
+    std::vector<bool> emitted(triCount, false);
+    for (std::size_t t = 0; t < triCount; ++t) {
+        triScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] +
+                      vertexScore[indices[t * 3 + 2]];
+    }
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    std::vector<unsigned int> cache, nextCache;
+    cache.reserve(FORSYTH_CACHE_SIZE + 3);
+    nextCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+    std::size_t best = 0;
+    for (std::size_t t = 1; t < triCount; ++t) {
+        if (triScore[t] > triScore[best]) best = t;
+    }
+    std::size_t seek = 0; // треугольники до seek уже выведены
+
+    for (std::size_t n = 0; n < triCount; ++n) {
+        const unsigned int* tri = &indices[best * 3];
+        emitted[best] = true;
+        result.insert(result.end(), tri, tri + 3);
+
+        // Убрать треугольник из списков его вершин
+        for (int k = 0; k < 3; ++k) {
+            unsigned int v = tri[k];
+            unsigned int* list = &adjacency[offset[v]];
+            unsigned int count = remaining[v];
+            for (unsigned int i = 0; i < count; ++i) {
+                if (list[i] == best) {
+                    list[i] = list[count - 1];
+                    break;
+                }
+            }
+            --remaining[v];
+        }
+
+        // Новый кеш: вершины треугольника впереди, остальные сдвигаются
+        nextCache.assign(tri, tri + 3);
+        for (unsigned int v : cache) {
+            if (v != tri[0] && v != tri[1] && v != tri[2]) nextCache.push_back(v);
+        }
+        cache.swap(nextCache);
+
+        // Пересчитать оценки вершин кеша (вытесненные выпадают с позицией -1)
+        for (std::size_t i = 0; i < cache.size(); ++i) {
+            unsigned int v = cache[i];
+            int position = i < static_cast<std::size_t>(FORSYTH_CACHE_SIZE) ? static_cast<int>(i) : -1;
+            cachePosition[v] = position;
+            float score = forsythScore(position, remaining[v]);
+            float delta = score - vertexScore[v];
+            vertexScore[v] = score;
+            for (unsigned int j = 0; j < remaining[v]; ++j) triScore[adjacency[offset[v] + j]] += delta;
+        }
+        if (cache.size() > static_cast<std::size_t>(FORSYTH_CACHE_SIZE)) cache.resize(FORSYTH_CACHE_SIZE);
+
+        // Следующий — лучший из треугольников вершин кеша
+        bool found = false;
+        float bestScore = 0.0f;
+        for (unsigned int v : cache) {
+            for (unsigned int j = 0; j < remaining[v]; ++j) {
+                unsigned int t = adjacency[offset[v] + j];
+                if (!found || triScore[t] > bestScore) {
+                    best = t;
+                    bestScore = triScore[t];
+                    found = true;
+                }
+            }
+        }
+
+        // Кеш исчерпан: первый не выведенный треугольник по исходному порядку
+        if (!found) {
+            while (seek < triCount && emitted[seek]) ++seek;
+            if (seek == triCount) break;
+            best = seek;
+        }
+    }
+
+    indices.swap(result);
+}
+
+// ═══════════════════════════════════════
+// Перерисовка: группы треугольников по направлению наружу
+// ═══════════════════════════════════════
+
+// Модель кеша FIFO: вершина в кеше, если промахов после её загрузки было меньше cacheSize
+class FifoCache {
+public:
+    FifoCache(std::size_t vertexCount, int cacheSize)
+        : mStamp(vertexCount, 0), mTime(static_cast<unsigned int>(cacheSize) + 1), mSize(cacheSize) {}
+
+    // Промахов у треугольника (0..3)
+    int access(const unsigned int* tri) {
+        int misses = 0;
+        for (int k = 0; k < 3; ++k) {
+            if (mTime - mStamp[tri[k]] > static_cast<unsigned int>(mSize)) {
+                mStamp[tri[k]] = mTime++;
+                ++misses;
+            }
+        }
+        return misses;
+    }
+
+    // Забыть всё содержимое
+    void flush() { mTime += static_cast<unsigned int>(mSize) + 1; }
+
+private:
+    std::vector<unsigned int> mStamp;
+    unsigned int mTime;
+    int mSize;
+};
+
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<MeshVertex>& vertices,
+                      float threshold) {
+    const std::size_t triCount = indices.size() / 3;
+    if (triCount < 2) return;
+
+    // Жёсткие границы: треугольник, у которого промахнулись все три вершины,
+    // начинает новое пятно — разрезать там ничего не стоит
+    std::vector<std::size_t> hard;
+    {
+        FifoCache cache(vertices.size(), MESH_CACHE_SIZE);
+        for (std::size_t t = 0; t < triCount; ++t) {
+            if (cache.access(&indices[t * 3]) == 3) hard.push_back(t);
+        }
+    }
+    hard.push_back(triCount);
+
+    // Мягкие границы внутри пятна: режем, пока ACMR начатой группы
+    // не хуже ACMR всего пятна больше чем в threshold раз
+    std::vector<std::size_t> clusters;
+    FifoCache cache(vertices.size(), MESH_CACHE_SIZE);
+    for (std::size_t h = 0; h + 1 < hard.size(); ++h) {
+        const std::size_t start = hard[h], end = hard[h + 1];
+
+        cache.flush();
+        std::size_t misses = 0;
+        for (std::size_t t = start; t < end; ++t) misses += cache.access(&indices[t * 3]);
+        const float limit = threshold * static_cast<float>(misses) / (end - start);
+
+        cache.flush();
+        clusters.push_back(start);
+        std::size_t clusterStart = start;
+        misses = 0;
+        for (std::size_t t = start; t < end; ++t) {
+            misses += cache.access(&indices[t * 3]);
+            if (t + 1 < end && static_cast<float>(misses) / (t + 1 - clusterStart) <= limit) {
+                clusters.push_back(t + 1);
+                clusterStart = t + 1;
+                misses = 0;
+                cache.flush();
+            }
+        }
+    }
+    clusters.push_back(triCount);
+
+    // Центр меша, взвешенный по площади
+    double meshCentroid[3] = {0.0, 0.0, 0.0};
+    double meshArea = 0.0;
+    const std::size_t clusterCount = clusters.size() - 1;
+    std::vector<double> clusterCentroid(clusterCount * 3, 0.0);
+    std::vector<double> clusterNormal(clusterCount * 3, 0.0);
+    std::vector<double> clusterArea(clusterCount, 0.0);
+
+    for (std::size_t c = 0; c < clusterCount; ++c) {
+        for (std::size_t t = clusters[c]; t < clusters[c + 1]; ++t) {
+            const MeshVertex& a = vertices[indices[t * 3]];
+            const MeshVertex& b = vertices[indices[t * 3 + 1]];
+            const MeshVertex& d = vertices[indices[t * 3 + 2]];
+            double e1[3] = {b.px - a.px, b.py - a.py, b.pz - a.pz};
+            double e2[3] = {d.px - a.px, d.py - a.py, d.pz - a.pz};
+            double n[3] = {e1[1] * e2[2] - e1[2] * e2[1],
+                           e1[2] * e2[0] - e1[0] * e2[2],
+                           e1[0] * e2[1] - e1[1] * e2[0]};
+            double area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+            double center[3] = {(a.px + b.px + d.px) / 3.0, (a.py + b.py + d.py) / 3.0,
+                                (a.pz + b.pz + d.pz) / 3.0};
+            for (int k = 0; k < 3; ++k) {
+                clusterCentroid[c * 3 + k] += center[k] * area;
+                clusterNormal[c * 3 + k] += n[k]; // длина нормали — удвоенная площадь
+                meshCentroid[k] += center[k] * area;
+            }
+            clusterArea[c] += area;
+            meshArea += area;
+        }
+    }
+    if (meshArea <= 0.0) return;
+    for (int k = 0; k < 3; ++k) meshCentroid[k] /= meshArea;
+
+    // Ключ группы: насколько она смотрит от центра меша
+    std::vector<float> sortKey(clusterCount, 0.0f);
+    for (std::size_t c = 0; c < clusterCount; ++c) {
+        if (clusterArea[c] <= 0.0) continue;
+        const double* n = &clusterNormal[c * 3];
+        double len = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (len <= 0.0) continue;
+        double dot = 0.0;
+        for (int k = 0; k < 3; ++k) {
+            dot += (clusterCentroid[c * 3 + k] / clusterArea[c] - meshCentroid[k]) * n[k] / len;
+        }
+        sortKey[c] = static_cast<float>(dot);
+    }
+
+    std::vector<std::size_t> order(clusterCount);
+    for (std::size_t c = 0; c < clusterCount; ++c) order[c] = c;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indices.size());
+    for (std::size_t c : order) {
+        result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+    }
+    indices.swap(result);
+}
+
+// ═══════════════════════════════════════
+// Порядок вершин
+// ═══════════════════════════════════════
+
+void optimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices) {
+    const unsigned int unused = std::numeric_limits<unsigned int>::max();
+    std::vector<unsigned int> remap(vertices.size(), unused);
+    std::vector<MeshVertex> ordered;
+    ordered.reserve(vertices.size());
+
+    for (unsigned int& i : indices) {
+        if (remap[i] == unused) {
+            remap[i] = static_cast<unsigned int>(ordered.size());
+            ordered.push_back(vertices[i]);
+        }
+        i = remap[i];
+    }
+    vertices.swap(ordered);
+}
+
+void optimizeMesh(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices) {
+    weldMesh(vertices, indices);
+    optimizeVertexCache(indices, vertices.size());
+    optimizeOverdraw(indices, vertices, OVERDRAW_THRESHOLD);
+    optimizeVertexFetch(vertices, indices);
+}
+
+// ═══════════════════════════════════════
+// Замеры
+// ═══════════════════════════════════════
+
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, std::size_t vertexCount,
+                                    int cacheSize) {
+    VertexCacheStats stats;
+    const std::size_t triCount = indices.size() / 3;
+    if (triCount == 0) return stats;
+
+    FifoCache cache(vertexCount, cacheSize);
+    std::size_t misses = 0;
+    for (std::size_t t = 0; t < triCount; ++t) misses += cache.access(&indices[t * 3]);
+
+    // ATVR — по вершинам, на которые есть ссылки
+    std::vector<bool> used(vertexCount, false);
+    std::size_t usedCount = 0;
+    for (unsigned int i : indices) {
+        if (!used[i]) {
+            used[i] = true;
+            ++usedCount;
+        }
+    }
+    stats.acmr = static_cast<float>(misses) / triCount;
+    stats.atvr = static_cast<float>(misses) / usedCount;
+    return stats;
+}
+
+// Растеризовать треугольник в буфер глубины (центры пикселей, тест «меньше»)
+static void rasterizeDepth(const float a[3], const float b[3], const float c[3],
+                           std::vector<float>& depth, OverdrawStats& stats) {
+    float area = (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+    if (area == 0.0f) return;
+    const float inv = 1.0f / area;
+
+    int x0 = std::max(0, static_cast<int>(std::floor(std::min({a[0], b[0], c[0]}))));
+    int y0 = std::max(0, static_cast<int>(std::floor(std::min({a[1], b[1], c[1]}))));
+    int x1 = std::min(OVERDRAW_GRID - 1, static_cast<int>(std::ceil(std::max({a[0], b[0], c[0]}))));
+    int y1 = std::min(OVERDRAW_GRID - 1, static_cast<int>(std::ceil(std::max({a[1], b[1], c[1]}))));
+
+    for (int y = y0; y <= y1; ++y) {
+        const float py = y + 0.5f;
+        for (int x = x0; x <= x1; ++x) {
+            const float px = x + 0.5f;
+            // Барицентрические координаты; знак площади учитывает обход
+            float w0 = ((b[0] - px) * (c[1] - py) - (b[1] - py) * (c[0] - px)) * inv;
+            float w1 = ((c[0] - px) * (a[1] - py) - (c[1] - py) * (a[0] - px)) * inv;
+            float w2 = 1.0f - w0 - w1;
+            if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f) continue;
+
+            float z = w0 * a[2] + w1 * b[2] + w2 * c[2];
+            float& d = depth[static_cast<std::size_t>(y) * OVERDRAW_GRID + x];
+            if (z < d) {
+                if (d == std::numeric_limits<float>::infinity()) ++stats.covered;
+                d = z;
+                ++stats.shaded;
+            }
+        }
+    }
+}
+
+OverdrawStats analyzeOverdraw(const std::vector<unsigned int>& indices,
+                              const std::vector<MeshVertex>& vertices) {
+    OverdrawStats stats;
+    if (indices.size() < 3) return stats;
+
+    float lo[3], hi[3];
+    for (int k = 0; k < 3; ++k) {
+        lo[k] = std::numeric_limits<float>::max();
+        hi[k] = -std::numeric_limits<float>::max();
+    }
+    for (unsigned int i : indices) {
+        const float p[3] = {vertices[i].px, vertices[i].py, vertices[i].pz};
+        for (int k = 0; k < 3; ++k) {
+            lo[k] = std::min(lo[k], p[k]);
+            hi[k] = std::max(hi[k], p[k]);
+        }
+    }
+    float extent = std::max({hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]});
+    if (extent <= 0.0f) return stats;
+    const float scale = (OVERDRAW_GRID - 1) / extent;
+
+    // Шесть видов: вдоль каждой оси с обеих сторон, проекция ортографическая
+    std::vector<float> depth(static_cast<std::size_t>(OVERDRAW_GRID) * OVERDRAW_GRID);
+    for (int axis = 0; axis < 3; ++axis) {
+        for (int dir = -1; dir <= 1; dir += 2) {
+            std::fill(depth.begin(), depth.end(), std::numeric_limits<float>::infinity());
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            for (std::size_t t = 0; t + 2 < indices.size(); t += 3) {
+                float s[3][3];
+                for (int k = 0; k < 3; ++k) {
+                    const MeshVertex& mv = vertices[indices[t + k]];
+                    const float p[3] = {mv.px, mv.py, mv.pz};
+                    s[k][0] = (p[u] - lo[u]) * scale;
+                    s[k][1] = (p[v] - lo[v]) * scale;
+                    s[k][2] = dir * (p[axis] - lo[axis]) * scale;
+                }
+                rasterizeDepth(s[0], s[1], s[2], depth, stats);
+            }
+        }
+    }
+    stats.overdraw = stats.covered != 0 ? static_cast<float>(stats.shaded) / stats.covered : 0.0f;
+    return stats;
+}
@@ -0,0 +1,63 @@
+// ═══════════════════════════════════════
+// Оптимизация индексированных мешей: кеш вершин и перерисовка
+// Совпадающие вершины сливаются, треугольники переставляются так, чтобы
+// вершины чаще брались из кеша после вершинного шейдера (алгоритм Форсайта),
+// затем группы треугольников, смотрящие наружу, ставятся вперёд (как в
+// Tipsify), чтобы тест глубины отбрасывал больше фрагментов. Напоследок
+// вершины укладываются в порядке первого использования
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "mesh.h"
+
+#include <cstddef>
+#include <vector>
+
+// Размер кеша вершин FIFO для замеров и разбиения на группы
+static const int MESH_CACHE_SIZE = 16;
+
+// Во сколько раз разбиение на группы может ухудшить ACMR ради перерисовки
+static const float OVERDRAW_THRESHOLD = 1.05f;
+
+// Кеш вершин: промахов на треугольник (ACMR, от 0.5 у идеальной сетки до 3)
+// и на вершину (ATVR, 1 — каждая вершина обрабатывается один раз)
+struct VertexCacheStats {
+    float acmr = 0.0f;
+    float atvr = 0.0f;
+};
+
+// Перерисовка: фрагментов, прошедших тест глубины, на покрытый пиксель
+// (среднее по шести видам вдоль осей)
+struct OverdrawStats {
+    std::size_t covered = 0;
+    std::size_t shaded = 0;
+    float overdraw = 0.0f;
+};
+
+// Слить вершины, совпадающие с точностью до WELD_EPSILON, и выбросить
+// вырожденные треугольники; возвращает число вершин после слияния
+std::size_t weldMesh(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices);
+
+// Переставить треугольники для кеша вершин (порядок вершин не меняется)
+void optimizeVertexCache(std::vector<unsigned int>& indices, std::size_t vertexCount);
+
+// Переставить группы треугольников от смотрящих наружу к смотрящим внутрь;
+// ACMR ухудшается не больше чем в threshold раз
+void optimizeOverdraw(std::vector<unsigned int>& indices, const std::vector<MeshVertex>& vertices,
+                      float threshold);
+
+// Уложить вершины в порядке первого обращения (неиспользуемые выбрасываются)
+void optimizeVertexFetch(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices);
+
+// Все шаги подряд: слияние, кеш вершин, перерисовка, порядок вершин
+void optimizeMesh(std::vector<MeshVertex>& vertices, std::vector<unsigned int>& indices);
+
+// Замер кеша вершин FIFO размера cacheSize
+VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, std::size_t vertexCount,
+                                    int cacheSize);
+
+// Замер перерисовки программной растеризацией (без отсечения нелицевых граней,
+// как рисуются полупрозрачные объекты)
+OverdrawStats analyzeOverdraw(const std::vector<unsigned int>& indices,
+                              const std::vector<MeshVertex>& vertices);
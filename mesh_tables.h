@@ -0,0 +1,234 @@
+// ═══════════════════════════════════════
+// Таблицы геометрии примитивов, собираемые при компиляции
+// Генераторы constexpr выдают массивы вершин и индексов, которые компилятор
+// кладёт в образ программы готовыми: ни тригонометрии, ни построения сетки
+// во время работы. Порядок вершин и треугольников тот же, что у исходных
+// glBegin/glEnd; синусы и корни округлены до float точно (std::sin из libm
+// может отличаться от них в последнем бите)
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "mesh.h"
+
+#include <cstddef>
+
+// ═══════════════════════════════════════
+// Математика для constexpr (std::sin и std::sqrt не constexpr до C++26)
+// Считается в double, результат округляется до float один раз
+// ═══════════════════════════════════════
+
+static constexpr double CT_PI = 3.14159265358979323846;
+
+// pi/2 в виде суммы: старшая часть с 33 значащими битами умножается на номер
+// четверти без ошибки, младшая уточняет остаток (приведение Коди — Уэйта)
+static constexpr double CT_PI_2_HI = 1.57079632673412561417e+00;
+static constexpr double CT_PI_2_LO = 6.07710050650619224932e-11;
+
+constexpr double ctSqrt(double x) {
+    if (x <= 0.0) return 0.0;
+    double r = x > 1.0 ? x : 1.0;
+    for (int i = 0; i < 64; ++i) {
+        double next = 0.5 * (r + x / r);
+        if (next >= r) break; // метод Ньютона сходится сверху монотонно
+        r = next;
+    }
+    return r;
+}
+
+// Ряды Тейлора на [-pi/4, pi/4]: 12 членов с запасом дают точность double
+constexpr double ctSinReduced(double r) {
+    double term = r, sum = r, r2 = r * r;
+    for (int k = 1; k < 12; ++k) {
+        term *= -r2 / ((2 * k) * (2 * k + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double ctCosReduced(double r) {
+    double term = 1.0, sum = 1.0, r2 = r * r;
+    for (int k = 1; k < 12; ++k) {
+        term *= -r2 / ((2 * k - 1) * (2 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+// sin(x + quarter * pi/2) по остатку r и номеру четверти
+constexpr double ctSinQuarter(double r, long quarter) {
+    switch (((quarter % 4) + 4) % 4) {
+        case 0:  return ctSinReduced(r);
+        case 1:  return ctCosReduced(r);
+        case 2:  return -ctSinReduced(r);
+        default: return -ctCosReduced(r);
+    }
+}
+
+constexpr long ctQuarter(double x) {
+    double q = x / (0.5 * CT_PI);
+    return static_cast<long>(q < 0.0 ? q - 0.5 : q + 0.5);
+}
+
+constexpr double ctSin(double x) {
+    long n = ctQuarter(x);
+    double r = (x - n * CT_PI_2_HI) - n * CT_PI_2_LO;
+    return ctSinQuarter(r, n);
+}
+
+constexpr double ctCos(double x) {
+    long n = ctQuarter(x);
+    double r = (x - n * CT_PI_2_HI) - n * CT_PI_2_LO;
+    return ctSinQuarter(r, n + 1);
+}
+
+// ═══════════════════════════════════════
+// Таблицы
+// ═══════════════════════════════════════
+
+// Вершины и индексы треугольников меша (GL_TRIANGLES)
+template <std::size_t VertexCount, std::size_t IndexCount>
+struct MeshTable {
+    MeshVertex   vertices[VertexCount];
+    unsigned int indices[IndexCount];
+};
+
+// Сфера: сетка (stacks + 1) x (slices + 1), по два треугольника на ячейку
+template <int Slices, int Stacks>
+using SphereTable = MeshTable<static_cast<std::size_t>(Stacks + 1) * (Slices + 1),
+                              static_cast<std::size_t>(Stacks) * Slices * 6>;
+
+// Куб: шесть четырёхугольных граней; пирамида: четыре треугольника и основание
+typedef MeshTable<24, 36> CubeTable;
+typedef MeshTable<16, 18> PyramidTable;
+
+// Сфера радиуса radius (порядок обхода как у GL_QUAD_STRIP в исходной версии)
+template <int Slices, int Stacks>
+constexpr SphereTable<Slices, Stacks> makeSphereTable(float radius) {
+    static_assert(Slices >= 3 && Stacks >= 2, "sphere needs at least 3 slices and 2 stacks");
+    SphereTable<Slices, Stacks> t{};
+
+    // Шов по долготе дублируется, как и в исходной версии с полосами
+    std::size_t v = 0;
+    for (int i = 0; i <= Stacks; ++i) {
+        float lat = static_cast<float>(CT_PI) * (-0.5f + static_cast<float>(i) / Stacks);
+        float y  = static_cast<float>(ctSin(lat));
+        float yr = static_cast<float>(ctCos(lat));
+
+        for (int j = 0; j <= Slices; ++j) {
+            float lng = 2.0f * static_cast<float>(CT_PI) * static_cast<float>(j) / Slices;
+            float x = static_cast<float>(ctCos(lng));
+            float z = static_cast<float>(ctSin(lng));
+
+            MeshVertex& mv = t.vertices[v++];
+            mv.nx = x * yr;
+            mv.ny = y;
+            mv.nz = z * yr;
+            mv.px = radius * mv.nx;
+            mv.py = radius * mv.ny;
+            mv.pz = radius * mv.nz;
+        }
+    }
+
+    // Каждый четырёхугольник полосы — два треугольника
+    // (нижняя j, верхняя j, верхняя j+1) и (нижняя j, верхняя j+1, нижняя j+1)
+    const unsigned int row = static_cast<unsigned int>(Slices + 1);
+    std::size_t k = 0;
+    for (int i = 0; i < Stacks; ++i) {
+        for (int j = 0; j < Slices; ++j) {
+            unsigned int lo0 = static_cast<unsigned int>(i) * row + j;
+            unsigned int lo1 = lo0 + 1;
+            unsigned int hi0 = lo0 + row;
+            unsigned int hi1 = hi0 + 1;
+
+            t.indices[k++] = lo0;
+            t.indices[k++] = hi0;
+            t.indices[k++] = hi1;
+
+            t.indices[k++] = lo0;
+            t.indices[k++] = hi1;
+            t.indices[k++] = lo1;
+        }
+    }
+    return t;
+}
+
+// Добавить плоскую грань с общей нормалью: многоугольник из n вершин веером
+// от первой, как GL_QUADS / GL_TRIANGLES раскладываются в треугольники
+template <typename Table>
+constexpr void addTableFace(Table& t, std::size_t& v, std::size_t& k,
+                            const float normal[3], const float (*corners)[3], int n) {
+    unsigned int base = static_cast<unsigned int>(v);
+    for (int i = 0; i < n; ++i) {
+        MeshVertex& mv = t.vertices[v++];
+        mv.px = corners[i][0]; mv.py = corners[i][1]; mv.pz = corners[i][2];
+        mv.nx = normal[0];     mv.ny = normal[1];     mv.nz = normal[2];
+    }
+    for (int i = 1; i + 1 < n; ++i) {
+        t.indices[k++] = base;
+        t.indices[k++] = base + i;
+        t.indices[k++] = base + i + 1;
+    }
+}
+
+// Куб с ребром size: нормаль и четыре вершины каждой грани против часовой стрелки снаружи
+constexpr CubeTable makeCubeTable(float size) {
+    CubeTable t{};
+    const float h = size / 2.0f;
+    const float normals[6][3] = {
+        {0.0f, 0.0f, 1.0f}, {0.0f, 0.0f, -1.0f}, {0.0f, 1.0f, 0.0f},
+        {0.0f, -1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, {-1.0f, 0.0f, 0.0f},
+    };
+    const float signs[6][4][3] = {
+        {{-1, -1,  1}, { 1, -1,  1}, { 1,  1,  1}, {-1,  1,  1}}, // передняя (+Z)
+        {{ 1, -1, -1}, {-1, -1, -1}, {-1,  1, -1}, { 1,  1, -1}}, // задняя (-Z)
+        {{-1,  1,  1}, { 1,  1,  1}, { 1,  1, -1}, {-1,  1, -1}}, // верхняя (+Y)
+        {{-1, -1, -1}, { 1, -1, -1}, { 1, -1,  1}, {-1, -1,  1}}, // нижняя (-Y)
+        {{ 1, -1,  1}, { 1, -1, -1}, { 1,  1, -1}, { 1,  1,  1}}, // правая (+X)
+        {{-1, -1, -1}, {-1, -1,  1}, {-1,  1,  1}, {-1,  1, -1}}, // левая (-X)
+    };
+    std::size_t v = 0, k = 0;
+    for (int f = 0; f < 6; ++f) {
+        float corners[4][3] = {};
+        for (int i = 0; i < 4; ++i) {
+            for (int a = 0; a < 3; ++a) corners[i][a] = signs[f][i][a] * h;
+        }
+        addTableFace(t, v, k, normals[f], corners, 4);
+    }
+    return t;
+}
+
+// Пирамида с квадратным основанием 2*halfBase и вершиной на высоте height
+constexpr PyramidTable makePyramidTable(float halfBase, float height) {
+    PyramidTable t{};
+    const float b = halfBase;
+
+    // Нормали боковых граней (как в исходной версии: наклон не зависит от высоты)
+    const float k2 = 1.0f / static_cast<float>(ctSqrt(2.0));
+    const float nFront[3] = {0.0f, k2,  k2};
+    const float nBack[3]  = {0.0f, k2, -k2};
+    const float nRight[3] = { k2, k2, 0.0f};
+    const float nLeft[3]  = {-k2, k2, 0.0f};
+    const float nDown[3]  = {0.0f, -1.0f, 0.0f};
+
+    const float front[3][3] = {{ b, 0.0f,  b}, {-b, 0.0f,  b}, {0.0f, height, 0.0f}};
+    const float back[3][3]  = {{-b, 0.0f, -b}, { b, 0.0f, -b}, {0.0f, height, 0.0f}};
+    const float right[3][3] = {{ b, 0.0f, -b}, { b, 0.0f,  b}, {0.0f, height, 0.0f}};
+    const float left[3][3]  = {{-b, 0.0f,  b}, {-b, 0.0f, -b}, {0.0f, height, 0.0f}};
+    const float base[4][3]  = {{-b, 0.0f, -b}, {-b, 0.0f,  b}, { b, 0.0f,  b}, { b, 0.0f, -b}};
+
+    std::size_t v = 0, k = 0;
+    addTableFace(t, v, k, nFront, front, 3);
+    addTableFace(t, v, k, nBack,  back,  3);
+    addTableFace(t, v, k, nRight, right, 3);
+    addTableFace(t, v, k, nLeft,  left,  3);
+    addTableFace(t, v, k, nDown,  base,  4);
+    return t;
+}
+
+// Меш из таблицы: загружается в VBO/IBO при первом запросе,
+// дальше берётся из кеша по адресу таблицы
+template <std::size_t VertexCount, std::size_t IndexCount>
+const Mesh& getTableMesh(const MeshTable<VertexCount, IndexCount>& table) {
+    return getStaticMesh(&table, table.vertices, VertexCount, table.indices, IndexCount);
+}
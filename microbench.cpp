@@ -0,0 +1,453 @@
+// ═══════════════════════════════════════
+// Микробенчмарки горячих путей (цель lab1_bench)
+// Тесселяция сферы, матрицы вида и проекции, отсечение, подготовка и
+// (с --gl) отправка вызовов рисования. Каждый случай прогоняется пачками
+// не короче MICRO_SAMPLE_MS; в отчёте — время одной операции по пачкам.
+// С --baseline FILE медиана сравнивается с прошлым JSON-отчётом, и замедление
+// больше --threshold процентов даёт код возврата 1
+// ═══════════════════════════════════════
+
+#include "bench.h"
+#include "culling.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "mesh.h"
+#include "mesh_optimizer.h"
+#include "mesh_tables.h"
+#include "primitives.h"
+#include "scene.h"
+#include "stream_ring.h"
+#include "stress_scene.h"
+#include "transparency.h"
+#include "vecmath.h"
+
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+// Пачка замеряется не короче этого (мс), чтобы не мерить таймер
+static const double MICRO_SAMPLE_MS = 5.0;
+
+// Пачек по умолчанию и пачек прогрева
+static const int MICRO_SAMPLES = 30;
+static const int MICRO_WARMUP  = 3;
+
+// Допустимое замедление относительно --baseline по умолчанию, проценты
+static const double MICRO_THRESHOLD = 10.0;
+
+// Размеры наборов данных
+static const std::size_t CULL_OBJECTS     = 10000;
+static const std::size_t CULL_TREES       = 100000;
+static const std::size_t SUBMIT_INSTANCES = 100000;
+static const std::size_t BATCH_MATRICES   = 1000;
+static const int         GL_DRAW_CALLS    = 1000;
+static const std::size_t GL_STRESS_OBJECTS = 10000;
+
+// Окно маленькое: замеряется отправка вызовов, а не заливка пикселей
+static const int GL_WIDTH  = 64;
+static const int GL_HEIGHT = 64;
+
+// Результаты складываются сюда, чтобы компилятор не выбросил вычисления
+static volatile float gSink = 0.0f;
+
+// Случай: имя, элементов за операцию (для пропускной способности) и операция
+struct MicroCase {
+    std::string name;
+    std::size_t items;
+    std::function<void()> run;
+};
+
+// Итог случая: время операции по пачкам, микросекунды
+struct MicroResult {
+    std::string name;
+    std::size_t items = 0;
+    long long iterations = 0;
+    FrameStats us; // поля *Ms здесь в микросекундах
+};
+
+// Параметры запуска
+struct MicroOptions {
+    std::string filter;       // --filter TEXT: только случаи с этой подстрокой
+    int         samples = MICRO_SAMPLES;
+    std::string jsonPath;     // --json FILE
+    std::string baselinePath; // --baseline FILE
+    double      threshold = MICRO_THRESHOLD;
+    bool        gl = false;   // --gl: ещё и отправка в OpenGL (нужно окно)
+};
+
+// ═══════════════════════════════════════
+// Случаи
+// ═══════════════════════════════════════
+
+// Тесселяция сферы, как в mySolidSphere исходной версии: slices x stacks
+template <int Segments>
+static void addSphereCase(std::vector<MicroCase>& cases) {
+    cases.push_back({"sphere_tessellate_" + std::to_string(Segments),
+                     static_cast<std::size_t>((Segments + 1) * (Segments + 1)), [] {
+        // Радиус через volatile — таблица не может быть посчитана при компиляции
+        static volatile float radius = 1.0f;
+        static SphereTable<Segments, Segments> table;
+        table = makeSphereTable<Segments, Segments>(radius);
+        gSink = gSink + table.vertices[Segments].px;
+    }});
+}
+
+static void addMeshCases(std::vector<MicroCase>& cases) {
+    addSphereCase<8>(cases);
+    addSphereCase<16>(cases);
+    addSphereCase<32>(cases);
+    addSphereCase<64>(cases);
+
+    const Mesh& sphere = *getSphereLodChain().levels[1];
+    cases.push_back({"optimize_mesh_sphere_32", sphere.indices.size() / 3, [&sphere] {
+        std::vector<MeshVertex> vertices = sphere.vertices;
+        std::vector<unsigned int> indices = sphere.indices;
+        optimizeMesh(vertices, indices);
+        gSink = gSink + static_cast<float>(indices.size());
+    }});
+}
+
+static void addMatrixCases(std::vector<MicroCase>& cases) {
+    cases.push_back({"mat4_look_at", 1, [] {
+        static float t = 0.0f;
+        t += 0.001f;
+        Mat4 m = mat4LookAt(t, 1.0f, 5.0f, t, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+        gSink = gSink + m.m[12];
+    }});
+    cases.push_back({"mat4_perspective", 1, [] {
+        static float aspect = 1.0f;
+        aspect += 0.0001f;
+        Mat4 m = mat4Perspective(45.0f, aspect, 0.1f, 100.0f);
+        gSink = gSink + m.m[0];
+    }});
+    cases.push_back({"mat4_multiply_batch_" + std::to_string(BATCH_MATRICES), BATCH_MATRICES, [] {
+        static std::vector<Mat4> models(BATCH_MATRICES, mat4Translate(1.0f, 2.0f, 3.0f));
+        static std::vector<Mat4> out(BATCH_MATRICES);
+        static Mat4 view = mat4LookAt(0.0f, 1.0f, 5.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+        mat4MultiplyBatch(view, models.data(), out.data(), BATCH_MATRICES);
+        gSink = gSink + out[BATCH_MATRICES - 1].m[14];
+    }});
+}
+
+// Камера 3D-сцены над сеткой объектов
+static Mat4 benchClip() {
+    Mat4 projection = mat4Perspective(45.0f, 4.0f / 3.0f, 0.1f, 100.0f);
+    Mat4 view = mat4LookAt(0.0f, 1.0f, 5.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+    return projection * view;
+}
+
+static void addCullingCases(std::vector<MicroCase>& cases) {
+    static Scene objects;
+    generateObjectGrid(objects, CULL_OBJECTS);
+    static Bvh bvh;
+    std::vector<Aabb> boxes(objects.objects.size());
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        const float* p = objects.objects[i].position;
+        for (int k = 0; k < 3; ++k) {
+            boxes[i].min[k] = p[k] - 0.5f;
+            boxes[i].max[k] = p[k] + 0.5f;
+        }
+    }
+    bvh.build(boxes.data(), boxes.size());
+
+    cases.push_back({"bvh_cull_" + std::to_string(CULL_OBJECTS), CULL_OBJECTS, [] {
+        static std::vector<std::uint32_t> visible;
+        Frustum frustum;
+        extractFrustum(benchClip().m, frustum);
+        CullStats stats;
+        bvh.cull(frustum, visible, stats);
+        gSink = gSink + static_cast<float>(stats.visible);
+    }});
+
+    static Scene forest;
+    generateForest(forest, CULL_TREES, 12345u);
+    static UniformGrid2D grid;
+    std::vector<Rect2D> rects(forest.trees.size());
+    for (std::size_t i = 0; i < rects.size(); ++i) {
+        const TreeInstance& t = forest.trees[i];
+        rects[i] = {t.x - 0.1f * t.scale, t.y - 0.1f * t.scale, t.x + 0.1f * t.scale, t.y + 0.3f * t.scale};
+    }
+    grid.build(rects.data(), rects.size());
+
+    cases.push_back({"grid_query_" + std::to_string(CULL_TREES), CULL_TREES, [] {
+        static std::vector<std::uint32_t> visible;
+        CullStats stats;
+        grid.query({-0.5f, -0.5f, 0.5f, 0.5f}, visible, stats);
+        gSink = gSink + static_cast<float>(stats.visible);
+    }});
+}
+
+// Подготовка отправки на CPU: сортировка полупрозрачных и сборка экземпляров
+static void addSubmitCases(std::vector<MicroCase>& cases) {
+    static std::vector<float> depth(SUBMIT_INSTANCES);
+    std::mt19937 rng(12345u);
+    std::uniform_real_distribution<float> dist(0.1f, 100.0f);
+    for (float& d : depth) d = dist(rng);
+
+    cases.push_back({"sort_translucent_" + std::to_string(SUBMIT_INSTANCES), SUBMIT_INSTANCES, [] {
+        static std::vector<std::uint32_t> order;
+        orderTranslucent(TRANSPARENCY_SORTED, depth.data(), depth.size(), order);
+        gSink = gSink + static_cast<float>(order[0]);
+    }});
+
+    static std::vector<StressInstance> instances;
+    generateStressInstances(instances, SUBMIT_INSTANCES, 1.0f, 12345u);
+    static std::vector<std::uint32_t> gather(SUBMIT_INSTANCES);
+    for (std::size_t i = 0; i < gather.size(); ++i) gather[i] = static_cast<std::uint32_t>(i * 7919 % gather.size());
+
+    cases.push_back({"gather_instances_" + std::to_string(SUBMIT_INSTANCES), SUBMIT_INSTANCES, [] {
+        static std::vector<StressInstance> out(SUBMIT_INSTANCES);
+        for (std::size_t k = 0; k < gather.size(); ++k) out[k] = instances[gather[k]];
+        gSink = gSink + out[SUBMIT_INSTANCES / 2].scale;
+    }});
+}
+
+// Отправка в OpenGL: операция заканчивается glFinish
+static void addGlCases(std::vector<MicroCase>& cases) {
+    cases.push_back({"gl_draw_mesh_" + std::to_string(GL_DRAW_CALLS), GL_DRAW_CALLS, [] {
+        const Mesh& mesh = getCubeMesh();
+        glMatrixMode(GL_MODELVIEW);
+        for (int i = 0; i < GL_DRAW_CALLS; ++i) {
+            glLoadIdentity();
+            glTranslatef(0.0f, 0.0f, -5.0f - 0.01f * static_cast<float>(i));
+            drawMesh(mesh);
+        }
+        glFinish();
+    }});
+
+    static std::vector<StressInstance> instances;
+    generateStressInstances(instances, GL_STRESS_OBJECTS, 1.0f, 12345u);
+    Material materials[PRIM_COUNT] = {};
+    for (Material& m : materials) m.shininess = 32.0f;
+    if (!initStressRenderer(instances.data(), instances.size(), materials, STRESS_SUBMIT_AUTO)) {
+        std::fprintf(stderr, "Stress renderer is not available; skipping gl_stress_scene\n");
+        return;
+    }
+    cases.push_back({"gl_stress_scene_" + std::to_string(GL_STRESS_OBJECTS), GL_STRESS_OBJECTS, [] {
+        StressFrame frame;
+        frame.projection = mat4Perspective(45.0f, static_cast<float>(GL_WIDTH) / GL_HEIGHT, 0.1f, 100.0f);
+        frame.view = mat4LookAt(0.0f, 1.0f, 5.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+        for (int i = 0; i < 4; ++i) {
+            frame.light.position[i] = i == 3 ? 1.0f : 3.0f;
+            frame.light.ambient[i] = frame.light.diffuse[i] = frame.light.specular[i] = 1.0f;
+            frame.light.modelAmbient[i] = 0.2f;
+        }
+        frame.brightness = 1.0f;
+        frame.alpha = 0.8f;
+        frame.mode = TRANSPARENCY_SORTED;
+        frame.cull = true;
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        streamBeginFrame();
+        drawStressScene(frame);
+        streamEndFrame();
+        glFinish();
+    }});
+}
+
+// ═══════════════════════════════════════
+// Замер
+// ═══════════════════════════════════════
+
+static MicroResult measure(const MicroCase& c, int samples) {
+    typedef std::chrono::steady_clock Clock;
+
+    // Подобрать размер пачки: удваивать, пока пачка короче MICRO_SAMPLE_MS
+    long long batch = 1;
+    for (;;) {
+        Clock::time_point t0 = Clock::now();
+        for (long long i = 0; i < batch; ++i) c.run();
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+        if (ms >= MICRO_SAMPLE_MS || batch >= (1ll << 30)) break;
+        batch *= 2;
+    }
+
+    std::vector<double> perOpUs;
+    perOpUs.reserve(static_cast<std::size_t>(samples));
+    for (int s = 0; s < MICRO_WARMUP + samples; ++s) {
+        Clock::time_point t0 = Clock::now();
+        for (long long i = 0; i < batch; ++i) c.run();
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+        if (s >= MICRO_WARMUP) perOpUs.push_back(us / static_cast<double>(batch));
+    }
+
+    MicroResult r;
+    r.name = c.name;
+    r.items = c.items;
+    r.iterations = batch * samples;
+    r.us = computeFrameStats(perOpUs);
+    return r;
+}
+
+// ═══════════════════════════════════════
+// Отчёт
+// ═══════════════════════════════════════
+
+static void writeJson(std::FILE* out, const std::vector<MicroResult>& results) {
+    std::fprintf(out, "[\n");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const MicroResult& r = results[i];
+        const FrameStats& st = r.us;
+        // Один случай — одна строка: --baseline читает файл построчно
+        std::fprintf(out,
+            "{\"name\":\"%s\",\"items\":%zu,\"iterations\":%lld,"
+            "\"us\":{\"min\":%.4f,\"mean\":%.4f,\"p50\":%.4f,\"p95\":%.4f,\"max\":%.4f},"
+            "\"items_per_sec\":%.1f}%s\n",
+            r.name.c_str(), r.items, r.iterations, st.minMs, st.meanMs, st.p50Ms, st.p95Ms, st.maxMs,
+            st.p50Ms > 0.0 ? static_cast<double>(r.items) * 1.0e6 / st.p50Ms : 0.0,
+            i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "]\n");
+}
+
+// Медианы из прошлого отчёта: имя случая -> p50, мкс
+static bool readBaseline(const char* path, std::map<std::string, double>& p50) {
+    std::FILE* f = std::fopen(path, "r");
+    if (f == nullptr) {
+        std::fprintf(stderr, "Cannot read %s\n", path);
+        return false;
+    }
+    char line[1024];
+    while (std::fgets(line, sizeof(line), f) != nullptr) {
+        const char* name = std::strstr(line, "\"name\":\"");
+        const char* median = std::strstr(line, "\"p50\":");
+        if (name == nullptr || median == nullptr) continue;
+        name += std::strlen("\"name\":\"");
+        const char* end = std::strchr(name, '"');
+        if (end == nullptr) continue;
+        p50[std::string(name, end)] = std::atof(median + std::strlen("\"p50\":"));
+    }
+    std::fclose(f);
+    return true;
+}
+
+static void printUsage() {
+    std::fprintf(stderr, "Usage: lab1_bench [--filter TEXT] [--samples N] [--json FILE] "
+                         "[--baseline FILE] [--threshold PCT] [--gl]\n");
+}
+
+static bool parseMicroOptions(int argc, char** argv, MicroOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--filter") == 0 && hasValue) {
+            opts.filter = argv[++i];
+        } else if (std::strcmp(arg, "--samples") == 0 && hasValue) {
+            opts.samples = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--json") == 0 && hasValue) {
+            opts.jsonPath = argv[++i];
+        } else if (std::strcmp(arg, "--baseline") == 0 && hasValue) {
+            opts.baselinePath = argv[++i];
+        } else if (std::strcmp(arg, "--threshold") == 0 && hasValue) {
+            opts.threshold = std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--gl") == 0) {
+            opts.gl = true;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg);
+            return false;
+        }
+    }
+    return opts.samples > 0 && opts.threshold >= 0.0;
+}
+
+// Скрытое окно с контекстом OpenGL для случаев --gl
+static GLFWwindow* createGlWindow() {
+    if (!glfwInit()) return nullptr;
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(GL_WIDTH, GL_HEIGHT, "lab1_bench", nullptr, nullptr);
+    if (window == nullptr) {
+        glfwTerminate();
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+    loadGLFunctions();
+    initStreamRing();
+    glsInvalidate();
+    glsEnable(GL_DEPTH_TEST);
+    glsEnable(GL_BLEND);
+    glsBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glViewport(0, 0, GL_WIDTH, GL_HEIGHT);
+    if (!gl.coreProfile) {
+        Mat4 projection = mat4Perspective(45.0f, static_cast<float>(GL_WIDTH) / GL_HEIGHT, 0.1f, 100.0f);
+        glMatrixMode(GL_PROJECTION);
+        glLoadMatrixf(projection.m);
+    }
+    return window;
+}
+
+int main(int argc, char** argv) {
+    MicroOptions opts;
+    if (!parseMicroOptions(argc, argv, opts)) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<MicroCase> cases;
+    addMeshCases(cases);
+    addMatrixCases(cases);
+    addCullingCases(cases);
+    addSubmitCases(cases);
+
+    GLFWwindow* window = nullptr;
+    if (opts.gl) {
+        window = createGlWindow();
+        if (window == nullptr) {
+            std::fprintf(stderr, "Cannot create an OpenGL window; skipping --gl cases\n");
+        } else {
+            addGlCases(cases);
+        }
+    }
+
+    std::printf("%-28s %12s %12s %12s %16s\n", "case", "p50 us", "min us", "p95 us", "items/s");
+    std::vector<MicroResult> results;
+    for (const MicroCase& c : cases) {
+        if (!opts.filter.empty() && c.name.find(opts.filter) == std::string::npos) continue;
+        MicroResult r = measure(c, opts.samples);
+        std::printf("%-28s %12.3f %12.3f %12.3f %16.0f\n", r.name.c_str(), r.us.p50Ms, r.us.minMs,
+                    r.us.p95Ms, r.us.p50Ms > 0.0 ? static_cast<double>(r.items) * 1.0e6 / r.us.p50Ms : 0.0);
+        std::fflush(stdout);
+        results.push_back(r);
+    }
+
+    if (window != nullptr) {
+        releaseStressRenderer();
+        releaseStreamRing();
+        releaseMeshCache();
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    if (!opts.jsonPath.empty()) {
+        std::FILE* f = std::fopen(opts.jsonPath.c_str(), "w");
+        if (f == nullptr) {
+            std::fprintf(stderr, "Cannot write %s\n", opts.jsonPath.c_str());
+            return 1;
+        }
+        writeJson(f, results);
+        std::fclose(f);
+    }
+
+    // Сравнение с прошлым отчётом: медиана хуже на threshold процентов — регрессия
+    int exitCode = 0;
+    if (!opts.baselinePath.empty()) {
+        std::map<std::string, double> baseline;
+        if (!readBaseline(opts.baselinePath.c_str(), baseline)) return 2;
+        for (const MicroResult& r : results) {
+            auto it = baseline.find(r.name);
+            if (it == baseline.end() || it->second <= 0.0) continue;
+            double change = (r.us.p50Ms / it->second - 1.0) * 100.0;
+            bool regressed = change > opts.threshold;
+            if (regressed) exitCode = 1;
+            std::printf("%-28s %+8.1f%%%s\n", r.name.c_str(), change, regressed ? "  REGRESSION" : "");
+        }
+    }
+    return exitCode;
+}
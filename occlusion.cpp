@@ -0,0 +1,174 @@
+// ═══════════════════════════════════════
+// Отсечение перекрытых объектов по иерархическому буферу глубины (Hi-Z)
+// ═══════════════════════════════════════
+
+#include "occlusion.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Наибольшая высота буфера (для очень узкого кадра)
+static const int OCCLUSION_MAX_HEIGHT = 4 * OCCLUSION_WIDTH;
+
+// Прямоугольник объекта на выбранном уровне пирамиды — не больше стольких текселей по оси
+static const int OCCLUSION_TEST_TEXELS = 4;
+
+void OcclusionBuffer::begin(const Mat4& clip, float aspect) {
+    mClip = clip;
+    mWidth = OCCLUSION_WIDTH;
+    mHeight = aspect > 0.0f ? static_cast<int>(std::lround(OCCLUSION_WIDTH / aspect)) : OCCLUSION_WIDTH;
+    mHeight = std::min(std::max(mHeight, 1), OCCLUSION_MAX_HEIGHT);
+    mTriangles = 0;
+
+    // Уровни до 1x1; память остаётся от прошлых кадров
+    int levels = 1;
+    for (int w = mWidth, h = mHeight; w > 1 || h > 1; w = (w + 1) / 2, h = (h + 1) / 2) ++levels;
+    mLevels.resize(static_cast<std::size_t>(levels));
+    int w = mWidth, h = mHeight;
+    for (Level& level : mLevels) {
+        level.width = w;
+        level.height = h;
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+    }
+    mLevels[0].depth.assign(static_cast<std::size_t>(mWidth) * mHeight, 1.0f);
+}
+
+void OcclusionBuffer::addTriangle(const float a[3], const float b[3], const float c[3]) {
+    // В пиксели буфера; вершина перед ближней плоскостью — треугольник не
+    // отсекается, а пропускается: настоящий объект там тоже отрезан
+    float v[3][3];
+    const float* in[3] = {a, b, c};
+    for (int i = 0; i < 3; ++i) {
+        float p[4];
+        transformPoint(mClip, in[i], p);
+        if (p[3] <= 0.0f || p[2] < -p[3]) return;
+        const float invW = 1.0f / p[3];
+        v[i][0] = (p[0] * invW * 0.5f + 0.5f) * mWidth;
+        v[i][1] = (p[1] * invW * 0.5f + 0.5f) * mHeight;
+        v[i][2] = p[2] * invW * 0.5f + 0.5f;
+    }
+
+    // Обход против часовой стрелки (окклюдеры двусторонние)
+    float area = (v[1][0] - v[0][0]) * (v[2][1] - v[0][1]) - (v[2][0] - v[0][0]) * (v[1][1] - v[0][1]);
+    if (area == 0.0f) return;
+    if (area < 0.0f) {
+        std::swap(v[1], v[2]);
+        area = -area;
+    }
+
+    const int minX = std::max(0, static_cast<int>(std::floor(std::min({v[0][0], v[1][0], v[2][0]}))));
+    const int minY = std::max(0, static_cast<int>(std::floor(std::min({v[0][1], v[1][1], v[2][1]}))));
+    const int maxX = std::min(mWidth - 1, static_cast<int>(std::ceil(std::max({v[0][0], v[1][0], v[2][0]}))) - 1);
+    const int maxY = std::min(mHeight - 1, static_cast<int>(std::ceil(std::max({v[0][1], v[1][1], v[2][1]}))) - 1);
+    if (minX > maxX || minY > maxY) return;
+    ++mTriangles;
+
+    // Рёберные функции A*x + B*y + C (внутри — не меньше нуля); пиксель покрыт
+    // целиком, если функция в центре не меньше половины |A| + |B|
+    float edge[3][3];
+    float inset[3];
+    for (int e = 0; e < 3; ++e) {
+        const float* p = v[e];
+        const float* q = v[(e + 1) % 3];
+        edge[e][0] = p[1] - q[1];
+        edge[e][1] = q[0] - p[0];
+        edge[e][2] = p[0] * q[1] - q[0] * p[1];
+        inset[e] = 0.5f * (std::fabs(edge[e][0]) + std::fabs(edge[e][1]));
+    }
+
+    // Плоскость глубины; в пиксель пишется дальняя глубина внутри него
+    const float dx1 = v[1][0] - v[0][0], dy1 = v[1][1] - v[0][1], dz1 = v[1][2] - v[0][2];
+    const float dx2 = v[2][0] - v[0][0], dy2 = v[2][1] - v[0][1], dz2 = v[2][2] - v[0][2];
+    const float dzdx = (dz1 * dy2 - dz2 * dy1) / area;
+    const float dzdy = (dx1 * dz2 - dx2 * dz1) / area;
+    const float slack = 0.5f * (std::fabs(dzdx) + std::fabs(dzdy));
+
+    std::vector<float>& depth = mLevels[0].depth;
+    for (int y = minY; y <= maxY; ++y) {
+        const float cy = y + 0.5f;
+        float* row = depth.data() + static_cast<std::size_t>(y) * mWidth;
+        for (int x = minX; x <= maxX; ++x) {
+            const float cx = x + 0.5f;
+            bool covered = true;
+            for (int e = 0; e < 3 && covered; ++e) {
+                covered = edge[e][0] * cx + edge[e][1] * cy + edge[e][2] >= inset[e];
+            }
+            if (!covered) continue;
+            const float z = v[0][2] + dzdx * (cx - v[0][0]) + dzdy * (cy - v[0][1]) + slack;
+            row[x] = std::min(row[x], z);
+        }
+    }
+}
+
+void OcclusionBuffer::buildPyramid() {
+    for (std::size_t k = 1; k < mLevels.size(); ++k) {
+        const Level& src = mLevels[k - 1];
+        Level& dst = mLevels[k];
+        dst.depth.resize(static_cast<std::size_t>(dst.width) * dst.height);
+        for (int y = 0; y < dst.height; ++y) {
+            const int y0 = 2 * y;
+            const int y1 = std::min(y0 + 1, src.height - 1);
+            for (int x = 0; x < dst.width; ++x) {
+                const int x0 = 2 * x;
+                const int x1 = std::min(x0 + 1, src.width - 1);
+                const float* r0 = src.depth.data() + static_cast<std::size_t>(y0) * src.width;
+                const float* r1 = src.depth.data() + static_cast<std::size_t>(y1) * src.width;
+                dst.depth[static_cast<std::size_t>(y) * dst.width + x] =
+                    std::max(std::max(r0[x0], r0[x1]), std::max(r1[x0], r1[x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionBuffer::occluded(const Aabb& box) const {
+    if (mLevels.empty()) return false;
+
+    // Прямоугольник AABB в пикселях и его ближняя глубина; угол перед
+    // ближней плоскостью — объект рядом с камерой, не проверяется
+    float minX = INFINITY, minY = INFINITY, maxX = -INFINITY, maxY = -INFINITY;
+    float nearest = INFINITY;
+    for (int corner = 0; corner < 8; ++corner) {
+        const float p[3] = {
+            (corner & 1) ? box.max[0] : box.min[0],
+            (corner & 2) ? box.max[1] : box.min[1],
+            (corner & 4) ? box.max[2] : box.min[2],
+        };
+        float clip[4];
+        transformPoint(mClip, p, clip);
+        if (clip[3] <= 0.0f || clip[2] < -clip[3]) return false;
+        const float invW = 1.0f / clip[3];
+        const float x = (clip[0] * invW * 0.5f + 0.5f) * mWidth;
+        const float y = (clip[1] * invW * 0.5f + 0.5f) * mHeight;
+        minX = std::min(minX, x);
+        maxX = std::max(maxX, x);
+        minY = std::min(minY, y);
+        maxY = std::max(maxY, y);
+        nearest = std::min(nearest, clip[2] * invW * 0.5f + 0.5f);
+    }
+
+    int x0 = std::max(0, static_cast<int>(std::floor(minX)));
+    int y0 = std::max(0, static_cast<int>(std::floor(minY)));
+    int x1 = std::min(mWidth - 1, static_cast<int>(std::floor(maxX)));
+    int y1 = std::min(mHeight - 1, static_cast<int>(std::floor(maxY)));
+    if (x0 > x1 || y0 > y1) return false; // за краем кадра — дело отсечения по пирамиде видимости
+
+    // Уровень, где прямоугольник занимает не больше OCCLUSION_TEST_TEXELS по оси
+    std::size_t k = 0;
+    while ((x1 - x0 >= OCCLUSION_TEST_TEXELS || y1 - y0 >= OCCLUSION_TEST_TEXELS) && k + 1 < mLevels.size()) {
+        x0 >>= 1;
+        y0 >>= 1;
+        x1 >>= 1;
+        y1 >>= 1;
+        ++k;
+    }
+
+    const Level& level = mLevels[k];
+    for (int y = y0; y <= y1; ++y) {
+        const float* row = level.depth.data() + static_cast<std::size_t>(y) * level.width;
+        for (int x = x0; x <= x1; ++x) {
+            if (row[x] >= nearest) return false;
+        }
+    }
+    return true;
+}
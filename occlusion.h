@@ -0,0 +1,58 @@
+// ═══════════════════════════════════════
+// Отсечение перекрытых объектов по иерархическому буферу глубины (Hi-Z)
+// Небольшой набор окклюдеров (ближайшие непрозрачные объекты, упрощённые
+// до плоских фигур, лежащих внутри них) растеризуется на CPU в буфер глубины
+// низкого разрешения. Над ним строится пирамида: каждый следующий уровень
+// вдвое меньше и хранит наибольшую (дальнюю) глубину своих 2x2 текселей.
+// Объект проверяется прямоугольником своего AABB на экране: берётся уровень,
+// где прямоугольник занимает не больше 4x4 текселей, и если все они ближе
+// самой ближней точки AABB — объект перекрыт. Растеризация консервативна
+// внутрь: пиксель заполняется, только если треугольник покрывает его целиком,
+// с дальней глубиной внутри пикселя — видимое никогда не отбрасывается
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "culling.h"
+#include "vecmath.h"
+
+#include <vector>
+
+// Ширина буфера глубины в пикселях (высота — по пропорциям кадра)
+static const int OCCLUSION_WIDTH = 256;
+
+class OcclusionBuffer {
+public:
+    // Начать кадр: матрица clip = projection * view, пропорции кадра
+    // (ширина / высота); глубина очищается до дальней
+    void begin(const Mat4& clip, float aspect);
+
+    // Растеризовать треугольник окклюдера (мировые координаты). Треугольники,
+    // задевающие ближнюю плоскость, пропускаются
+    void addTriangle(const float a[3], const float b[3], const float c[3]);
+
+    // Построить пирамиду после всех окклюдеров
+    void buildPyramid();
+
+    // true — AABB целиком за окклюдерами. Потокобезопасно после buildPyramid
+    bool occluded(const Aabb& box) const;
+
+    int width() const { return mWidth; }
+    int height() const { return mHeight; }
+
+    // Растеризованных треугольников за кадр
+    std::size_t triangles() const { return mTriangles; }
+
+private:
+    struct Level {
+        int width = 0;
+        int height = 0;
+        std::vector<float> depth; // глубина 0..1, строки снизу вверх
+    };
+
+    Mat4 mClip;
+    int mWidth = 0;
+    int mHeight = 0;
+    std::size_t mTriangles = 0;
+    std::vector<Level> mLevels; // [0] — буфер окклюдеров
+};
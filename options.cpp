@@ -0,0 +1,227 @@
+// ═══════════════════════════════════════
+// Параметры командной строки
+// ═══════════════════════════════════════
+
+#include "options.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Прочитать целочисленное значение следующего аргумента
+static bool readInt(int argc, char** argv, int& i, int& out) {
+    if (i + 1 >= argc) {
+        std::fprintf(stderr, "Missing value for %s\n", argv[i]);
+        return false;
+    }
+    char* end = nullptr;
+    long v = std::strtol(argv[++i], &end, 10);
+    if (end == argv[i] || *end != '\0') {
+        std::fprintf(stderr, "Invalid value for %s: %s\n", argv[i - 1], argv[i]);
+        return false;
+    }
+    out = static_cast<int>(v);
+    return true;
+}
+
+// Прочитать строковое значение следующего аргумента
+static bool readString(int argc, char** argv, int& i, std::string& out) {
+    if (i + 1 >= argc) {
+        std::fprintf(stderr, "Missing value for %s\n", argv[i]);
+        return false;
+    }
+    out = argv[++i];
+    return true;
+}
+
+// Прочитать вещественное значение следующего аргумента
+static bool readDouble(int argc, char** argv, int& i, double& out) {
+    if (i + 1 >= argc) {
+        std::fprintf(stderr, "Missing value for %s\n", argv[i]);
+        return false;
+    }
+    char* end = nullptr;
+    double v = std::strtod(argv[++i], &end);
+    if (end == argv[i] || *end != '\0') {
+        std::fprintf(stderr, "Invalid value for %s: %s\n", argv[i - 1], argv[i]);
+        return false;
+    }
+    out = v;
+    return true;
+}
+
+// Разобрать политику вертикальной синхронизации
+static bool readVsync(int argc, char** argv, int& i, VsyncMode& out) {
+    std::string value;
+    if (!readString(argc, argv, i, value)) return false;
+    if (value == "off") {
+        out = VSYNC_OFF;
+    } else if (value == "on") {
+        out = VSYNC_ON;
+    } else if (value == "adaptive") {
+        out = VSYNC_ADAPTIVE;
+    } else {
+        std::fprintf(stderr, "Invalid value for --vsync: %s (expected off, on, adaptive)\n",
+                     value.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool parseOptions(int argc, char** argv, AppOptions& opts) {
+    BenchOptions& bench = opts.bench;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        bool ok = true;
+        if (std::strcmp(arg, "--bench") == 0) {
+            bench.enabled = true;
+        } else if (std::strcmp(arg, "--headless") == 0) {
+            bench.headless = true;
+        } else if (std::strcmp(arg, "--frames") == 0) {
+            ok = readInt(argc, argv, i, bench.frames);
+        } else if (std::strcmp(arg, "--warmup") == 0) {
+            ok = readInt(argc, argv, i, bench.warmup);
+        } else if (std::strcmp(arg, "--scene") == 0) {
+            ok = readInt(argc, argv, i, bench.scene);
+        } else if (std::strcmp(arg, "--width") == 0) {
+            ok = readInt(argc, argv, i, bench.width);
+        } else if (std::strcmp(arg, "--height") == 0) {
+            ok = readInt(argc, argv, i, bench.height);
+        } else if (std::strcmp(arg, "--trees") == 0) {
+            ok = readInt(argc, argv, i, bench.trees);
+        } else if (std::strcmp(arg, "--objects") == 0) {
+            ok = readInt(argc, argv, i, bench.objects);
+        } else if (std::strcmp(arg, "--json") == 0) {
+            ok = readString(argc, argv, i, bench.jsonPath);
+        } else if (std::strcmp(arg, "--profile") == 0) {
+            opts.profile = true;
+        } else if (std::strcmp(arg, "--trace") == 0) {
+            ok = readString(argc, argv, i, opts.tracePath);
+        } else if (std::strcmp(arg, "--on-demand") == 0) {
+            opts.onDemand = true;
+        } else if (std::strcmp(arg, "--redraw-timeout") == 0) {
+            ok = readDouble(argc, argv, i, opts.redrawTimeout);
+        } else if (std::strcmp(arg, "--vsync") == 0) {
+            ok = readVsync(argc, argv, i, opts.vsync);
+        } else if (std::strcmp(arg, "--fps-limit") == 0) {
+            ok = readDouble(argc, argv, i, opts.fpsLimit);
+        } else if (std::strcmp(arg, "--no-lod") == 0) {
+            opts.noLod = true;
+        } else if (std::strcmp(arg, "--pan-speed") == 0) {
+            ok = readDouble(argc, argv, i, bench.panSpeed);
+        } else if (std::strcmp(arg, "--infinite-forest") == 0) {
+            opts.infiniteForest = true;
+        } else if (std::strcmp(arg, "--chunk-trees") == 0) {
+            ok = readInt(argc, argv, i, opts.chunkTrees);
+        } else if (std::strcmp(arg, "--no-cull") == 0) {
+            opts.noCull = true;
+        } else if (std::strcmp(arg, "--no-occlusion") == 0) {
+            opts.noOcclusion = true;
+        } else if (std::strcmp(arg, "--no-stream-ring") == 0) {
+            opts.noStreamRing = true;
+        } else if (std::strcmp(arg, "--core") == 0) {
+            opts.core = true;
+        } else if (std::strcmp(arg, "--software") == 0) {
+            opts.software = true;
+        } else if (std::strcmp(arg, "--output") == 0) {
+            ok = readString(argc, argv, i, opts.outputPath);
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            ok = readInt(argc, argv, i, opts.threads);
+        } else if (std::strcmp(arg, "--optimize-meshes") == 0) {
+            opts.optimizeMeshes = true;
+        } else if (std::strcmp(arg, "--mesh-stats") == 0) {
+            opts.meshStats = true;
+        } else if (std::strcmp(arg, "--dynamic-res") == 0) {
+            ok = readDouble(argc, argv, i, opts.dynamicResMs);
+        } else if (std::strcmp(arg, "--min-scale") == 0) {
+            ok = readDouble(argc, argv, i, opts.minScale);
+        } else if (std::strcmp(arg, "--stress") == 0) {
+            ok = readInt(argc, argv, i, opts.stressCount);
+        } else if (std::strcmp(arg, "--stress-spacing") == 0) {
+            ok = readDouble(argc, argv, i, opts.stressSpacing);
+        } else if (std::strcmp(arg, "--forest3d") == 0) {
+            ok = readInt(argc, argv, i, opts.forest3dCount);
+        } else if (std::strcmp(arg, "--impostor-distance") == 0) {
+            ok = readDouble(argc, argv, i, opts.impostorDistance);
+        } else if (std::strcmp(arg, "--stress-submit") == 0) {
+            std::string value;
+            ok = readString(argc, argv, i, value);
+            if (ok && !parseStressSubmit(value.c_str(), opts.stressSubmit)) {
+                std::fprintf(stderr, "Invalid value for --stress-submit: %s "
+                                     "(expected auto, instanced, indirect)\n", value.c_str());
+                ok = false;
+            }
+        } else if (std::strcmp(arg, "--scene-file") == 0) {
+            ok = readString(argc, argv, i, opts.sceneFile);
+        } else if (std::strcmp(arg, "--convert-scene") == 0) {
+            if (i + 2 >= argc) {
+                std::fprintf(stderr, "--convert-scene needs TEXT and OUTPUT paths\n");
+                return false;
+            }
+            opts.convertInput  = argv[++i];
+            opts.convertOutput = argv[++i];
+        } else if (std::strcmp(arg, "--record") == 0) {
+            ok = readString(argc, argv, i, opts.recordPath);
+        } else if (std::strcmp(arg, "--record-fps") == 0) {
+            ok = readInt(argc, argv, i, opts.recordFps);
+        } else if (std::strcmp(arg, "--transparency") == 0) {
+            std::string value;
+            ok = readString(argc, argv, i, value);
+            if (ok && !parseTransparencyMode(value.c_str(), opts.transparency)) {
+                std::fprintf(stderr, "Invalid value for --transparency: %s "
+                                     "(expected unsorted, sorted, oit)\n", value.c_str());
+                ok = false;
+            }
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg);
+            return false;
+        }
+        if (!ok) return false;
+    }
+
+    if (bench.frames <= 0 || bench.warmup < 0 || bench.width <= 0 || bench.height <= 0 ||
+        (bench.scene != 0 && bench.scene != 1)) {
+        std::fprintf(stderr, "Invalid benchmark parameters\n");
+        return false;
+    }
+    if (opts.threads < 0) {
+        std::fprintf(stderr, "Invalid value for --threads: %d\n", opts.threads);
+        return false;
+    }
+    if (opts.dynamicResMs < 0.0) {
+        std::fprintf(stderr, "Invalid value for --dynamic-res: %g\n", opts.dynamicResMs);
+        return false;
+    }
+    if (opts.minScale <= 0.0 || opts.minScale > 1.0) {
+        std::fprintf(stderr, "Invalid value for --min-scale: %g (expected 0 < F <= 1)\n", opts.minScale);
+        return false;
+    }
+    if (opts.stressCount < 0 || opts.stressCount > static_cast<int>(STRESS_MAX_INSTANCES)) {
+        std::fprintf(stderr, "Invalid value for --stress: %d (expected 0..%d)\n", opts.stressCount,
+                     static_cast<int>(STRESS_MAX_INSTANCES));
+        return false;
+    }
+    if (opts.stressSpacing <= 0.0) {
+        std::fprintf(stderr, "Invalid value for --stress-spacing: %g\n", opts.stressSpacing);
+        return false;
+    }
+    if (opts.forest3dCount < 0 || opts.forest3dCount > static_cast<int>(FOREST3D_MAX_TREES)) {
+        std::fprintf(stderr, "Invalid value for --forest3d: %d (expected 0..%d)\n", opts.forest3dCount,
+                     static_cast<int>(FOREST3D_MAX_TREES));
+        return false;
+    }
+    if (opts.impostorDistance <= 0.0) {
+        std::fprintf(stderr, "Invalid value for --impostor-distance: %g\n", opts.impostorDistance);
+        return false;
+    }
+    if (opts.recordFps <= 0) {
+        std::fprintf(stderr, "Invalid value for --record-fps: %d\n", opts.recordFps);
+        return false;
+    }
+    if (opts.redrawTimeout < 0.0 || opts.fpsLimit < 0.0) {
+        std::fprintf(stderr, "Invalid frame pacing parameters\n");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+// ═══════════════════════════════════════
+// Параметры командной строки
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "bench.h"
+#include "forest3d.h"
+#include "frame_pacer.h"
+#include "stress_scene.h"
+#include "transparency.h"
+
+#include <string>
+
+// Все параметры запуска приложения
+struct AppOptions {
+    BenchOptions bench;     // --bench и его параметры
+    bool         profile = false; // --profile: сводка по фазам кадра
+    std::string  tracePath;       // --trace FILE: трасса Chrome trace_event
+
+    // Темп отрисовки
+    bool      onDemand      = false;   // --on-demand: перерисовка только по событиям
+    double    redrawTimeout = 0.0;     // --redraw-timeout SEC: пробуждение для анимаций
+    VsyncMode vsync         = VSYNC_ON; // --vsync off|on|adaptive
+    double    fpsLimit      = 0.0;     // --fps-limit N: ограничение частоты (0 — нет)
+
+    bool core = false; // --core: контекст OpenGL 3.3 core, только шейдеры
+
+    // --transparency unsorted|sorted|oit: смешивание полупрозрачных объектов
+    TransparencyMode transparency = TRANSPARENCY_SORTED;
+
+    bool noLod = false;  // --no-lod: сфера всегда в полной детализации
+    bool noCull = false; // --no-cull: рисовать все объекты без отсечения
+    bool noOcclusion = false; // --no-occlusion: 3D-лес без отсечения перекрытых деревьев
+    bool noStreamRing = false; // --no-stream-ring: данные кадра через glBufferSubData, без кольца
+
+    bool infiniteForest = false; // --infinite-forest: 2D-лес из подгружаемых чанков
+    int  chunkTrees = 0;         // --chunk-trees: деревьев в чанке (0 — по умолчанию)
+
+    bool        software = false; // --software: отрисовка на процессоре без OpenGL
+    std::string outputPath;       // --output FILE: сохранить кадр в PPM/PNG
+    int         threads = 0;      // --threads N: потоков программной отрисовки (0 — по числу ядер)
+
+    bool        optimizeMeshes = false; // --optimize-meshes: слить вершины и переставить треугольники сеток
+    bool        meshStats = false;      // --mesh-stats: напечатать ACMR/ATVR и перерисовку сеток и выйти
+
+    double      dynamicResMs = 0.0; // --dynamic-res MS: бюджет кадра для динамического разрешения (0 — выкл)
+    double      minScale = 0.5;     // --min-scale F: наименьшая доля стороны кадра
+
+    int          stressCount = 0;      // --stress N: нагрузочная 3D-сцена из N примитивов (0 — выкл)
+    double       stressSpacing = 1.0;  // --stress-spacing F: шаг сетки нагрузочной сцены
+    StressSubmit stressSubmit = STRESS_SUBMIT_AUTO; // --stress-submit auto|instanced|indirect
+
+    int    forest3dCount = 0;    // --forest3d N: 3D-лес из N деревьев вокруг примитивов (0 — выкл)
+    double impostorDistance = FOREST3D_IMPOSTOR_DISTANCE; // --impostor-distance F: переход в impostor
+
+    std::string sceneFile;        // --scene-file FILE: содержимое сцен из двоичного файла
+    std::string convertInput;     // --convert-scene TEXT OUT: собрать файл сцены и выйти
+    std::string convertOutput;
+
+    std::string recordPath;     // --record FILE: запись видео (.y4m, шаблон PPM или сырые RGB)
+    int         recordFps = 60; // --record-fps N: частота кадров в заголовке Y4M
+};
+
+// Разобрать аргументы командной строки. Возвращает false при ошибке
+// (сообщение уже выведено в stderr)
+bool parseOptions(int argc, char** argv, AppOptions& opts);
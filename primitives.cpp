@@ -0,0 +1,89 @@
+// ═══════════════════════════════════════
+// Примитивы 3D-сцены
+// ═══════════════════════════════════════
+
+#include "primitives.h"
+#include "mesh_optimizer.h"
+#include "mesh_tables.h"
+
+static constexpr CubeTable    CUBE_TABLE    = makeCubeTable(CUBE_SIZE);
+static constexpr PyramidTable PYRAMID_TABLE = makePyramidTable(PYRAMID_HALF_BASE, PYRAMID_HEIGHT);
+static constexpr SphereTable<SPHERE_SLICES, SPHERE_STACKS> SPHERE_TABLE =
+    makeSphereTable<SPHERE_SLICES, SPHERE_STACKS>(SPHERE_RADIUS);
+
+// Уровни сферы: число сегментов по долготе и широте
+static constexpr SphereTable<64, 64> SPHERE_LOD_64 = makeSphereTable<64, 64>(SPHERE_RADIUS);
+static constexpr SphereTable<32, 32> SPHERE_LOD_32 = makeSphereTable<32, 32>(SPHERE_RADIUS);
+static constexpr SphereTable<16, 16> SPHERE_LOD_16 = makeSphereTable<16, 16>(SPHERE_RADIUS);
+static constexpr SphereTable<8, 8>   SPHERE_LOD_8  = makeSphereTable<8, 8>(SPHERE_RADIUS);
+static constexpr SphereTable<4, 4>   SPHERE_LOD_4  = makeSphereTable<4, 4>(SPHERE_RADIUS);
+
+// Наибольшее отклонение хорды от окружности при n сегментах на оборот, в долях радиуса
+static constexpr float chordError(int n) {
+    return 1.0f - static_cast<float>(ctCos(static_cast<float>(CT_PI) / static_cast<float>(n)));
+}
+
+const Mesh& getCubeMesh() {
+    return getTableMesh(CUBE_TABLE);
+}
+
+const Mesh& getPyramidMesh() {
+    return getTableMesh(PYRAMID_TABLE);
+}
+
+const Mesh& getSphereMesh() {
+    return getTableMesh(SPHERE_TABLE);
+}
+
+const LodChain& getSphereLodChain() {
+    static LodChain chain;
+    if (chain.levels.empty()) {
+        chain.levels = {&getTableMesh(SPHERE_LOD_64), &getTableMesh(SPHERE_LOD_32),
+                        &getTableMesh(SPHERE_LOD_16), &getTableMesh(SPHERE_LOD_8),
+                        &getTableMesh(SPHERE_LOD_4)};
+        chain.error = {chordError(64), chordError(32), chordError(16), chordError(8), chordError(4)};
+    }
+    return chain;
+}
+
+// ═══════════════════════════════════════
+// Отчёт по сеткам
+// ═══════════════════════════════════════
+
+// Столбцы одной сетки: вершины, треугольники, ACMR, ATVR, перерисовка
+static void printMeshRow(std::FILE* out, const std::vector<MeshVertex>& vertices,
+                         const std::vector<unsigned int>& indices) {
+    VertexCacheStats cache = analyzeVertexCache(indices, vertices.size(), MESH_CACHE_SIZE);
+    OverdrawStats overdraw = analyzeOverdraw(indices, vertices);
+    std::fprintf(out, "  %6zu %6zu %6.3f %6.3f %8.3f", vertices.size(), indices.size() / 3,
+                 cache.acmr, cache.atvr, overdraw.overdraw);
+}
+
+// Строка отчёта: сетка как есть и после optimizeMesh
+template <std::size_t VertexCount, std::size_t IndexCount>
+static void printTableStats(std::FILE* out, const char* name,
+                            const MeshTable<VertexCount, IndexCount>& table) {
+    std::vector<MeshVertex> vertices(table.vertices, table.vertices + VertexCount);
+    std::vector<unsigned int> indices(table.indices, table.indices + IndexCount);
+    std::fprintf(out, "%-14s", name);
+    printMeshRow(out, vertices, indices);
+    optimizeMesh(vertices, indices);
+    std::fprintf(out, "  |");
+    printMeshRow(out, vertices, indices);
+    std::fprintf(out, "\n");
+}
+
+void printPrimitiveMeshStats(std::FILE* out) {
+    std::fprintf(out, "Vertex cache: FIFO %d; overdraw: 6 axis views, depth test, no culling\n",
+                 MESH_CACHE_SIZE);
+    std::fprintf(out, "%-14s  %6s %6s %6s %6s %8s  |  %6s %6s %6s %6s %8s\n", "mesh",
+                 "verts", "tris", "ACMR", "ATVR", "overdraw", "verts", "tris", "ACMR", "ATVR", "overdraw");
+    printTableStats(out, "cube", CUBE_TABLE);
+    printTableStats(out, "pyramid", PYRAMID_TABLE);
+    printTableStats(out, "sphere", SPHERE_TABLE);
+    printTableStats(out, "sphere lod 64", SPHERE_LOD_64);
+    printTableStats(out, "sphere lod 32", SPHERE_LOD_32);
+    printTableStats(out, "sphere lod 16", SPHERE_LOD_16);
+    printTableStats(out, "sphere lod 8", SPHERE_LOD_8);
+    printTableStats(out, "sphere lod 4", SPHERE_LOD_4);
+}
@@ -0,0 +1,35 @@
+// ═══════════════════════════════════════
+// Примитивы 3D-сцены: размеры и готовые меши
+// Сетки куба, пирамиды и всех уровней детализации сферы собраны
+// при компиляции (mesh_tables.h) и лежат в образе программы
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "lod.h"
+#include "mesh.h"
+
+#include <cstdio>
+
+// Параметры пирамиды
+static constexpr float PYRAMID_HALF_BASE = 0.5f;
+static constexpr float PYRAMID_HEIGHT    = 1.0f;
+
+// Параметры сферы (без уровней детализации)
+static constexpr float SPHERE_RADIUS = 0.5f;
+static constexpr int   SPHERE_SLICES = 32;
+static constexpr int   SPHERE_STACKS = 32;
+
+// Размер куба
+static constexpr float CUBE_SIZE = 0.8f;
+
+const Mesh& getCubeMesh();
+const Mesh& getPyramidMesh();
+const Mesh& getSphereMesh();
+
+// Цепочка уровней сферы (64, 32, 16, 8 и 4 сегмента)
+const LodChain& getSphereLodChain();
+
+// Таблица ACMR/ATVR и перерисовки всех сеток примитивов до и после
+// оптимизации (без OpenGL)
+void printPrimitiveMeshStats(std::FILE* out);
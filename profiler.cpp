@@ -0,0 +1,322 @@
+// ═══════════════════════════════════════
+// Профилировщик кадра
+// ═══════════════════════════════════════
+
+#include "profiler.h"
+#include "gl_ext.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+bool gProfilerEnabled = false;
+
+// Кадров в кольце запросов GPU: результаты кадра N читаются в кадре N + GPU_LATENCY
+static const int GPU_LATENCY = 4;
+
+// Кадров в скользящей сводке
+static const int SUMMARY_WINDOW = 120;
+
+// Предел событий трассы (защита от неограниченного роста памяти)
+static const std::size_t MAX_TRACE_EVENTS = 2000000;
+
+// Дорожки трассы
+static const int TID_CPU = 1;
+static const int TID_GPU = 2;
+
+typedef std::chrono::steady_clock Clock;
+
+// ═══════════════════════════════════════
+// Внутреннее состояние
+// ═══════════════════════════════════════
+
+// Завершённый интервал (или значение счётчика, если tid == 0) для трассы
+struct TraceEvent {
+    const char* name;
+    double      startUs;
+    double      durUs;   // для счётчика — значение
+    int         tid;
+};
+
+// Интервал GPU: пара запросов-меток в пуле слота
+struct GpuSpan {
+    const char* name;
+    int         startQuery;
+    int         endQuery;
+};
+
+// Слот кольца: запросы одного кадра
+struct GpuFrameSlot {
+    std::vector<GLuint>  queries;   // пул, растёт по мере надобности
+    int                  used = 0;
+    std::vector<GpuSpan> spans;
+    bool                 pending = false;
+};
+
+// Скользящий ряд значений одной фазы
+struct PhaseSeries {
+    std::vector<double> samples;
+    std::size_t         next = 0;
+
+    void push(double v) {
+        if (samples.size() < static_cast<std::size_t>(SUMMARY_WINDOW)) {
+            samples.push_back(v);
+        } else {
+            samples[next] = v;
+            next = (next + 1) % samples.size();
+        }
+    }
+};
+
+// Сравнение имён фаз по содержимому, а не по адресу литерала
+struct NameLess {
+    bool operator()(const char* a, const char* b) const { return std::strcmp(a, b) < 0; }
+};
+
+struct PhaseStats {
+    PhaseSeries cpu;
+    PhaseSeries gpu;
+};
+
+static Clock::time_point gEpoch;
+static std::string       gTracePath;
+static bool              gTracing = false;
+static bool              gGpuTiming = false;
+static double            gGpuOffsetUs = 0.0;  // перевод времени GPU на шкалу CPU
+static long long         gFrameIndex = 0;
+static double            gFrameStartUs = 0.0;
+static int               gDroppedGpuFrames = 0;
+
+static std::vector<TraceEvent>                   gTrace;
+static GpuFrameSlot                              gSlots[GPU_LATENCY];
+static std::map<const char*, PhaseStats, NameLess> gStats;
+static std::map<const char*, PhaseSeries, NameLess> gCounters;
+
+static double nowUs() {
+    return std::chrono::duration<double, std::micro>(Clock::now() - gEpoch).count();
+}
+
+static void recordTrace(const char* name, double startUs, double durUs, int tid) {
+    if (!gTracing || gTrace.size() >= MAX_TRACE_EVENTS) return;
+    TraceEvent e = {name, startUs, durUs, tid};
+    gTrace.push_back(e);
+}
+
+static GpuFrameSlot& currentSlot() {
+    return gSlots[gFrameIndex % GPU_LATENCY];
+}
+
+// ═══════════════════════════════════════
+// Сбор результатов GPU
+// ═══════════════════════════════════════
+
+// Прочитать результаты слота, если GPU их уже записал; иначе отбросить без ожидания
+static void collectSlot(GpuFrameSlot& slot) {
+    if (!slot.pending) return;
+    slot.pending = false;
+    if (slot.used == 0) return;
+
+    // Запросы завершаются по порядку: достаточно проверить последний
+    GLint available = 0;
+    gl.GetQueryObjectiv(slot.queries[slot.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) {
+        ++gDroppedGpuFrames;
+        return;
+    }
+
+    for (const GpuSpan& span : slot.spans) {
+        if (span.endQuery < 0) continue; // область не закрыта (не должно случаться)
+        unsigned long long t0 = 0;
+        unsigned long long t1 = 0;
+        gl.GetQueryObjectui64v(slot.queries[span.startQuery], GL_QUERY_RESULT, &t0);
+        gl.GetQueryObjectui64v(slot.queries[span.endQuery], GL_QUERY_RESULT, &t1);
+        double startUs = static_cast<double>(t0) / 1000.0 + gGpuOffsetUs;
+        double durUs   = static_cast<double>(t1 - t0) / 1000.0;
+        recordTrace(span.name, startUs, durUs, TID_GPU);
+        gStats[span.name].gpu.push(durUs / 1000.0);
+    }
+}
+
+// Выдать запрос-метку из пула текущего слота и поставить её в поток команд
+static int issueTimestamp() {
+    GpuFrameSlot& slot = currentSlot();
+    if (slot.used == static_cast<int>(slot.queries.size())) {
+        GLuint q = 0;
+        gl.GenQueries(1, &q);
+        slot.queries.push_back(q);
+    }
+    int index = slot.used++;
+    gl.QueryCounter(slot.queries[index], GL_TIMESTAMP);
+    return index;
+}
+
+// ═══════════════════════════════════════
+// Области замера
+// ═══════════════════════════════════════
+
+void ProfileScope::begin(const char* name, bool gpu) {
+    mName = name;
+    if (gpu && gGpuTiming) {
+        GpuFrameSlot& slot = currentSlot();
+        GpuSpan span = {name, issueTimestamp(), -1};
+        mGpuSpan = static_cast<int>(slot.spans.size());
+        slot.spans.push_back(span);
+    }
+    mStartUs = nowUs();
+}
+
+void ProfileScope::end() {
+    double endUs = nowUs();
+    if (mGpuSpan >= 0) {
+        currentSlot().spans[mGpuSpan].endQuery = issueTimestamp();
+    }
+    recordTrace(mName, mStartUs, endUs - mStartUs, TID_CPU);
+    gStats[mName].cpu.push((endUs - mStartUs) / 1000.0);
+}
+
+void profilerCounterImpl(const char* name, double value) {
+    recordTrace(name, nowUs(), value, 0);
+    gCounters[name].push(value);
+}
+
+// ═══════════════════════════════════════
+// Кадры
+// ═══════════════════════════════════════
+
+void profilerInit(const char* tracePath) {
+    gProfilerEnabled = true;
+    gEpoch = Clock::now();
+    gTracing = tracePath != nullptr && tracePath[0] != '\0';
+    if (gTracing) gTracePath = tracePath;
+
+    gGpuTiming = gl.hasTimerQuery;
+    if (gGpuTiming) {
+        // Сопоставить часы GPU с часами CPU в один момент
+        long long gpuNs = 0;
+        gl.GetInteger64v(GL_TIMESTAMP, &gpuNs);
+        gGpuOffsetUs = nowUs() - static_cast<double>(gpuNs) / 1000.0;
+    }
+}
+
+void profilerBeginFrame() {
+    if (!gProfilerEnabled) return;
+
+    // Слот этого кадра использовался GPU_LATENCY кадров назад — забрать его результаты
+    GpuFrameSlot& slot = currentSlot();
+    if (gGpuTiming) collectSlot(slot);
+    slot.used = 0;
+    slot.spans.clear();
+
+    gFrameStartUs = nowUs();
+}
+
+void profilerEndFrame() {
+    if (!gProfilerEnabled) return;
+
+    double endUs = nowUs();
+    recordTrace("frame", gFrameStartUs, endUs - gFrameStartUs, TID_CPU);
+    gStats["frame"].cpu.push((endUs - gFrameStartUs) / 1000.0);
+
+    currentSlot().pending = true;
+    ++gFrameIndex;
+}
+
+// ═══════════════════════════════════════
+// Сводка и трасса
+// ═══════════════════════════════════════
+
+static void seriesStats(const PhaseSeries& s, double& avg, double& mx) {
+    avg = 0.0;
+    mx = 0.0;
+    if (s.samples.empty()) return;
+    for (double v : s.samples) {
+        avg += v;
+        mx = std::max(mx, v);
+    }
+    avg /= static_cast<double>(s.samples.size());
+}
+
+void profilerPrintSummary(std::FILE* out) {
+    if (!gProfilerEnabled) return;
+
+    std::fprintf(out, "Profile, last %d samples per phase (ms):\n", SUMMARY_WINDOW);
+    std::fprintf(out, "  %-20s %9s %9s %9s %9s\n", "phase", "cpu avg", "cpu max", "gpu avg", "gpu max");
+    for (const auto& entry : gStats) {
+        double cpuAvg, cpuMax, gpuAvg, gpuMax;
+        seriesStats(entry.second.cpu, cpuAvg, cpuMax);
+        seriesStats(entry.second.gpu, gpuAvg, gpuMax);
+        if (entry.second.gpu.samples.empty()) {
+            std::fprintf(out, "  %-20s %9.3f %9.3f %9s %9s\n", entry.first, cpuAvg, cpuMax, "-", "-");
+        } else {
+            std::fprintf(out, "  %-20s %9.3f %9.3f %9.3f %9.3f\n",
+                         entry.first, cpuAvg, cpuMax, gpuAvg, gpuMax);
+        }
+    }
+    if (!gCounters.empty()) {
+        std::fprintf(out, "  %-20s %9s %9s\n", "counter", "avg", "max");
+        for (const auto& entry : gCounters) {
+            double avg, mx;
+            seriesStats(entry.second, avg, mx);
+            std::fprintf(out, "  %-20s %9.1f %9.1f\n", entry.first, avg, mx);
+        }
+    }
+    if (!gGpuTiming) {
+        std::fprintf(out, "  (GPU timer queries unavailable)\n");
+    } else if (gDroppedGpuFrames > 0) {
+        std::fprintf(out, "  (%d frames of GPU results not ready in time, dropped)\n", gDroppedGpuFrames);
+    }
+}
+
+static void writeTrace() {
+    std::FILE* f = std::fopen(gTracePath.c_str(), "w");
+    if (f == nullptr) {
+        std::fprintf(stderr, "Cannot write trace %s\n", gTracePath.c_str());
+        return;
+    }
+
+    std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                    "\"args\":{\"name\":\"CPU\"}},\n", TID_CPU);
+    std::fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                    "\"args\":{\"name\":\"GPU\"}}", TID_GPU);
+    for (const TraceEvent& e : gTrace) {
+        if (e.tid == 0) {
+            std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,"
+                            "\"args\":{\"value\":%.3f}}", e.name, e.startUs, e.durUs);
+        } else {
+            std::fprintf(f, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+                            "\"ts\":%.3f,\"dur\":%.3f}", e.name, e.tid, e.startUs, e.durUs);
+        }
+    }
+    std::fprintf(f, "\n]}\n");
+    std::fclose(f);
+
+    if (gTrace.size() >= MAX_TRACE_EVENTS) {
+        std::fprintf(stderr, "Trace truncated at %zu events\n", MAX_TRACE_EVENTS);
+    }
+}
+
+void profilerShutdown() {
+    if (!gProfilerEnabled) return;
+
+    // Дочитать то, что GPU уже успел выполнить
+    if (gGpuTiming) {
+        glFinish();
+        for (GpuFrameSlot& slot : gSlots) collectSlot(slot);
+    }
+    if (gTracing) writeTrace();
+
+    for (GpuFrameSlot& slot : gSlots) {
+        if (!slot.queries.empty()) {
+            gl.DeleteQueries(static_cast<GLsizei>(slot.queries.size()), slot.queries.data());
+        }
+        slot = GpuFrameSlot();
+    }
+    gTrace.clear();
+    gStats.clear();
+    gCounters.clear();
+    gProfilerEnabled = false;
+}
@@ -0,0 +1,64 @@
+// ═══════════════════════════════════════
+// Профилировщик кадра: интервалы CPU и GPU по фазам
+// Выключенный профилировщик стоит одной проверки флага на область.
+// Запросы таймера GPU читаются через несколько кадров без ожидания,
+// результаты выгружаются в формате Chrome trace_event
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <cstdio>
+
+// Профилировщик включён (--profile или --trace)
+extern bool gProfilerEnabled;
+
+// Включить профилировщик; tracePath — файл Chrome trace (nullptr — без трассы).
+// Вызывать после создания контекста OpenGL
+void profilerInit(const char* tracePath);
+
+// Записать трассу, освободить запросы GPU (до уничтожения контекста)
+void profilerShutdown();
+
+// Границы кадра: в начале кадра собираются готовые результаты GPU прошлых кадров
+void profilerBeginFrame();
+void profilerEndFrame();
+
+// Записать значение счётчика за кадр (число объектов, вызовов и т.п.)
+void profilerCounterImpl(const char* name, double value);
+inline void profilerCounter(const char* name, double value) {
+    if (gProfilerEnabled) profilerCounterImpl(name, value);
+}
+
+// Вывести скользящую сводку по фазам за последние кадры
+void profilerPrintSummary(std::FILE* out);
+
+// Область замера: интервал CPU и, если gpu == true, интервал GPU по меткам времени
+class ProfileScope {
+public:
+    ProfileScope(const char* name, bool gpu) {
+        if (gProfilerEnabled) begin(name, gpu);
+    }
+    ~ProfileScope() {
+        if (mName != nullptr) end();
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    void begin(const char* name, bool gpu);
+    void end();
+
+    const char* mName = nullptr;
+    double      mStartUs = 0.0;
+    int         mGpuSpan = -1;
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// Замер только процессорного времени области
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name, false)
+
+// Замер процессорного и графического времени области
+#define PROFILE_GPU_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name, true)
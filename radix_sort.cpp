@@ -0,0 +1,119 @@
+// ═══════════════════════════════════════
+// Поразрядная сортировка пар (ключ, индекс)
+// ═══════════════════════════════════════
+
+#include "radix_sort.h"
+#include "thread_pool.h"
+
+#include <cstring>
+
+// Меньшие массивы сортируются в одном потоке: синхронизация дороже выигрыша
+static const std::size_t PARALLEL_THRESHOLD = 32768;
+
+static const int RADIX_BITS    = 8;
+static const int RADIX_BUCKETS = 1 << RADIX_BITS;
+static const int RADIX_PASSES  = 32 / RADIX_BITS;
+
+// Однопоточный проход по одному байту ключа
+static void radixPassSerial(const SortItem* src, SortItem* dst, std::size_t n, int shift) {
+    std::size_t count[RADIX_BUCKETS] = {};
+    for (std::size_t i = 0; i < n; ++i) ++count[(src[i].key >> shift) & 0xFF];
+
+    std::size_t sum = 0;
+    for (int b = 0; b < RADIX_BUCKETS; ++b) {
+        std::size_t c = count[b];
+        count[b] = sum;
+        sum += c;
+    }
+    for (std::size_t i = 0; i < n; ++i) dst[count[(src[i].key >> shift) & 0xFF]++] = src[i];
+}
+
+// Параллельный проход: у каждого исполнителя свой кусок входа и своя гистограмма,
+// смещения считаются по (корзина, исполнитель), чтобы сохранить устойчивость
+static void radixPassParallel(ThreadPool& pool, const SortItem* src, SortItem* dst,
+                              std::size_t n, int shift) {
+    const unsigned parts = pool.size();
+    std::vector<std::size_t> hist(static_cast<std::size_t>(parts) * RADIX_BUCKETS, 0);
+
+    // Куски совпадают с разбиением parallelFor: part-й кусок — [n*part/parts, n*(part+1)/parts)
+    pool.parallelFor(parts, [&](std::size_t pBegin, std::size_t pEnd, unsigned) {
+        for (std::size_t p = pBegin; p < pEnd; ++p) {
+            std::size_t* h = &hist[p * RADIX_BUCKETS];
+            std::size_t begin = n * p / parts;
+            std::size_t end   = n * (p + 1) / parts;
+            for (std::size_t i = begin; i < end; ++i) ++h[(src[i].key >> shift) & 0xFF];
+        }
+    });
+
+    std::size_t sum = 0;
+    for (int b = 0; b < RADIX_BUCKETS; ++b) {
+        for (unsigned p = 0; p < parts; ++p) {
+            std::size_t& slot = hist[static_cast<std::size_t>(p) * RADIX_BUCKETS + b];
+            std::size_t c = slot;
+            slot = sum;
+            sum += c;
+        }
+    }
+
+    pool.parallelFor(parts, [&](std::size_t pBegin, std::size_t pEnd, unsigned) {
+        for (std::size_t p = pBegin; p < pEnd; ++p) {
+            std::size_t* offs = &hist[p * RADIX_BUCKETS];
+            std::size_t begin = n * p / parts;
+            std::size_t end   = n * (p + 1) / parts;
+            for (std::size_t i = begin; i < end; ++i) dst[offs[(src[i].key >> shift) & 0xFF]++] = src[i];
+        }
+    });
+}
+
+void radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch) {
+    const std::size_t n = items.size();
+    if (n < 2) return;
+    scratch.resize(n);
+
+    // Байты, одинаковые у всех ключей, не влияют на порядок — такие проходы пропускаем
+    std::uint32_t orBits = 0;
+    std::uint32_t andBits = 0xFFFFFFFFu;
+    for (const SortItem& it : items) {
+        orBits |= it.key;
+        andBits &= it.key;
+    }
+    std::uint32_t varying = orBits ^ andBits;
+
+    ThreadPool& pool = ThreadPool::global();
+    bool parallel = n >= PARALLEL_THRESHOLD && pool.size() > 1;
+
+    SortItem* src = items.data();
+    SortItem* dst = scratch.data();
+    for (int pass = 0; pass < RADIX_PASSES; ++pass) {
+        int shift = pass * RADIX_BITS;
+        if (((varying >> shift) & 0xFF) == 0) continue;
+
+        if (parallel) {
+            radixPassParallel(pool, src, dst, n, shift);
+        } else {
+            radixPassSerial(src, dst, n, shift);
+        }
+        SortItem* t = src;
+        src = dst;
+        dst = t;
+    }
+
+    // Результат оказался в буфере — вернуть в items
+    if (src != items.data()) std::memcpy(items.data(), src, n * sizeof(SortItem));
+}
+
+void sortBackToFront(const float* viewDepth, std::size_t count, std::vector<std::uint32_t>& order) {
+    static std::vector<SortItem> items;
+    static std::vector<SortItem> scratch;
+
+    // Инвертированный ключ: по возрастанию ключа — по убыванию глубины
+    items.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        items[i].key   = ~floatSortKey(viewDepth[i]);
+        items[i].value = static_cast<std::uint32_t>(i);
+    }
+    radixSort(items, scratch);
+
+    order.resize(count);
+    for (std::size_t i = 0; i < count; ++i) order[i] = items[i].value;
+}
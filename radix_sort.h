@@ -0,0 +1,30 @@
+// ═══════════════════════════════════════
+// Поразрядная сортировка пар (ключ, индекс)
+// Большие массивы сортируются параллельно на пуле потоков
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Пара для сортировки: беззнаковый ключ и индекс объекта
+struct SortItem {
+    std::uint32_t key;
+    std::uint32_t value;
+};
+
+// Отобразить float в беззнаковый ключ с тем же порядком (по возрастанию)
+inline std::uint32_t floatSortKey(float f) {
+    union { float f; std::uint32_t u; } bits;
+    bits.f = f;
+    std::uint32_t mask = (bits.u & 0x80000000u) ? 0xFFFFFFFFu : 0x80000000u;
+    return bits.u ^ mask;
+}
+
+// Устойчивая сортировка по возрастанию ключа; scratch — буфер того же размера
+void radixSort(std::vector<SortItem>& items, std::vector<SortItem>& scratch);
+
+// Индексы объектов от дальнего к ближнему по глубине вида (больше — дальше)
+void sortBackToFront(const float* viewDepth, std::size_t count, std::vector<std::uint32_t>& order);
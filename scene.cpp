@@ -0,0 +1,202 @@
+// ═══════════════════════════════════════
+// Содержимое сцен
+// ═══════════════════════════════════════
+
+#include "scene.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+// ═══════════════════════════════════════
+// Исходное содержимое
+// ═══════════════════════════════════════
+
+// Семь ёлочек с разными позициями и масштабами
+static const TreeInstance DEFAULT_TREES[] = {
+    {-0.85f, -0.6f,  0.55f},
+    {-0.55f, -0.65f, 0.45f},
+    {-0.25f, -0.6f,  0.65f},
+    { 0.05f, -0.7f,  0.38f},
+    { 0.32f, -0.6f,  0.58f},
+    { 0.62f, -0.65f, 0.42f},
+    { 0.88f, -0.6f,  0.52f},
+};
+
+// Материалы: зелёный куб, фиолетовая пирамида, синяя сфера
+static const Material DEFAULT_MATERIALS[] = {
+    {{0.1f,  0.7f,  0.2f },  {0.9f, 0.9f, 0.9f, 1.0f}, 64.0f},
+    {{0.55f, 0.0f,  0.8f },  {0.9f, 0.9f, 0.9f, 1.0f}, 32.0f},
+    {{0.15f, 0.35f, 0.85f},  {1.0f, 1.0f, 1.0f, 1.0f}, 128.0f},
+};
+
+// Куб слева (повёрнут), пирамида по центру, сфера справа
+static const SceneObject DEFAULT_OBJECTS[] = {
+    {PRIM_CUBE,    {-1.5f, 0.0f, 0.0f}, 30.0f, {1.0f, 1.0f, 0.0f}, 0},
+    {PRIM_PYRAMID, { 0.0f, 0.0f, 0.0f},  0.0f, {0.0f, 1.0f, 0.0f}, 1},
+    {PRIM_SPHERE,  { 1.5f, 0.0f, 0.0f},  0.0f, {0.0f, 1.0f, 0.0f}, 2},
+};
+
+static const std::size_t DEFAULT_OBJECT_COUNT = sizeof(DEFAULT_OBJECTS) / sizeof(DEFAULT_OBJECTS[0]);
+
+// Расстояние между соседними тройками примитивов в сетке
+static const float GRID_STEP_X = 4.5f;
+static const float GRID_STEP_Z = 2.0f;
+
+void buildDefaultScene(Scene& scene) {
+    scene.trees.reset().assign(std::begin(DEFAULT_TREES), std::end(DEFAULT_TREES));
+    scene.objects.reset().assign(std::begin(DEFAULT_OBJECTS), std::end(DEFAULT_OBJECTS));
+    scene.materials.reset().assign(std::begin(DEFAULT_MATERIALS), std::end(DEFAULT_MATERIALS));
+}
+
+// ═══════════════════════════════════════
+// Генераторы нагрузочных сцен
+// ═══════════════════════════════════════
+
+// Простой детерминированный генератор (xorshift32), одинаковый на всех платформах
+static float nextRandom(unsigned int& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return static_cast<float>(state & 0xFFFFFFu) / static_cast<float>(0x1000000);
+}
+
+void generateForest(Scene& scene, std::size_t count, unsigned int seed) {
+    unsigned int state = seed != 0 ? seed : 1u;
+    std::vector<TreeInstance>& trees = scene.trees.reset();
+    trees.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        TreeInstance t;
+        t.x     = -1.0f + 2.0f * nextRandom(state);
+        t.y     = -0.7f + 0.1f * nextRandom(state);
+        t.scale = 0.35f + 0.3f * nextRandom(state);
+        trees.push_back(t);
+    }
+}
+
+void generateForestChunk(std::vector<TreeInstance>& out, long long chunk, float x0, float width,
+                         int count, unsigned int seed) {
+    // Смешать зерно мира с номером чанка (финализатор MurmurHash3)
+    unsigned long long h = static_cast<unsigned long long>(chunk) * 0x9E3779B97F4A7C15ull ^ seed;
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    unsigned int state = static_cast<unsigned int>(h);
+    if (state == 0) state = 1u;
+
+    out.clear();
+    out.reserve(static_cast<std::size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        TreeInstance t;
+        t.x     = x0 + width * nextRandom(state);
+        t.y     = -0.7f + 0.1f * nextRandom(state);
+        t.scale = 0.35f + 0.3f * nextRandom(state);
+        out.push_back(t);
+    }
+}
+
+void generateObjectGrid(Scene& scene, std::size_t count) {
+    std::size_t triples = (count + DEFAULT_OBJECT_COUNT - 1) / DEFAULT_OBJECT_COUNT;
+    std::size_t side = static_cast<std::size_t>(std::ceil(std::sqrt(static_cast<double>(triples))));
+    if (side == 0) side = 1;
+
+    std::vector<SceneObject>& objects = scene.objects.reset();
+    objects.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t triple = i / DEFAULT_OBJECT_COUNT;
+        SceneObject obj = DEFAULT_OBJECTS[i % DEFAULT_OBJECT_COUNT];
+
+        // Сетка центрирована по X и уходит от камеры по -Z
+        float col = static_cast<float>(triple % side) - 0.5f * static_cast<float>(side - 1);
+        float row = static_cast<float>(triple / side);
+        obj.position[0] += col * GRID_STEP_X;
+        obj.position[2] -= row * GRID_STEP_Z;
+        objects.push_back(obj);
+    }
+}
+
+// Случайный поворот: ось на единичной сфере, угол в [0, 2pi)
+static void randomRotation(unsigned int& state, float q[4]) {
+    float z = 2.0f * nextRandom(state) - 1.0f;
+    float phi = 6.2831853f * nextRandom(state);
+    float r = std::sqrt(std::max(0.0f, 1.0f - z * z));
+    float half = 3.1415927f * nextRandom(state);
+    float s = std::sin(half);
+    q[0] = r * std::cos(phi) * s;
+    q[1] = r * std::sin(phi) * s;
+    q[2] = z * s;
+    q[3] = std::cos(half);
+}
+
+// Цвет по оттенку h в [0, 1) при насыщенности 0.75 и яркости 1 (HSV)
+static void hueColor(float h, std::uint8_t rgb[3]) {
+    for (int c = 0; c < 3; ++c) {
+        float k = std::fmod(5.0f - 2.0f * c + h * 6.0f, 6.0f);
+        float v = 1.0f - 0.75f * std::max(0.0f, std::min(std::min(k, 4.0f - k), 1.0f));
+        rgb[c] = static_cast<std::uint8_t>(v * 255.0f + 0.5f);
+    }
+}
+
+void generateStressInstances(std::vector<StressInstance>& out, std::size_t count, float spacing,
+                             unsigned int seed) {
+    std::size_t side = static_cast<std::size_t>(std::ceil(std::cbrt(static_cast<double>(count))));
+    if (side == 0) side = 1;
+    while (side * side * side < count) ++side; // cbrt может недобрать из-за округления
+    const float center = 0.5f * static_cast<float>(side - 1);
+
+    unsigned int state = seed != 0 ? seed : 1u;
+    out.resize(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        StressInstance& inst = out[i];
+        inst.position[0] = (static_cast<float>(i % side) - center) * spacing;
+        inst.position[1] = (static_cast<float>((i / side) % side) - center) * spacing;
+        inst.position[2] = -static_cast<float>(i / (side * side)) * spacing;
+        inst.scale = spacing * (0.45f + 0.2f * nextRandom(state));
+        randomRotation(state, inst.rotation);
+        hueColor(nextRandom(state), inst.color);
+        inst.color[3] = static_cast<std::uint8_t>(128.0f + 127.0f * nextRandom(state));
+        inst.type = static_cast<std::uint32_t>(i % PRIM_COUNT);
+    }
+}
+
+void generateForest3D(std::vector<Tree3D>& out, std::size_t count, float spacing, float clearing,
+                      float groundY, unsigned int seed) {
+    unsigned int state = seed != 0 ? seed : 1u;
+    out.clear();
+    out.reserve(count);
+
+    // Кольцо ring — ячейки с max(|i|, |j|) == ring: лес растёт от центра квадратом
+    const float clearing2 = clearing * clearing;
+    for (long long ring = 0; out.size() < count; ++ring) {
+        const long long side = ring == 0 ? 1 : 8 * ring;
+        for (long long k = 0; k < side && out.size() < count; ++k) {
+            long long i = 0, j = 0;
+            if (ring > 0) {
+                // Обход по периметру против часовой стрелки от угла (ring, -ring)
+                const long long edge = k / (2 * ring);
+                const long long step = k % (2 * ring);
+                if (edge == 0)      { i = ring;        j = -ring + step; }
+                else if (edge == 1) { i = ring - step; j = ring; }
+                else if (edge == 2) { i = -ring;       j = ring - step; }
+                else                { i = -ring + step; j = -ring; }
+            }
+            const float jx = nextRandom(state) - 0.5f;
+            const float jz = nextRandom(state) - 0.5f;
+            const float x = (static_cast<float>(i) + 0.8f * jx) * spacing;
+            const float z = (static_cast<float>(j) + 0.8f * jz) * spacing;
+            const float scale = 0.7f + 0.6f * nextRandom(state);
+            const float shade = nextRandom(state);
+            if (x * x + z * z < clearing2) continue;
+
+            Tree3D tree;
+            tree.position[0] = x;
+            tree.position[1] = groundY;
+            tree.position[2] = z;
+            tree.scale = scale;
+            tree.tint[0] = static_cast<std::uint8_t>(200.0f + 55.0f * shade);
+            tree.tint[1] = static_cast<std::uint8_t>(215.0f + 40.0f * (1.0f - shade));
+            tree.tint[2] = static_cast<std::uint8_t>(200.0f + 30.0f * shade);
+            out.push_back(tree);
+        }
+    }
+}
@@ -0,0 +1,144 @@
+// ═══════════════════════════════════════
+// Содержимое сцен: деревья 2D-леса, 3D-примитивы и их материалы
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "forest.h"
+#include "mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Тип 3D-примитива
+enum PrimitiveType {
+    PRIM_CUBE    = 0,
+    PRIM_PYRAMID = 1,
+    PRIM_SPHERE  = 2,
+    PRIM_COUNT   = 3
+};
+
+// Материал: рассеянный цвет (альфа задаётся общей прозрачностью), блик и его резкость
+struct Material {
+    float diffuse[3];
+    float specular[4];
+    float shininess;
+};
+
+// 3D-объект сцены: примитив, перенос, поворот вокруг оси и индекс материала
+struct SceneObject {
+    PrimitiveType type;
+    float position[3];
+    float rotAngle;    // градусы
+    float rotAxis[3];
+    int   material;
+};
+
+// Массив сцены: свои данные или окно в чужую память (отображённый файл сцены)
+template <typename T>
+class SceneArray {
+public:
+    std::size_t size() const { return mIsView ? mViewSize : mOwned.size(); }
+    bool empty() const { return size() == 0; }
+    const T* data() const { return mIsView ? mView : mOwned.data(); }
+    const T& operator[](std::size_t i) const { return data()[i]; }
+    const T* begin() const { return data(); }
+    const T* end() const { return data() + size(); }
+
+    // Смотреть в память снаружи; она должна жить не меньше массива
+    void view(const T* items, std::size_t count) {
+        std::vector<T>().swap(mOwned);
+        mView = items;
+        mViewSize = count;
+        mIsView = true;
+    }
+
+    // Пустой свой массив для заполнения заново (окно отбрасывается без копии)
+    std::vector<T>& reset() {
+        mView = nullptr;
+        mViewSize = 0;
+        mIsView = false;
+        mOwned.clear();
+        return mOwned;
+    }
+
+private:
+    std::vector<T> mOwned;
+    const T*    mView = nullptr;
+    std::size_t mViewSize = 0;
+    bool        mIsView = false;
+};
+
+// Экземпляр нагрузочной сцены (stress_scene.h): 40 байт, вершинный шейдер
+// читает их прямо из буфера
+struct StressInstance {
+    float position[3];
+    float scale;
+    float rotation[4];       // единичный кватернион (x, y, z, w)
+    std::uint8_t color[4];   // RGBA; альфа умножается на общую прозрачность
+    std::uint32_t type;      // PrimitiveType
+};
+
+// Наибольшее число экземпляров нагрузочной сцены
+static const std::size_t STRESS_MAX_INSTANCES = 1000000;
+
+// Дерево 3D-леса (forest3d.h): основание ствола, масштаб и оттенок (множитель цвета)
+struct Tree3D {
+    float position[3];
+    float scale;
+    std::uint8_t tint[3];
+};
+
+// Наибольшее число деревьев 3D-леса
+static const std::size_t FOREST3D_MAX_TREES = 1000000;
+
+// Готовая сетка примитива из файла сцены (vertexCount == 0 — встроенная)
+struct SceneMesh {
+    const MeshVertex*   vertices = nullptr;
+    std::size_t         vertexCount = 0;
+    const unsigned int* indices = nullptr;
+    std::size_t         indexCount = 0;
+    float boundsMin[3] = {0.0f, 0.0f, 0.0f};
+    float boundsMax[3] = {0.0f, 0.0f, 0.0f};
+};
+
+// Полное описание обеих сцен
+struct Scene {
+    SceneArray<TreeInstance> trees;
+    SceneArray<SceneObject>  objects;
+    SceneArray<Material>     materials;
+    SceneMesh meshes[PRIM_COUNT];
+
+    // Отображённый файл, в который смотрят массивы (nullptr — всё своё)
+    std::shared_ptr<const void> storage;
+};
+
+// Исходная сцена: семь ёлочек, куб, пирамида и сфера
+void buildDefaultScene(Scene& scene);
+
+// Заменить деревья на count случайных (детерминированно по seed) вдоль полосы земли
+void generateForest(Scene& scene, std::size_t count, unsigned int seed);
+
+// Деревья одного чанка бесконечного леса: count деревьев в полосе [x0, x0 + width)
+// вдоль земли; раскладка зависит только от seed и номера чанка
+void generateForestChunk(std::vector<TreeInstance>& out, long long chunk, float x0, float width,
+                         int count, unsigned int seed);
+
+// Заменить 3D-объекты сеткой из count примитивов: тройки куб-пирамида-сфера
+// в исходной раскладке, тройки расставлены квадратной сеткой вглубь сцены
+void generateObjectGrid(Scene& scene, std::size_t count);
+
+// count экземпляров нагрузочной сцены в сетке side^3 (side = ceil(cbrt(count)))
+// с шагом spacing: по X и Y сетка центрирована, вглубь уходит по -Z. Типы идут
+// по кругу, поворот, размер, цвет и прозрачность случайные (детерминированно по seed)
+void generateStressInstances(std::vector<StressInstance>& out, std::size_t count, float spacing,
+                             unsigned int seed);
+
+// count деревьев 3D-леса на земле y = groundY: по одному в ячейке квадратной
+// сетки с шагом spacing со случайным сдвигом, ячейки заполняются кольцами от
+// начала координат; ячейки ближе clearing к началу пусты (там стоят примитивы).
+// Масштаб и оттенок случайные (детерминированно по seed)
+void generateForest3D(std::vector<Tree3D>& out, std::size_t count, float spacing, float clearing,
+                      float groundY, unsigned int seed);
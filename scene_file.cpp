@@ -0,0 +1,501 @@
+// ═══════════════════════════════════════
+// Двоичный файл сцены, отображаемый в память
+// ═══════════════════════════════════════
+
+#include "scene_file.h"
+
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Массивы файла читаются как массивы структур программы: раскладка обязана совпадать
+static_assert(sizeof(TreeInstance) == 12, "TreeInstance layout is part of the scene file format");
+static_assert(sizeof(PrimitiveType) == 4, "PrimitiveType must be 32-bit in the scene file");
+static_assert(sizeof(SceneObject) == 36, "SceneObject layout is part of the scene file format");
+static_assert(sizeof(Material) == 32, "Material layout is part of the scene file format");
+static_assert(sizeof(MeshVertex) == 24, "MeshVertex layout is part of the scene file format");
+static_assert(sizeof(SceneFileHeader) == 32 && sizeof(SceneFileSection) == 24 &&
+              sizeof(SceneFileMesh) == 64, "scene file records must not have padding");
+static_assert(std::is_trivially_copyable<SceneObject>::value &&
+              std::is_trivially_copyable<Material>::value &&
+              std::is_trivially_copyable<TreeInstance>::value,
+              "scene records are mapped without construction");
+
+// ═══════════════════════════════════════
+// Отображение файла только для чтения
+// ═══════════════════════════════════════
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const char* path);
+    void close();
+
+    const unsigned char* data() const { return mData; }
+    std::uint64_t size() const { return mSize; }
+
+private:
+    const unsigned char* mData = nullptr;
+    std::uint64_t mSize = 0;
+#if defined(_WIN32)
+    HANDLE mFile = INVALID_HANDLE_VALUE;
+    HANDLE mMapping = nullptr;
+#endif
+};
+
+#if defined(_WIN32)
+
+bool MappedFile::open(const char* path) {
+    mFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (mFile == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mFile, &size) || size.QuadPart <= 0) {
+        close();
+        return false;
+    }
+    mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mMapping == nullptr) {
+        close();
+        return false;
+    }
+    mData = static_cast<const unsigned char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+    if (mData == nullptr) {
+        close();
+        return false;
+    }
+    mSize = static_cast<std::uint64_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mData != nullptr) UnmapViewOfFile(mData);
+    if (mMapping != nullptr) CloseHandle(mMapping);
+    if (mFile != INVALID_HANDLE_VALUE) CloseHandle(mFile);
+    mData = nullptr;
+    mMapping = nullptr;
+    mFile = INVALID_HANDLE_VALUE;
+    mSize = 0;
+}
+
+#else
+
+bool MappedFile::open(const char* path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* p = mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // отображение держит файл само
+    if (p == MAP_FAILED) return false;
+
+    // Экземпляры читаются целиком сразу после загрузки: пусть ядро подгружает заранее
+    madvise(p, static_cast<std::size_t>(st.st_size), MADV_WILLNEED);
+    mData = static_cast<const unsigned char*>(p);
+    mSize = static_cast<std::uint64_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (mData != nullptr) {
+        munmap(const_cast<unsigned char*>(mData), static_cast<std::size_t>(mSize));
+    }
+    mData = nullptr;
+    mSize = 0;
+}
+
+#endif
+
+// ═══════════════════════════════════════
+// Загрузка
+// ═══════════════════════════════════════
+
+// Раздел kind, если он есть и его массив целиком лежит в файле
+static bool findSection(const MappedFile& file, const SceneFileSection* sections, std::uint32_t count,
+                        std::uint32_t kind, std::size_t elementSize, const SceneFileSection*& out) {
+    out = nullptr;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        if (sections[i].kind != kind) continue;
+        const SceneFileSection& s = sections[i];
+        if (s.elementSize != elementSize || s.offset % SCENE_FILE_ALIGNMENT != 0 ||
+            s.offset > file.size() || s.count > (file.size() - s.offset) / elementSize) {
+            return false;
+        }
+        out = &s;
+        return true;
+    }
+    return true;
+}
+
+template <typename T>
+static const T* sectionData(const MappedFile& file, const SceneFileSection* s) {
+    return s != nullptr ? reinterpret_cast<const T*>(file.data() + s->offset) : nullptr;
+}
+
+bool loadSceneFile(const char* path, Scene& scene) {
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->open(path)) {
+        std::fprintf(stderr, "Cannot open scene file %s\n", path);
+        return false;
+    }
+
+    // Заголовок и таблица разделов
+    const SceneFileHeader* header = reinterpret_cast<const SceneFileHeader*>(file->data());
+    if (file->size() < sizeof(SceneFileHeader) ||
+        std::memcmp(header->magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC)) != 0) {
+        std::fprintf(stderr, "%s is not a scene file\n", path);
+        return false;
+    }
+    if (header->endianTag != SCENE_FILE_ENDIAN_TAG || header->version != SCENE_FILE_VERSION) {
+        std::fprintf(stderr, "%s: unsupported scene file version or byte order\n", path);
+        return false;
+    }
+    if (header->fileSize != file->size() ||
+        header->sectionCount > (file->size() - sizeof(SceneFileHeader)) / sizeof(SceneFileSection)) {
+        std::fprintf(stderr, "%s: scene file is truncated\n", path);
+        return false;
+    }
+    const SceneFileSection* sections =
+        reinterpret_cast<const SceneFileSection*>(file->data() + sizeof(SceneFileHeader));
+    const std::uint32_t count = header->sectionCount;
+
+    const SceneFileSection *trees, *objects, *materials, *meshes, *vertices, *indices;
+    bool ok = findSection(*file, sections, count, SCENE_SECTION_TREES, sizeof(TreeInstance), trees);
+    ok &= findSection(*file, sections, count, SCENE_SECTION_OBJECTS, sizeof(SceneObject), objects);
+    ok &= findSection(*file, sections, count, SCENE_SECTION_MATERIALS, sizeof(Material), materials);
+    ok &= findSection(*file, sections, count, SCENE_SECTION_MESHES, sizeof(SceneFileMesh), meshes);
+    ok &= findSection(*file, sections, count, SCENE_SECTION_VERTICES, sizeof(MeshVertex), vertices);
+    ok &= findSection(*file, sections, count, SCENE_SECTION_INDICES, sizeof(std::uint32_t), indices);
+    if (!ok) {
+        std::fprintf(stderr, "%s: scene file section is out of bounds\n", path);
+        return false;
+    }
+
+    // Без материалов сцену не нарисовать (нагрузочная сцена берёт нулевой)
+    if (materials != nullptr && materials->count == 0) {
+        std::fprintf(stderr, "%s: scene file has an empty materials section\n", path);
+        return false;
+    }
+
+    // Объекты ссылаются на материалы и примитивы по номеру: один проход проверки
+    // (те же страницы сразу читает построение BVH). Проверяются объекты, которые
+    // останутся в сцене, — из файла или прежние, если раздела объектов нет
+    std::size_t materialCount = materials != nullptr ? materials->count : scene.materials.size();
+    const SceneObject* objectData = sectionData<SceneObject>(*file, objects);
+    const SceneObject* checkedObjects = objects != nullptr ? objectData : scene.objects.data();
+    std::size_t checkedCount = objects != nullptr ? static_cast<std::size_t>(objects->count)
+                                                  : scene.objects.size();
+    for (std::size_t i = 0; i < checkedCount; ++i) {
+        const SceneObject& obj = checkedObjects[i];
+        if (static_cast<unsigned>(obj.type) >= PRIM_COUNT || obj.material < 0 ||
+            static_cast<std::size_t>(obj.material) >= materialCount) {
+            std::fprintf(stderr, "%s: object %zu has an invalid primitive or material\n", path, i);
+            return false;
+        }
+    }
+
+    // Готовые сетки: диапазоны внутри общих массивов вершин и индексов
+    SceneMesh loaded[PRIM_COUNT];
+    const SceneFileMesh* meshData = sectionData<SceneFileMesh>(*file, meshes);
+    const MeshVertex* vertexData = sectionData<MeshVertex>(*file, vertices);
+    const std::uint32_t* indexData = sectionData<std::uint32_t>(*file, indices);
+    for (std::size_t i = 0; meshes != nullptr && i < meshes->count; ++i) {
+        const SceneFileMesh& m = meshData[i];
+        std::uint64_t vertexTotal = vertices != nullptr ? vertices->count : 0;
+        std::uint64_t indexTotal  = indices != nullptr ? indices->count : 0;
+        bool valid = m.primitive < PRIM_COUNT && m.vertexCount > 0 && m.indexCount % 3 == 0 &&
+                     m.firstVertex <= vertexTotal && m.vertexCount <= vertexTotal - m.firstVertex &&
+                     m.firstIndex <= indexTotal && m.indexCount <= indexTotal - m.firstIndex;
+        for (std::uint64_t k = 0; valid && k < m.indexCount; ++k) {
+            valid = indexData[m.firstIndex + k] < m.vertexCount;
+        }
+        if (!valid) {
+            std::fprintf(stderr, "%s: mesh %zu is out of bounds\n", path, i);
+            return false;
+        }
+        SceneMesh& out = loaded[m.primitive];
+        out.vertices    = vertexData + m.firstVertex;
+        out.vertexCount = static_cast<std::size_t>(m.vertexCount);
+        out.indices     = indexData + m.firstIndex;
+        out.indexCount  = static_cast<std::size_t>(m.indexCount);
+        std::memcpy(out.boundsMin, m.boundsMin, sizeof(out.boundsMin));
+        std::memcpy(out.boundsMax, m.boundsMax, sizeof(out.boundsMax));
+    }
+
+    // Всё проверено — массивы сцены переводятся на отображённые страницы
+    if (trees != nullptr) {
+        scene.trees.view(sectionData<TreeInstance>(*file, trees), static_cast<std::size_t>(trees->count));
+    }
+    if (objects != nullptr) scene.objects.view(objectData, static_cast<std::size_t>(objects->count));
+    if (materials != nullptr) {
+        scene.materials.view(sectionData<Material>(*file, materials),
+                             static_cast<std::size_t>(materials->count));
+    }
+    for (int p = 0; p < PRIM_COUNT; ++p) {
+        if (loaded[p].vertexCount != 0) scene.meshes[p] = loaded[p];
+    }
+    scene.storage = file;
+
+    std::printf("Scene file %s: %zu trees, %zu objects, %zu materials\n", path,
+                scene.trees.size(), scene.objects.size(), scene.materials.size());
+    return true;
+}
+
+// ═══════════════════════════════════════
+// Запись
+// ═══════════════════════════════════════
+
+static std::uint64_t alignUp(std::uint64_t value) {
+    return (value + SCENE_FILE_ALIGNMENT - 1) / SCENE_FILE_ALIGNMENT * SCENE_FILE_ALIGNMENT;
+}
+
+bool writeSceneFile(const char* path, const Scene& scene) {
+    // Готовые сетки складываются в общие массивы вершин и индексов
+    std::vector<SceneFileMesh> meshes;
+    std::vector<MeshVertex> vertices;
+    std::vector<std::uint32_t> indices;
+    for (int p = 0; p < PRIM_COUNT; ++p) {
+        const SceneMesh& src = scene.meshes[p];
+        if (src.vertexCount == 0) continue;
+        SceneFileMesh m = {};
+        m.primitive   = static_cast<std::uint32_t>(p);
+        m.firstVertex = vertices.size();
+        m.vertexCount = src.vertexCount;
+        m.firstIndex  = indices.size();
+        m.indexCount  = src.indexCount;
+        std::memcpy(m.boundsMin, src.boundsMin, sizeof(m.boundsMin));
+        std::memcpy(m.boundsMax, src.boundsMax, sizeof(m.boundsMax));
+        vertices.insert(vertices.end(), src.vertices, src.vertices + src.vertexCount);
+        indices.insert(indices.end(), src.indices, src.indices + src.indexCount);
+        meshes.push_back(m);
+    }
+
+    struct Blob {
+        std::uint32_t kind;
+        std::uint32_t elementSize;
+        std::uint64_t count;
+        const void* data;
+    };
+    std::vector<Blob> blobs = {
+        {SCENE_SECTION_TREES,     sizeof(TreeInstance), scene.trees.size(),     scene.trees.data()},
+        {SCENE_SECTION_OBJECTS,   sizeof(SceneObject),  scene.objects.size(),   scene.objects.data()},
+    };
+    // Пустой раздел материалов загрузка отвергает: без него остаются встроенные
+    if (!scene.materials.empty()) {
+        blobs.push_back({SCENE_SECTION_MATERIALS, sizeof(Material), scene.materials.size(), scene.materials.data()});
+    }
+    if (!meshes.empty()) {
+        blobs.push_back({SCENE_SECTION_MESHES,   sizeof(SceneFileMesh), meshes.size(),   meshes.data()});
+        blobs.push_back({SCENE_SECTION_VERTICES, sizeof(MeshVertex),    vertices.size(), vertices.data()});
+        blobs.push_back({SCENE_SECTION_INDICES,  sizeof(std::uint32_t), indices.size(),  indices.data()});
+    }
+
+    // Раскладка: заголовок, таблица разделов, выровненные массивы
+    std::vector<SceneFileSection> sections(blobs.size());
+    std::uint64_t offset = alignUp(sizeof(SceneFileHeader) + sections.size() * sizeof(SceneFileSection));
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+        sections[i] = {blobs[i].kind, blobs[i].elementSize, blobs[i].count, offset};
+        offset = alignUp(offset + blobs[i].count * blobs[i].elementSize);
+    }
+
+    SceneFileHeader header = {};
+    std::memcpy(header.magic, SCENE_FILE_MAGIC, sizeof(SCENE_FILE_MAGIC));
+    header.version      = SCENE_FILE_VERSION;
+    header.endianTag    = SCENE_FILE_ENDIAN_TAG;
+    header.sectionCount = static_cast<std::uint32_t>(sections.size());
+    header.fileSize     = offset;
+
+    std::FILE* f = std::fopen(path, "wb");
+    if (f == nullptr) {
+        std::fprintf(stderr, "Cannot write %s\n", path);
+        return false;
+    }
+    static const unsigned char ZERO_PAD[SCENE_FILE_ALIGNMENT] = {};
+    std::uint64_t written = 0;
+    auto put = [&](const void* data, std::uint64_t bytes) {
+        if (bytes != 0) std::fwrite(data, 1, static_cast<std::size_t>(bytes), f);
+        written += bytes;
+    };
+    auto padTo = [&](std::uint64_t target) { put(ZERO_PAD, target - written); };
+
+    put(&header, sizeof(header));
+    put(sections.data(), sections.size() * sizeof(SceneFileSection));
+    for (std::size_t i = 0; i < blobs.size(); ++i) {
+        padTo(sections[i].offset);
+        put(blobs[i].data, blobs[i].count * blobs[i].elementSize);
+    }
+    padTo(header.fileSize);
+
+    bool ok = std::ferror(f) == 0;
+    ok &= std::fclose(f) == 0;
+    if (!ok) std::fprintf(stderr, "Cannot write %s\n", path);
+    return ok;
+}
+
+// ═══════════════════════════════════════
+// Текстовое описание
+// ═══════════════════════════════════════
+
+static bool parsePrimitive(const char* name, PrimitiveType& out) {
+    if (std::strcmp(name, "cube") == 0) {
+        out = PRIM_CUBE;
+    } else if (std::strcmp(name, "pyramid") == 0) {
+        out = PRIM_PYRAMID;
+    } else if (std::strcmp(name, "sphere") == 0) {
+        out = PRIM_SPHERE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool convertSceneText(const char* textPath, const char* binaryPath) {
+    std::FILE* in = std::fopen(textPath, "r");
+    if (in == nullptr) {
+        std::fprintf(stderr, "Cannot open %s\n", textPath);
+        return false;
+    }
+
+    Scene scene;
+    std::vector<TreeInstance>& trees = scene.trees.reset();
+    std::vector<SceneObject>& objects = scene.objects.reset();
+    std::vector<Material>& materials = scene.materials.reset();
+    std::vector<MeshVertex> meshVertices[PRIM_COUNT];
+    std::vector<unsigned int> meshIndices[PRIM_COUNT];
+    int currentMesh = -1; // внутри блока mesh ... end
+
+    char line[512];
+    int lineNo = 0;
+    bool ok = true;
+    while (ok && std::fgets(line, sizeof(line), in) != nullptr) {
+        ++lineNo;
+        char word[32] = {};
+        if (std::sscanf(line, "%31s", word) != 1 || word[0] == '#') continue;
+
+        char name[32] = {};
+        if (currentMesh >= 0) {
+            MeshVertex v;
+            unsigned int a, b, c;
+            if (std::strcmp(word, "v") == 0 &&
+                std::sscanf(line, " v %f %f %f %f %f %f", &v.px, &v.py, &v.pz, &v.nx, &v.ny, &v.nz) == 6) {
+                meshVertices[currentMesh].push_back(v);
+            } else if (std::strcmp(word, "f") == 0 && std::sscanf(line, " f %u %u %u", &a, &b, &c) == 3) {
+                meshIndices[currentMesh].insert(meshIndices[currentMesh].end(), {a, b, c});
+            } else if (std::strcmp(word, "end") == 0) {
+                currentMesh = -1;
+            } else {
+                ok = false;
+            }
+        } else if (std::strcmp(word, "tree") == 0) {
+            TreeInstance t;
+            ok = std::sscanf(line, " tree %f %f %f", &t.x, &t.y, &t.scale) == 3;
+            if (ok) trees.push_back(t);
+        } else if (std::strcmp(word, "material") == 0) {
+            Material m;
+            ok = std::sscanf(line, " material %f %f %f %f %f %f %f %f",
+                             &m.diffuse[0], &m.diffuse[1], &m.diffuse[2],
+                             &m.specular[0], &m.specular[1], &m.specular[2], &m.specular[3],
+                             &m.shininess) == 8;
+            if (ok) materials.push_back(m);
+        } else if (std::strcmp(word, "object") == 0) {
+            SceneObject o;
+            ok = std::sscanf(line, " object %31s %f %f %f %f %f %f %f %d", name,
+                             &o.position[0], &o.position[1], &o.position[2],
+                             &o.rotAngle, &o.rotAxis[0], &o.rotAxis[1], &o.rotAxis[2],
+                             &o.material) == 9 &&
+                 parsePrimitive(name, o.type);
+            if (ok) objects.push_back(o);
+        } else if (std::strcmp(word, "mesh") == 0) {
+            PrimitiveType type;
+            ok = std::sscanf(line, " mesh %31s", name) == 1 && parsePrimitive(name, type);
+            if (ok) {
+                currentMesh = type;
+                meshVertices[type].clear();
+                meshIndices[type].clear();
+            }
+        } else {
+            ok = false;
+        }
+    }
+    std::fclose(in);
+    if (!ok) {
+        std::fprintf(stderr, "%s:%d: cannot parse scene line\n", textPath, lineNo);
+        return false;
+    }
+    if (currentMesh >= 0) {
+        std::fprintf(stderr, "%s: mesh block without end\n", textPath);
+        return false;
+    }
+
+    // Ссылки проверяются здесь, чтобы загрузка двоичного файла только сверяла границы.
+    // Без строк material раздел не пишется, и при загрузке объекты получают
+    // встроенные материалы исходной сцены — с ними и сверяемся
+    std::size_t materialCount = materials.size();
+    if (materials.empty()) {
+        Scene builtin;
+        buildDefaultScene(builtin);
+        materialCount = builtin.materials.size();
+    }
+    for (std::size_t i = 0; i < objects.size(); ++i) {
+        if (objects[i].material < 0 || static_cast<std::size_t>(objects[i].material) >= materialCount) {
+            std::fprintf(stderr, "%s: object %zu uses undefined material %d\n",
+                         textPath, i, objects[i].material);
+            return false;
+        }
+    }
+    for (int p = 0; p < PRIM_COUNT; ++p) {
+        const std::vector<MeshVertex>& verts = meshVertices[p];
+        const std::vector<unsigned int>& idx = meshIndices[p];
+        if (verts.empty()) continue;
+        for (unsigned int i : idx) {
+            if (i >= verts.size()) {
+                std::fprintf(stderr, "%s: mesh index %u is out of range\n", textPath, i);
+                return false;
+            }
+        }
+        SceneMesh& m = scene.meshes[p];
+        m.vertices    = verts.data();
+        m.vertexCount = verts.size();
+        m.indices     = idx.data();
+        m.indexCount  = idx.size();
+        for (int a = 0; a < 3; ++a) {
+            m.boundsMin[a] = m.boundsMax[a] = (&verts[0].px)[a];
+        }
+        for (const MeshVertex& v : verts) {
+            const float pos[3] = {v.px, v.py, v.pz};
+            for (int a = 0; a < 3; ++a) {
+                if (pos[a] < m.boundsMin[a]) m.boundsMin[a] = pos[a];
+                if (pos[a] > m.boundsMax[a]) m.boundsMax[a] = pos[a];
+            }
+        }
+    }
+
+    if (!writeSceneFile(binaryPath, scene)) return false;
+    std::printf("Wrote %s: %zu trees, %zu objects, %zu materials\n", binaryPath,
+                trees.size(), objects.size(), materials.size());
+    return true;
+}
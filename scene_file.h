@@ -0,0 +1,81 @@
+// ═══════════════════════════════════════
+// Двоичный файл сцены, отображаемый в память
+// Заголовок, таблица разделов и массивы, лежащие в файле ровно так же, как
+// в памяти программы (TreeInstance, SceneObject, Material, MeshVertex).
+// Загрузка — mmap и проверка границ: массивы сцены смотрят прямо в
+// отображённые страницы, разбора и копирования нет, из них же данные
+// уходят в glBufferData. Файл собирается из текстового описания
+// (convertSceneText); порядок байт — little-endian
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "scene.h"
+
+#include <cstdint>
+
+// Сигнатура и версия формата
+static const char          SCENE_FILE_MAGIC[8] = {'L', 'A', 'B', '1', 'S', 'C', 'N', '\0'};
+static const std::uint32_t SCENE_FILE_VERSION  = 1;
+
+// Метка порядка байт: в файле с другим порядком читается как 0x04030201
+static const std::uint32_t SCENE_FILE_ENDIAN_TAG = 0x01020304u;
+
+// Выравнивание начала каждого массива в файле (строка кеша)
+static const std::uint64_t SCENE_FILE_ALIGNMENT = 64;
+
+// Разделы файла
+enum SceneSectionKind {
+    SCENE_SECTION_TREES     = 1, // TreeInstance
+    SCENE_SECTION_OBJECTS   = 2, // SceneObject
+    SCENE_SECTION_MATERIALS = 3, // Material
+    SCENE_SECTION_MESHES    = 4, // SceneFileMesh: готовые сетки примитивов
+    SCENE_SECTION_VERTICES  = 5, // MeshVertex всех сеток подряд
+    SCENE_SECTION_INDICES   = 6, // uint32, индексы внутри своей сетки
+};
+
+// Заголовок в начале файла; за ним sectionCount записей SceneFileSection
+struct SceneFileHeader {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t endianTag;
+    std::uint32_t sectionCount;
+    std::uint32_t reserved;
+    std::uint64_t fileSize;
+};
+
+struct SceneFileSection {
+    std::uint32_t kind;
+    std::uint32_t elementSize; // sizeof элемента: защита от чужой раскладки структур
+    std::uint64_t count;
+    std::uint64_t offset;      // от начала файла, кратно SCENE_FILE_ALIGNMENT
+};
+
+// Сетка, заменяющая встроенную для примитива, с готовым AABB
+struct SceneFileMesh {
+    std::uint32_t primitive; // PrimitiveType
+    std::uint32_t reserved;
+    std::uint64_t firstVertex;
+    std::uint64_t vertexCount;
+    std::uint64_t firstIndex;
+    std::uint64_t indexCount;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+// Отобразить файл и направить массивы сцены в него. Разделов, которых нет
+// в файле, загрузка не трогает. false — файл не открылся или повреждён
+// (сообщение уже выведено в stderr, сцена не изменена)
+bool loadSceneFile(const char* path, Scene& scene);
+
+// Записать сцену (свои массивы и сетки) в двоичный файл
+bool writeSceneFile(const char* path, const Scene& scene);
+
+// Собрать двоичный файл из текстового описания, по строке на запись:
+//   material R G B  SR SG SB SA  SHININESS
+//   tree X Y SCALE
+//   object cube|pyramid|sphere  X Y Z  ANGLE AX AY AZ  MATERIAL
+//   mesh cube|pyramid|sphere ... end — сетка примитива: строки
+//   "v PX PY PZ NX NY NZ" и "f A B C" (индексы вершин сетки с нуля)
+// Пустые строки и строки с '#' в начале пропускаются
+bool convertSceneText(const char* textPath, const char* binaryPath);
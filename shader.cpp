@@ -0,0 +1,70 @@
+// ═══════════════════════════════════════
+// Сборка шейдерных программ GLSL
+// ═══════════════════════════════════════
+
+#include "shader.h"
+#include "gl_ext.h"
+
+#include <cstdio>
+#include <vector>
+
+// Скомпилировать одну стадию; при ошибке вывести журнал и вернуть 0
+static GLuint compileStage(GLenum type, const char* src) {
+    GLuint shader = gl.CreateShader(type);
+    gl.ShaderSource(shader, 1, &src, nullptr);
+    gl.CompileShader(shader);
+
+    GLint status = GL_FALSE;
+    gl.GetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint len = 0;
+        gl.GetShaderiv(shader, GL_INFO_LOG_LENGTH, &len);
+        std::vector<char> log(static_cast<std::size_t>(len > 1 ? len : 1), '\0');
+        gl.GetShaderInfoLog(shader, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::fprintf(stderr, "%s shader compile error:\n%s\n",
+                     type == GL_VERTEX_SHADER ? "Vertex" : "Fragment", log.data());
+        gl.DeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+GLuint buildProgram(const char* vertexSrc, const char* fragmentSrc,
+                    const AttribBinding* bindings, int bindingCount) {
+    if (!gl.hasShaders) return 0;
+
+    GLuint vs = 0;
+    GLuint fs = 0;
+    if (vertexSrc != nullptr && (vs = compileStage(GL_VERTEX_SHADER, vertexSrc)) == 0) {
+        return 0;
+    }
+    if (fragmentSrc != nullptr && (fs = compileStage(GL_FRAGMENT_SHADER, fragmentSrc)) == 0) {
+        if (vs != 0) gl.DeleteShader(vs);
+        return 0;
+    }
+
+    GLuint program = gl.CreateProgram();
+    if (vs != 0) gl.AttachShader(program, vs);
+    if (fs != 0) gl.AttachShader(program, fs);
+    for (int i = 0; i < bindingCount; ++i) {
+        gl.BindAttribLocation(program, bindings[i].index, bindings[i].name);
+    }
+    gl.LinkProgram(program);
+
+    // Шейдеры больше не нужны: программа держит их до удаления
+    if (vs != 0) gl.DeleteShader(vs);
+    if (fs != 0) gl.DeleteShader(fs);
+
+    GLint status = GL_FALSE;
+    gl.GetProgramiv(program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        GLint len = 0;
+        gl.GetProgramiv(program, GL_INFO_LOG_LENGTH, &len);
+        std::vector<char> log(static_cast<std::size_t>(len > 1 ? len : 1), '\0');
+        gl.GetProgramInfoLog(program, static_cast<GLsizei>(log.size()), nullptr, log.data());
+        std::fprintf(stderr, "Shader program link error:\n%s\n", log.data());
+        gl.DeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
@@ -0,0 +1,19 @@
+// ═══════════════════════════════════════
+// Сборка шейдерных программ GLSL
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <GLFW/glfw3.h>
+
+// Привязка атрибута вершины к фиксированному индексу (до компоновки программы)
+struct AttribBinding {
+    GLuint      index;
+    const char* name;
+};
+
+// Скомпилировать и скомпоновать программу из исходников вершинного и фрагментного
+// шейдеров. Любой из исходников может быть nullptr (тогда стадия остаётся
+// фиксированной). Ошибки компиляции выводятся в stderr; при ошибке возвращается 0
+GLuint buildProgram(const char* vertexSrc, const char* fragmentSrc,
+                    const AttribBinding* bindings = nullptr, int bindingCount = 0);
@@ -0,0 +1,220 @@
+// ═══════════════════════════════════════
+// Симуляция с фиксированным шагом в отдельном потоке
+// ═══════════════════════════════════════
+
+#include "simulation.h"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Ёмкость очереди событий (нажатий между двумя шагами много меньше)
+static const std::size_t SIM_EVENT_CAPACITY = 256;
+
+// Отстав больше чем на столько, симуляция пропускает шаги, а не догоняет
+static const double SIM_MAX_LAG = 0.25;
+
+// Оси непрерывного состояния
+enum SimAxis {
+    AXIS_OFFSET_X,
+    AXIS_OFFSET_Y,
+    AXIS_CAM_X,
+    AXIS_CAM_Y,
+    AXIS_CAM_Z,
+    AXIS_BRIGHTNESS,
+    AXIS_TRANSPARENCY,
+    AXIS_COUNT
+};
+
+// Ось: поле состояния, скорость и пределы (false у limited — без ограничения)
+struct AxisSpec {
+    float SimState::* field;
+    float speed;
+    bool  limitedMin, limitedMax;
+    float min, max;
+};
+
+static const AxisSpec AXES[AXIS_COUNT] = {
+    {&SimState::offsetX,         OFFSET_SPEED,       true,  true,  OFFSET_X_MIN,     OFFSET_X_MAX},
+    {&SimState::offsetY,         OFFSET_SPEED,       true,  true,  OFFSET_Y_MIN,     OFFSET_Y_MAX},
+    {&SimState::camX,            CAM_XY_SPEED,       false, false, 0.0f,             0.0f},
+    {&SimState::camY,            CAM_XY_SPEED,       false, false, 0.0f,             0.0f},
+    {&SimState::camZ,            CAM_Z_SPEED,        true,  false, CAM_Z_MIN,        0.0f},
+    {&SimState::lightBrightness, BRIGHTNESS_SPEED,   true,  true,  BRIGHTNESS_MIN,   BRIGHTNESS_MAX},
+    {&SimState::transparency,    TRANSPARENCY_SPEED, true,  true,  TRANSPARENCY_MIN, TRANSPARENCY_MAX},
+};
+
+// Клавиша двигает ось в направлении sign
+struct KeyBinding {
+    int key;
+    SimAxis axis;
+    int sign;
+};
+
+static const KeyBinding KEY_BINDINGS[] = {
+    {GLFW_KEY_A,             AXIS_OFFSET_X,     -1},
+    {GLFW_KEY_D,             AXIS_OFFSET_X,     +1},
+    {GLFW_KEY_W,             AXIS_OFFSET_Y,     +1},
+    {GLFW_KEY_S,             AXIS_OFFSET_Y,     -1},
+    {GLFW_KEY_LEFT,          AXIS_CAM_X,        -1},
+    {GLFW_KEY_RIGHT,         AXIS_CAM_X,        +1},
+    {GLFW_KEY_UP,            AXIS_CAM_Y,        +1},
+    {GLFW_KEY_DOWN,          AXIS_CAM_Y,        -1},
+    {GLFW_KEY_Q,             AXIS_CAM_Z,        -1},
+    {GLFW_KEY_E,             AXIS_CAM_Z,        +1},
+    {GLFW_KEY_EQUAL,         AXIS_BRIGHTNESS,   +1},
+    {GLFW_KEY_KP_ADD,        AXIS_BRIGHTNESS,   +1},
+    {GLFW_KEY_MINUS,         AXIS_BRIGHTNESS,   -1},
+    {GLFW_KEY_KP_SUBTRACT,   AXIS_BRIGHTNESS,   -1},
+    {GLFW_KEY_LEFT_BRACKET,  AXIS_TRANSPARENCY, -1},
+    {GLFW_KEY_RIGHT_BRACKET, AXIS_TRANSPARENCY, +1},
+};
+
+static const int KEY_BINDING_COUNT = static_cast<int>(sizeof(KEY_BINDINGS) / sizeof(KEY_BINDINGS[0]));
+
+static int findBinding(int key) {
+    for (int i = 0; i < KEY_BINDING_COUNT; ++i) {
+        if (KEY_BINDINGS[i].key == key) return i;
+    }
+    return -1;
+}
+
+bool Simulation::handlesKey(int key) {
+    return findBinding(key) >= 0;
+}
+
+Simulation::Simulation(const SimState& initial, bool limitOffsetX)
+    : mEvents(SIM_EVENT_CAPACITY),
+      mInitial(initial),
+      mLimitOffsetX(limitOffsetX),
+      mEpoch(std::chrono::steady_clock::now()) {
+    for (Snapshot& s : mSnapshots) s = {initial, initial, 0.0};
+    mThread = std::thread(&Simulation::run, this);
+}
+
+Simulation::~Simulation() {
+    mStop.store(true);
+    mThread.join();
+}
+
+bool Simulation::post(const SimEvent& event) {
+    return mEvents.tryPush(event);
+}
+
+double Simulation::now() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - mEpoch).count();
+}
+
+SimState Simulation::sample() {
+    if (mMiddle.load(std::memory_order_relaxed) & SNAPSHOT_DIRTY) {
+        mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & ~SNAPSHOT_DIRTY;
+    }
+    const Snapshot& s = mSnapshots[mFront];
+
+    // Текущий шаг становится видимым целиком через SIM_STEP после своего времени
+    float t = static_cast<float>((now() - s.time) / SIM_STEP);
+    t = std::min(std::max(t, 0.0f), 1.0f);
+    SimState out;
+    for (const AxisSpec& axis : AXES) {
+        out.*axis.field = s.prev.*axis.field + (s.curr.*axis.field - s.prev.*axis.field) * t;
+    }
+    return out;
+}
+
+// ═══════════════════════════════════════
+// Поток симуляции
+// ═══════════════════════════════════════
+
+void Simulation::run() {
+    // Доля разницы скоростей, которую гасит один шаг
+    const float response = 1.0f - std::exp(-static_cast<float>(SIM_STEP) / SIM_SMOOTHING_TIME);
+
+    SimState prev = mInitial;
+    SimState curr = mInitial;
+    float velocity[AXIS_COUNT] = {};
+    bool  held[KEY_BINDING_COUNT] = {};
+    bool  pressed[KEY_BINDING_COUNT] = {}; // нажата за этот шаг (короткое нажатие — хотя бы шаг)
+
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration step =
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(SIM_STEP));
+    Clock::time_point next = Clock::now();
+
+    while (!mStop.load(std::memory_order_relaxed)) {
+        // События накопились с прошлого шага
+        bool reset = false;
+        SimEvent e;
+        while (mEvents.tryPop(e)) {
+            int b = findBinding(e.key);
+            switch (e.type) {
+                case SIM_KEY_DOWN:
+                    if (b >= 0) held[b] = pressed[b] = true;
+                    break;
+                case SIM_KEY_UP:
+                    if (b >= 0) held[b] = false;
+                    break;
+                case SIM_RESET_OFFSET:
+                    reset = true;
+                    break;
+                case SIM_LIMIT_OFFSET_X:
+                    mLimitOffsetX = e.value != 0;
+                    break;
+            }
+        }
+
+        // Направление по каждой оси от удерживаемых клавиш
+        int dir[AXIS_COUNT] = {};
+        for (int b = 0; b < KEY_BINDING_COUNT; ++b) {
+            if (held[b] || pressed[b]) dir[KEY_BINDINGS[b].axis] += KEY_BINDINGS[b].sign;
+            pressed[b] = false;
+        }
+
+        prev = curr;
+        bool moving = false;
+        for (int a = 0; a < AXIS_COUNT; ++a) {
+            const AxisSpec& axis = AXES[a];
+            float target = static_cast<float>(std::min(std::max(dir[a], -1), 1)) * axis.speed;
+            velocity[a] += (target - velocity[a]) * response;
+            if (target == 0.0f && std::fabs(velocity[a]) < axis.speed * 1e-3f) velocity[a] = 0.0f;
+
+            float& value = curr.*axis.field;
+            value += velocity[a] * static_cast<float>(SIM_STEP);
+            bool limitMin = axis.limitedMin && (a != AXIS_OFFSET_X || mLimitOffsetX);
+            bool limitMax = axis.limitedMax && (a != AXIS_OFFSET_X || mLimitOffsetX);
+            if (limitMin && value < axis.min) {
+                value = axis.min;
+                velocity[a] = 0.0f;
+            }
+            if (limitMax && value > axis.max) {
+                value = axis.max;
+                velocity[a] = 0.0f;
+            }
+            moving |= dir[a] != 0 || velocity[a] != 0.0f;
+        }
+
+        // Сброс смещения — скачком, без интерполяции через всю сцену
+        if (reset) {
+            curr.offsetX = prev.offsetX = 0.0f;
+            curr.offsetY = prev.offsetY = 0.0f;
+            velocity[AXIS_OFFSET_X] = velocity[AXIS_OFFSET_Y] = 0.0f;
+        }
+
+        // Опубликовать шаг
+        Snapshot& s = mSnapshots[mBack];
+        s.prev = prev;
+        s.curr = curr;
+        s.time = std::chrono::duration<double>(next - mEpoch).count();
+        mBack = mMiddle.exchange(mBack | SNAPSHOT_DIRTY, std::memory_order_acq_rel) & ~SNAPSHOT_DIRTY;
+        // Отрисовка по требованию спит в glfwWaitEvents: будить её, когда движение
+        // началось (кадр после нажатия мог ещё не застать его обработанным) и
+        // когда закончилось (нужен кадр с конечным положением)
+        const bool nowMoving = moving || reset;
+        if (mMoving.exchange(nowMoving, std::memory_order_relaxed) != nowMoving) glfwPostEmptyEvent();
+
+        next += step;
+        Clock::time_point t = Clock::now();
+        if (t - next > std::chrono::duration<double>(SIM_MAX_LAG)) next = t;
+        std::this_thread::sleep_until(next);
+    }
+}
@@ -0,0 +1,121 @@
+// ═══════════════════════════════════════
+// Симуляция с фиксированным шагом в отдельном потоке
+// Колбэк клавиатуры только кладёт событие в очередь без блокировок. Поток
+// симуляции раз в SIM_STEP разбирает очередь, помнит нажатые клавиши и
+// интегрирует по скорости смещение 2D-сцены, камеру, яркость и прозрачность.
+// Два последних шага публикуются через тройной буфер (ни одна сторона
+// не ждёт другую), поток отрисовки интерполирует между ними. Скорость
+// движения не зависит ни от автоповтора клавиш, ни от частоты кадров
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "lockfree_queue.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Шаг симуляции, секунды
+static const double SIM_STEP = 1.0 / 120.0;
+
+// Ограничения смещения 2D-сцены
+static const float OFFSET_X_MIN = -0.5f;
+static const float OFFSET_X_MAX =  0.5f;
+static const float OFFSET_Y_MIN = -0.3f;
+static const float OFFSET_Y_MAX =  0.3f;
+
+// Ограничение камеры (только минимальная дистанция по Z, чтобы не уйти в 0)
+static const float CAM_Z_MIN = 0.1f;
+
+// Ограничения яркости и прозрачности
+static const float BRIGHTNESS_MIN   = 0.1f;
+static const float BRIGHTNESS_MAX   = 2.0f;
+static const float TRANSPARENCY_MIN = 0.1f;
+static const float TRANSPARENCY_MAX = 1.0f;
+
+// Скорости при удержании клавиши, единиц в секунду
+static const float OFFSET_SPEED       = 1.0f;
+static const float CAM_XY_SPEED       = 2.0f;
+static const float CAM_Z_SPEED        = 4.0f;
+static const float BRIGHTNESS_SPEED   = 1.0f;
+static const float TRANSPARENCY_SPEED = 0.5f;
+
+// За сколько секунд скорость проходит ~63% пути к заданной (разгон и торможение)
+static const float SIM_SMOOTHING_TIME = 0.08f;
+
+// Непрерывное состояние, которым управляет симуляция
+struct SimState {
+    float offsetX;
+    float offsetY;
+    float camX;
+    float camY;
+    float camZ;
+    float lightBrightness;
+    float transparency;
+};
+
+// События для потока симуляции
+enum SimEventType {
+    SIM_KEY_DOWN,       // key нажата
+    SIM_KEY_UP,         // key отпущена
+    SIM_RESET_OFFSET,   // смещение 2D-сцены в ноль (смена режима)
+    SIM_LIMIT_OFFSET_X, // value != 0 — смещение по X ограничено (выключен бесконечный лес)
+};
+
+struct SimEvent {
+    SimEventType type;
+    int key;
+    int value;
+};
+
+class Simulation {
+public:
+    Simulation(const SimState& initial, bool limitOffsetX);
+    ~Simulation();
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    // Клавиша управляет непрерывным состоянием (её нажатия передаются в post)
+    static bool handlesKey(int key);
+
+    // Из потока событий окна; false — очередь переполнена, событие потеряно
+    bool post(const SimEvent& event);
+
+    // Состояние на текущий момент: между двумя последними шагами
+    // (отстаёт от симуляции не больше чем на шаг). Только из потока отрисовки
+    SimState sample();
+
+    // Идёт движение: клавиши удерживаются или скорость ещё не погасла. При
+    // смене значения поток симуляции будит цикл событий (glfwPostEmptyEvent)
+    bool moving() const { return mMoving.load(std::memory_order_relaxed); }
+
+private:
+    // Опубликованный шаг: предыдущее и текущее состояние и время текущего
+    struct Snapshot {
+        SimState prev;
+        SimState curr;
+        double   time;
+    };
+
+    void run();
+    double now() const;
+
+    // Тройной буфер: поток симуляции пишет в mBack и меняет его местами
+    // со средним, отрисовка забирает средний, если в нём новый шаг
+    static const int SNAPSHOT_DIRTY = 4;
+    Snapshot mSnapshots[3];
+    int mBack  = 0;                 // только поток симуляции
+    int mFront = 2;                 // только поток отрисовки
+    std::atomic<int> mMiddle{1};    // индекс | SNAPSHOT_DIRTY
+
+    LockFreeQueue<SimEvent> mEvents;
+    SimState mInitial;
+    bool mLimitOffsetX;
+    std::chrono::steady_clock::time_point mEpoch;
+
+    std::thread mThread;
+    std::atomic<bool> mStop{false};
+    std::atomic<bool> mMoving{false};
+};
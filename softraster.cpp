@@ -0,0 +1,440 @@
+// ═══════════════════════════════════════
+// Программный растеризатор для отрисовки без GPU
+// ═══════════════════════════════════════
+
+#include "softraster.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// SSE2 есть на любом x86-64; на остальных платформах — скалярный путь
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LAB_SOFT_SSE 1
+#include <emmintrin.h>
+#endif
+
+// Размер плитки в пикселях (степень двойки)
+static const int TILE_SHIFT = 6;
+static const int TILE_SIZE  = 1 << TILE_SHIFT;
+
+// Биты состояния треугольника
+static const std::uint8_t STATE_DEPTH_TEST  = 1;
+static const std::uint8_t STATE_DEPTH_WRITE = 2;
+static const std::uint8_t STATE_BLEND       = 4;
+
+// ═══════════════════════════════════════
+// Освещение
+// ═══════════════════════════════════════
+
+static float clamp01(float v) {
+    return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+}
+
+void softLightVertex(const SoftLight& light, const SoftMaterial& mat,
+                     const float eyePos[3], const float normal[3], float out[4]) {
+    // Направление на источник (позиционный или направленный)
+    float l[3];
+    for (int i = 0; i < 3; ++i) {
+        l[i] = light.position[3] != 0.0f ? light.position[i] - eyePos[i] : light.position[i];
+    }
+    float lLen = std::sqrt(l[0] * l[0] + l[1] * l[1] + l[2] * l[2]);
+    if (lLen > 0.0f) {
+        l[0] /= lLen; l[1] /= lLen; l[2] /= lLen;
+    }
+    float nDotL = normal[0] * l[0] + normal[1] * l[1] + normal[2] * l[2];
+
+    // Бесконечно удалённый наблюдатель: полувектор между L и (0, 0, 1)
+    float specular = 0.0f;
+    if (nDotL > 0.0f) {
+        float h[3] = {l[0], l[1], l[2] + 1.0f};
+        float hLen = std::sqrt(h[0] * h[0] + h[1] * h[1] + h[2] * h[2]);
+        float nDotH = hLen > 0.0f ? (normal[0] * h[0] + normal[1] * h[1] + normal[2] * h[2]) / hLen : 0.0f;
+        if (nDotH > 0.0f) specular = std::pow(nDotH, mat.shininess);
+    }
+    float diffuse = nDotL > 0.0f ? nDotL : 0.0f;
+
+    for (int i = 0; i < 3; ++i) {
+        float c = light.modelAmbient[i] * mat.ambient[i]
+                + light.ambient[i] * mat.ambient[i]
+                + diffuse * light.diffuse[i] * mat.diffuse[i]
+                + specular * light.specular[i] * mat.specular[i];
+        out[i] = clamp01(c);
+    }
+    out[3] = clamp01(mat.diffuse[3]);
+}
+
+// ═══════════════════════════════════════
+// Кадр
+// ═══════════════════════════════════════
+
+SoftRasterizer::SoftRasterizer(ThreadPool& pool)
+    : mPool(pool),
+      mSetup(pool.size()),
+      mBins(pool.size()) {
+    mState = STATE_DEPTH_TEST | STATE_DEPTH_WRITE | STATE_BLEND;
+}
+
+void SoftRasterizer::resize(int width, int height) {
+    mWidth = std::max(width, 1);
+    mHeight = std::max(height, 1);
+    mTilesX = (mWidth + TILE_SIZE - 1) / TILE_SIZE;
+    mTilesY = (mHeight + TILE_SIZE - 1) / TILE_SIZE;
+    mColor.assign(static_cast<std::size_t>(mWidth) * mHeight * 4, 0);
+    mDepth.assign(static_cast<std::size_t>(mWidth) * mHeight, 1.0f);
+    for (auto& bins : mBins) bins.assign(static_cast<std::size_t>(mTilesX) * mTilesY, {});
+}
+
+void SoftRasterizer::clear(float r, float g, float b, float a) {
+    mVertices.clear();
+    mTriState.clear();
+    mClearPending = true;
+    mClearColor[0] = r;
+    mClearColor[1] = g;
+    mClearColor[2] = b;
+    mClearColor[3] = a;
+}
+
+void SoftRasterizer::setState(const SoftState& state) {
+    mState = static_cast<std::uint8_t>((state.depthTest  ? STATE_DEPTH_TEST  : 0) |
+                                       (state.depthWrite ? STATE_DEPTH_WRITE : 0) |
+                                       (state.blend      ? STATE_BLEND       : 0));
+}
+
+void SoftRasterizer::drawTriangles(const SoftVertex* vertices, std::size_t count) {
+    count -= count % 3;
+    mVertices.insert(mVertices.end(), vertices, vertices + count);
+    mTriState.insert(mTriState.end(), count / 3, mState);
+}
+
+void SoftRasterizer::finish() {
+    const std::size_t parts = mSetup.size();
+
+    // Подготовка и раскладка: part-й кусок входа — в свои списки, порядок сохраняется
+    mPool.parallelFor(parts, [&](std::size_t begin, std::size_t end, unsigned) {
+        for (std::size_t part = begin; part < end; ++part) setupPart(part, parts);
+    });
+
+    // Плитки независимы; раздаются по одной, чтобы нагрузка выравнивалась
+    const int tiles = mTilesX * mTilesY;
+    std::atomic<int> next(0);
+    mPool.parallelFor(mPool.size(), [&](std::size_t, std::size_t, unsigned) {
+        for (int tile = next++; tile < tiles; tile = next++) rasterTile(tile);
+    });
+
+    mVertices.clear();
+    mTriState.clear();
+    mClearPending = false;
+}
+
+// ═══════════════════════════════════════
+// Отсечение и подготовка треугольников
+// ═══════════════════════════════════════
+
+void SoftRasterizer::setupPart(std::size_t part, std::size_t parts) {
+    std::vector<SetupTri>& setup = mSetup[part];
+    setup.clear();
+    for (auto& bin : mBins[part]) bin.clear();
+
+    const std::size_t tris = mTriState.size();
+    const std::size_t first = tris * part / parts;
+    const std::size_t last = tris * (part + 1) / parts;
+
+    for (std::size_t t = first; t < last; ++t) {
+        const SoftVertex* v[3] = {&mVertices[t * 3], &mVertices[t * 3 + 1], &mVertices[t * 3 + 2]};
+
+        // Целиком снаружи одной из плоскостей — отбросить
+        bool rejected = false;
+        for (int axis = 0; axis < 3 && !rejected; ++axis) {
+            bool allBelow = true, allAbove = true;
+            for (int k = 0; k < 3; ++k) {
+                float c = v[k]->clip[axis], w = v[k]->clip[3];
+                allBelow = allBelow && c < -w;
+                allAbove = allAbove && c > w;
+            }
+            rejected = allBelow || allAbove;
+        }
+        if (rejected) continue;
+
+        bool needsClip = false;
+        for (int k = 0; k < 3; ++k) needsClip = needsClip || v[k]->clip[2] < -v[k]->clip[3];
+        if (!needsClip) {
+            emitTriangle(part, v, mTriState[t]);
+            continue;
+        }
+
+        // Отсечение ближней плоскостью z = -w (Сазерленд–Ходжмен), до четырёх вершин
+        SoftVertex poly[4];
+        int n = 0;
+        for (int k = 0; k < 3; ++k) {
+            const SoftVertex& a = *v[k];
+            const SoftVertex& b = *v[(k + 1) % 3];
+            float da = a.clip[2] + a.clip[3];
+            float db = b.clip[2] + b.clip[3];
+            if (da >= 0.0f) poly[n++] = a;
+            if ((da >= 0.0f) != (db >= 0.0f)) {
+                float s = da / (da - db);
+                SoftVertex& out = poly[n++];
+                for (int i = 0; i < 4; ++i) {
+                    out.clip[i]  = a.clip[i]  + (b.clip[i]  - a.clip[i])  * s;
+                    out.front[i] = a.front[i] + (b.front[i] - a.front[i]) * s;
+                    out.back[i]  = a.back[i]  + (b.back[i]  - a.back[i])  * s;
+                }
+            }
+        }
+        for (int k = 1; k + 1 < n; ++k) {
+            const SoftVertex* fan[3] = {&poly[0], &poly[k], &poly[k + 1]};
+            emitTriangle(part, fan, mTriState[t]);
+        }
+    }
+}
+
+void SoftRasterizer::emitTriangle(std::size_t part, const SoftVertex* v[3], std::uint8_t state) {
+    // Экранные координаты (начало — левый нижний угол, как у OpenGL)
+    float sx[3], sy[3], sz[3], invW[3];
+    for (int k = 0; k < 3; ++k) {
+        float w = v[k]->clip[3];
+        if (w <= 0.0f) return;
+        invW[k] = 1.0f / w;
+        sx[k] = (v[k]->clip[0] * invW[k] * 0.5f + 0.5f) * mWidth;
+        sy[k] = (v[k]->clip[1] * invW[k] * 0.5f + 0.5f) * mHeight;
+        sz[k] = v[k]->clip[2] * invW[k] * 0.5f + 0.5f;
+    }
+
+    // Лицевая сторона — обход против часовой стрелки; обратную приводим к нему
+    float area = (sx[1] - sx[0]) * (sy[2] - sy[0]) - (sx[2] - sx[0]) * (sy[1] - sy[0]);
+    if (area == 0.0f || !std::isfinite(area)) return;
+    bool backFacing = area < 0.0f;
+    int order[3] = {0, 1, 2};
+    if (backFacing) {
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+
+    SetupTri tri;
+    tri.state = state;
+
+    // Ребро i лежит напротив вершины i: от order[i+1] к order[i+2]
+    float a[3], b[3], c[3];
+    for (int i = 0; i < 3; ++i) {
+        int p = order[(i + 1) % 3];
+        int q = order[(i + 2) % 3];
+        a[i] = sy[p] - sy[q];
+        b[i] = sx[q] - sx[p];
+        c[i] = -(a[i] * sx[p] + b[i] * sy[p]);
+        tri.edge[i][0] = a[i];
+        tri.edge[i][1] = b[i];
+        tri.edge[i][2] = c[i];
+        // Правило top-left в координатах с осью y вниз: здесь y вверх,
+        // поэтому включаются левые и нижние рёбра (так же растеризует OpenGL)
+        tri.topLeft[i] = (a[i] > 0.0f || (a[i] == 0.0f && b[i] > 0.0f)) ? -1 : 0;
+    }
+
+    // Плоскости атрибутов: производные по разностям с вершиной order[0], так что
+    // постоянный атрибут (глубина плоской 2D-сцены, цвет грани) получается точно
+    // и совпадающие по глубине треугольники отсекаются тестом GL_LESS, как у OpenGL
+    float values[6][3];
+    for (int i = 0; i < 3; ++i) {
+        int k = order[i];
+        const float* color = backFacing ? v[k]->back : v[k]->front;
+        values[0][i] = sz[k];
+        values[1][i] = invW[k];
+        for (int ch = 0; ch < 4; ++ch) values[2 + ch][i] = color[ch] * invW[k];
+    }
+    const float x0 = sx[order[0]], y0 = sy[order[0]];
+    const float dx1 = sx[order[1]] - x0, dy1 = sy[order[1]] - y0;
+    const float dx2 = sx[order[2]] - x0, dy2 = sy[order[2]] - y0;
+    float inv = 1.0f / area;
+    for (int attr = 0; attr < 6; ++attr) {
+        const float* val = values[attr];
+        float d1 = val[1] - val[0];
+        float d2 = val[2] - val[0];
+        float ddx = (d1 * dy2 - d2 * dy1) * inv;
+        float ddy = (d2 * dx1 - d1 * dx2) * inv;
+        tri.plane[attr][0] = val[0] - ddx * x0 - ddy * y0;
+        tri.plane[attr][1] = ddx;
+        tri.plane[attr][2] = ddy;
+    }
+
+    // Ограничивающий прямоугольник в пикселях, обрезанный экраном
+    float minX = std::min(sx[0], std::min(sx[1], sx[2]));
+    float maxX = std::max(sx[0], std::max(sx[1], sx[2]));
+    float minY = std::min(sy[0], std::min(sy[1], sy[2]));
+    float maxY = std::max(sy[0], std::max(sy[1], sy[2]));
+    tri.minX = std::max(0, static_cast<int>(std::floor(std::max(minX, -1.0f))));
+    tri.minY = std::max(0, static_cast<int>(std::floor(std::max(minY, -1.0f))));
+    tri.maxX = std::min(mWidth - 1,  static_cast<int>(std::ceil(std::min(maxX, static_cast<float>(mWidth)))));
+    tri.maxY = std::min(mHeight - 1, static_cast<int>(std::ceil(std::min(maxY, static_cast<float>(mHeight)))));
+    if (tri.minX > tri.maxX || tri.minY > tri.maxY) return;
+
+    std::vector<SetupTri>& setup = mSetup[part];
+    std::uint32_t index = static_cast<std::uint32_t>(setup.size());
+    setup.push_back(tri);
+
+    std::vector<std::vector<std::uint32_t>>& bins = mBins[part];
+    for (int ty = tri.minY >> TILE_SHIFT; ty <= tri.maxY >> TILE_SHIFT; ++ty) {
+        for (int tx = tri.minX >> TILE_SHIFT; tx <= tri.maxX >> TILE_SHIFT; ++tx) {
+            bins[static_cast<std::size_t>(ty) * mTilesX + tx].push_back(index);
+        }
+    }
+}
+
+// ═══════════════════════════════════════
+// Растеризация плитки
+// ═══════════════════════════════════════
+
+// Перевод в 8 бит с округлением до ближайшего чётного, как у GPU
+// (0.3 * 255 = 76.5 даёт 76, а не 77)
+static std::uint8_t toUnorm8(float v) {
+    return static_cast<std::uint8_t>(std::lrint(clamp01(v) * 255.0f));
+}
+
+#ifdef LAB_SOFT_SSE
+// Фрагмент со смешиванием по альфе источника: все четыре канала разом.
+// cvtps2dq округляет до чётного (режим MXCSR по умолчанию), как и lrint
+static void writeFragment(std::uint8_t* dst, __m128 color, bool blend) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(255.0f);
+    __m128 out = _mm_min_ps(_mm_max_ps(color, _mm_setzero_ps()), one);
+    if (blend) {
+        const __m128i zero = _mm_setzero_si128();
+        std::int32_t packed;
+        std::memcpy(&packed, dst, 4);
+        __m128i d = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+        __m128 prev = _mm_div_ps(_mm_cvtepi32_ps(d), scale);
+        __m128 alpha = _mm_shuffle_ps(out, out, _MM_SHUFFLE(3, 3, 3, 3));
+        out = _mm_add_ps(_mm_mul_ps(out, alpha), _mm_mul_ps(prev, _mm_sub_ps(one, alpha)));
+        out = _mm_min_ps(_mm_max_ps(out, _mm_setzero_ps()), one);
+    }
+    __m128i v = _mm_cvtps_epi32(_mm_mul_ps(out, scale));
+    v = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+    std::int32_t result = _mm_cvtsi128_si32(v);
+    std::memcpy(dst, &result, 4);
+}
+#else
+// Записать фрагмент со смешиванием по альфе источника (буфер 8 бит на канал)
+static void writeFragment(std::uint8_t* dst, const float color[4], bool blend) {
+    float alpha = clamp01(color[3]);
+    for (int ch = 0; ch < 4; ++ch) {
+        float out = clamp01(color[ch]);
+        if (blend) out = out * alpha + (dst[ch] / 255.0f) * (1.0f - alpha);
+        dst[ch] = toUnorm8(out);
+    }
+}
+#endif
+
+void SoftRasterizer::rasterTile(int tile) {
+    const int tx0 = (tile % mTilesX) * TILE_SIZE;
+    const int ty0 = (tile / mTilesX) * TILE_SIZE;
+    const int tx1 = std::min(tx0 + TILE_SIZE, mWidth) - 1;
+    const int ty1 = std::min(ty0 + TILE_SIZE, mHeight) - 1;
+
+    if (mClearPending) {
+        std::uint8_t clearRgba[4];
+        for (int ch = 0; ch < 4; ++ch) clearRgba[ch] = toUnorm8(mClearColor[ch]);
+        std::uint32_t clearPixel;
+        std::memcpy(&clearPixel, clearRgba, 4);
+        for (int y = ty0; y <= ty1; ++y) {
+            std::size_t row = static_cast<std::size_t>(y) * mWidth;
+            std::uint32_t* color = reinterpret_cast<std::uint32_t*>(&mColor[(row + tx0) * 4]);
+            std::fill(color, color + (tx1 - tx0 + 1), clearPixel);
+            std::fill(&mDepth[row + tx0], &mDepth[row + tx1] + 1, 1.0f);
+        }
+    }
+
+    for (std::size_t part = 0; part < mSetup.size(); ++part) {
+        const std::vector<SetupTri>& setup = mSetup[part];
+        for (std::uint32_t index : mBins[part][tile]) {
+            const SetupTri& tri = setup[index];
+            const bool depthTest  = (tri.state & STATE_DEPTH_TEST) != 0;
+            const bool depthWrite = (tri.state & STATE_DEPTH_WRITE) != 0;
+            const bool blend      = (tri.state & STATE_BLEND) != 0;
+
+            const int xBegin = std::max(tri.minX, tx0) & ~3; // по четыре пикселя
+            const int xEnd = std::min(tri.maxX, tx1);
+            const int yBegin = std::max(tri.minY, ty0);
+            const int yEnd = std::min(tri.maxY, ty1);
+
+#ifdef LAB_SOFT_SSE
+            // Плоскости цвета r/w, g/w, b/w, a/w — по каналу в дорожке
+            const __m128 colorC  = _mm_setr_ps(tri.plane[2][0], tri.plane[3][0], tri.plane[4][0], tri.plane[5][0]);
+            const __m128 colorDx = _mm_setr_ps(tri.plane[2][1], tri.plane[3][1], tri.plane[4][1], tri.plane[5][1]);
+            const __m128 colorDy = _mm_setr_ps(tri.plane[2][2], tri.plane[3][2], tri.plane[4][2], tri.plane[5][2]);
+#endif
+
+            for (int y = yBegin; y <= yEnd; ++y) {
+                const float py = y + 0.5f;
+                const std::size_t row = static_cast<std::size_t>(y) * mWidth;
+#ifdef LAB_SOFT_SSE
+                const __m128 colorRow = _mm_add_ps(colorC, _mm_mul_ps(colorDy, _mm_set1_ps(py)));
+#endif
+
+                for (int x = xBegin; x <= xEnd; x += 4) {
+                    const float px = x + 0.5f;
+                    unsigned mask;
+                    float z[4];
+#ifdef LAB_SOFT_SSE
+                    const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+                    const __m128 vx = _mm_add_ps(_mm_set1_ps(px), lane);
+                    const __m128 zero = _mm_setzero_ps();
+                    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                    for (int e = 0; e < 3; ++e) {
+                        __m128 ev = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.edge[e][0]), vx),
+                                               _mm_set1_ps(tri.edge[e][1] * py + tri.edge[e][2]));
+                        // Строго внутри или на ребре top-left
+                        __m128 pass = _mm_or_ps(_mm_cmpgt_ps(ev, zero),
+                                                _mm_and_ps(_mm_cmpeq_ps(ev, zero),
+                                                           _mm_castsi128_ps(_mm_set1_epi32(tri.topLeft[e]))));
+                        inside = _mm_and_ps(inside, pass);
+                    }
+                    mask = static_cast<unsigned>(_mm_movemask_ps(inside));
+                    if (mask == 0) continue;
+                    __m128 vz = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(tri.plane[0][1]), vx),
+                                           _mm_set1_ps(tri.plane[0][2] * py + tri.plane[0][0]));
+                    _mm_storeu_ps(z, vz);
+#else
+                    mask = 0;
+                    for (int l = 0; l < 4; ++l) {
+                        float lx = px + l;
+                        bool in = true;
+                        for (int e = 0; e < 3 && in; ++e) {
+                            float ev = tri.edge[e][0] * lx + tri.edge[e][1] * py + tri.edge[e][2];
+                            in = ev > 0.0f || (ev == 0.0f && tri.topLeft[e] != 0);
+                        }
+                        if (in) mask |= 1u << l;
+                        z[l] = tri.plane[0][0] + tri.plane[0][1] * lx + tri.plane[0][2] * py;
+                    }
+                    if (mask == 0) continue;
+#endif
+                    for (int l = 0; l < 4; ++l) {
+                        if (!(mask & (1u << l))) continue;
+                        const int xl = x + l;
+                        if (xl < tx0 || xl > xEnd) continue;
+
+                        // Глубина вне [0, 1] — за дальней плоскостью
+                        if (z[l] < 0.0f || z[l] > 1.0f) continue;
+                        float& depth = mDepth[row + xl];
+                        if (depthTest && !(z[l] < depth)) continue;
+                        if (depthWrite) depth = z[l];
+
+                        // Цвет с коррекцией перспективы
+                        const float lx = px + l;
+                        float w = 1.0f / (tri.plane[1][0] + tri.plane[1][1] * lx + tri.plane[1][2] * py);
+#ifdef LAB_SOFT_SSE
+                        __m128 color = _mm_mul_ps(_mm_add_ps(colorRow, _mm_mul_ps(colorDx, _mm_set1_ps(lx))),
+                                                  _mm_set1_ps(w));
+#else
+                        float color[4];
+                        for (int ch = 0; ch < 4; ++ch) {
+                            const float* pl = tri.plane[2 + ch];
+                            color[ch] = (pl[0] + pl[1] * lx + pl[2] * py) * w;
+                        }
+#endif
+                        writeFragment(&mColor[(row + xl) * 4], color, blend);
+                    }
+                }
+            }
+        }
+    }
+}
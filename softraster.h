@@ -0,0 +1,116 @@
+// ═══════════════════════════════════════
+// Программный растеризатор для отрисовки без GPU
+// Треугольники накапливаются за кадр и растеризуются в finish():
+// подготовка и раскладка по плиткам 64x64 идут параллельно по кускам
+// входа, затем плитки растеризуются независимо на всех ядрах.
+// Рёберные функции считаются по четыре пикселя за раз (SSE).
+// Повторяет фиксированный конвейер OpenGL, которым пользуется display():
+// тест глубины GL_LESS, маска глубины, смешивание
+// GL_SRC_ALPHA / GL_ONE_MINUS_SRC_ALPHA, освещение по вершинам
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "thread_pool.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Вершина в пространстве отсечения и её цвет для лицевой и обратной стороны
+// (двустороннее освещение); без освещения цвета совпадают
+struct SoftVertex {
+    float clip[4];
+    float front[4];
+    float back[4];
+};
+
+// Состояние конвейера для последующих треугольников
+struct SoftState {
+    bool depthTest  = true;
+    bool depthWrite = true;
+    bool blend      = true; // GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA
+};
+
+// Источник света фиксированного конвейера (позиция — в координатах глаза)
+struct SoftLight {
+    float position[4];
+    float ambient[4];
+    float diffuse[4];
+    float specular[4];
+    float modelAmbient[4]; // GL_LIGHT_MODEL_AMBIENT
+};
+
+// Материал фиксированного конвейера
+struct SoftMaterial {
+    float ambient[4];
+    float diffuse[4];
+    float specular[4];
+    float shininess;
+};
+
+// Цвет вершины по модели освещения OpenGL (один источник, бесконечно удалённый
+// наблюдатель); eyePos и normal — в координатах глаза, normal нормализована
+void softLightVertex(const SoftLight& light, const SoftMaterial& mat,
+                     const float eyePos[3], const float normal[3], float out[4]);
+
+class SoftRasterizer {
+public:
+    explicit SoftRasterizer(ThreadPool& pool);
+
+    void resize(int width, int height);
+    int width() const { return mWidth; }
+    int height() const { return mHeight; }
+
+    // Пул, на котором идёт растеризация (им же удобно готовить вершины)
+    ThreadPool& pool() const { return mPool; }
+
+    // Начать кадр: очистка цвета и глубины (выполняется в finish() вместе с плитками)
+    void clear(float r, float g, float b, float a);
+
+    void setState(const SoftState& state);
+
+    // Добавить count / 3 треугольников (вершины по три подряд)
+    void drawTriangles(const SoftVertex* vertices, std::size_t count);
+
+    // Растеризовать всё накопленное за кадр
+    void finish();
+
+    // Кадр в RGBA8, строки снизу вверх (как у glReadPixels)
+    const std::uint8_t* pixels() const { return mColor.data(); }
+
+private:
+    // Треугольник в экранных координатах: рёберные функции A*x + B*y + C,
+    // плоскости глубины, 1/w и цвета/w (значение в нуле и производные по x, y)
+    struct SetupTri {
+        float edge[3][3];
+        std::int32_t topLeft[3]; // -1 — ребро включает пиксели на самой границе (правило top-left)
+        float plane[6][3]; // z, 1/w, r/w, g/w, b/w, a/w
+        int minX, minY, maxX, maxY;
+        std::uint8_t state;
+    };
+
+    void setupPart(std::size_t part, std::size_t parts);
+    void emitTriangle(std::size_t part, const SoftVertex* v[3], std::uint8_t state);
+    void rasterTile(int tile);
+
+    ThreadPool& mPool;
+    int mWidth = 0;
+    int mHeight = 0;
+    int mTilesX = 0;
+    int mTilesY = 0;
+
+    std::vector<std::uint8_t> mColor; // RGBA8
+    std::vector<float>        mDepth;
+
+    // Кадр: вершины, состояние каждого треугольника и очистка
+    std::vector<SoftVertex>   mVertices;
+    std::vector<std::uint8_t> mTriState;
+    std::uint8_t mState = 0;
+    bool  mClearPending = false;
+    float mClearColor[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+
+    // По кускам входа: подготовленные треугольники и их списки по плиткам
+    std::vector<std::vector<SetupTri>> mSetup;
+    std::vector<std::vector<std::vector<std::uint32_t>>> mBins;
+};
@@ -0,0 +1,214 @@
+// ═══════════════════════════════════════
+// Кольцевой буфер потоковых данных кадра
+// ═══════════════════════════════════════
+
+#include "stream_ring.h"
+#include "profiler.h"
+
+#include <cstdio>
+#include <vector>
+
+// Размер сегмента кратен этому выравниванию (не меньше выравнивания uniform-блоков)
+static const std::size_t STREAM_SEGMENT_ALIGN = 256;
+
+// Сколько ждать освобождения сегмента за один вызов, наносекунды, и сколько
+// таких ожиданий подряд, прежде чем отказаться от буфера
+static const unsigned long long STREAM_FENCE_TIMEOUT_NS = 1000000000ull;
+static const int STREAM_FENCE_MAX_WAITS = 5;
+
+// Буфер, из которого кольцо выросло: удаляется через столько кадров. Сразу
+// нельзя — удаление отвязало бы его от точек привязки, уже заданных в кадре
+struct RetiredBuffer {
+    GLuint buffer;
+    int framesLeft;
+};
+
+static GLuint gBuffer = 0;
+static unsigned char* gMapped = nullptr;
+static std::size_t gSegmentSize = 0;
+static std::size_t gSegmentAlign = STREAM_SEGMENT_ALIGN;
+static std::size_t gUniformAlign = STREAM_SEGMENT_ALIGN;
+static LabGLsync gFences[STREAM_RING_SEGMENTS] = {};
+static int gSegment = 0;
+static std::size_t gOffset = 0; // занято в текущем сегменте
+static std::vector<RetiredBuffer> gRetired;
+
+// Итоги текущего кадра
+static std::size_t gFrameBytes = 0;
+static int gFrameStalls = 0;
+
+static std::size_t alignUp(std::size_t value, std::size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+static void deleteFences() {
+    for (LabGLsync& fence : gFences) {
+        if (fence != nullptr) gl.DeleteSync(fence);
+        fence = nullptr;
+    }
+}
+
+// Буфер на три сегмента с постоянным когерентным отображением
+static bool createRingBuffer(std::size_t segmentSize) {
+    const std::ptrdiff_t total = static_cast<std::ptrdiff_t>(segmentSize * STREAM_RING_SEGMENTS);
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    GLuint buffer = 0;
+    gl.GenBuffers(1, &buffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+    gl.BufferStorage(GL_ARRAY_BUFFER, total, nullptr, flags);
+    void* mapped = gl.MapBufferRange(GL_ARRAY_BUFFER, 0, total, flags);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    if (mapped == nullptr) {
+        gl.DeleteBuffers(1, &buffer);
+        return false;
+    }
+
+    gBuffer = buffer;
+    gMapped = static_cast<unsigned char*>(mapped);
+    gSegmentSize = segmentSize;
+    gSegment = 0;
+    gOffset = 0;
+    return true;
+}
+
+// Пересоздать кольцо с сегментом size (уже выровненным); прежний буфер
+// доживает несколько кадров. Выделенное в этом кадре из него остаётся в силе
+static bool replaceRing(std::size_t size) {
+    GLuint old = gBuffer;
+    gl.BindBuffer(GL_ARRAY_BUFFER, old);
+    gl.UnmapBuffer(GL_ARRAY_BUFFER);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    gRetired.push_back({old, STREAM_RING_SEGMENTS});
+    deleteFences();
+    gBuffer = 0;
+    gMapped = nullptr;
+
+    return createRingBuffer(size);
+}
+
+// Пересоздать кольцо вдвое большим или с сегментом не меньше segmentBytes
+static bool growRing(std::size_t segmentBytes) {
+    std::size_t size = gSegmentSize * 2;
+    if (size < segmentBytes) size = segmentBytes;
+    size = alignUp(size, gSegmentAlign);
+
+    if (!replaceRing(size)) {
+        std::fprintf(stderr, "Cannot grow the stream ring to %zu KB per segment\n", size / 1024);
+        return false;
+    }
+    std::fprintf(stderr, "Stream ring grown to %zu KB per segment\n", size / 1024);
+    return true;
+}
+
+bool initStreamRing() {
+    if (gMapped != nullptr) return true;
+    if (!gl.hasBufferStorage) return false;
+
+    if (gl.hasUniformBuffers) {
+        GLint align = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+        if (align > 0) gUniformAlign = static_cast<std::size_t>(align);
+    }
+    gSegmentAlign = gUniformAlign > STREAM_SEGMENT_ALIGN ? gUniformAlign : STREAM_SEGMENT_ALIGN;
+    return createRingBuffer(alignUp(STREAM_SEGMENT_SIZE, gSegmentAlign));
+}
+
+bool streamRingAvailable() {
+    return gMapped != nullptr;
+}
+
+void reserveStreamRing(std::size_t segmentBytes) {
+    if (gMapped != nullptr && segmentBytes > gSegmentSize) growRing(segmentBytes);
+}
+
+std::size_t streamUniformAlignment() {
+    return gUniformAlign;
+}
+
+void streamBeginFrame() {
+    if (gMapped == nullptr) return;
+
+    for (std::size_t i = 0; i < gRetired.size();) {
+        if (--gRetired[i].framesLeft > 0) {
+            ++i;
+            continue;
+        }
+        gl.DeleteBuffers(1, &gRetired[i].buffer);
+        gRetired[i] = gRetired.back();
+        gRetired.pop_back();
+    }
+
+    gSegment = (gSegment + 1) % STREAM_RING_SEGMENTS;
+    gOffset = 0;
+    gFrameBytes = 0;
+    gFrameStalls = 0;
+
+    // Сегмент свободен, когда GPU выполнил команды кадра, писавшего в него
+    LabGLsync& fence = gFences[gSegment];
+    if (fence == nullptr) return;
+    GLenum status = gl.ClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        ++gFrameStalls;
+        for (int wait = 0; wait < STREAM_FENCE_MAX_WAITS && status == GL_TIMEOUT_EXPIRED; ++wait) {
+            status = gl.ClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAM_FENCE_TIMEOUT_NS);
+        }
+    }
+    gl.DeleteSync(fence);
+    fence = nullptr;
+    if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) return;
+
+    // GPU так и не отпустил сегмент (или ожидание сломалось): писать в него
+    // нельзя — кольцо переезжает в новый буфер, старый удаляется позже
+    std::fprintf(stderr, "Stream ring segment is still in use by the GPU; replacing the ring buffer\n");
+    if (!replaceRing(gSegmentSize)) {
+        std::fprintf(stderr, "Cannot recreate the stream ring; falling back to buffer uploads\n");
+    }
+}
+
+StreamAlloc streamAllocate(std::size_t bytes, std::size_t align) {
+    StreamAlloc alloc;
+    if (gMapped == nullptr) return alloc;
+
+    std::size_t offset = alignUp(gOffset, align);
+    if (offset + bytes > gSegmentSize) {
+        if (!growRing(bytes)) return alloc;
+        offset = 0;
+    }
+    gOffset = offset + bytes;
+    gFrameBytes += bytes;
+
+    const std::size_t base = static_cast<std::size_t>(gSegment) * gSegmentSize + offset;
+    alloc.ptr = gMapped + base;
+    alloc.buffer = gBuffer;
+    alloc.offset = base;
+    return alloc;
+}
+
+void streamEndFrame() {
+    if (gMapped == nullptr) return;
+
+    LabGLsync& fence = gFences[gSegment];
+    if (fence != nullptr) gl.DeleteSync(fence);
+    fence = gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+    profilerCounter("streamBytes", static_cast<double>(gFrameBytes));
+    profilerCounter("streamStalls", static_cast<double>(gFrameStalls));
+}
+
+void releaseStreamRing() {
+    deleteFences();
+    if (gBuffer != 0) {
+        gl.BindBuffer(GL_ARRAY_BUFFER, gBuffer);
+        gl.UnmapBuffer(GL_ARRAY_BUFFER);
+        gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+        gl.DeleteBuffers(1, &gBuffer);
+    }
+    for (const RetiredBuffer& retired : gRetired) gl.DeleteBuffers(1, &retired.buffer);
+    gRetired.clear();
+    gBuffer = 0;
+    gMapped = nullptr;
+    gSegmentSize = 0;
+    gSegment = 0;
+    gOffset = 0;
+}
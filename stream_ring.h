@@ -0,0 +1,60 @@
+// ═══════════════════════════════════════
+// Кольцевой буфер потоковых данных кадра
+// Один буфер из трёх сегментов с неизменяемым хранилищем, постоянно и
+// когерентно отображённым в память процесса (OpenGL 4.4 / ARB_buffer_storage).
+// Кадр пишет вершины, экземпляры и uniform-блоки прямо в свой сегмент
+// (выделение — сдвиг указателя), пока GPU читает два предыдущих; перед
+// повторным использованием сегмент ждёт fence своего кадра. Ни glBufferData,
+// ни glBufferSubData в кадре нет — драйверу нечего копировать и не на чем
+// останавливаться
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "gl_ext.h"
+
+#include <cstddef>
+
+// Сегментов в кольце: кадр пишет в один, пока GPU читает два предыдущих
+static const int STREAM_RING_SEGMENTS = 3;
+
+// Начальный размер сегмента, байты (растёт при нехватке)
+static const std::size_t STREAM_SEGMENT_SIZE = 1024 * 1024;
+
+// Выделенный участок кольца: писать в ptr, читать из buffer со смещения offset.
+// Действителен до конца кадра; ptr == nullptr — кольца нет
+struct StreamAlloc {
+    void*       ptr = nullptr;
+    GLuint      buffer = 0;
+    std::size_t offset = 0;
+};
+
+// Создать кольцо. false — нет постоянного отображения (или кольцо выключено):
+// вызывающие остаются на своих путях с glBufferSubData
+bool initStreamRing();
+
+// Кольцо создано и отображено
+bool streamRingAvailable();
+
+// Сегмент не меньше segmentBytes заранее (например, под все экземпляры
+// нагрузочной сцены), чтобы кольцо не росло посреди кадра
+void reserveStreamRing(std::size_t segmentBytes);
+
+// Выравнивание смещений uniform-блоков (GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT)
+std::size_t streamUniformAlignment();
+
+// Начать кадр: перейти к следующему сегменту, дождавшись его fence
+// (ожидание — счётчик streamStalls). Если GPU не отпускает сегмент и после
+// нескольких секунд ожидания, кольцо переезжает в новый буфер
+void streamBeginFrame();
+
+// Выделить bytes байт с выравниванием align (степень двойки). Если сегмент
+// кончился, кольцо пересоздаётся вдвое большим; прежний буфер живёт, пока
+// GPU может читать выделенное из него
+StreamAlloc streamAllocate(std::size_t bytes, std::size_t align);
+
+// Завершить кадр: fence за командами кадра, счётчик streamBytes
+void streamEndFrame();
+
+// Удалить буферы и fence (до уничтожения контекста)
+void releaseStreamRing();
@@ -0,0 +1,475 @@
+// ═══════════════════════════════════════
+// Нагрузочная 3D-сцена: до миллиона примитивов инстансингом
+// ═══════════════════════════════════════
+
+#include "stress_scene.h"
+#include "culling.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "primitives.h"
+#include "profiler.h"
+#include "shader.h"
+#include "stream_ring.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+static_assert(sizeof(StressInstance) == 40, "StressInstance is read by the vertex shader as-is");
+
+// Данные кадра выровнены; в их начале — команды косвенного рисования
+static const std::size_t STRESS_FRAME_ALIGN = 256;
+static const std::size_t STRESS_COMMANDS_SIZE = 64;
+
+// Уровень сферы из цепочки LOD (16 сегментов): миллион сфер по 32x32 не нужен
+static const int STRESS_SPHERE_LEVEL = 2;
+
+// Атрибуты экземпляра (после MESH_ATTR_POSITION и MESH_ATTR_NORMAL)
+static const GLuint STRESS_ATTR_OFFSET   = 2;
+static const GLuint STRESS_ATTR_ROTATION = 3;
+static const GLuint STRESS_ATTR_COLOR    = 4;
+static const GLuint STRESS_ATTR_TYPE     = 5;
+
+// Команда glMultiDrawElementsIndirect (раскладка из спецификации)
+struct DrawElementsCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint  baseVertex;
+    GLuint baseInstance;
+};
+
+static_assert(sizeof(DrawElementsCommand) * PRIM_COUNT <= STRESS_COMMANDS_SIZE,
+              "indirect commands do not fit the segment header");
+
+// ═══════════════════════════════════════
+// Шейдеры
+// Модель освещения та же, что у LIT_FS в core_renderer.cpp; рассеянный цвет
+// и альфа берутся из экземпляра, блик и его резкость — из материала типа
+// ═══════════════════════════════════════
+
+static const char* STRESS_VS =
+    "#version 330 core\n"
+    "uniform mat4 uProjection;\n"
+    "uniform mat4 uView;\n"
+    "in vec3 aPosition;\n"
+    "in vec3 aNormal;\n"
+    "in vec4 aOffset;\n"   // xyz — позиция, w — масштаб
+    "in vec4 aRotation;\n" // кватернион
+    "in vec4 aColor;\n"
+    "in float aType;\n"
+    "out vec3 vEyePos;\n"
+    "out vec3 vNormal;\n"
+    "out vec4 vColor;\n"
+    "flat out int vType;\n"
+    "vec3 rotate(vec4 q, vec3 v) {\n"
+    "    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);\n"
+    "}\n"
+    "void main() {\n"
+    "    vec3 world = rotate(aRotation, aPosition * aOffset.w) + aOffset.xyz;\n"
+    "    vec4 eye = uView * vec4(world, 1.0);\n"
+    "    vEyePos = eye.xyz;\n"
+    "    vNormal = mat3(uView) * rotate(aRotation, aNormal);\n"
+    "    vColor = aColor;\n"
+    "    vType = int(aType + 0.5);\n"
+    "    gl_Position = uProjection * eye;\n"
+    "}\n";
+
+static const char* STRESS_FS =
+    "#version 330 core\n"
+    "uniform vec4 uLightPosition;\n"
+    "uniform vec4 uLightAmbient;\n"
+    "uniform vec4 uLightDiffuse;\n"
+    "uniform vec4 uLightSpecular;\n"
+    "uniform vec4 uModelAmbient;\n"
+    "uniform vec4 uParams;\n"      // x — яркость, y — общая прозрачность
+    "uniform vec4 uSpecular[3];\n" // блик типа, w — резкость (PRIM_COUNT)
+    "in vec3 vEyePos;\n"
+    "in vec3 vNormal;\n"
+    "in vec4 vColor;\n"
+    "flat in int vType;\n"
+    "out vec4 fragColor;\n"
+    "void main() {\n"
+    "    vec4 spec = uSpecular[vType];\n"
+    "    float brightness = uParams.x;\n"
+    "    vec3 ambient = vec3(0.2);\n" // фоновый цвет материала по умолчанию
+    "    vec3 n = normalize(vNormal);\n"
+    "    if (!gl_FrontFacing) n = -n;\n"
+    "    vec3 l = normalize(uLightPosition.w != 0.0 ? uLightPosition.xyz - vEyePos\n"
+    "                                               : uLightPosition.xyz);\n"
+    "    float nDotL = dot(n, l);\n"
+    "    vec3 color = uModelAmbient.rgb * ambient + uLightAmbient.rgb * brightness * ambient;\n"
+    "    if (nDotL > 0.0) {\n"
+    "        color += nDotL * uLightDiffuse.rgb * brightness * vColor.rgb;\n"
+    "        float nDotH = dot(n, normalize(l + vec3(0.0, 0.0, 1.0)));\n"
+    "        if (nDotH > 0.0) {\n"
+    "            color += pow(nDotH, spec.w) * uLightSpecular.rgb * brightness * spec.rgb;\n"
+    "        }\n"
+    "    }\n"
+    "    fragColor = vec4(clamp(color, 0.0, 1.0), clamp(vColor.a * uParams.y, 0.0, 1.0));\n"
+    "}\n";
+
+// ═══════════════════════════════════════
+// Ресурсы
+// ═══════════════════════════════════════
+
+static bool   gStressReady = false;
+static GLuint gProgram = 0;
+static GLuint gVao = 0;
+static GLuint gMeshVbo = 0;
+static GLuint gMeshIbo = 0;
+static GLuint gStreamBuffer = 0;
+
+static GLint gProjectionLocation = -1;
+static GLint gViewLocation = -1;
+static GLint gLightLocations[5] = {-1, -1, -1, -1, -1};
+static GLint gParamsLocation = -1;
+static GLint gSpecularLocations[PRIM_COUNT] = {-1, -1, -1};
+static float gSpecular[PRIM_COUNT][4] = {};
+
+// Геометрия типов в общем буфере (индексы уже со смещением вершин типа)
+static GLuint gFirstIndex[PRIM_COUNT] = {};
+static GLuint gIndexCount[PRIM_COUNT] = {};
+
+// Экземпляры, их номера по типам и BVH каждого типа
+static const StressInstance* gInstances = nullptr;
+static std::size_t gInstanceCount = 0;
+static std::vector<std::uint32_t> gTypeIndices[PRIM_COUNT];
+static Bvh gTypeBvh[PRIM_COUNT];
+
+// Данные кадра: в кольце потоковых данных или в своём буфере, перезаливаемом из gStaging
+static bool gIndirect = false;
+static bool gUseRing = false;
+static std::size_t gFrameSize = 0; // команды и все экземпляры
+static std::vector<unsigned char> gStaging;
+
+bool parseStressSubmit(const char* name, StressSubmit& submit) {
+    if (std::strcmp(name, "auto") == 0) {
+        submit = STRESS_SUBMIT_AUTO;
+    } else if (std::strcmp(name, "instanced") == 0) {
+        submit = STRESS_SUBMIT_INSTANCED;
+    } else if (std::strcmp(name, "indirect") == 0) {
+        submit = STRESS_SUBMIT_INDIRECT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Сетки типов в общие VBO/IBO; radius — радиус описанной сферы типа
+static void uploadGeometry(float radius[PRIM_COUNT]) {
+    const Mesh* meshes[PRIM_COUNT] = {
+        &getCubeMesh(), &getPyramidMesh(), getSphereLodChain().levels[STRESS_SPHERE_LEVEL],
+    };
+
+    std::vector<MeshVertex> vertices;
+    std::vector<unsigned int> indices;
+    for (int t = 0; t < PRIM_COUNT; ++t) {
+        const Mesh& mesh = *meshes[t];
+        const unsigned int base = static_cast<unsigned int>(vertices.size());
+        gFirstIndex[t] = static_cast<GLuint>(indices.size());
+        gIndexCount[t] = static_cast<GLuint>(mesh.indices.size());
+        for (unsigned int i : mesh.indices) indices.push_back(base + i);
+
+        radius[t] = 0.0f;
+        for (const MeshVertex& v : mesh.vertices) {
+            vertices.push_back(v);
+            radius[t] = std::max(radius[t], std::sqrt(v.px * v.px + v.py * v.py + v.pz * v.pz));
+        }
+    }
+
+    gl.GenBuffers(1, &gMeshVbo);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gMeshVbo);
+    gl.BufferData(GL_ARRAY_BUFFER, static_cast<std::ptrdiff_t>(vertices.size() * sizeof(MeshVertex)),
+                  vertices.data(), GL_STATIC_DRAW);
+    gl.GenBuffers(1, &gMeshIbo);
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, gMeshIbo);
+    gl.BufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<std::ptrdiff_t>(indices.size() * sizeof(unsigned int)),
+                  indices.data(), GL_STATIC_DRAW);
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// BVH каждого типа по описанным сферам экземпляров
+static void buildTypeBvhs(const float radius[PRIM_COUNT]) {
+    std::vector<Aabb> boxes;
+    for (int t = 0; t < PRIM_COUNT; ++t) {
+        gTypeIndices[t].clear();
+        boxes.clear();
+        for (std::size_t i = 0; i < gInstanceCount; ++i) {
+            const StressInstance& inst = gInstances[i];
+            if (inst.type != static_cast<std::uint32_t>(t)) continue;
+            float r = radius[t] * inst.scale;
+            Aabb box;
+            for (int k = 0; k < 3; ++k) {
+                box.min[k] = inst.position[k] - r;
+                box.max[k] = inst.position[k] + r;
+            }
+            boxes.push_back(box);
+            gTypeIndices[t].push_back(static_cast<std::uint32_t>(i));
+        }
+        gTypeBvh[t].build(boxes.data(), boxes.size());
+    }
+}
+
+// Место под данные кадра: в кольце потоковых данных (сразу на все экземпляры,
+// чтобы оно не росло посреди кадра), иначе — свой буфер на перезаливку
+static void createStreamBuffer() {
+    gFrameSize = STRESS_COMMANDS_SIZE + gInstanceCount * sizeof(StressInstance);
+    gFrameSize = (gFrameSize + STRESS_FRAME_ALIGN - 1) / STRESS_FRAME_ALIGN * STRESS_FRAME_ALIGN;
+
+    gUseRing = streamRingAvailable();
+    if (gUseRing) {
+        reserveStreamRing(gFrameSize + STRESS_FRAME_ALIGN);
+        return;
+    }
+    gl.GenBuffers(1, &gStreamBuffer);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gStreamBuffer);
+    gl.BufferData(GL_ARRAY_BUFFER, static_cast<std::ptrdiff_t>(gFrameSize), nullptr, GL_STREAM_DRAW);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    gStaging.resize(gFrameSize);
+}
+
+bool initStressRenderer(const StressInstance* instances, std::size_t count,
+                        const Material materials[PRIM_COUNT], StressSubmit submit) {
+    if (gStressReady) releaseStressRenderer();
+    if (!gl.hasShaders || !gl.hasInstancing || !gl.hasUniformBuffers || !glVersionAtLeast(3, 3)) {
+        return false;
+    }
+
+    const AttribBinding bindings[] = {
+        {MESH_ATTR_POSITION,   "aPosition"},
+        {MESH_ATTR_NORMAL,     "aNormal"},
+        {STRESS_ATTR_OFFSET,   "aOffset"},
+        {STRESS_ATTR_ROTATION, "aRotation"},
+        {STRESS_ATTR_COLOR,    "aColor"},
+        {STRESS_ATTR_TYPE,     "aType"},
+    };
+    gProgram = buildProgram(STRESS_VS, STRESS_FS, bindings, 6);
+    if (gProgram == 0) return false;
+
+    gProjectionLocation = gl.GetUniformLocation(gProgram, "uProjection");
+    gViewLocation       = gl.GetUniformLocation(gProgram, "uView");
+    gParamsLocation     = gl.GetUniformLocation(gProgram, "uParams");
+    const char* lightNames[5] = {"uLightPosition", "uLightAmbient", "uLightDiffuse",
+                                 "uLightSpecular", "uModelAmbient"};
+    for (int i = 0; i < 5; ++i) gLightLocations[i] = gl.GetUniformLocation(gProgram, lightNames[i]);
+    for (int t = 0; t < PRIM_COUNT; ++t) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "uSpecular[%d]", t);
+        gSpecularLocations[t] = gl.GetUniformLocation(gProgram, name);
+        for (int c = 0; c < 3; ++c) gSpecular[t][c] = materials[t].specular[c];
+        gSpecular[t][3] = materials[t].shininess;
+    }
+
+    gInstances = instances;
+    gInstanceCount = count;
+    float radius[PRIM_COUNT];
+    uploadGeometry(radius);
+    buildTypeBvhs(radius);
+    createStreamBuffer();
+
+    gIndirect = submit != STRESS_SUBMIT_INSTANCED && gl.hasMultiDrawIndirect;
+    if (submit == STRESS_SUBMIT_INDIRECT && !gIndirect) {
+        std::fprintf(stderr, "glMultiDrawElementsIndirect is not available; using instanced draws\n");
+    }
+
+    // Вершины сеток и индексы — в VAO; указатели экземпляров задаются каждый кадр
+    gl.GenVertexArrays(1, &gVao);
+    gl.BindVertexArray(gVao);
+    gl.BindBuffer(GL_ARRAY_BUFFER, gMeshVbo);
+    gl.EnableVertexAttribArray(MESH_ATTR_POSITION);
+    gl.EnableVertexAttribArray(MESH_ATTR_NORMAL);
+    gl.VertexAttribPointer(MESH_ATTR_POSITION, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex),
+                           attribPointer(nullptr, offsetof(MeshVertex, px)));
+    gl.VertexAttribPointer(MESH_ATTR_NORMAL, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex),
+                           attribPointer(nullptr, offsetof(MeshVertex, nx)));
+    const GLuint instanceAttribs[] = {STRESS_ATTR_OFFSET, STRESS_ATTR_ROTATION,
+                                      STRESS_ATTR_COLOR, STRESS_ATTR_TYPE};
+    for (GLuint attrib : instanceAttribs) {
+        gl.EnableVertexAttribArray(attrib);
+        gl.VertexAttribDivisor(attrib, 1);
+    }
+    gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, gMeshIbo);
+    gl.BindVertexArray(0);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+
+    std::fprintf(stderr, "Stress scene: %zu instances, %s draws, %s instance buffer\n", count,
+                 gIndirect ? "indirect" : "instanced", gUseRing ? "streamed" : "re-uploaded");
+    gStressReady = true;
+    return true;
+}
+
+void releaseStressRenderer() {
+    if (gStreamBuffer != 0) gl.DeleteBuffers(1, &gStreamBuffer);
+    if (gMeshVbo != 0) gl.DeleteBuffers(1, &gMeshVbo);
+    if (gMeshIbo != 0) gl.DeleteBuffers(1, &gMeshIbo);
+    if (gVao != 0) gl.DeleteVertexArrays(1, &gVao);
+    if (gProgram != 0) gl.DeleteProgram(gProgram);
+    gStreamBuffer = gMeshVbo = gMeshIbo = gVao = gProgram = 0;
+    gUseRing = false;
+    std::vector<unsigned char>().swap(gStaging);
+    for (std::vector<std::uint32_t>& list : gTypeIndices) std::vector<std::uint32_t>().swap(list);
+    gInstances = nullptr;
+    gInstanceCount = 0;
+    gStressReady = false;
+}
+
+// ═══════════════════════════════════════
+// Кадр
+// ═══════════════════════════════════════
+
+// Указатели атрибутов экземпляра на начало их массива в буфере кадра
+static void setInstancePointers(std::size_t offset) {
+    const GLsizei stride = sizeof(StressInstance);
+    gl.VertexAttribPointer(STRESS_ATTR_OFFSET, 4, GL_FLOAT, GL_FALSE, stride,
+                           attribPointer(nullptr, offset + offsetof(StressInstance, position)));
+    gl.VertexAttribPointer(STRESS_ATTR_ROTATION, 4, GL_FLOAT, GL_FALSE, stride,
+                           attribPointer(nullptr, offset + offsetof(StressInstance, rotation)));
+    gl.VertexAttribPointer(STRESS_ATTR_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                           attribPointer(nullptr, offset + offsetof(StressInstance, color)));
+    gl.VertexAttribPointer(STRESS_ATTR_TYPE, 1, GL_UNSIGNED_INT, GL_FALSE, stride,
+                           attribPointer(nullptr, offset + offsetof(StressInstance, type)));
+}
+
+void drawStressScene(const StressFrame& frame) {
+    if (!gStressReady) return;
+
+    // Взвешенная OIT рассчитана на фиксированный конвейер — здесь сортировка
+    TransparencyMode mode = frame.mode;
+    if (mode == TRANSPARENCY_WEIGHTED_OIT) mode = TRANSPARENCY_SORTED;
+
+    // Видимые экземпляры каждого типа
+    static std::vector<std::uint32_t> local;
+    static std::vector<std::uint32_t> visible[PRIM_COUNT];
+    static std::vector<float> viewDepth;
+    static std::vector<std::uint32_t> order;
+    const std::vector<std::uint32_t>* lists[PRIM_COUNT];
+    {
+        PROFILE_SCOPE("cullStress");
+        CullStats total;
+        Frustum frustum;
+        Mat4 clip = frame.projection * frame.view;
+        extractFrustum(clip.m, frustum);
+        for (int t = 0; t < PRIM_COUNT; ++t) {
+            lists[t] = &gTypeIndices[t];
+            if (frame.cull) {
+                CullStats stats;
+                gTypeBvh[t].cull(frustum, local, stats);
+                visible[t].resize(local.size());
+                for (std::size_t k = 0; k < local.size(); ++k) visible[t][k] = gTypeIndices[t][local[k]];
+                lists[t] = &visible[t];
+                total.visible += stats.visible;
+                total.culled += stats.culled;
+            } else {
+                total.visible += gTypeIndices[t].size();
+            }
+        }
+        profilerCounter("visibleObjects", static_cast<double>(total.visible));
+        profilerCounter("culledObjects", static_cast<double>(total.culled));
+    }
+
+    // Сортировка от дальнего к ближнему — внутри типа (три вызова рисования)
+    if (mode == TRANSPARENCY_SORTED) {
+        PROFILE_SCOPE("sortTranslucent");
+        const float* v = frame.view.m;
+        for (int t = 0; t < PRIM_COUNT; ++t) {
+            const std::vector<std::uint32_t>& list = *lists[t];
+            viewDepth.resize(list.size());
+            for (std::size_t k = 0; k < list.size(); ++k) {
+                const float* p = gInstances[list[k]].position;
+                viewDepth[k] = -(v[2] * p[0] + v[6] * p[1] + v[10] * p[2] + v[14]);
+            }
+            orderTranslucent(mode, viewDepth.data(), list.size(), order);
+            local.resize(order.size());
+            for (std::size_t k = 0; k < order.size(); ++k) local[k] = list[order[k]];
+            visible[t].swap(local);
+            lists[t] = &visible[t];
+        }
+    }
+
+    // Команды и экземпляры кадра — в кольцо потоковых данных или в gStaging
+    DrawElementsCommand commands[PRIM_COUNT];
+    GLuint first = 0;
+    double triangles = 0.0;
+    for (int t = 0; t < PRIM_COUNT; ++t) {
+        const GLuint n = static_cast<GLuint>(lists[t]->size());
+        commands[t] = {gIndexCount[t], n, gFirstIndex[t], 0, first};
+        first += n;
+        triangles += static_cast<double>(n) * (gIndexCount[t] / 3);
+    }
+    profilerCounter("triangles3D", triangles);
+
+    const std::size_t used = STRESS_COMMANDS_SIZE + static_cast<std::size_t>(first) * sizeof(StressInstance);
+    unsigned char* frameData = gStaging.data();
+    GLuint buffer = gStreamBuffer;
+    std::size_t frameOffset = 0;
+    if (gUseRing) {
+        StreamAlloc alloc = streamAllocate(used, STRESS_FRAME_ALIGN);
+        if (alloc.ptr == nullptr) return; // кольцо не выросло — кадр без нагрузочной сцены
+        frameData = static_cast<unsigned char*>(alloc.ptr);
+        buffer = alloc.buffer;
+        frameOffset = alloc.offset;
+    }
+    {
+        PROFILE_SCOPE("writeInstances");
+        std::memcpy(frameData, commands, sizeof(commands));
+
+        StressInstance* dst = reinterpret_cast<StressInstance*>(frameData + STRESS_COMMANDS_SIZE);
+        for (int t = 0; t < PRIM_COUNT; ++t) {
+            const std::uint32_t* src = lists[t]->data();
+            StressInstance* out = dst + commands[t].baseInstance;
+            ThreadPool::global().parallelFor(lists[t]->size(), [&](std::size_t begin, std::size_t end, unsigned) {
+                for (std::size_t k = begin; k < end; ++k) out[k] = gInstances[src[k]];
+            });
+        }
+    }
+
+    gl.BindBuffer(GL_ARRAY_BUFFER, buffer);
+    if (!gUseRing) {
+        // Без постоянного отображения: старое хранилище отдаётся драйверу, кадр — в новое
+        gl.BufferData(GL_ARRAY_BUFFER, static_cast<std::ptrdiff_t>(gFrameSize), nullptr, GL_STREAM_DRAW);
+        gl.BufferSubData(GL_ARRAY_BUFFER, 0, static_cast<std::ptrdiff_t>(used), gStaging.data());
+    }
+
+    gl.UseProgram(gProgram);
+    gl.UniformMatrix4fv(gProjectionLocation, 1, GL_FALSE, frame.projection.m);
+    gl.UniformMatrix4fv(gViewLocation, 1, GL_FALSE, frame.view.m);
+    const float* light[5] = {frame.light.position, frame.light.ambient, frame.light.diffuse,
+                             frame.light.specular, frame.light.modelAmbient};
+    for (int i = 0; i < 5; ++i) {
+        gl.Uniform4f(gLightLocations[i], light[i][0], light[i][1], light[i][2], light[i][3]);
+    }
+    gl.Uniform4f(gParamsLocation, frame.brightness, frame.alpha, 0.0f, 0.0f);
+    for (int t = 0; t < PRIM_COUNT; ++t) {
+        gl.Uniform4f(gSpecularLocations[t], gSpecular[t][0], gSpecular[t][1], gSpecular[t][2], gSpecular[t][3]);
+    }
+
+    // Как в draw3DObjects: задние грани видны сквозь передние
+    glsDepthMask(GL_FALSE);
+    gl.BindVertexArray(gVao);
+    const std::size_t instanceOffset = frameOffset + STRESS_COMMANDS_SIZE;
+    if (gIndirect) {
+        setInstancePointers(instanceOffset);
+        gl.BindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+        gl.MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, attribPointer(nullptr, frameOffset),
+                                     PRIM_COUNT, sizeof(DrawElementsCommand));
+        gl.BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    } else {
+        for (int t = 0; t < PRIM_COUNT; ++t) {
+            if (commands[t].instanceCount == 0) continue;
+            setInstancePointers(instanceOffset + commands[t].baseInstance * sizeof(StressInstance));
+            gl.DrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>(commands[t].count), GL_UNSIGNED_INT,
+                                     attribPointer(nullptr, commands[t].firstIndex * sizeof(GLuint)),
+                                     static_cast<GLsizei>(commands[t].instanceCount));
+        }
+    }
+    gl.BindVertexArray(0);
+    gl.BindBuffer(GL_ARRAY_BUFFER, 0);
+    gl.UseProgram(0);
+    glsDepthMask(GL_TRUE);
+}
@@ -0,0 +1,51 @@
+// ═══════════════════════════════════════
+// Нагрузочная 3D-сцена: до миллиона примитивов инстансингом
+// Кубы, пирамиды и сферы со своим переносом, поворотом, масштабом, цветом
+// и прозрачностью стоят в кубической сетке. Каждый кадр видимые экземпляры
+// (BVH на каждый тип примитива) пишутся в кольцо потоковых данных
+// (stream_ring.h, OpenGL 4.4), иначе в свой перезаливаемый буфер — и рисуются
+// одним glMultiDrawElementsIndirect на три команды (OpenGL 4.3) или тремя
+// glDrawElementsInstanced. Освещение — та же модель, что у setupLighting
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include "core_renderer.h"
+#include "scene.h"
+#include "transparency.h"
+#include "vecmath.h"
+
+#include <cstddef>
+
+// Способ отправки вызовов рисования
+enum StressSubmit {
+    STRESS_SUBMIT_AUTO      = 0, // косвенный, если поддерживается
+    STRESS_SUBMIT_INSTANCED = 1, // glDrawElementsInstanced на каждый тип
+    STRESS_SUBMIT_INDIRECT  = 2  // одна glMultiDrawElementsIndirect
+};
+
+// Разобрать имя способа (auto, instanced, indirect); false — имя неизвестно
+bool parseStressSubmit(const char* name, StressSubmit& submit);
+
+// Параметры кадра
+struct StressFrame {
+    Mat4 projection;
+    Mat4 view;
+    CoreLight light;         // источник как в setupLighting (позиция в координатах глаза)
+    float brightness;
+    float alpha;             // общая прозрачность
+    TransparencyMode mode;   // OIT недоступна — вместо неё сортировка
+    bool cull;               // отсечение по пирамиде видимости
+};
+
+// Подготовить буферы и программу. Массив экземпляров (generateStressInstances)
+// должен жить до releaseStressRenderer; блик и резкость типа — из materials[тип].
+// false — нужен OpenGL 3.3 (шейдеры, инстансинг, VAO)
+bool initStressRenderer(const StressInstance* instances, std::size_t count,
+                        const Material materials[PRIM_COUNT], StressSubmit submit);
+
+// Нарисовать видимые экземпляры (тест глубины без записи, как draw3DObjects)
+void drawStressScene(const StressFrame& frame);
+
+// Освободить буферы и программу (до уничтожения контекста)
+void releaseStressRenderer();
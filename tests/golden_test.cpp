@@ -0,0 +1,196 @@
+// ═══════════════════════════════════════
+// Проверка по эталонным изображениям (цель lab1_golden, запускается ctest)
+// Эталоны двух видов: tests/golden/sceneN.ppm нарисованы через OpenGL
+// (--bench --output), sceneN_software.ppm — программной отрисовкой.
+// Программная отрисовка детерминирована и сверяется со своим эталоном
+// точно (до единицы округления), а с эталоном OpenGL — с допуском: пиксель
+// отличается, если хотя бы один канал расходится больше чем на --tolerance,
+// и таких пикселей не больше доли --max-bad. С --gl через OpenGL рисуется и
+// сама программа (нужен дисплей) и сверяется с эталоном OpenGL с тем же
+// допуском. --update перезаписывает эталоны программной отрисовки,
+// --update --gl — эталоны OpenGL
+// ═══════════════════════════════════════
+
+#include "image_io.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// Размер кадра эталонов
+static const int GOLDEN_WIDTH  = 320;
+static const int GOLDEN_HEIGHT = 240;
+
+// Допуск по умолчанию между разными путями отрисовки: OpenGL и программная
+// отрисовка расходятся на единицы из-за округления цвета, но не на целые пиксели
+static const int    DEFAULT_TOLERANCE = 8;
+static const double DEFAULT_MAX_BAD   = 0.001;
+
+// Программная отрисовка против своего эталона: не больше единицы округления
+// (другой компилятор может иначе свернуть умножение со сложением), ни одного
+// пикселя сверх
+static const int    SOFTWARE_TOLERANCE = 1;
+static const double SOFTWARE_MAX_BAD   = 0.0;
+
+// Параметры запуска
+struct GoldenOptions {
+    std::string lab1;      // путь к lab1
+    std::string goldenDir; // каталог эталонов
+    std::string outDir;    // каталог для отрисованных кадров
+    bool   gl = false;
+    bool   update = false;
+    int    tolerance = DEFAULT_TOLERANCE;
+    double maxBad = DEFAULT_MAX_BAD;
+};
+
+// Итог сравнения двух кадров
+struct ImageDiff {
+    int maxDiff = 0;
+    std::size_t badPixels = 0;
+    std::size_t pixels = 0;
+};
+
+static void printUsage() {
+    std::fprintf(stderr, "Usage: lab1_golden LAB1 GOLDEN_DIR OUT_DIR [--gl] [--update] "
+                         "[--tolerance N] [--max-bad F]\n");
+}
+
+static bool parseGoldenOptions(int argc, char** argv, GoldenOptions& opts) {
+    std::vector<const char*> positional;
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (std::strcmp(arg, "--gl") == 0) {
+            opts.gl = true;
+        } else if (std::strcmp(arg, "--update") == 0) {
+            opts.update = true;
+        } else if (std::strcmp(arg, "--tolerance") == 0 && i + 1 < argc) {
+            opts.tolerance = std::atoi(argv[++i]);
+        } else if (std::strcmp(arg, "--max-bad") == 0 && i + 1 < argc) {
+            opts.maxBad = std::atof(argv[++i]);
+        } else if (arg[0] == '-') {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg);
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 3 || opts.tolerance < 0 || opts.maxBad < 0.0) return false;
+    opts.lab1 = positional[0];
+    opts.goldenDir = positional[1];
+    opts.outDir = positional[2];
+    return true;
+}
+
+// Отрисовать сцену в файл: программно или через OpenGL (--bench в скрытом окне)
+static bool renderScene(const GoldenOptions& opts, int scene, bool gl, const std::string& path) {
+    char args[256];
+    if (gl) {
+        std::snprintf(args, sizeof(args), "--bench --headless --frames 1 --warmup 0 --scene %d "
+                                          "--width %d --height %d", scene, GOLDEN_WIDTH, GOLDEN_HEIGHT);
+    } else {
+        std::snprintf(args, sizeof(args), "--software --scene %d --width %d --height %d",
+                      scene, GOLDEN_WIDTH, GOLDEN_HEIGHT);
+    }
+    std::string command = "\"" + opts.lab1 + "\" " + args + " --output \"" + path + "\"";
+    if (gl) {
+#if defined(_WIN32)
+        command += " > NUL";
+#else
+        command += " > /dev/null";
+#endif
+    }
+    if (std::system(command.c_str()) != 0) {
+        std::fprintf(stderr, "FAILED: %s\n", command.c_str());
+        return false;
+    }
+    return true;
+}
+
+static ImageDiff compareImages(const std::vector<std::uint8_t>& a, const std::vector<std::uint8_t>& b,
+                               int tolerance) {
+    ImageDiff diff;
+    diff.pixels = a.size() / 4;
+    for (std::size_t i = 0; i < diff.pixels; ++i) {
+        int worst = 0;
+        for (int c = 0; c < 3; ++c) {
+            int d = std::abs(static_cast<int>(a[i * 4 + c]) - static_cast<int>(b[i * 4 + c]));
+            if (d > worst) worst = d;
+        }
+        if (worst > diff.maxDiff) diff.maxDiff = worst;
+        if (worst > tolerance) ++diff.badPixels;
+    }
+    return diff;
+}
+
+// Эталон сцены: отрисованный через OpenGL или программно
+static std::string goldenPath(const GoldenOptions& opts, int scene, bool gl) {
+    return opts.goldenDir + "/scene" + std::to_string(scene) + (gl ? ".ppm" : "_software.ppm");
+}
+
+// Сравнить кадр с эталоном; name — что с чем сравнивается (для отчёта)
+static bool compareWithGolden(const std::vector<std::uint8_t>& actual, int w, int h,
+                              const std::string& golden, int tolerance, double maxBad,
+                              int scene, const char* name) {
+    std::vector<std::uint8_t> expected;
+    int gw = 0, gh = 0;
+    if (!readPPM(golden.c_str(), expected, gw, gh)) return false;
+    if (w != gw || h != gh) {
+        std::printf("scene %d (%s): FAILED, size %dx%d, golden %dx%d\n", scene, name, w, h, gw, gh);
+        return false;
+    }
+
+    ImageDiff diff = compareImages(actual, expected, tolerance);
+    double badShare = static_cast<double>(diff.badPixels) / static_cast<double>(diff.pixels);
+    bool ok = badShare <= maxBad;
+    std::printf("scene %d (%s): %s, max channel diff %d, %zu of %zu pixels over %d\n", scene, name,
+                ok ? "ok" : "FAILED", diff.maxDiff, diff.badPixels, diff.pixels, tolerance);
+    return ok;
+}
+
+// Отрисовать сцену и сверить её с эталонами; при --update — записать её эталоном
+static bool checkScene(const GoldenOptions& opts, int scene, bool gl) {
+    const char* path = gl ? "gl" : "software";
+    std::string output = opts.outDir + "/scene" + std::to_string(scene) + "_" + path + ".ppm";
+    if (!renderScene(opts, scene, gl, output)) return false;
+
+    std::vector<std::uint8_t> actual;
+    int w = 0, h = 0;
+    if (!readPPM(output.c_str(), actual, w, h)) return false;
+
+    if (opts.update) {
+        std::string golden = goldenPath(opts, scene, gl);
+        if (!writePPM(golden.c_str(), actual.data(), w, h, false)) return false;
+        std::printf("scene %d (%s): golden image updated\n", scene, path);
+        return true;
+    }
+
+    if (gl) {
+        return compareWithGolden(actual, w, h, goldenPath(opts, scene, true), opts.tolerance, opts.maxBad,
+                                 scene, "gl");
+    }
+    // Программная отрисовка: точно — со своим эталоном, с допуском — с эталоном OpenGL
+    bool exact = compareWithGolden(actual, w, h, goldenPath(opts, scene, false), SOFTWARE_TOLERANCE,
+                                   SOFTWARE_MAX_BAD, scene, "software");
+    bool close = compareWithGolden(actual, w, h, goldenPath(opts, scene, true), opts.tolerance, opts.maxBad,
+                                   scene, "software vs gl golden");
+    return exact && close;
+}
+
+int main(int argc, char** argv) {
+    GoldenOptions opts;
+    if (!parseGoldenOptions(argc, argv, opts)) {
+        printUsage();
+        return 2;
+    }
+
+    bool ok = true;
+    for (int scene = 0; scene <= 1; ++scene) {
+        // --update --gl обновляет только эталоны OpenGL
+        if (!(opts.update && opts.gl)) ok = checkScene(opts, scene, false) && ok;
+        if (opts.gl) ok = checkScene(opts, scene, true) && ok;
+    }
+    return ok ? 0 : 1;
+}
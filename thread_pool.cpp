@@ -0,0 +1,155 @@
+// ═══════════════════════════════════════
+// Пул потоков для параллельных циклов
+// ═══════════════════════════════════════
+
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) threads = std::thread::hardware_concurrency();
+    if (threads == 0) threads = 1;
+
+    for (unsigned i = 1; i < threads; ++i) {
+        mWorkers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_all();
+    for (std::thread& t : mWorkers) t.join();
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+// Своя доля кусков, затем доли остальных по кругу; возвращает число выполненных
+std::size_t ThreadPool::runStolenChunks(Job& job, unsigned worker) {
+    std::size_t done = 0;
+    const unsigned n = size();
+    for (unsigned k = 0; k < n; ++k) {
+        StealRange& range = job.ranges[(worker + k) % n];
+        for (;;) {
+            std::size_t chunk = range.next.fetch_add(1);
+            if (chunk >= range.end) break;
+            std::size_t begin = chunk * job.grain;
+            (*job.fn)(begin, std::min(begin + job.grain, job.count), worker);
+            ++done;
+        }
+    }
+    return done;
+}
+
+// Забирать куски задания, пока они не кончатся
+void ThreadPool::runChunks(Job& job, unsigned worker) {
+    std::size_t done = 0;
+    if (job.grain != 0) {
+        done = runStolenChunks(job, worker);
+    } else {
+        for (;;) {
+            std::size_t chunk = job.nextChunk.fetch_add(1);
+            if (chunk >= job.chunks) break;
+            std::size_t begin = job.count * chunk / job.chunks;
+            std::size_t end   = job.count * (chunk + 1) / job.chunks;
+            (*job.fn)(begin, end, worker);
+            ++done;
+        }
+    }
+
+    if (done > 0) {
+        std::lock_guard<std::mutex> lock(mMutex);
+        job.finished += done;
+        if (job.finished == job.chunks) mDone.notify_all();
+    }
+}
+
+void ThreadPool::workerLoop(unsigned worker) {
+    unsigned long long seen = 0;
+    std::shared_ptr<Job> job;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            // Ссылка отпускается под mMutex: runJob видит её и не переиспользует задание раньше времени
+            job.reset();
+            mWake.wait(lock, [&] { return mStop || mGeneration != seen; });
+            if (mStop) return;
+            seen = mGeneration;
+            job = mJob; // пусто, если задание уже выполнено без этого исполнителя
+        }
+        if (job) runChunks(*job, worker);
+    }
+}
+
+void ThreadPool::parallelFor(std::size_t count, const RangeFn& fn) {
+    if (count == 0) return;
+
+    // Нет рабочих потоков — выполнить на месте
+    if (mWorkers.empty()) {
+        fn(0, count, 0);
+        return;
+    }
+    runJob(count, count < size() ? count : size(), 0, fn);
+}
+
+void ThreadPool::parallelForStealing(std::size_t count, std::size_t grain, const RangeFn& fn) {
+    if (count == 0) return;
+    if (grain == 0) grain = 1;
+
+    // Один кусок или нет рабочих потоков — выполнить на месте
+    const std::size_t chunks = (count + grain - 1) / grain;
+    if (mWorkers.empty() || chunks == 1) {
+        fn(0, count, 0);
+        return;
+    }
+    runJob(count, chunks, grain, fn);
+}
+
+// Раздать задание исполнителям и выполнить его часть в вызывающем потоке
+void ThreadPool::runJob(std::size_t count, std::size_t chunks, std::size_t grain, const RangeFn& fn) {
+    std::shared_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // Свободное задание — то, на которое ссылается только mJobs
+        for (const std::shared_ptr<Job>& spare : mJobs) {
+            if (spare.use_count() == 1) {
+                job = spare;
+                break;
+            }
+        }
+        if (!job) {
+            job = std::make_shared<Job>();
+            job->ranges.reset(new StealRange[size()]);
+            mJobs.push_back(job);
+        }
+
+        job->fn = &fn;
+        job->count = count;
+        job->chunks = chunks;
+        job->grain = grain;
+        job->nextChunk.store(0);
+        if (grain != 0) {
+            const unsigned n = size();
+            for (unsigned w = 0; w < n; ++w) {
+                job->ranges[w].end = chunks * (w + 1) / n;
+                job->ranges[w].next.store(chunks * w / n);
+            }
+        }
+        job->finished = 0;
+        mJob = job;
+        ++mGeneration;
+    }
+    mWake.notify_all();
+
+    runChunks(*job, 0);
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDone.wait(lock, [&] { return job->finished == job->chunks; });
+    job->fn = nullptr;
+    mJob.reset();
+}
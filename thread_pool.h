@@ -0,0 +1,83 @@
+// ═══════════════════════════════════════
+// Пул потоков для параллельных циклов
+// Вызывающий поток тоже выполняет часть работы. parallelForStealing делит
+// работу на мелкие куски: исполнитель начинает со своей доли, а закончив её,
+// забирает куски из долей остальных
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // Тело цикла: полуинтервал [begin, end) и номер исполнителя (0 — вызывающий поток)
+    typedef std::function<void(std::size_t begin, std::size_t end, unsigned worker)> RangeFn;
+
+    // threads — общее число исполнителей вместе с вызывающим (0 — по числу ядер)
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Число исполнителей вместе с вызывающим потоком
+    unsigned size() const { return static_cast<unsigned>(mWorkers.size()) + 1; }
+
+    // Разбить [0, count) на size() равных кусков и выполнить их параллельно.
+    // Возвращается, когда все куски выполнены
+    void parallelFor(std::size_t count, const RangeFn& fn);
+
+    // Разбить [0, count) на куски по grain элементов (для неравной цены
+    // элементов): у каждого исполнителя своя доля кусков, опустевший
+    // исполнитель крадёт куски у остальных. Возвращается, когда все куски выполнены
+    void parallelForStealing(std::size_t count, std::size_t grain, const RangeFn& fn);
+
+    // Общий пул приложения
+    static ThreadPool& global();
+
+private:
+    // Доля кусков исполнителя: следующий кусок и конец доли. Кусок забирается
+    // fetch_add, поэтому хозяин и вор не могут получить один и тот же
+    struct alignas(64) StealRange {
+        std::atomic<std::size_t> next{0};
+        std::size_t              end = 0;
+    };
+
+    // Задание целиком: исполнитель берёт ссылку на него под mMutex при
+    // пробуждении и работает только с ней. Опоздавший исполнитель поэтому
+    // не может взять куски следующего задания или засчитать ему свои
+    struct Job {
+        const RangeFn*           fn = nullptr;
+        std::size_t              count = 0;
+        std::size_t              chunks = 0;
+        std::size_t              grain = 0;   // 0 — равные куски parallelFor
+        std::atomic<std::size_t> nextChunk{0};
+        std::unique_ptr<StealRange[]> ranges; // доли исполнителей, size() штук
+        std::size_t              finished = 0; // под mMutex
+    };
+
+    void workerLoop(unsigned worker);
+    void runChunks(Job& job, unsigned worker);
+    std::size_t runStolenChunks(Job& job, unsigned worker);
+    void runJob(std::size_t count, std::size_t chunks, std::size_t grain, const RangeFn& fn);
+
+    std::vector<std::thread> mWorkers;
+    std::mutex               mMutex;
+    std::condition_variable  mWake;
+    std::condition_variable  mDone;
+
+    // Текущее задание и отработавшие (переиспользуются, когда на них больше
+    // никто не ссылается) — всё под mMutex
+    std::shared_ptr<Job>              mJob;
+    std::vector<std::shared_ptr<Job>> mJobs;
+    unsigned long long       mGeneration = 0;
+    bool                     mStop = false;
+};
@@ -0,0 +1,236 @@
+// ═══════════════════════════════════════
+// Полупрозрачные объекты: порядок отрисовки и OIT
+// ═══════════════════════════════════════
+
+#include "transparency.h"
+#include "gl_ext.h"
+#include "gl_state.h"
+#include "radix_sort.h"
+#include "shader.h"
+
+#include <cstring>
+
+// ═══════════════════════════════════════
+// Режимы
+// ═══════════════════════════════════════
+
+static const char* MODE_NAMES[] = {"unsorted", "sorted", "oit"};
+
+const char* transparencyModeName(TransparencyMode mode) {
+    return MODE_NAMES[mode];
+}
+
+bool parseTransparencyMode(const char* name, TransparencyMode& mode) {
+    for (int i = 0; i < 3; ++i) {
+        if (std::strcmp(name, MODE_NAMES[i]) == 0) {
+            mode = static_cast<TransparencyMode>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void orderTranslucent(TransparencyMode mode, const float* viewDepth, std::size_t count,
+                      std::vector<std::uint32_t>& order) {
+    if (mode == TRANSPARENCY_SORTED) {
+        sortBackToFront(viewDepth, count, order);
+        return;
+    }
+
+    // Без сортировки и для OIT — порядок описания сцены
+    order.resize(count);
+    for (std::size_t i = 0; i < count; ++i) order[i] = static_cast<std::uint32_t>(i);
+}
+
+// ═══════════════════════════════════════
+// Weighted blended OIT (McGuire, Bavoil 2013)
+// Буфер 0 (RGBA16F): rgb += цвет * альфа * вес, a = произведение (1 - альфа).
+// Буфер 1 (R16F):    r += альфа * вес.
+// Одна функция смешивания (ONE, ONE, ZERO, ONE_MINUS_SRC_ALPHA) даёт оба
+// накопления, поэтому не нужен glBlendFunci из OpenGL 4.0
+// ═══════════════════════════════════════
+
+// Накопление: вершины и освещение считает фиксированный конвейер,
+// шейдер получает освещённый цвет в gl_Color
+static const char* ACCUM_FS =
+    "#version 120\n"
+    "void main() {\n"
+    "    vec4 c = gl_Color;\n"
+    "    float w = clamp(pow(min(1.0, c.a * 10.0) + 0.01, 3.0) * 1e8 *\n"
+    "                    pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);\n"
+    "    gl_FragData[0] = vec4(c.rgb * c.a * w, c.a);\n"
+    "    gl_FragData[1] = vec4(c.a * w);\n"
+    "}\n";
+
+// Наложение: средний взвешенный цвет с покрытием 1 - произведение (1 - альфа)
+static const char* COMPOSITE_FS =
+    "#version 120\n"
+    "uniform sampler2D uAccum;\n"
+    "uniform sampler2D uWeight;\n"
+    "uniform vec4 uViewport;\n" // x, y, ширина, высота
+    "void main() {\n"
+    "    vec2 uv = (gl_FragCoord.xy - uViewport.xy) / uViewport.zw;\n"
+    "    vec4 accum = texture2D(uAccum, uv);\n"
+    "    float revealage = accum.a;\n"
+    "    if (revealage >= 1.0) discard;\n"
+    "    float weight = max(texture2D(uWeight, uv).r, 1e-5);\n"
+    "    gl_FragColor = vec4(accum.rgb / weight, 1.0 - revealage);\n"
+    "}\n";
+
+// Ресурсы OIT
+static bool   gOitInitDone = false;
+static bool   gOitAvailable = false;
+static GLuint gAccumProgram = 0;
+static GLuint gCompositeProgram = 0;
+static GLuint gOitFbo = 0;
+static GLuint gAccumTex = 0;
+static GLuint gWeightTex = 0;
+static int    gOitWidth = 0;
+static int    gOitHeight = 0;
+
+// Состояние, восстанавливаемое после накопления
+static GLint  gSavedFbo = 0;
+static GLint  gSavedViewport[4] = {0, 0, 0, 0};
+
+static void initOIT() {
+    gOitInitDone = true;
+    if (!gl.hasFramebuffer) return;
+
+    gAccumProgram = buildProgram(nullptr, ACCUM_FS);
+    gCompositeProgram = buildProgram(nullptr, COMPOSITE_FS);
+    if (gAccumProgram == 0 || gCompositeProgram == 0) return;
+
+    gl.UseProgram(gCompositeProgram);
+    gl.Uniform1i(gl.GetUniformLocation(gCompositeProgram, "uAccum"), 0);
+    gl.Uniform1i(gl.GetUniformLocation(gCompositeProgram, "uWeight"), 1);
+    gl.UseProgram(0);
+
+    gl.GenFramebuffers(1, &gOitFbo);
+    glGenTextures(1, &gAccumTex);
+    glGenTextures(1, &gWeightTex);
+    gOitAvailable = true;
+}
+
+// Текстура-цель с плавающей точкой заданного формата
+static void allocTarget(GLuint tex, GLenum internalFormat, GLenum format, int w, int h) {
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(internalFormat), w, h, 0,
+                 format, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// Пересоздать цели при изменении размера области вывода
+static bool resizeTargets(int w, int h) {
+    if (w == gOitWidth && h == gOitHeight) return true;
+
+    allocTarget(gAccumTex, GL_RGBA16F, GL_RGBA, w, h);
+    allocTarget(gWeightTex, GL_R16F, GL_RED, w, h);
+
+    gl.BindFramebuffer(GL_FRAMEBUFFER, gOitFbo);
+    gl.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gAccumTex, 0);
+    gl.FramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gWeightTex, 0);
+    bool complete = gl.CheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    gl.BindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(gSavedFbo));
+
+    if (!complete) {
+        gOitAvailable = false; // формат не поддерживается — больше не пытаться
+        return false;
+    }
+    gOitWidth = w;
+    gOitHeight = h;
+    return true;
+}
+
+bool beginWeightedOIT() {
+    // Наложение рисуется фиксированным конвейером — в core-профиле только сортировка
+    if (gl.coreProfile) return false;
+    if (!gOitInitDone) initOIT();
+    if (!gOitAvailable) return false;
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &gSavedFbo);
+    glGetIntegerv(GL_VIEWPORT, gSavedViewport);
+    if (!resizeTargets(gSavedViewport[2], gSavedViewport[3])) return false;
+
+    // Буферов глубины у целей нет, и тест глубины без буфера всегда проходит.
+    // Поэтому OIT годится, только пока в сцене нет непрозрачной геометрии перед
+    // объектами: с трёхмерным лесом вызывающий код выбирает сортировку
+    gl.BindFramebuffer(GL_FRAMEBUFFER, gOitFbo);
+    const GLenum buffers[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    gl.DrawBuffers(2, buffers);
+    glViewport(0, 0, gOitWidth, gOitHeight);
+
+    const GLfloat accumClear[]  = {0.0f, 0.0f, 0.0f, 1.0f};
+    const GLfloat weightClear[] = {0.0f, 0.0f, 0.0f, 0.0f};
+    gl.ClearBufferfv(GL_COLOR, 0, accumClear);
+    gl.ClearBufferfv(GL_COLOR, 1, weightClear);
+
+    glsBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+    gl.UseProgram(gAccumProgram);
+    return true;
+}
+
+void endWeightedOIT() {
+    gl.UseProgram(0);
+    gl.BindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(gSavedFbo));
+    glViewport(gSavedViewport[0], gSavedViewport[1], gSavedViewport[2], gSavedViewport[3]);
+    glsBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // Полноэкранный прямоугольник в единичных матрицах, без освещения и глубины.
+    // Флаги восстанавливаются через кеш состояния, а не glPushAttrib/glPopAttrib,
+    // иначе кеш разошёлся бы с драйвером
+    bool lighting = glsIsEnabled(GL_LIGHTING);
+    bool depthTest = glsIsEnabled(GL_DEPTH_TEST);
+    glsDisable(GL_LIGHTING);
+    glsDisable(GL_DEPTH_TEST);
+    glMatrixMode(GL_PROJECTION);
+    glPushMatrix();
+    glLoadIdentity();
+    glMatrixMode(GL_MODELVIEW);
+    glPushMatrix();
+    glLoadIdentity();
+
+    gl.ActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, gWeightTex);
+    gl.ActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, gAccumTex);
+
+    gl.UseProgram(gCompositeProgram);
+    gl.Uniform4f(gl.GetUniformLocation(gCompositeProgram, "uViewport"),
+                 static_cast<GLfloat>(gSavedViewport[0]), static_cast<GLfloat>(gSavedViewport[1]),
+                 static_cast<GLfloat>(gSavedViewport[2]), static_cast<GLfloat>(gSavedViewport[3]));
+
+    static const GLfloat quad[] = {-1.0f, -1.0f,  1.0f, -1.0f,  -1.0f, 1.0f,  1.0f, 1.0f};
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glVertexPointer(2, GL_FLOAT, 0, quad);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glDisableClientState(GL_VERTEX_ARRAY);
+
+    gl.UseProgram(0);
+    gl.ActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    gl.ActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    glMatrixMode(GL_PROJECTION);
+    glPopMatrix();
+    glMatrixMode(GL_MODELVIEW);
+    glPopMatrix();
+    if (lighting) glsEnable(GL_LIGHTING);
+    if (depthTest) glsEnable(GL_DEPTH_TEST);
+}
+
+void releaseTransparency() {
+    if (gAccumProgram != 0) gl.DeleteProgram(gAccumProgram);
+    if (gCompositeProgram != 0) gl.DeleteProgram(gCompositeProgram);
+    if (gOitFbo != 0) gl.DeleteFramebuffers(1, &gOitFbo);
+    if (gAccumTex != 0) glDeleteTextures(1, &gAccumTex);
+    if (gWeightTex != 0) glDeleteTextures(1, &gWeightTex);
+    gAccumProgram = gCompositeProgram = gOitFbo = gAccumTex = gWeightTex = 0;
+    gOitWidth = gOitHeight = 0;
+    gOitInitDone = false;
+    gOitAvailable = false;
+}
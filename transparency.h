@@ -0,0 +1,40 @@
+// ═══════════════════════════════════════
+// Полупрозрачные объекты: порядок отрисовки и OIT
+// Сортировка от дальнего к ближнему по глубине вида или однопроходная
+// взвешенная прозрачность без сортировки (weighted blended OIT)
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Способ смешивания полупрозрачных объектов
+enum TransparencyMode {
+    TRANSPARENCY_UNSORTED     = 0, // порядок описания сцены (как в исходной версии)
+    TRANSPARENCY_SORTED       = 1, // от дальнего к ближнему, поразрядная сортировка
+    TRANSPARENCY_WEIGHTED_OIT = 2  // weighted blended OIT, порядок не важен
+};
+
+// Имя режима для сообщений и параметров командной строки
+const char* transparencyModeName(TransparencyMode mode);
+
+// Разобрать имя режима (unsorted, sorted, oit); false — имя неизвестно
+bool parseTransparencyMode(const char* name, TransparencyMode& mode);
+
+// Порядок отрисовки count объектов для режима mode (глубина — расстояние вдоль взгляда)
+void orderTranslucent(TransparencyMode mode, const float* viewDepth, std::size_t count,
+                      std::vector<std::uint32_t>& order);
+
+// Начать накопление OIT: рисование переключается во внеэкранные буферы
+// накопления. false — OIT недоступна (нет FBO / шейдеров, core-профиль),
+// рисовать с сортировкой. Буферы накопления без глубины: непрозрачная
+// геометрия, нарисованная раньше, полупрозрачные объекты не закрывает
+bool beginWeightedOIT();
+
+// Закончить накопление и наложить результат на прежний кадровый буфер
+void endWeightedOIT();
+
+// Освободить буферы и шейдеры OIT
+void releaseTransparency();
@@ -0,0 +1,387 @@
+// ═══════════════════════════════════════
+// Матрицы 4x4 на процессоре
+// ═══════════════════════════════════════
+
+#include "vecmath.h"
+
+#include <cmath>
+
+// M_PI может отсутствовать на MSVC
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// SSE2 есть на любом x86-64; на остальных платформах — скалярный путь.
+// AVX — только если компилятор собирает под него (-mavx, /arch:AVX)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define LAB_MATH_SSE 1
+#include <emmintrin.h>
+#endif
+#if defined(LAB_MATH_SSE) && defined(__AVX__)
+#define LAB_MATH_AVX 1
+#include <immintrin.h>
+#endif
+
+// Все пути суммируют в одном порядке (a0*b0 + a1*b1 + a2*b2 + a3*b3) и без FMA,
+// поэтому скалярный, SSE- и AVX-результаты умножений совпадают побитово
+// (обращение в скалярном пути считается другой формулой)
+
+#if defined(LAB_MATH_SSE)
+// Столбец результата: сумма столбцов a с весами из столбца b
+static inline __m128 linearCombine(const __m128 a[4], const float* b) {
+    __m128 r = _mm_mul_ps(a[0], _mm_set1_ps(b[0]));
+    r = _mm_add_ps(r, _mm_mul_ps(a[1], _mm_set1_ps(b[1])));
+    r = _mm_add_ps(r, _mm_mul_ps(a[2], _mm_set1_ps(b[2])));
+    r = _mm_add_ps(r, _mm_mul_ps(a[3], _mm_set1_ps(b[3])));
+    return r;
+}
+
+static inline void loadColumns(const float m[16], __m128 cols[4]) {
+    for (int i = 0; i < 4; ++i) cols[i] = _mm_loadu_ps(m + i * 4);
+}
+#endif
+
+void multiplyMatrix(const float a[16], const float b[16], float out[16]) {
+#if defined(LAB_MATH_SSE)
+    __m128 cols[4];
+    loadColumns(a, cols);
+    // Столбцы считаются целиком до записи: out может совпадать с a или b
+    __m128 r0 = linearCombine(cols, b);
+    __m128 r1 = linearCombine(cols, b + 4);
+    __m128 r2 = linearCombine(cols, b + 8);
+    __m128 r3 = linearCombine(cols, b + 12);
+    _mm_storeu_ps(out, r0);
+    _mm_storeu_ps(out + 4, r1);
+    _mm_storeu_ps(out + 8, r2);
+    _mm_storeu_ps(out + 12, r3);
+#else
+    float r[16];
+    for (int col = 0; col < 4; ++col) {
+        for (int row = 0; row < 4; ++row) {
+            float sum = a[row] * b[col * 4];
+            for (int k = 1; k < 4; ++k) sum += a[k * 4 + row] * b[col * 4 + k];
+            r[col * 4 + row] = sum;
+        }
+    }
+    for (int i = 0; i < 16; ++i) out[i] = r[i];
+#endif
+}
+
+Mat4 operator*(const Mat4& a, const Mat4& b) {
+    Mat4 out;
+    multiplyMatrix(a.m, b.m, out.m);
+    return out;
+}
+
+void mat4MultiplyBatch(const Mat4& a, const Mat4* b, Mat4* out, std::size_t count) {
+#if defined(LAB_MATH_AVX)
+    // Два столбца результата за раз: столбцы a продублированы в обеих половинах,
+    // перестановка внутри половин раздаёт веса двух столбцов b
+    __m256 cols[4];
+    for (int k = 0; k < 4; ++k) {
+        __m128 c = _mm_loadu_ps(a.m + k * 4);
+        cols[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(c), c, 1);
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        const float* bm = b[i].m;
+        __m256 lo = _mm256_loadu_ps(bm);     // столбцы 0 и 1
+        __m256 hi = _mm256_loadu_ps(bm + 8); // столбцы 2 и 3
+        __m256 r0 = _mm256_mul_ps(cols[0], _mm256_shuffle_ps(lo, lo, 0x00));
+        __m256 r1 = _mm256_mul_ps(cols[0], _mm256_shuffle_ps(hi, hi, 0x00));
+        r0 = _mm256_add_ps(r0, _mm256_mul_ps(cols[1], _mm256_shuffle_ps(lo, lo, 0x55)));
+        r1 = _mm256_add_ps(r1, _mm256_mul_ps(cols[1], _mm256_shuffle_ps(hi, hi, 0x55)));
+        r0 = _mm256_add_ps(r0, _mm256_mul_ps(cols[2], _mm256_shuffle_ps(lo, lo, 0xAA)));
+        r1 = _mm256_add_ps(r1, _mm256_mul_ps(cols[2], _mm256_shuffle_ps(hi, hi, 0xAA)));
+        r0 = _mm256_add_ps(r0, _mm256_mul_ps(cols[3], _mm256_shuffle_ps(lo, lo, 0xFF)));
+        r1 = _mm256_add_ps(r1, _mm256_mul_ps(cols[3], _mm256_shuffle_ps(hi, hi, 0xFF)));
+        _mm256_storeu_ps(out[i].m, r0);
+        _mm256_storeu_ps(out[i].m + 8, r1);
+    }
+#elif defined(LAB_MATH_SSE)
+    __m128 cols[4];
+    loadColumns(a.m, cols);
+    for (std::size_t i = 0; i < count; ++i) {
+        const float* bm = b[i].m;
+        __m128 r0 = linearCombine(cols, bm);
+        __m128 r1 = linearCombine(cols, bm + 4);
+        __m128 r2 = linearCombine(cols, bm + 8);
+        __m128 r3 = linearCombine(cols, bm + 12);
+        _mm_storeu_ps(out[i].m, r0);
+        _mm_storeu_ps(out[i].m + 4, r1);
+        _mm_storeu_ps(out[i].m + 8, r2);
+        _mm_storeu_ps(out[i].m + 12, r3);
+    }
+#else
+    for (std::size_t i = 0; i < count; ++i) multiplyMatrix(a.m, b[i].m, out[i].m);
+#endif
+}
+
+// ═══════════════════════════════════════
+// Обращение
+// Блочный метод: матрица делится на четыре блока 2x2 (A B / C D),
+// обратная выражается через присоединённые 2x2 и определители блоков.
+// Формулы симметричны относительно транспонирования, поэтому годятся
+// и для column-major хранения
+// ═══════════════════════════════════════
+
+#if defined(LAB_MATH_SSE)
+#define LAB_SHUFFLE(a, b, x, y, z, w) _mm_shuffle_ps(a, b, _MM_SHUFFLE(w, z, y, x))
+#define LAB_SWIZZLE(v, x, y, z, w)    LAB_SHUFFLE(v, v, x, y, z, w)
+
+// Блок 2x2 хранится как (m00, m01, m10, m11)
+// a * b
+static inline __m128 mat2Mul(__m128 a, __m128 b) {
+    return _mm_add_ps(_mm_mul_ps(a, LAB_SWIZZLE(b, 0, 3, 0, 3)),
+                      _mm_mul_ps(LAB_SWIZZLE(a, 1, 0, 3, 2), LAB_SWIZZLE(b, 2, 1, 2, 1)));
+}
+
+// adj(a) * b
+static inline __m128 mat2AdjMul(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(LAB_SWIZZLE(a, 3, 3, 0, 0), b),
+                      _mm_mul_ps(LAB_SWIZZLE(a, 1, 1, 2, 2), LAB_SWIZZLE(b, 2, 3, 0, 1)));
+}
+
+// a * adj(b)
+static inline __m128 mat2MulAdj(__m128 a, __m128 b) {
+    return _mm_sub_ps(_mm_mul_ps(a, LAB_SWIZZLE(b, 3, 0, 3, 0)),
+                      _mm_mul_ps(LAB_SWIZZLE(a, 1, 0, 3, 2), LAB_SWIZZLE(b, 2, 1, 2, 1)));
+}
+#endif
+
+bool mat4Inverse(const Mat4& m, Mat4& out) {
+#if defined(LAB_MATH_SSE)
+    __m128 c0 = _mm_loadu_ps(m.m);
+    __m128 c1 = _mm_loadu_ps(m.m + 4);
+    __m128 c2 = _mm_loadu_ps(m.m + 8);
+    __m128 c3 = _mm_loadu_ps(m.m + 12);
+
+    __m128 a = _mm_movelh_ps(c0, c1);
+    __m128 b = _mm_movehl_ps(c1, c0);
+    __m128 c = _mm_movelh_ps(c2, c3);
+    __m128 d = _mm_movehl_ps(c3, c2);
+
+    // Определители блоков (|A|, |B|, |C|, |D|)
+    __m128 detSub = _mm_sub_ps(
+        _mm_mul_ps(LAB_SHUFFLE(c0, c2, 0, 2, 0, 2), LAB_SHUFFLE(c1, c3, 1, 3, 1, 3)),
+        _mm_mul_ps(LAB_SHUFFLE(c0, c2, 1, 3, 1, 3), LAB_SHUFFLE(c1, c3, 0, 2, 0, 2)));
+    __m128 detA = LAB_SWIZZLE(detSub, 0, 0, 0, 0);
+    __m128 detB = LAB_SWIZZLE(detSub, 1, 1, 1, 1);
+    __m128 detC = LAB_SWIZZLE(detSub, 2, 2, 2, 2);
+    __m128 detD = LAB_SWIZZLE(detSub, 3, 3, 3, 3);
+
+    __m128 dc = mat2AdjMul(d, c); // adj(D) C
+    __m128 ab = mat2AdjMul(a, b); // adj(A) B
+
+    // Присоединённые блоки обратной матрицы
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), mat2Mul(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), mat2Mul(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), mat2MulAdj(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), mat2MulAdj(a, dc));
+
+    // |M| = |A||D| + |B||C| - tr(adj(A) B adj(D) C)
+    __m128 tr = _mm_mul_ps(ab, LAB_SWIZZLE(dc, 0, 2, 1, 3));
+    tr = _mm_add_ps(tr, LAB_SWIZZLE(tr, 2, 3, 0, 1));
+    tr = _mm_add_ps(tr, LAB_SWIZZLE(tr, 1, 0, 3, 2));
+    __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+    if (_mm_cvtss_f32(detM) == 0.0f) return false;
+
+    __m128 rDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), detM);
+    x = _mm_mul_ps(x, rDet);
+    y = _mm_mul_ps(y, rDet);
+    z = _mm_mul_ps(z, rDet);
+    w = _mm_mul_ps(w, rDet);
+
+    // Присоединение (перестановка внутри блоков) совмещено с раскладкой по столбцам
+    _mm_storeu_ps(out.m,      LAB_SHUFFLE(x, y, 3, 1, 3, 1));
+    _mm_storeu_ps(out.m + 4,  LAB_SHUFFLE(x, y, 2, 0, 2, 0));
+    _mm_storeu_ps(out.m + 8,  LAB_SHUFFLE(z, w, 3, 1, 3, 1));
+    _mm_storeu_ps(out.m + 12, LAB_SHUFFLE(z, w, 2, 0, 2, 0));
+    return true;
+#else
+    // Разложение по минорам 2x2 верхних и нижних двух строк
+    const float* a = m.m;
+    float s0 = a[0] * a[5]  - a[4] * a[1];
+    float s1 = a[0] * a[9]  - a[8] * a[1];
+    float s2 = a[0] * a[13] - a[12] * a[1];
+    float s3 = a[4] * a[9]  - a[8] * a[5];
+    float s4 = a[4] * a[13] - a[12] * a[5];
+    float s5 = a[8] * a[13] - a[12] * a[9];
+    float c5 = a[10] * a[15] - a[14] * a[11];
+    float c4 = a[6] * a[15]  - a[14] * a[7];
+    float c3 = a[6] * a[11]  - a[10] * a[7];
+    float c2 = a[2] * a[15]  - a[14] * a[3];
+    float c1 = a[2] * a[11]  - a[10] * a[3];
+    float c0 = a[2] * a[7]   - a[6] * a[3];
+
+    float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (det == 0.0f) return false;
+    float inv = 1.0f / det;
+
+    float* r = out.m;
+    r[0]  = ( a[5] * c5 - a[9] * c4 + a[13] * c3) * inv;
+    r[4]  = (-a[4] * c5 + a[8] * c4 - a[12] * c3) * inv;
+    r[8]  = ( a[7] * s5 - a[11] * s4 + a[15] * s3) * inv;
+    r[12] = (-a[6] * s5 + a[10] * s4 - a[14] * s3) * inv;
+    r[1]  = (-a[1] * c5 + a[9] * c2 - a[13] * c1) * inv;
+    r[5]  = ( a[0] * c5 - a[8] * c2 + a[12] * c1) * inv;
+    r[9]  = (-a[3] * s5 + a[11] * s2 - a[15] * s1) * inv;
+    r[13] = ( a[2] * s5 - a[10] * s2 + a[14] * s1) * inv;
+    r[2]  = ( a[1] * c4 - a[5] * c2 + a[13] * c0) * inv;
+    r[6]  = (-a[0] * c4 + a[4] * c2 - a[12] * c0) * inv;
+    r[10] = ( a[3] * s4 - a[7] * s2 + a[15] * s0) * inv;
+    r[14] = (-a[2] * s4 + a[6] * s2 - a[14] * s0) * inv;
+    r[3]  = (-a[1] * c3 + a[5] * c1 - a[9] * c0) * inv;
+    r[7]  = ( a[0] * c3 - a[4] * c1 + a[8] * c0) * inv;
+    r[11] = (-a[3] * s3 + a[7] * s1 - a[11] * s0) * inv;
+    r[15] = ( a[2] * s3 - a[6] * s1 + a[10] * s0) * inv;
+    return true;
+#endif
+}
+
+// ═══════════════════════════════════════
+// Построители
+// ═══════════════════════════════════════
+
+Mat4 mat4Identity() {
+    Mat4 r = {{1.0f, 0.0f, 0.0f, 0.0f,
+               0.0f, 1.0f, 0.0f, 0.0f,
+               0.0f, 0.0f, 1.0f, 0.0f,
+               0.0f, 0.0f, 0.0f, 1.0f}};
+    return r;
+}
+
+Mat4 mat4Translate(float x, float y, float z) {
+    Mat4 r = mat4Identity();
+    r.m[12] = x;
+    r.m[13] = y;
+    r.m[14] = z;
+    return r;
+}
+
+Mat4 mat4Rotate(float angleDeg, float x, float y, float z) {
+    Mat4 r = mat4Identity();
+    float len = std::sqrt(x * x + y * y + z * z);
+    if (angleDeg == 0.0f || len == 0.0f) return r;
+    x /= len; y /= len; z /= len;
+
+    float a = angleDeg * static_cast<float>(M_PI) / 180.0f;
+    float c = std::cos(a), s = std::sin(a), t = 1.0f - c;
+    r.m[0] = x * x * t + c;     r.m[4] = x * y * t - z * s; r.m[8]  = x * z * t + y * s;
+    r.m[1] = y * x * t + z * s; r.m[5] = y * y * t + c;     r.m[9]  = y * z * t - x * s;
+    r.m[2] = x * z * t - y * s; r.m[6] = y * z * t + x * s; r.m[10] = z * z * t + c;
+    return r;
+}
+
+Mat4 mat4Ortho(float left, float right, float bottom, float top, float zNear, float zFar) {
+    Mat4 r = mat4Identity();
+    r.m[0]  =  2.0f / (right - left);
+    r.m[5]  =  2.0f / (top - bottom);
+    r.m[10] = -2.0f / (zFar - zNear);
+    r.m[12] = -(right + left) / (right - left);
+    r.m[13] = -(top + bottom) / (top - bottom);
+    r.m[14] = -(zFar + zNear) / (zFar - zNear);
+    return r;
+}
+
+Mat4 mat4Frustum(float left, float right, float bottom, float top, float zNear, float zFar) {
+    Mat4 r = {{0.0f}};
+    r.m[0]  = 2.0f * zNear / (right - left);
+    r.m[5]  = 2.0f * zNear / (top - bottom);
+    r.m[8]  = (right + left) / (right - left);
+    r.m[9]  = (top + bottom) / (top - bottom);
+    r.m[10] = -(zFar + zNear) / (zFar - zNear);
+    r.m[11] = -1.0f;
+    r.m[14] = -2.0f * zFar * zNear / (zFar - zNear);
+    return r;
+}
+
+Mat4 mat4Perspective(float fovyDeg, float aspect, float zNear, float zFar) {
+    float top = zNear * std::tan(fovyDeg * static_cast<float>(M_PI) / 360.0f);
+    float right = top * aspect;
+    return mat4Frustum(-right, right, -top, top, zNear, zFar);
+}
+
+Mat4 mat4LookAt(float eyeX, float eyeY, float eyeZ,
+                float centerX, float centerY, float centerZ,
+                float upX, float upY, float upZ) {
+    // Вектор направления взгляда (forward)
+    float fx = centerX - eyeX;
+    float fy = centerY - eyeY;
+    float fz = centerZ - eyeZ;
+    float fLen = std::sqrt(fx * fx + fy * fy + fz * fz);
+    fx /= fLen; fy /= fLen; fz /= fLen;
+
+    // Боковой вектор (side = forward x up)
+    float sx = fy * upZ - fz * upY;
+    float sy = fz * upX - fx * upZ;
+    float sz = fx * upY - fy * upX;
+    float sLen = std::sqrt(sx * sx + sy * sy + sz * sz);
+    sx /= sLen; sy /= sLen; sz /= sLen;
+
+    // Вертикальный вектор (u = side x forward)
+    float ux = sy * fz - sz * fy;
+    float uy = sz * fx - sx * fz;
+    float uz = sx * fy - sy * fx;
+
+    Mat4 r = {{ sx,  ux, -fx, 0.0f,
+                sy,  uy, -fy, 0.0f,
+                sz,  uz, -fz, 0.0f,
+              0.0f, 0.0f, 0.0f, 1.0f}};
+    return r * mat4Translate(-eyeX, -eyeY, -eyeZ);
+}
+
+// ═══════════════════════════════════════
+// Преобразование точек и векторов
+// ═══════════════════════════════════════
+
+void transformPoint(const Mat4& m, const float p[3], float out[4]) {
+#if defined(LAB_MATH_SSE)
+    __m128 r = _mm_mul_ps(_mm_loadu_ps(m.m), _mm_set1_ps(p[0]));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m.m + 4), _mm_set1_ps(p[1])));
+    r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m.m + 8), _mm_set1_ps(p[2])));
+    _mm_storeu_ps(out, _mm_add_ps(r, _mm_loadu_ps(m.m + 12)));
+#else
+    for (int row = 0; row < 4; ++row) {
+        out[row] = m.m[row] * p[0] + m.m[4 + row] * p[1] + m.m[8 + row] * p[2] + m.m[12 + row];
+    }
+#endif
+}
+
+void transformVector(const Mat4& m, const float v[3], float out[3]) {
+    for (int row = 0; row < 3; ++row) {
+        out[row] = m.m[row] * v[0] + m.m[4 + row] * v[1] + m.m[8 + row] * v[2];
+    }
+}
+
+void transformPoints(const Mat4& m, const float* in, std::size_t inStride, float* out, std::size_t count) {
+#if defined(LAB_MATH_SSE)
+    __m128 cols[4];
+    loadColumns(m.m, cols);
+    for (std::size_t i = 0; i < count; ++i, in += inStride, out += 4) {
+        __m128 r = _mm_mul_ps(cols[0], _mm_set1_ps(in[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(cols[1], _mm_set1_ps(in[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(cols[2], _mm_set1_ps(in[2])));
+        _mm_storeu_ps(out, _mm_add_ps(r, cols[3]));
+    }
+#else
+    for (std::size_t i = 0; i < count; ++i, in += inStride, out += 4) transformPoint(m, in, out);
+#endif
+}
+
+void transformVectors(const Mat4& m, const float* in, std::size_t inStride, float* out, std::size_t count) {
+#if defined(LAB_MATH_SSE)
+    __m128 cols[3];
+    for (int k = 0; k < 3; ++k) cols[k] = _mm_loadu_ps(m.m + k * 4);
+    // Четвёртая компонента пишется за пределы тройки — последний вектор считается отдельно
+    std::size_t fast = count > 0 ? count - 1 : 0;
+    for (std::size_t i = 0; i < fast; ++i, in += inStride, out += 3) {
+        __m128 r = _mm_mul_ps(cols[0], _mm_set1_ps(in[0]));
+        r = _mm_add_ps(r, _mm_mul_ps(cols[1], _mm_set1_ps(in[1])));
+        r = _mm_add_ps(r, _mm_mul_ps(cols[2], _mm_set1_ps(in[2])));
+        _mm_storeu_ps(out, r);
+    }
+    if (count > 0) transformVector(m, in, out);
+#else
+    for (std::size_t i = 0; i < count; ++i, in += inStride, out += 3) transformVector(m, in, out);
+#endif
+}
@@ -0,0 +1,52 @@
+// ═══════════════════════════════════════
+// Матрицы 4x4 на процессоре
+// Column-major порядок, как у OpenGL: построители повторяют
+// glTranslatef / glRotatef / glOrtho / glFrustum / gluLookAt.
+// Умножение, обращение и пакетные преобразования считаются
+// инструкциями SSE (пакеты матриц — AVX, если сборка его разрешает),
+// на остальных платформах — скалярно с тем же порядком операций
+// ═══════════════════════════════════════
+
+#pragma once
+
+#include <cstddef>
+
+// Матрица 4x4, m[col * 4 + row]
+struct Mat4 {
+    float m[16];
+};
+
+// out = a * b для матриц в column-major порядке
+void multiplyMatrix(const float a[16], const float b[16], float out[16]);
+
+Mat4 operator*(const Mat4& a, const Mat4& b);
+
+// out[i] = a * b[i] для count матриц (например, вид * модель всех объектов кадра)
+void mat4MultiplyBatch(const Mat4& a, const Mat4* b, Mat4* out, std::size_t count);
+
+// Обратная матрица; false — матрица вырождена (out не меняется)
+bool mat4Inverse(const Mat4& m, Mat4& out);
+
+Mat4 mat4Identity();
+Mat4 mat4Translate(float x, float y, float z);
+
+// Поворот на angleDeg градусов вокруг оси (x, y, z), ось нормализуется
+Mat4 mat4Rotate(float angleDeg, float x, float y, float z);
+
+Mat4 mat4Ortho(float left, float right, float bottom, float top, float zNear, float zFar);
+Mat4 mat4Frustum(float left, float right, float bottom, float top, float zNear, float zFar);
+Mat4 mat4Perspective(float fovyDeg, float aspect, float zNear, float zFar);
+Mat4 mat4LookAt(float eyeX, float eyeY, float eyeZ,
+                float centerX, float centerY, float centerZ,
+                float upX, float upY, float upZ);
+
+// out = M * (p, 1)
+void transformPoint(const Mat4& m, const float p[3], float out[4]);
+
+// out = верхний 3x3 блок M * v (направления и нормали при повороте без масштаба)
+void transformVector(const Mat4& m, const float v[3], float out[3]);
+
+// Пакетные варианты: точка/вектор i берётся из in + i * inStride (в числах float),
+// результаты пишутся подряд (по 4 числа для точек, по 3 — для векторов)
+void transformPoints(const Mat4& m, const float* in, std::size_t inStride, float* out, std::size_t count);
+void transformVectors(const Mat4& m, const float* in, std::size_t inStride, float* out, std::size_t count);